@@ -0,0 +1,194 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Keyframe animation engine for the display and the LED ladder. The host uploads short keyframe sequences into a
+ *  fixed pool of slots once, then starts them with a single command, so effects such as fade-ins, a blinking mute
+ *  indicator or a sweep to a new value cost no further host traffic while they play.
+ *
+ *  Each channel (number, ladder level and brightness) is kept in 8.8 fixed point and moved by a per-frame step
+ *  computed once at the start of each keyframe segment, so playback needs no division per frame. The engine is
+ *  stepped once per display frame from the main loop.
+ */
+
+#include "Animation.h"
+
+/** Number of interpolated channels in a keyframe. */
+#define ANIMATION_CHANNELS  3
+
+/** Pool of stored animation sequences. */
+static Animation_Keyframe_t Keyframes[ANIMATION_SLOTS][ANIMATION_SLOT_KEYFRAMES];
+
+/** Sequence being played, or \c NULL if no animation is running. */
+static const Animation_Keyframe_t* Sequence;
+
+/** Number of keyframes in the sequence being played. */
+static uint8_t SequenceLength;
+
+/** Index of the keyframe being moved towards. */
+static uint8_t KeyIndex;
+
+/** Display frames elapsed in the current keyframe segment. */
+static uint8_t Elapsed;
+
+/** Plays of the sequence left, or \ref ANIMATION_LOOP_FOREVER. */
+static uint8_t LoopsLeft;
+
+/** Current value of each channel, in 8.8 fixed point. */
+static uint16_t Values[ANIMATION_CHANNELS];
+
+/** Per-frame step of each channel in the current keyframe segment, in 8.8 fixed point. */
+static int16_t Steps[ANIMATION_CHANNELS];
+
+/** Retrieves the value of each channel of a keyframe.
+ *
+ *  \param[in]  Keyframe  Keyframe to read.
+ *  \param[out] Targets   Location where the value of each channel is to be stored.
+ */
+static void Animation_GetTargets(const Animation_Keyframe_t* const Keyframe,
+                                 uint8_t* const Targets)
+{
+	Targets[0] = Keyframe->Number;
+	Targets[1] = Keyframe->Level;
+	Targets[2] = (Keyframe->BrightnessFlags >> 4);
+}
+
+/** Starts the segment moving from the current values to the keyframe at \ref KeyIndex. */
+static void Animation_StartSegment(void)
+{
+	const Animation_Keyframe_t* Keyframe = &Sequence[KeyIndex];
+	uint8_t Targets[ANIMATION_CHANNELS];
+
+	Animation_GetTargets(Keyframe, Targets);
+	Elapsed = 0;
+
+	for (uint8_t Channel = 0; Channel < ANIMATION_CHANNELS; Channel++)
+	{
+		/* Single frame and stepped segments jump at their end, longer segments need at least two frames to
+		 * keep the step within 16 bits */
+		if ((Keyframe->Frames < 2) || (Keyframe->BrightnessFlags & ANIMATION_KEY_STEP))
+		  Steps[Channel] = 0;
+		else
+		  Steps[Channel] = (int16_t)((((int32_t)Targets[Channel] << 8) - Values[Channel]) / Keyframe->Frames);
+	}
+}
+
+/** Stores a keyframe of an animation sequence.
+ *
+ *  \param[in] Slot      Slot of the sequence, less than \ref ANIMATION_SLOTS.
+ *  \param[in] Index     Index of the keyframe in the sequence, less than \ref ANIMATION_SLOT_KEYFRAMES.
+ *  \param[in] Keyframe  Keyframe to store.
+ *
+ *  \return Boolean \c true if the keyframe was stored, \c false if the slot or index is out of range.
+ */
+bool Animation_SetKeyframe(const uint8_t Slot,
+                           const uint8_t Index,
+                           const Animation_Keyframe_t* const Keyframe)
+{
+	if ((Slot >= ANIMATION_SLOTS) || (Index >= ANIMATION_SLOT_KEYFRAMES))
+	  return false;
+
+	Keyframes[Slot][Index] = *Keyframe;
+	return true;
+}
+
+/** Starts playing a stored animation sequence, moving from the last values shown by the engine to its first
+ *  keyframe. Any animation already running is replaced.
+ *
+ *  \param[in] Slot           Slot of the sequence to play.
+ *  \param[in] KeyframeCount  Number of keyframes of the sequence to play, from the first.
+ *  \param[in] Loops          Number of times to play the sequence, or \ref ANIMATION_LOOP_FOREVER.
+ */
+void Animation_Start(const uint8_t Slot,
+                     const uint8_t KeyframeCount,
+                     const uint8_t Loops)
+{
+	if ((Slot >= ANIMATION_SLOTS) || !(KeyframeCount) || (KeyframeCount > ANIMATION_SLOT_KEYFRAMES))
+	{
+		Animation_Stop();
+		return;
+	}
+
+	Sequence       = Keyframes[Slot];
+	SequenceLength = KeyframeCount;
+	LoopsLeft      = Loops;
+	KeyIndex       = 0;
+
+	Animation_StartSegment();
+}
+
+/** Stops the running animation, leaving its last frame on the display. */
+void Animation_Stop(void)
+{
+	Sequence = NULL;
+}
+
+/** Steps the running animation by one display frame.
+ *
+ *  \param[out] Frame  Location where the display state for this frame is to be stored.
+ *
+ *  \return Boolean \c true if an animation is running and the frame was stored, \c false otherwise.
+ */
+bool Animation_Task(Animation_Frame_t* const Frame)
+{
+	if (Sequence == NULL)
+	  return false;
+
+	const Animation_Keyframe_t* Keyframe = &Sequence[KeyIndex];
+
+	if (Elapsed < Keyframe->Frames)
+	{
+		Elapsed++;
+
+		for (uint8_t Channel = 0; Channel < ANIMATION_CHANNELS; Channel++)
+		  Values[Channel] += Steps[Channel];
+	}
+
+	//Snap exactly onto the keyframe at the end of its segment, then move on to the next one
+	if (Elapsed >= Keyframe->Frames)
+	{
+		uint8_t Targets[ANIMATION_CHANNELS];
+
+		Animation_GetTargets(Keyframe, Targets);
+
+		for (uint8_t Channel = 0; Channel < ANIMATION_CHANNELS; Channel++)
+		  Values[Channel] = ((uint16_t)Targets[Channel] << 8);
+
+		if (++KeyIndex == SequenceLength)
+		{
+			KeyIndex = 0;
+
+			if ((LoopsLeft != ANIMATION_LOOP_FOREVER) && !(--LoopsLeft))
+			  Sequence = NULL;
+		}
+
+		if (Sequence != NULL)
+		  Animation_StartSegment();
+	}
+
+	Frame->Number     = (Values[0] + 0x80) >> 8;
+	Frame->Level      = (Values[1] + 0x80) >> 8;
+	Frame->Brightness = (Values[2] + 0x80) >> 8;
+	return true;
+}
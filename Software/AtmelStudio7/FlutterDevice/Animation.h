@@ -0,0 +1,88 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Animation.c.
+ */
+
+#ifndef _ANIMATION_H_
+#define _ANIMATION_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of animation sequences that can be stored at once. */
+		#define ANIMATION_SLOTS             4
+
+		/** Number of keyframes each stored animation sequence can hold. */
+		#define ANIMATION_SLOT_KEYFRAMES    8
+
+		/** Keyframe flag holding the previous keyframe's values until this keyframe is reached, then jumping to it,
+		 *  rather than interpolating between the two.
+		 */
+		#define ANIMATION_KEY_STEP          (1 << 0)
+
+		/** Mask of the keyframe flags within the \c BrightnessFlags field of a keyframe. */
+		#define ANIMATION_KEY_FLAGS_MASK    0x0F
+
+		/** Packs a digit brightness level and keyframe flags into the \c BrightnessFlags field of a keyframe. */
+		#define ANIMATION_KEY_BRIGHTNESS_FLAGS(Brightness, Flags)  (((Brightness) << 4) | ((Flags) & ANIMATION_KEY_FLAGS_MASK))
+
+		/** Loop count which repeats an animation until it is stopped. */
+		#define ANIMATION_LOOP_FOREVER      0
+
+	/* Type Defines: */
+		/** Type define for a single keyframe of an animation sequence. */
+		typedef struct
+		{
+			uint8_t Frames; /**< Display frames taken to move from the previous keyframe to this one. */
+			uint8_t Number; /**< Number shown on the display. */
+			uint8_t Level; /**< Level shown on the LED ladder, against the ladder thresholds. */
+			uint8_t BrightnessFlags; /**< Digit brightness in the high nibble, \c ANIMATION_KEY_* flags in the low nibble. */
+		} Animation_Keyframe_t;
+
+		/** Type define for the display state produced by the animation engine for one display frame. */
+		typedef struct
+		{
+			uint8_t Number; /**< Number to show on the display. */
+			uint8_t Level; /**< Level to show on the LED ladder. */
+			uint8_t Brightness; /**< Brightness level of the digits. */
+		} Animation_Frame_t;
+
+	/* Function Prototypes: */
+		bool Animation_SetKeyframe(const uint8_t Slot,
+		                           const uint8_t Index,
+		                           const Animation_Keyframe_t* const Keyframe) ATTR_NON_NULL_PTR_ARG(3);
+		void Animation_Start(const uint8_t Slot,
+		                     const uint8_t KeyframeCount,
+		                     const uint8_t Loops);
+		void Animation_Stop(void);
+		bool Animation_Task(Animation_Frame_t* const Frame) ATTR_NON_NULL_PTR_ARG(1);
+
+#endif
+
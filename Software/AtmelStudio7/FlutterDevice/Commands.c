@@ -0,0 +1,87 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Decoder for the host command stream. A single report may pack several commands, each encoded as a type byte,
+ *  a length byte and that many value bytes:
+ *
+ *  \verbatim
+ *  | Type | Length | Value ... | Type | Length | Value ... | 0x00 (end/padding) |
+ *  \endverbatim
+ *
+ *  Each command is dispatched through a table in FLASH memory mapping command types to handlers. Commands with an
+ *  unknown type or too short a value are skipped using their length, so older firmware ignores newer commands.
+ */
+
+#include "Commands.h"
+
+/** Decodes a command stream and executes each command through the given command table.
+ *
+ *  \param[in] Table      Pointer to the command table, located in FLASH memory.
+ *  \param[in] TableSize  Number of entries in the command table.
+ *  \param[in] Data       Pointer to the command stream.
+ *  \param[in] Length     Size in bytes of the command stream.
+ *
+ *  \return Number of commands executed.
+ */
+uint8_t Commands_Process(const Commands_Entry_t* const Table,
+                         const uint8_t TableSize,
+                         const uint8_t* Data,
+                         uint16_t Length)
+{
+	uint8_t Executed = 0;
+
+	while (Length >= COMMAND_HEADER_SIZE)
+	{
+		uint8_t Type        = Data[0];
+		uint8_t ValueLength = Data[1];
+
+		if ((Type == COMMAND_END) || (ValueLength > (Length - COMMAND_HEADER_SIZE)))
+		  break;
+
+		for (uint8_t EntryIndex = 0; EntryIndex < TableSize; EntryIndex++)
+		{
+			const Commands_Entry_t* Entry = &Table[EntryIndex];
+
+			if (pgm_read_byte(&Entry->Type) != Type)
+			  continue;
+
+			if (ValueLength >= pgm_read_byte(&Entry->MinLength))
+			{
+				Commands_Handler_t Handler = (Commands_Handler_t)pgm_read_ptr(&Entry->Handler);
+
+				Handler(&Data[COMMAND_HEADER_SIZE], ValueLength);
+				Executed++;
+			}
+
+			break;
+		}
+
+		Data   += (COMMAND_HEADER_SIZE + ValueLength);
+		Length -= (COMMAND_HEADER_SIZE + ValueLength);
+	}
+
+	return Executed;
+}
+
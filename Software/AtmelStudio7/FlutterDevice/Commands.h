@@ -0,0 +1,71 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Commands.c.
+ */
+
+#ifndef _COMMANDS_H_
+#define _COMMANDS_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/pgmspace.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Command type marking the end of a command stream. Reports are zero padded, so the padding after the last
+		 *  command ends the stream.
+		 */
+		#define COMMAND_END                0x00
+
+		/** Size in bytes of the header (type and length) preceding the value of each command in a stream. */
+		#define COMMAND_HEADER_SIZE        2
+
+	/* Type Defines: */
+		/** Type define for a command handler, called with the value of a command from the stream.
+		 *
+		 *  \param[in] Value   Pointer to the value bytes of the command.
+		 *  \param[in] Length  Number of value bytes, at least the minimum length given in the command table.
+		 */
+		typedef void (*Commands_Handler_t)(const uint8_t* Value, const uint8_t Length);
+
+		/** Type define for an entry of a command table, stored in FLASH memory. */
+		typedef struct
+		{
+			uint8_t            Type; /**< Command type the entry handles. */
+			uint8_t            MinLength; /**< Minimum length of the command value, shorter commands are ignored. */
+			Commands_Handler_t Handler; /**< Function called to execute the command. */
+		} Commands_Entry_t;
+
+	/* Function Prototypes: */
+		uint8_t Commands_Process(const Commands_Entry_t* const Table,
+		                         const uint8_t TableSize,
+		                         const uint8_t* Data,
+		                         uint16_t Length) ATTR_NON_NULL_PTR_ARG(1);
+
+#endif
+
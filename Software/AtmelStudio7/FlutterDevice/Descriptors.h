@@ -56,6 +56,7 @@
 			USB_Descriptor_Interface_t            HID_Interface;
 			USB_HID_Descriptor_HID_t              HID_GenericHID;
 			USB_Descriptor_Endpoint_t             HID_ReportINEndpoint;
+			USB_Descriptor_Endpoint_t             HID_ReportOUTEndpoint;
 		} USB_Descriptor_Configuration_t;
 
 		/** Enum for the device interface descriptor IDs within the device. Each interface descriptor
@@ -82,8 +83,36 @@
 		/** Endpoint address of the Generic HID reporting IN endpoint. */
 		#define GENERIC_IN_EPADDR         (ENDPOINT_DIR_IN | 1)
 
-		/** Size in bytes of the Generic HID reporting endpoint. */
-		#define GENERIC_EPSIZE            8
+		/** Endpoint address of the Generic HID reporting OUT endpoint. */
+		#define GENERIC_OUT_EPADDR        (ENDPOINT_DIR_OUT | 2)
+
+		/** Size in bytes of the Generic HID feature report, which must not exceed \c GENERIC_REPORT_SIZE as feature
+		 *  reports are read back through the same buffer as IN reports.
+		 */
+		#define GENERIC_FEATURE_SIZE      8
+
+		#if defined(GENERIC_FULL_SPEED_REPORTS) || defined(__DOXYGEN__)
+			/** Size in bytes of the Generic HID reporting endpoints. */
+			#define GENERIC_EPSIZE            64
+
+			/** Number of banks of the Generic HID reporting endpoints, so that one bank can be filled or
+			 *  drained by the firmware while the other is being transferred to or from the host.
+			 */
+			#define GENERIC_EPBANKS           2
+
+			/** Polling interval in milliseconds of the Generic HID reporting IN endpoint. */
+			#define GENERIC_IN_INTERVAL_MS    1
+
+			/** Vendor usage of the Generic HID report collection, distinct for each report size so that hosts
+			 *  which cannot see the endpoint descriptors can tell how long the reports are.
+			 */
+			#define GENERIC_COLLECTION_USAGE  0x40
+		#else
+			#define GENERIC_EPSIZE            8
+			#define GENERIC_EPBANKS           1
+			#define GENERIC_IN_INTERVAL_MS    5
+			#define GENERIC_COLLECTION_USAGE  0x01
+		#endif
 
 	/* Function Prototypes: */
 		uint16_t CALLBACK_USB_GetDescriptor(const uint16_t wValue,
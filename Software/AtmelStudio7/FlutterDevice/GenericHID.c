@@ -31,8 +31,68 @@
 /** Buffer to hold the previously generated HID report, for comparison purposes inside the HID class driver. */
 static uint8_t PrevHIDReportBuffer[GENERIC_REPORT_SIZE];
 
-//Globals for holding the volume info to be passed between display and rotary
-uint8_t* current = 0;
+/** Buffer to hold output reports received on the HID OUT endpoint, before they are processed. */
+static uint8_t HIDReportOUTBuffer[GENERIC_REPORT_SIZE];
+
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+/** Buffer to hold the HID IN report being sent by the endpoint interrupt. */
+static uint8_t HIDReportINBuffer[GENERIC_REPORT_SIZE];
+#endif
+
+/** Sequence number of the last IN report sent to the host. */
+static uint8_t ReportSequence;
+
+/** Set once the host has sent a level, from then on the LED ladder shows the meter rather than the USB status. */
+static bool LadderFromMeter;
+
+/** Set while the display shows frames of an animation, whose brightness channel overrides the saved brightness. */
+static bool AnimationShown;
+
+/** Settings used until the host changes them and they are saved to EEPROM. */
+static const Settings_t PROGMEM DefaultSettings =
+	{
+		.RotaryMax   = 100,
+		.RotaryCurve = ROTARY_ACCEL_STEEP,
+		.Thresholds  = {15, 25, 35, 50},
+		.Brightness  = {SS_4201AS_BRIGHTNESS_MAX, SS_4201AS_BRIGHTNESS_MAX},
+		.RefreshHz   = 100,
+		.Meter       =
+			{
+				.Attack       = METER_COEFF_INSTANT,
+				.Release      = METER_COEFF_INSTANT,
+				.PeakHold     = 0,
+				.PeakDecay    = 0,
+				.SamplePeriod = 1,
+			},
+		.Buttons     =
+			{
+				.LongPress   = 50,
+				.DoubleClick = 25,
+			},
+	};
+
+/** Feature page selected for reading back by GET_FEATURE. */
+static uint8_t FeaturePage;
+
+/** Level last written to \ref FEATURE_PAGE_PROBE. */
+static uint8_t ProbeLevel;
+
+/** Low power statistics and register snapshot, the data of \ref FEATURE_PAGE_POWER. */
+static uint8_t PowerStats[POWER_PAGE_SIZE];
+
+/** Board LED mask of each LED of the ladder, in the order used by the host. */
+static const uint8_t PROGMEM LadderLEDMasks[LADDER_LED_COUNT] = {LEDS_LED1, LEDS_LED2, LEDS_LED3, LEDS_LED4};
+
+/** Board button mask of each button, in the order used by the host. */
+static const uint8_t PROGMEM ButtonMasks[GESTURES_BUTTON_COUNT] = {BUTTONS_BUTTON1, BUTTONS_BUTTON2};
+
+#if defined(INTERRUPT_DATA_ENDPOINTS)
+/** Transfer callback for an output report received on the OUT endpoint, waking the main loop to process it. */
+static void ReportOUTReceived(USB_Endpoint_Transfer_t* const Transfer)
+{
+	Scheduler_PostEvent(SCHED_EVENT_USB);
+}
+#endif
 
 /** LUFA HID Class driver interface configuration and state information. This structure is
  *  passed to all HID Class driver functions, so that multiple instances of the same class
@@ -47,14 +107,127 @@ USB_ClassInfo_HID_Device_t Generic_HID_Interface =
 					{
 						.Address              = GENERIC_IN_EPADDR,
 						.Size                 = GENERIC_EPSIZE,
-						.Banks                = 1,
+						.Banks                = GENERIC_EPBANKS,
+					},
+				.ReportOUTEndpoint            =
+					{
+						.Address              = GENERIC_OUT_EPADDR,
+						.Size                 = GENERIC_EPSIZE,
+						.Banks                = GENERIC_EPBANKS,
 					},
 				.PrevReportINBuffer           = PrevHIDReportBuffer,
 				.PrevReportINBufferSize       = sizeof(PrevHIDReportBuffer),
+				.ReportOUTBuffer              = HIDReportOUTBuffer,
+				.ReportOUTBufferSize          = sizeof(HIDReportOUTBuffer),
+				#if defined(INTERRUPT_DATA_ENDPOINTS)
+				.ReportINBuffer               = HIDReportINBuffer,
+				.ReportOUTReceived            = ReportOUTReceived,
+				#endif
 			},
 	};
 
 
+/** Sets the system clock prescaler. The new setting must be written within four cycles of enabling the change,
+ *  so interrupts are held off while doing so.
+ *
+ *  \param[in] Division  Prescaler setting as the \c CLKPS bits of \c CLKPR, zero for the full clock speed.
+ */
+static void SetClockDivision(const uint8_t Division)
+{
+	// clock_prescale_set() implementation missing - http://savannah.nongnu.org/bugs/?39061
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	CLKPR = (1 << CLKPCE);
+	CLKPR = Division;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Applies the saved refresh rate and brightness to the display, which \c SS_4201AS_Init() resets. */
+static void ApplyDisplaySettings(void)
+{
+	SS_4201AS_SetRefreshRate(Settings.RefreshHz);
+	for (uint8_t Digit = 0; Digit < SS_4201AS_DIGITS; Digit++)
+	  SS_4201AS_SetBrightness(Digit, Settings.Brightness[Digit]);
+}
+
+/** Gives the display back its saved brightness once an animation has stopped showing on it. */
+static void RestoreBrightness(void)
+{
+	if (!(AnimationShown))
+	  return;
+
+	AnimationShown = false;
+	for (uint8_t Digit = 0; Digit < SS_4201AS_DIGITS; Digit++)
+	  SS_4201AS_SetBrightness(Digit, Settings.Brightness[Digit]);
+}
+
+/** Stops the running animation, handing the display back to the commands that stopped it. */
+static void StopAnimation(void)
+{
+	Animation_Stop();
+	RestoreBrightness();
+}
+
+/** Keeps the device in its low power state for as long as the bus is suspended. The display and LEDs are turned
+ *  off, unused peripherals are powered down and the core sleeps in power down mode on a prescaled clock, from
+ *  which only the USB controller or the encoder's pin change interrupt can wake it. Turning the encoder signals a
+ *  remote wakeup to the host if the host has enabled them.
+ */
+static void RunSuspended(void)
+{
+	uint8_t SavedPRR0  = PRR0;
+	uint8_t SavedPRR1  = PRR1;
+	uint8_t SavedLEDs  = LEDs_GetLEDs();
+	bool    WakeupSent = false;
+
+	PowerStats[POWER_SUSPENDS]++;
+
+	WATCHDOG_PAUSE();
+	SS_4201AS_Disable();
+	LEDs_SetAllLEDs(LEDS_NO_LEDS);
+
+	PRR0 |= POWER_PRR0_SUSPENDED;
+	PRR1 |= POWER_PRR1_SUSPENDED;
+
+	/* A wakeup posts an event before leaving the suspended state, so the core cannot go back to sleep once
+	 * the bus has resumed */
+	while (USB_DeviceState == DEVICE_STATE_Suspended)
+	{
+		//Once a remote wakeup has been signalled the USB clock is running again, so only idle until the host resumes
+		set_sleep_mode(WakeupSent ? SLEEP_MODE_IDLE : SLEEP_MODE_PWR_DOWN);
+		SetClockDivision(SUSPEND_CLOCK_DIVISION);
+
+		PowerStats[POWER_SLEEP_SMCR]   = SMCR;
+		PowerStats[POWER_SLEEP_PRR0]   = PRR0;
+		PowerStats[POWER_SLEEP_PRR1]   = PRR1;
+		PowerStats[POWER_SLEEP_TCCR0B] = TCCR0B;
+		PowerStats[POWER_SLEEP_CLKPR]  = CLKPR;
+
+		uint8_t Events = Scheduler_WaitForEvents(true);
+
+		SetClockDivision(0);
+
+		if ((Events & SCHED_EVENT_ENCODER) && USB_Device_RemoteWakeupEnabled && !(WakeupSent))
+		{
+			USB_Device_SendRemoteWakeup();
+			PowerStats[POWER_REMOTE_WAKEUPS]++;
+			WakeupSent = true;
+		}
+	}
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	PRR0 = SavedPRR0;
+	PRR1 = SavedPRR1;
+
+	SS_4201AS_Init();
+	ApplyDisplaySettings();
+	LEDs_SetAllLEDs(SavedLEDs);
+	WATCHDOG_RESUME();
+}
+
 /** Main program entry point. This routine contains the overall program flow, including initial
  *  setup of all components and the main program loop.
  */
@@ -68,28 +241,71 @@ int main(void)
 
 	for (;;)
 	{
-		HID_Device_USBTask(&Generic_HID_Interface);
-		USB_USBTask();
+		if (USB_DeviceState == DEVICE_STATE_Suspended)
+		  RunSuspended();
+
+		/* Sleep until an interrupt posts some work. With deferred control requests the endpoint interrupt wakes
+		 * the core for every request the main loop has to answer, so it may sleep from power on; otherwise the
+		 * control endpoint is polled, and the core is only allowed to sleep once configured, where start of frame
+		 * events then bound the request latency to 1ms */
+		#if defined(DEFERRED_CONTROL_REQUESTS)
+		uint8_t Events = Scheduler_WaitForEvents(true);
+		#else
+		uint8_t Events = Scheduler_WaitForEvents(USB_DeviceState == DEVICE_STATE_Configured);
+		#endif
+
+		WATCHDOG_BEGIN_ITERATION();
+
+		if (Events & SCHED_EVENT_USB)
+		{
+			PROFILE_BEGIN(PROFILE_PROBE_HID_TASK);
+			HID_Device_USBTask(&Generic_HID_Interface);
+			PROFILE_END(PROFILE_PROBE_HID_TASK);
+
+			PROFILE_BEGIN(PROFILE_PROBE_USB_TASK);
+			USB_USBTask();
+			PROFILE_END(PROFILE_PROBE_USB_TASK);
+		}
+
+		if (Events & SCHED_EVENT_DISPLAY)
+		{
+			UpdateDisplay();
+			Settings_Task();
+		}
+
+		WATCHDOG_END_ITERATION();
 	}
 }
 
 /** Configures the board hardware and chip peripherals for the demo's functionality. */
 void SetupHardware(void)
 {
-	/* Disable watchdog if enabled by bootloader/fuses */
+	/* Disable watchdog if enabled by bootloader/fuses, or hand it over to the main loop supervisor */
+	#if defined(WATCHDOG_ENABLED)
+	Watchdog_Init();
+	#else
 	MCUSR &= ~(1 << WDRF);
 	wdt_disable();
+	#endif
 
 	/* Disable clock division */
-	// Implementation missing - http://savannah.nongnu.org/bugs/?39061
-	// clock_prescale_set(clock_div_1);
-	CLKPR = (1 << CLKPCE);
-	CLKPR = (0 << CLKPS3) | (0 << CLKPS2) | (0 << CLKPS1) | (0 << CLKPS0);
+	SetClockDivision(0);
 
 	/* Hardware Initialization */
+	Scheduler_Init();
+	#if defined(PROFILE_ENABLED)
+	Profile_Init();
+	#endif
+	Settings_Init(&DefaultSettings);
+	Ladder_SetThresholds(Settings.Thresholds);
+	Meter_SetConfig(&Settings.Meter);
 	LEDs_Init();
 	SS_4201AS_Init();
-	Rotary_Init(100);
+	ApplyDisplaySettings();
+	Rotary_Init(Settings.RotaryMax);
+	Rotary_SetAccelCurve(Settings.RotaryCurve);
+	Gestures_SetConfig(&Settings.Buttons);
+	Buttons_Init();
 	USB_Init();
 }
 
@@ -124,10 +340,120 @@ void EVENT_USB_Device_ControlRequest(void)
 	HID_Device_ProcessControlRequest(&Generic_HID_Interface);
 }
 
+#if defined(DEFERRED_CONTROL_REQUESTS)
+/** Event handler for a control request deferred by the endpoint interrupt, waking the main loop to run it. */
+void EVENT_USB_Device_ControlRequestDeferred(void)
+{
+	Scheduler_PostEvent(SCHED_EVENT_USB);
+}
+#endif
+
 /** Event handler for the USB device Start Of Frame event. */
 void EVENT_USB_Device_StartOfFrame(void)
 {
 	HID_Device_MillisecondElapsed(&Generic_HID_Interface);
+	Scheduler_PostEvent(SCHED_EVENT_USB);
+}
+
+/** Event handler for the USB device Suspend event, waking the main loop to enter the low power state. */
+void EVENT_USB_Device_Suspend(void)
+{
+	Scheduler_PostEvent(SCHED_EVENT_USB);
+}
+
+/** Event handler for the USB device Wake Up event, waking the main loop to leave the low power state. */
+void EVENT_USB_Device_WakeUp(void)
+{
+	Scheduler_PostEvent(SCHED_EVENT_USB);
+}
+
+/** Event handler for the rotary encoder, fired from its ISR for each counted detent. */
+void EVENT_Rotary_Turned(const int8_t Steps)
+{
+	InputQueue_Push(Steps, 0);
+	Scheduler_PostEvent(SCHED_EVENT_ENCODER);
+}
+
+/** Event handler for the buttons, fired from their sampling ISR with the debounced buttons held down. */
+void EVENT_Buttons_Sampled(const uint8_t Pressed)
+{
+	uint8_t HostPressed = 0;
+
+	for (uint8_t ButtonIndex = 0; ButtonIndex < GESTURES_BUTTON_COUNT; ButtonIndex++)
+	{
+		if (Pressed & pgm_read_byte(&ButtonMasks[ButtonIndex]))
+		  HostPressed |= (1 << ButtonIndex);
+	}
+
+	uint8_t Gestures = Gestures_Update(HostPressed, (1000 / BUTTONS_SAMPLE_HZ));
+
+	if (Gestures)
+	{
+		InputQueue_Push(0, Gestures);
+		Scheduler_PostEvent(SCHED_EVENT_BUTTONS);
+	}
+}
+
+/** Event handler for the 4201AS display, fired from its ISR at the end of each multiplex frame. */
+void EVENT_SS_4201AS_FrameComplete(void)
+{
+	InputQueue_Flush();
+	Trace_FrameShown(SS_4201AS_GetShownSerial(), USB_Device_GetFrameNumber());
+	Scheduler_PostEvent(SCHED_EVENT_DISPLAY);
+}
+
+#if defined(PROFILE_ENABLED)
+/** Depth of USB controller ISRs currently running, as the endpoint and general ISRs may preempt each other. */
+static uint8_t USBInterruptDepth;
+
+/** Event handler for entry to a USB controller ISR, starting its profiling probe unless another USB controller ISR
+ *  was preempted, whose run then includes this one.
+ */
+void EVENT_USB_InterruptEntry(void)
+{
+	if (!(USBInterruptDepth++))
+	  PROFILE_BEGIN(PROFILE_PROBE_USB_ISR);
+}
+
+/** Event handler for exit from a USB controller ISR, finishing its profiling probe once no USB controller ISR is
+ *  left running.
+ */
+void EVENT_USB_InterruptExit(void)
+{
+	if (!(--USBInterruptDepth))
+	  PROFILE_END(PROFILE_PROBE_USB_ISR);
+}
+
+/** Event handler for entry to the display multiplex ISR, starting its profiling probe. */
+void EVENT_SS_4201AS_InterruptEntry(void)
+{
+	PROFILE_BEGIN(PROFILE_PROBE_DISPLAY_ISR);
+}
+
+/** Event handler for exit from the display multiplex ISR, finishing its profiling probe. */
+void EVENT_SS_4201AS_InterruptExit(void)
+{
+	PROFILE_END(PROFILE_PROBE_DISPLAY_ISR);
+}
+#endif
+
+/** Widens a gesture mask to all the gesture flags of each button with a gesture in it.
+ *
+ *  \param[in] Gestures  Gesture mask, as in \ref REPORT_IN_BUTTONS.
+ *
+ *  \return Mask of the gesture flags of every button with a gesture in \c Gestures.
+ */
+static uint8_t GestureButtons(const uint8_t Gestures)
+{
+	uint8_t Buttons = 0;
+
+	for (uint8_t ButtonIndex = 0; ButtonIndex < GESTURES_BUTTON_COUNT; ButtonIndex++)
+	{
+		if (Gestures & GESTURE_BUTTON_MASK(ButtonIndex))
+		  Buttons |= GESTURE_BUTTON_MASK(ButtonIndex);
+	}
+
+	return Buttons;
 }
 
 /** HID class driver callback function for the creation of HID reports to the host.
@@ -146,14 +472,357 @@ bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDIn
                                          void* ReportData,
                                          uint16_t* const ReportSize)
 {
-	//Send back the current value controlled by the rotary encoder
 	uint8_t* Data = (uint8_t*)ReportData;
 
-	
-	*ReportSize = sizeof(uint8_t);
-	return false;
+	if (ReportType == HID_REPORT_ITEM_Feature)
+	{
+		CreateFeatureReport(Data);
+
+		*ReportSize = GENERIC_FEATURE_SIZE;
+		return true;
+	}
+
+	InputQueue_Event_t Event;
+	int16_t Steps       = 0;
+	uint8_t ButtonEdges = 0;
+	bool    HasInput    = false;
+
+	/* Coalesce queued input into this report for as long as nothing would be lost or reordered by doing so. A report
+	 * reads as its steps followed by at most one batch of gestures per button, so it ends before a turn that follows a
+	 * gesture and before a further gesture of a button that already has one */
+	while (InputQueue_Peek(&Event))
+	{
+		int16_t MergedSteps = (Steps + Event.Steps);
+
+		if ((MergedSteps > INT8_MAX) || (MergedSteps < INT8_MIN) || (ButtonEdges && Event.Steps) ||
+		    (GestureButtons(ButtonEdges) & Event.ButtonEdges))
+		{
+			break;
+		}
+
+		Steps        = MergedSteps;
+		ButtonEdges |= Event.ButtonEdges;
+		HasInput     = true;
+
+		InputQueue_Pop();
+	}
+
+	//Return a completed trace along with any input
+	bool HasTrace = Trace_GetResult(USB_Device_GetFrameNumber(), &Data[REPORT_IN_TRACE_ID]);
+
+	//Only send a report when there is new input, so that idle repeats never duplicate a delta
+	if (!(HasInput || HasTrace))
+	{
+		*ReportSize = 0;
+		return false;
+	}
+
+	//Send back the input along with the current value controlled by the rotary encoder
+	Data[REPORT_IN_SEQUENCE] = ++ReportSequence;
+	Data[REPORT_IN_STEPS]    = (uint8_t)Steps;
+	Data[REPORT_IN_BUTTONS]  = ButtonEdges;
+	Rotary_GetCount(&Data[REPORT_IN_COUNT]);
+
+	*ReportSize = GENERIC_REPORT_SIZE;
+	return true;
+}
+
+/** Fills a feature report with the feature page selected by the host.
+ *
+ *  \param[out] Data  Feature report of \c GENERIC_FEATURE_SIZE bytes to fill.
+ */
+void CreateFeatureReport(uint8_t* const Data)
+{
+	Data[FEATURE_SELECTOR] = FeaturePage;
+
+	if (FeaturePage == FEATURE_PAGE_PROBE)
+	{
+		Data[FEATURE_DATA]     = ProbeLevel;
+		Data[FEATURE_DATA + 1] = Ladder_LevelToMask(ProbeLevel);
+	}
+	else if (FeaturePage == FEATURE_PAGE_POWER)
+	{
+		memcpy(&Data[FEATURE_DATA], PowerStats, sizeof(PowerStats));
+	}
+	#if defined(WATCHDOG_ENABLED)
+	else if ((FeaturePage >= FEATURE_PAGE_WATCHDOG) && (FeaturePage < (FEATURE_PAGE_WATCHDOG + WATCHDOG_PAGE_COUNT)))
+	{
+		Watchdog_ReadPage(FeaturePage - FEATURE_PAGE_WATCHDOG, &Data[FEATURE_DATA]);
+	}
+	#endif
+	#if defined(PROFILE_ENABLED)
+	else if (FeaturePage >= FEATURE_PAGE_PROFILE)
+	{
+		uint8_t ProfilePage = (FeaturePage - FEATURE_PAGE_PROFILE);
+
+		Profile_ReadPage(ProfilePage / PROFILE_PAGE_COUNT, ProfilePage % PROFILE_PAGE_COUNT, &Data[FEATURE_DATA]);
+	}
+	#endif
+	else
+	{
+		Ladder_ReadPage(FeaturePage - FEATURE_PAGE_LADDER, &Data[FEATURE_DATA]);
+	}
+}
+
+/** Processes a feature report from the host, selecting the feature page to read back and writing it unless
+ *  \ref FEATURE_SELECT_ONLY is set.
+ *
+ *  \param[in] Data        Feature report sent by the host.
+ *  \param[in] ReportSize  Size in bytes of the feature report.
+ */
+void ProcessFeatureReport(const uint8_t* const Data,
+                          const uint16_t ReportSize)
+{
+	if (ReportSize < GENERIC_FEATURE_SIZE)
+	  return;
+
+	FeaturePage = (Data[FEATURE_SELECTOR] & ~FEATURE_SELECT_ONLY);
+
+	if (Data[FEATURE_SELECTOR] & FEATURE_SELECT_ONLY)
+	  return;
+
+	if (FeaturePage == FEATURE_PAGE_PROBE)
+	  ProbeLevel = Data[FEATURE_DATA];
+	else if (FeaturePage == FEATURE_PAGE_POWER)
+	  memset(PowerStats, 0, sizeof(PowerStats));
+	#if defined(WATCHDOG_ENABLED)
+	else if (FeaturePage == FEATURE_PAGE_WATCHDOG)
+	  Watchdog_Clear();
+	else if ((FeaturePage > FEATURE_PAGE_WATCHDOG) && (FeaturePage < (FEATURE_PAGE_WATCHDOG + WATCHDOG_PAGE_COUNT)))
+	  return;
+	#endif
+	#if defined(PROFILE_ENABLED)
+	else if (FeaturePage >= FEATURE_PAGE_PROFILE)
+	  Profile_Latch((FeaturePage - FEATURE_PAGE_PROFILE) / PROFILE_PAGE_COUNT);
+	#endif
+	else
+	  Ladder_WritePage(FeaturePage - FEATURE_PAGE_LADDER, &Data[FEATURE_DATA]);
+}
+
+/** Converts a host LED mask (bit 0 for LED 1 through bit 3 for LED 4) to the board LED mask. */
+static uint8_t LadderToLEDMask(const uint8_t LadderMask)
+{
+	uint8_t LEDMask = LEDS_NO_LEDS;
+
+	for (uint8_t LEDIndex = 0; LEDIndex < LADDER_LED_COUNT; LEDIndex++)
+	{
+		if (LadderMask & (1 << LEDIndex))
+		  LEDMask |= pgm_read_byte(&LadderLEDMasks[LEDIndex]);
+	}
+
+	return LEDMask;
+}
+
+/** Steps the level meter by one display frame and shows it on the LED ladder, with the peak indicator lighting
+ *  the highest LED its level has reached on top of the bar.
+ */
+void RenderLadder(void)
+{
+	Meter_Task();
+
+	if (!(LadderFromMeter))
+	  return;
+
+	uint8_t LadderMask = Ladder_LevelToMask(Meter_GetLevel());
+	uint8_t Peak;
+
+	if (Meter_GetPeak(&Peak))
+	{
+		uint8_t PeakMask = Ladder_LevelToMask(Peak);
+
+		//Keep only the highest LED of the peak
+		for (uint8_t LEDIndex = LADDER_LED_COUNT; LEDIndex-- > 0;)
+		{
+			if (PeakMask & (1 << LEDIndex))
+			{
+				LadderMask |= (1 << LEDIndex);
+				break;
+			}
+		}
+	}
+
+	LEDs_SetAllLEDs(LadderToLEDMask(LadderMask));
+}
+
+/** Advances the display by one frame, showing the running animation if there is one, or else the level meter. */
+void UpdateDisplay(void)
+{
+	Animation_Frame_t Frame;
+
+	if (!(Animation_Task(&Frame)))
+	{
+		//An animation that has played out leaves its last number and level, but not its brightness
+		RestoreBrightness();
+		RenderLadder();
+		return;
+	}
+
+	AnimationShown = true;
+	SS_4201AS_SetNum(Frame.Number);
+	SS_4201AS_SetAllBrightness(Frame.Brightness);
+	LEDs_SetAllLEDs(LadderToLEDMask(Ladder_LevelToMask(Frame.Level)));
 }
 
+/** Handler for \ref COMMAND_SET_NUMBER. */
+static void Command_SetNumber(const uint8_t* Value, const uint8_t Length)
+{
+	//Direct display commands always take over from a running animation
+	StopAnimation();
+	//Set the new byte into the stream
+	SS_4201AS_SetNum(Value[0]);
+	//Give the volume to the rotary encoder so turning continues from the host's value
+	Rotary_SetCount(Value[0]);
+}
+
+/** Handler for \ref COMMAND_SET_LEDS. */
+static void Command_SetLEDs(const uint8_t* Value, const uint8_t Length)
+{
+	StopAnimation();
+	LadderFromMeter = false;
+	LEDs_SetAllLEDs(LadderToLEDMask(Value[0]));
+}
+
+/** Handler for \ref COMMAND_SET_LEVEL. */
+static void Command_SetLevel(const uint8_t* Value, const uint8_t Length)
+{
+	StopAnimation();
+	LadderFromMeter = true;
+	Meter_PushSamples(Value, 1);
+}
+
+/** Handler for \ref COMMAND_SET_THRESHOLDS. */
+static void Command_SetThresholds(const uint8_t* Value, const uint8_t Length)
+{
+	memcpy(Settings.Thresholds, Value, sizeof(Settings.Thresholds));
+	Settings_Changed();
+
+	Ladder_SetThresholds(Settings.Thresholds);
+}
+
+/** Handler for \ref COMMAND_METER_SAMPLES. */
+static void Command_MeterSamples(const uint8_t* Value, const uint8_t Length)
+{
+	StopAnimation();
+	LadderFromMeter = true;
+	Meter_PushSamples(Value, Length);
+}
+
+/** Handler for \ref COMMAND_SET_METER. */
+static void Command_SetMeter(const uint8_t* Value, const uint8_t Length)
+{
+	Settings.Meter = (Meter_Config_t)
+		{
+			.Attack       = Value[0],
+			.Release      = Value[1],
+			.PeakHold     = Value[2],
+			.PeakDecay    = Value[3],
+			.SamplePeriod = Value[4],
+		};
+	Settings_Changed();
+
+	Meter_SetConfig(&Settings.Meter);
+}
+
+/** Handler for \ref COMMAND_ANIM_KEYFRAME. */
+static void Command_AnimKeyframe(const uint8_t* Value, const uint8_t Length)
+{
+	Animation_Keyframe_t Keyframe =
+		{
+			.Frames          = Value[1],
+			.Number          = Value[2],
+			.Level           = Value[3],
+			.BrightnessFlags = Value[4],
+		};
+
+	Animation_SetKeyframe((Value[0] >> 4), (Value[0] & 0x0F), &Keyframe);
+}
+
+/** Handler for \ref COMMAND_ANIM_START. */
+static void Command_AnimStart(const uint8_t* Value, const uint8_t Length)
+{
+	Animation_Start(Value[0], Value[1], Value[2]);
+}
+
+/** Handler for \ref COMMAND_ANIM_STOP. */
+static void Command_AnimStop(const uint8_t* Value, const uint8_t Length)
+{
+	StopAnimation();
+}
+
+/** Handler for \ref COMMAND_SET_BRIGHTNESS. */
+static void Command_SetBrightness(const uint8_t* Value, const uint8_t Length)
+{
+	for (uint8_t Digit = 0; Digit < SS_4201AS_DIGITS; Digit++)
+	{
+		//A single level sets both digits
+		Settings.Brightness[Digit] = MIN(Value[(Length >= SS_4201AS_DIGITS) ? Digit : 0], SS_4201AS_BRIGHTNESS_MAX);
+		SS_4201AS_SetBrightness(Digit, Settings.Brightness[Digit]);
+	}
+
+	Settings_Changed();
+}
+
+/** Handler for \ref COMMAND_SET_REFRESH. */
+static void Command_SetRefresh(const uint8_t* Value, const uint8_t Length)
+{
+	//Save the rate the display actually runs at, rather than one it would clamp on every boot
+	Settings.RefreshHz = MIN(MAX(Value[0], SS_4201AS_MIN_REFRESH_HZ), SS_4201AS_MAX_REFRESH_HZ);
+	Settings_Changed();
+
+	SS_4201AS_SetRefreshRate(Settings.RefreshHz);
+}
+
+/** Handler for \ref COMMAND_SET_ENCODER. */
+static void Command_SetEncoder(const uint8_t* Value, const uint8_t Length)
+{
+	//Unknown curves are refused whole, so that they are never saved
+	if (Value[1] >= ROTARY_ACCEL_CURVES)
+	  return;
+
+	Settings.RotaryMax   = Value[0];
+	Settings.RotaryCurve = Value[1];
+	Settings_Changed();
+
+	Rotary_SetMax(Settings.RotaryMax);
+	Rotary_SetAccelCurve(Settings.RotaryCurve);
+}
+
+/** Handler for \ref COMMAND_SET_BUTTONS. */
+static void Command_SetButtons(const uint8_t* Value, const uint8_t Length)
+{
+	Settings.Buttons.LongPress   = Value[0];
+	Settings.Buttons.DoubleClick = Value[1];
+	Settings_Changed();
+
+	Gestures_SetConfig(&Settings.Buttons);
+}
+
+/** Handler for \ref COMMAND_TRACE. */
+static void Command_Trace(const uint8_t* Value, const uint8_t Length)
+{
+	if (Value[0] != TRACE_ID_NONE)
+	  Trace_Arrived(Value[0], USB_Device_GetFrameNumber());
+}
+
+/** Table of the commands understood in the host command stream. */
+static const Commands_Entry_t PROGMEM CommandTable[] =
+	{
+		{.Type = COMMAND_SET_NUMBER,     .MinLength = 1,                .Handler = Command_SetNumber},
+		{.Type = COMMAND_SET_LEDS,       .MinLength = 1,                .Handler = Command_SetLEDs},
+		{.Type = COMMAND_SET_LEVEL,      .MinLength = 1,                .Handler = Command_SetLevel},
+		{.Type = COMMAND_SET_THRESHOLDS, .MinLength = LADDER_LED_COUNT, .Handler = Command_SetThresholds},
+		{.Type = COMMAND_SET_BRIGHTNESS, .MinLength = 1,                .Handler = Command_SetBrightness},
+		{.Type = COMMAND_SET_REFRESH,    .MinLength = 1,                .Handler = Command_SetRefresh},
+		{.Type = COMMAND_METER_SAMPLES,  .MinLength = 1,                .Handler = Command_MeterSamples},
+		{.Type = COMMAND_SET_METER,      .MinLength = 5,                .Handler = Command_SetMeter},
+		{.Type = COMMAND_ANIM_KEYFRAME,  .MinLength = 5,                .Handler = Command_AnimKeyframe},
+		{.Type = COMMAND_ANIM_START,     .MinLength = 3,                .Handler = Command_AnimStart},
+		{.Type = COMMAND_ANIM_STOP,      .MinLength = 0,                .Handler = Command_AnimStop},
+		{.Type = COMMAND_SET_ENCODER,    .MinLength = 2,                .Handler = Command_SetEncoder},
+		{.Type = COMMAND_TRACE,          .MinLength = 1,                .Handler = Command_Trace},
+		{.Type = COMMAND_SET_BUTTONS,    .MinLength = 2,                .Handler = Command_SetButtons},
+	};
+
 /** HID class driver callback function for the processing of HID reports from the host.
  *
  *  \param[in] HIDInterfaceInfo  Pointer to the HID class interface configuration structure being referenced
@@ -168,31 +837,32 @@ void CALLBACK_HID_Device_ProcessHIDReport(USB_ClassInfo_HID_Device_t* const HIDI
                                           const void* ReportData,
                                           const uint16_t ReportSize)
 {
-	uint8_t* Data = (uint8_t*)ReportData;
-	
-	uint8_t  NewLEDMask = LEDS_NO_LEDS;
-
-	//Check for the command being sent from master
-	if (Data[0] == 0x80){
-		//Set the new byte into the stream
-		SS_4201AS_SetNum(Data[1]);
-		//Give the volume to the current for manipulation by the rotary later
-		*current = Data[1];
-		//If the level is greater than 10 light up LED 1
-		if(Data[2] >= 15 && Data[2] < 25){
-			NewLEDMask |= LEDS_LED1;
-		}
-		else if(Data[2] >= 25 && Data[2] < 35){
-			NewLEDMask |= (LEDS_LED1|LEDS_LED2);
-		}
-		else if(Data[2] >= 35 && Data[2] < 50){
-			NewLEDMask |= (LEDS_LED1|LEDS_LED2|LEDS_LED3);
-		}
-		else if(Data[2] >= 50){
-			NewLEDMask |= LEDS_ALL_LEDS;
+	const uint8_t* Data = (const uint8_t*)ReportData;
+
+	if (!(ReportSize))
+	  return;
+
+	if (ReportType == HID_REPORT_ITEM_Feature)
+	{
+		ProcessFeatureReport(Data, ReportSize);
+		return;
+	}
+
+	//Check for the legacy fixed format command being sent from master
+	if (Data[0] == COMMAND_LEGACY_VOLUME)
+	{
+		if (ReportSize >= 3)
+		{
+			Command_SetNumber(&Data[1], 1);
+			Command_SetLevel(&Data[2], 1);
 		}
+
+		return;
 	}
 
-	LEDs_SetAllLEDs(NewLEDMask);
+	Commands_Process(CommandTable, (sizeof(CommandTable) / sizeof(CommandTable[0])), Data, ReportSize);
+
+	//Any trace in the report follows the display frame holding all of the report's changes
+	Trace_Published(SS_4201AS_GetFrameSerial());
 }
 
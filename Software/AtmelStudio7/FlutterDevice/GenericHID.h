@@ -44,44 +44,69 @@
 		#include <string.h>
 
 		#include "Descriptors.h"
+		#include "Protocol.h"
+		#include "Scheduler.h"
+		#include "InputQueue.h"
+		#include "Commands.h"
+		#include "Meter.h"
+		#include "Animation.h"
+		#include "Ladder.h"
+		#include "Settings.h"
+		#include "Profile.h"
+		#include "Trace.h"
+		#include "Gestures.h"
+		#include "Watchdog.h"
 		#include "Config/AppConfig.h"
 
 		#include <LUFA/Drivers/Board/LEDs.h>
 		#include <LUFA/Drivers/Board/4201AS.h>
 		#include <LUFA/Drivers/Board/RotaryEncoder.h>
+		#include <LUFA/Drivers/Board/Buttons.h>
 		#include <LUFA/Drivers/USB/USB.h>
 		#include <LUFA/Platform/Platform.h>
 
-	/* Macros: */
-		/** LED mask for the library LED driver, to indicate that the USB interface is not ready. */
-		#define LEDMASK_USB_NOTREADY      LEDS_LED1
+	/* Preprocessor Checks: */
+		#if (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
+			#if ((ROTARY_ACCEL_NONE != ENCODER_CURVE_NONE) || (ROTARY_ACCEL_GENTLE != ENCODER_CURVE_GENTLE) || \
+			     (ROTARY_ACCEL_STEEP != ENCODER_CURVE_STEEP) || (ROTARY_ACCEL_CURVES != ENCODER_CURVE_COUNT))
+				#error The ENCODER_CURVE_* values of Protocol.h do not match the curves of the encoder driver.
+			#endif
 
-		/** LED mask for the library LED driver, to indicate that the USB interface is enumerating. */
-		#define LEDMASK_USB_ENUMERATING  (LEDS_LED2 | LEDS_LED3)
-
-		/** LED mask for the library LED driver, to indicate that the USB interface is ready. */
-		#define LEDMASK_USB_READY        (LEDS_LED2 | LEDS_LED4)
-
-		/** LED mask for the library LED driver, to indicate that an error has occurred in the USB interface. */
-		#define LEDMASK_USB_ERROR        (LEDS_LED1 | LEDS_LED3)
-		
-		/** Byte mask for the library 4201AS driver, to indicate that the USB device is not ready. */
-		#define BYTEMASK_USB_NOTREADY    0b00001101 //11
-		
-		/** Byte mask for the library 4201AS driver, to indicate that the USB interface is enumerating. */
-		#define BYTEMASK_USB_ENUMERATING  0b00000000 //0
-		
-		/** Byte mask for the library 4201AS driver, to indicate that the USB interface is ready. */
-		#define BYTEMASK_USB_READY        0b00001100 //10
+			#if ((SS_4201AS_MIN_REFRESH_HZ != DISPLAY_MIN_REFRESH_HZ) || (SS_4201AS_MAX_REFRESH_HZ != DISPLAY_MAX_REFRESH_HZ) || \
+			     (SS_4201AS_BRIGHTNESS_MAX != DISPLAY_BRIGHTNESS_MAX))
+				#error The DISPLAY_* limits of Protocol.h do not match those of the 4201AS driver.
+			#endif
+		#endif
 
 	/* Function Prototypes: */
 		void SetupHardware(void);
+		void RenderLadder(void);
+		void UpdateDisplay(void);
+		void CreateFeatureReport(uint8_t* const Data);
+		void ProcessFeatureReport(const uint8_t* const Data,
+		                          const uint16_t ReportSize);
 
 		void EVENT_USB_Device_Connect(void);
 		void EVENT_USB_Device_Disconnect(void);
 		void EVENT_USB_Device_ConfigurationChanged(void);
 		void EVENT_USB_Device_ControlRequest(void);
+		#if defined(DEFERRED_CONTROL_REQUESTS)
+		void EVENT_USB_Device_ControlRequestDeferred(void);
+		#endif
 		void EVENT_USB_Device_StartOfFrame(void);
+		void EVENT_USB_Device_Suspend(void);
+		void EVENT_USB_Device_WakeUp(void);
+
+		void EVENT_Rotary_Turned(const int8_t Steps);
+		void EVENT_Buttons_Sampled(const uint8_t Pressed);
+		void EVENT_SS_4201AS_FrameComplete(void);
+
+		#if defined(PROFILE_ENABLED)
+		void EVENT_USB_InterruptEntry(void);
+		void EVENT_USB_InterruptExit(void);
+		void EVENT_SS_4201AS_InterruptEntry(void);
+		void EVENT_SS_4201AS_InterruptExit(void);
+		#endif
 
 		bool CALLBACK_HID_Device_CreateHIDReport(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo,
 		                                         uint8_t* const ReportID,
@@ -0,0 +1,167 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Button gesture recogniser. It is stepped from the button sampling interrupt with the debounced state of the
+ *  buttons, and tells clicks, double clicks and long presses apart by timing each button's presses and releases.
+ *  A click is held back until the double click time has passed without a second press, unless double clicks are
+ *  disabled; a second press held long enough reports the pending click along with a long press.
+ */
+
+#include "Gestures.h"
+
+/** States of the gesture recogniser of a button. */
+enum Gestures_States_t
+{
+	GESTURE_STATE_Idle       = 0, /**< The button is released with no gesture in progress. */
+	GESTURE_STATE_Down       = 1, /**< The button has been pressed once. */
+	GESTURE_STATE_Up         = 2, /**< The button has been pressed and released, waiting for a second press. */
+	GESTURE_STATE_DownAgain  = 3, /**< The button has been pressed a second time. */
+	GESTURE_STATE_Held       = 4, /**< A long press has been reported, waiting for the release. */
+};
+
+/** Type define for the gesture recogniser state of a button. */
+typedef struct
+{
+	uint8_t  State; /**< Current state, a \ref Gestures_States_t value. */
+	bool     Down; /**< Whether the button was held down at the previous step. */
+	uint16_t Time; /**< Time in milliseconds since the last press or release, saturating. */
+} Gestures_Button_t;
+
+/** Gesture timings in milliseconds. */
+static volatile uint16_t LongPressMS;
+static volatile uint16_t DoubleClickMS;
+
+/** Gesture recogniser state of each button. */
+static Gestures_Button_t Buttons[GESTURES_BUTTON_COUNT];
+
+/** Sets the gesture timings.
+ *
+ *  \param[in] Config  Gesture timings to use.
+ */
+void Gestures_SetConfig(const Gestures_Config_t* const Config)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	LongPressMS   = ((uint16_t)Config->LongPress * GESTURES_UNIT_MS);
+	DoubleClickMS = ((uint16_t)Config->DoubleClick * GESTURES_UNIT_MS);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Steps the gesture recognisers of all buttons. This must be called periodically from a single context.
+ *
+ *  \param[in] Pressed    Mask of the buttons held down after debouncing, bit \c n for button \c n.
+ *  \param[in] ElapsedMS  Time in milliseconds since the previous call.
+ *
+ *  \return Mask of the gestures recognised, \c GESTURE_* flags shifted by \ref GESTURE_BITS per button.
+ */
+uint8_t Gestures_Update(const uint8_t Pressed,
+                        const uint8_t ElapsedMS)
+{
+	uint8_t Gestures = 0;
+
+	for (uint8_t ButtonIndex = 0; ButtonIndex < GESTURES_BUTTON_COUNT; ButtonIndex++)
+	{
+		Gestures_Button_t* Button = &Buttons[ButtonIndex];
+		bool    Down  = ((Pressed & (1 << ButtonIndex)) != 0);
+		uint8_t Flags = 0;
+
+		//Time every press and release from the step it was first seen in
+		if (Down != Button->Down)
+		{
+			Button->Down = Down;
+			Button->Time = 0;
+		}
+		else
+		{
+			Button->Time = ((Button->Time > (UINT16_MAX - ElapsedMS)) ? UINT16_MAX : (Button->Time + ElapsedMS));
+		}
+
+		bool Long = (LongPressMS && (Button->Time >= LongPressMS));
+
+		switch (Button->State)
+		{
+			case GESTURE_STATE_Idle:
+				if (Down)
+				  Button->State = GESTURE_STATE_Down;
+				break;
+
+			case GESTURE_STATE_Down:
+				if (!(Down))
+				{
+					if (DoubleClickMS)
+					{
+						Button->State = GESTURE_STATE_Up;
+					}
+					else
+					{
+						Flags         = GESTURE_CLICK;
+						Button->State = GESTURE_STATE_Idle;
+					}
+				}
+				else if (Long)
+				{
+					Flags         = GESTURE_LONG_PRESS;
+					Button->State = GESTURE_STATE_Held;
+				}
+				break;
+
+			case GESTURE_STATE_Up:
+				if (Down)
+				{
+					Button->State = GESTURE_STATE_DownAgain;
+				}
+				else if (Button->Time >= DoubleClickMS)
+				{
+					Flags         = GESTURE_CLICK;
+					Button->State = GESTURE_STATE_Idle;
+				}
+				break;
+
+			case GESTURE_STATE_DownAgain:
+				if (!(Down))
+				{
+					Flags         = GESTURE_DOUBLE_CLICK;
+					Button->State = GESTURE_STATE_Idle;
+				}
+				else if (Long)
+				{
+					Flags         = (GESTURE_CLICK | GESTURE_LONG_PRESS);
+					Button->State = GESTURE_STATE_Held;
+				}
+				break;
+
+			default:
+				if (!(Down))
+				  Button->State = GESTURE_STATE_Idle;
+				break;
+		}
+
+		Gestures |= (Flags << (ButtonIndex * GESTURE_BITS));
+	}
+
+	return Gestures;
+}
@@ -0,0 +1,83 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Gestures.c.
+ */
+
+#ifndef _GESTURES_H_
+#define _GESTURES_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of buttons gestures are recognised on. */
+		#define GESTURES_BUTTON_COUNT    2
+
+		/** Gesture flag for a single press and release, reported once the double click time has passed without a
+		 *  second press.
+		 */
+		#define GESTURE_CLICK            (1 << 0)
+
+		/** Gesture flag for two presses and releases within the double click time. */
+		#define GESTURE_DOUBLE_CLICK     (1 << 1)
+
+		/** Gesture flag for a press held for the long press time, reported while the button is still held. */
+		#define GESTURE_LONG_PRESS       (1 << 2)
+
+		/** Number of gesture flag bits of each button in a gesture mask, so that the gestures of button \c n are
+		 *  the \c GESTURE_* flags shifted left by \c n times this.
+		 */
+		#define GESTURE_BITS             3
+
+		/** Mask of all the gesture flags of a button in a gesture mask.
+		 *
+		 *  \param[in] Button  Index of the button, from zero.
+		 */
+		#define GESTURE_BUTTON_MASK(Button)   (((1 << GESTURE_BITS) - 1) << ((Button) * GESTURE_BITS))
+
+		/** Time unit of the gesture timings, in milliseconds. */
+		#define GESTURES_UNIT_MS         10
+
+	/* Type Defines: */
+		/** Type define for the gesture timings, in units of \ref GESTURES_UNIT_MS. */
+		typedef struct
+		{
+			uint8_t LongPress; /**< Time a button must be held for a long press, zero to disable long presses. */
+			uint8_t DoubleClick; /**< Time from a release to the next press for a double click, zero to disable
+			                      *   double clicks so that clicks are reported as soon as the button is released.
+			                      */
+		} Gestures_Config_t;
+
+	/* Function Prototypes: */
+		void    Gestures_SetConfig(const Gestures_Config_t* const Config) ATTR_NON_NULL_PTR_ARG(1);
+		uint8_t Gestures_Update(const uint8_t Pressed,
+		                        const uint8_t ElapsedMS);
+
+#endif
+
@@ -0,0 +1,1070 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Core of the host simulation, modelling the parts of the ATmega32U4 other than the USB controller and the board:
+ *  the virtual clock, register writes, interrupt delivery, sleep, the timers, the EEPROM and the signature row.
+ *
+ *  The firmware only ever writes a modelled register through the pointer handed out by the accessor called just
+ *  before, so the write of one access is passed on to the simulated peripherals at the start of the next one.
+ *  Timers are not ticked on every access; each one keeps the configuration it was last loaded with, is advanced in
+ *  closed form whenever the clock passes the next moment one of its flags is due to be set, and is brought up to
+ *  date with its old configuration before a new one is loaded.
+ */
+
+#include "HostSim.h"
+
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include <avr/boot.h>
+#include <avr/sleep.h>
+#include <util/delay.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+/** Size of the host stack the firmware runs on. */
+#define FIRMWARE_STACK_SIZE    (256 * 1024)
+
+/** Global interrupt enable bit of \c SREG. */
+#define SREG_I                 7
+
+/** Cycles taken to wake from a sleep mode by an interrupt. */
+#define WAKEUP_CYCLES          4
+
+/** Cycles of the virtual clock the PLL takes to lock once enabled, 100us. */
+#define PLL_LOCK_CYCLES        (HOSTSIM_CLOCK_HZ / 10000)
+
+/** Number of interrupt vectors modelled. */
+#define VECTOR_COUNT           (sizeof(Vectors) / sizeof(Vectors[0]))
+
+/** Number of timers modelled. */
+#define TIMER_COUNT            4
+
+/** Reserved bit of each interrupt flag register which always reads back as one, so that writing a one back to a
+ *  flag that is already set still changes the register and is seen as a write.
+ */
+#define FLAG_PHANTOM           (1 << 7)
+
+/** Reserved bit of \c TIFR4 used in place of \ref FLAG_PHANTOM, as bit 7 of that register is \c OCF4D. */
+#define FLAG_PHANTOM_TIFR4     (1 << 0)
+
+/** Marks a vector the firmware may define, whose address is null when it does not. */
+#define ATTR_WEAK_VECTOR       __attribute__((weak))
+
+void PCINT0_vect(void)        ATTR_WEAK_VECTOR;
+void USB_GEN_vect(void)       ATTR_WEAK_VECTOR;
+void USB_COM_vect(void)       ATTR_WEAK_VECTOR;
+void WDT_vect(void)           ATTR_WEAK_VECTOR;
+void TIMER1_COMPA_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER1_COMPB_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER1_OVF_vect(void)    ATTR_WEAK_VECTOR;
+void TIMER0_COMPA_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER0_COMPB_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER0_OVF_vect(void)    ATTR_WEAK_VECTOR;
+void TIMER3_COMPA_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER3_COMPB_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER3_OVF_vect(void)    ATTR_WEAK_VECTOR;
+void TIMER4_COMPA_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER4_COMPB_vect(void)  ATTR_WEAK_VECTOR;
+void TIMER4_OVF_vect(void)    ATTR_WEAK_VECTOR;
+
+/** Interrupt vector of the simulated device. */
+typedef struct
+{
+	void    (*Handler)(void); /**< Handler defined by the firmware, or \c NULL if it does not define one. */
+	uint8_t FlagAddress; /**< Address of the register holding the interrupt flag, cleared on entry to the handler. */
+	uint8_t FlagMask; /**< Mask of the interrupt flag. */
+	uint8_t EnableAddress; /**< Address of the register holding the interrupt enable. */
+	uint8_t EnableMask; /**< Mask of the interrupt enable. */
+	bool    (*Pending)(void); /**< Function returning whether the interrupt is pending, for interrupts whose flags are
+	                           *   left for the handler to clear.
+	                           */
+} Vector_t;
+
+/** Interrupt vectors, in order of priority. */
+static const Vector_t Vectors[] =
+	{
+		{PCINT0_vect,       0x3B, (1 << PCIF0),  0x68, (1 << PCIE0),  NULL},
+		{USB_GEN_vect,      0,    0,             0,    0,             SimUSB_GeneralInterruptPending},
+		{USB_COM_vect,      0,    0,             0,    0,             SimUSB_EndpointInterruptPending},
+		{TIMER1_COMPA_vect, 0x36, (1 << OCF1A),  0x6F, (1 << OCIE1A), NULL},
+		{TIMER1_COMPB_vect, 0x36, (1 << OCF1B),  0x6F, (1 << OCIE1B), NULL},
+		{TIMER1_OVF_vect,   0x36, (1 << TOV1),   0x6F, (1 << TOIE1),  NULL},
+		{TIMER0_COMPA_vect, 0x35, (1 << OCF0A),  0x6E, (1 << OCIE0A), NULL},
+		{TIMER0_COMPB_vect, 0x35, (1 << OCF0B),  0x6E, (1 << OCIE0B), NULL},
+		{TIMER0_OVF_vect,   0x35, (1 << TOV0),   0x6E, (1 << TOIE0),  NULL},
+		{TIMER3_COMPA_vect, 0x38, (1 << OCF3A),  0x71, (1 << OCIE3A), NULL},
+		{TIMER3_COMPB_vect, 0x38, (1 << OCF3B),  0x71, (1 << OCIE3B), NULL},
+		{TIMER3_OVF_vect,   0x38, (1 << TOV3),   0x71, (1 << TOIE3),  NULL},
+		{TIMER4_COMPA_vect, 0x39, (1 << OCF4A),  0x72, (1 << OCIE4A), NULL},
+		{TIMER4_COMPB_vect, 0x39, (1 << OCF4B),  0x72, (1 << OCIE4B), NULL},
+		{TIMER4_OVF_vect,   0x39, (1 << TOV4),   0x72, (1 << TOIE4),  NULL},
+	};
+
+/** State of a simulated timer, holding the configuration it was last loaded with. */
+typedef struct
+{
+	uint32_t Prescale; /**< CPU cycles per count, zero while the timer is stopped. */
+	uint16_t Top; /**< Count after which the counter wraps to zero. */
+	uint16_t Max; /**< Largest count of the counter. */
+	uint16_t CompareA; /**< Count matched by compare unit A. */
+	uint16_t CompareB; /**< Count matched by compare unit B. */
+	bool     OverflowAtTop; /**< Whether the overflow flag is set on wrapping at \c Top. */
+	uint16_t Count; /**< Current count. */
+	uint32_t Residual; /**< Cycles elapsed towards the next count. */
+} Timer_t;
+
+/** Data space addresses of the registers of a timer. */
+typedef struct
+{
+	uint8_t Flags; /**< Interrupt flag register. */
+	uint8_t Counter; /**< Low byte of the counter. */
+	bool    Wide; /**< Whether the counter has a high byte above the low one. */
+	uint8_t Overflow; /**< Overflow flag mask. */
+	uint8_t MatchA; /**< Compare A flag mask. */
+	uint8_t MatchB; /**< Compare B flag mask. */
+	uint8_t PowerReduction; /**< Power reduction register holding the bit stopping the timer. */
+	uint8_t PowerMask; /**< Mask of the bit stopping the timer. */
+} TimerRegisters_t;
+
+static const TimerRegisters_t TimerRegisters[TIMER_COUNT] =
+	{
+		{0x35, 0x46, false, (1 << TOV0), (1 << OCF0A), (1 << OCF0B), 0x64, (1 << PRTIM0)},
+		{0x36, 0x84, true,  (1 << TOV1), (1 << OCF1A), (1 << OCF1B), 0x64, (1 << PRTIM1)},
+		{0x38, 0x94, true,  (1 << TOV3), (1 << OCF3A), (1 << OCF3B), 0x65, (1 << PRTIM3)},
+		{0x39, 0xBE, false, (1 << TOV4), (1 << OCF4A), (1 << OCF4B), 0x65, (1 << PRTIM4)},
+	};
+
+/** Cycles per count of the clock select settings of timers 0, 1 and 3. External clocks are treated as stopped. */
+static const uint16_t ClockSelectPrescale[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+
+volatile uint8_t HostSim_DataSpace[0x100];
+HostSim_Stats_t  HostSim_Stats;
+
+static uint8_t                Published[0x100];
+static HostSim_WriteHandler_t WriteHandlers[0x100];
+
+static uint8_t  LastAddress;
+static bool     LastWide;
+static bool     LastPending;
+
+static Timer_t  Timers[TIMER_COUNT];
+static uint64_t TimersSyncedAt;
+static uint64_t NextTimerEvent;
+static bool     TimersFrozen;
+
+static uint8_t  ClockShift;
+static bool     ClockChangeEnabled;
+
+static uint64_t PLLLocksAt;
+
+static uint64_t          RaisedAt[VECTOR_COUNT];
+static HostSim_Latency_t Latencies[VECTOR_COUNT];
+
+static uint8_t  EEPROM[HOSTSIM_EEPROM_SIZE];
+static uint8_t  SignatureRow[0x20] = {0x1E, 0x00, 0x95, 0x00, 0x87};
+
+static ucontext_t HostContext;
+static ucontext_t FirmwareContext;
+static uint8_t    FirmwareStack[FIRMWARE_STACK_SIZE];
+static bool       FirmwareReturned;
+static bool       Asleep;
+static uint32_t   MainLoopLoad;
+static uint64_t   SliceEnd;
+
+
+/** Returns the cycle count of a number of CPU cycles at the current system clock prescaler setting. */
+static inline uint64_t ScaledCycles(const uint32_t CPUCycles)
+{
+	return ((uint64_t)CPUCycles << ClockShift);
+}
+
+/** Hands control back to the host side until the next time slice. */
+static void Yield(void)
+{
+	swapcontext(&FirmwareContext, &HostContext);
+}
+
+/** Entry point of the firmware coroutine. */
+static void FirmwareEntry(void)
+{
+	HostSim_FirmwareMain();
+
+	FirmwareReturned = true;
+
+	for (;;)
+	  Yield();
+}
+
+/** Passes a firmware write of a single register to its handler, if it has changed the register. */
+static void ReconcileAddress(const uint8_t Address)
+{
+	uint8_t Written = HostSim_DataSpace[Address];
+
+	if (Written == Published[Address])
+	  return;
+
+	if (WriteHandlers[Address] != NULL)
+	  WriteHandlers[Address](Address, Published[Address], Written);
+
+	Published[Address] = HostSim_DataSpace[Address];
+}
+
+void HostSim_Reconcile(void)
+{
+	if (LastPending)
+	{
+		LastPending = false;
+
+		ReconcileAddress(LastAddress);
+
+		if (LastWide)
+		  ReconcileAddress(LastAddress + 1);
+	}
+
+	SimUSB_Reconcile();
+}
+
+void HostSim_OnWrite(const uint8_t Address, const HostSim_WriteHandler_t Handler)
+{
+	WriteHandlers[Address] = Handler;
+}
+
+void HostSim_SetRegister(const uint8_t Address, const uint8_t Value)
+{
+	HostSim_DataSpace[Address] = Value;
+	Published[Address]         = Value;
+}
+
+void HostSim_SetBits(const uint8_t Address, const uint8_t Mask)
+{
+	HostSim_SetRegister(Address, (HostSim_DataSpace[Address] | Mask));
+}
+
+void HostSim_ClearBits(const uint8_t Address, const uint8_t Mask)
+{
+	HostSim_SetRegister(Address, (HostSim_DataSpace[Address] & ~Mask));
+}
+
+/** Reads a 16-bit register from the data space. */
+static uint16_t ReadWide(const uint8_t Address)
+{
+	return (HostSim_DataSpace[Address] | ((uint16_t)HostSim_DataSpace[Address + 1] << 8));
+}
+
+/** Loads the configuration of a timer from its registers, keeping its count. */
+static void Timer_Load(const uint8_t Index)
+{
+	Timer_t*                Timer     = &Timers[Index];
+	const TimerRegisters_t* Registers = &TimerRegisters[Index];
+	bool                    CTC       = false;
+
+	switch (Index)
+	{
+		case 0:
+		{
+			uint8_t Mode = ((TCCR0A & 0x03) | ((TCCR0B >> 1) & 0x04));
+
+			Timer->Prescale = ClockSelectPrescale[TCCR0B & 0x07];
+			Timer->Max      = 0xFF;
+			Timer->Top      = ((Mode == 2) || (Mode == 5) || (Mode == 7)) ? OCR0A : 0xFF;
+			Timer->CompareA = OCR0A;
+			Timer->CompareB = OCR0B;
+			CTC             = (Mode == 2);
+			break;
+		}
+
+		case 1:
+		case 2:
+		{
+			uint8_t Base = (Index == 1) ? 0x80 : 0x90;
+			uint8_t Mode = ((HostSim_DataSpace[Base] & 0x03) | ((HostSim_DataSpace[Base + 1] >> 1) & 0x0C));
+
+			Timer->Prescale = ClockSelectPrescale[HostSim_DataSpace[Base + 1] & 0x07];
+			Timer->Max      = 0xFFFF;
+			Timer->CompareA = ReadWide(Base + 8);
+			Timer->CompareB = ReadWide(Base + 10);
+
+			if ((Mode == 4) || (Mode == 15))
+			  Timer->Top = Timer->CompareA;
+			else if ((Mode == 12) || (Mode == 14))
+			  Timer->Top = ReadWide(Base + 6);
+			else
+			  Timer->Top = 0xFFFF;
+
+			CTC = ((Mode == 4) || (Mode == 12));
+			break;
+		}
+
+		case 3:
+		{
+			uint8_t ClockSelect = (TCCR4B & 0x0F);
+
+			Timer->Prescale = ClockSelect ? (1UL << (ClockSelect - 1)) : 0;
+			Timer->Max      = 0xFF;
+			Timer->Top      = OCR4C;
+			Timer->CompareA = OCR4A;
+			Timer->CompareB = OCR4B;
+			break;
+		}
+	}
+
+	Timer->OverflowAtTop = (!(CTC) || (Timer->Top == Timer->Max));
+
+	if (HostSim_DataSpace[Registers->PowerReduction] & Registers->PowerMask)
+	  Timer->Prescale = 0;
+}
+
+/** Returns the number of counts after which the counter of a timer reaches the given count, at least one. */
+static uint32_t Timer_CountsUntil(const Timer_t* const Timer, const uint16_t Target)
+{
+	uint32_t Period = ((uint32_t)Timer->Top + 1);
+
+	if (Timer->Count > Timer->Top)
+	  return ((uint32_t)Timer->Max - Timer->Count + 1 + ((Target <= Timer->Top) ? Target : 0));
+
+	if (Target > Timer->Top)
+	  return UINT32_MAX;
+
+	return (Target > Timer->Count) ? (Target - Timer->Count) : (Target + Period - Timer->Count);
+}
+
+/** Notes the time at which interrupt flags were raised, for those of them that were clear until then.
+ *
+ *  \param[in] Address  Data space address of the flag register.
+ *  \param[in] Mask     Mask of the flags raised.
+ *  \param[in] At       Time the flags were raised.
+ */
+static void NoteRaised(const uint8_t Address, const uint8_t Mask, const uint64_t At)
+{
+	for (uint8_t Index = 0; Index < VECTOR_COUNT; Index++)
+	{
+		const Vector_t* Vector = &Vectors[Index];
+
+		if ((Vector->FlagAddress == Address) && (Mask & Vector->FlagMask) &&
+		    !(HostSim_DataSpace[Address] & Vector->FlagMask))
+		{
+			RaisedAt[Index] = At;
+		}
+	}
+}
+
+/** Advances a timer by a number of counts, setting the flags of the events passed on the way and noting when
+ *  each was raised.
+ *
+ *  \param[in] Index      Index of the timer.
+ *  \param[in] Counts     Number of counts to advance the timer by.
+ *  \param[in] LastCount  Time of the last of the counts.
+ */
+static void Timer_Advance(const uint8_t Index, uint32_t Counts, const uint64_t LastCount)
+{
+	Timer_t*                Timer     = &Timers[Index];
+	const TimerRegisters_t* Registers = &TimerRegisters[Index];
+	uint64_t                Period    = ScaledCycles(Timer->Prescale);
+	uint8_t                 Flags     = 0;
+
+	if (!(Counts))
+	  return;
+
+	//Time of the count before the first, from which the counts until each event are measured
+	uint64_t Start = (LastCount - ((uint64_t)Counts * Period));
+
+	//A counter beyond a lowered top runs on to its maximum before wrapping, missing the compare matches
+	if (Timer->Count > Timer->Top)
+	{
+		uint32_t ToWrap = ((uint32_t)Timer->Max - Timer->Count + 1);
+
+		if (Counts < ToWrap)
+		{
+			Timer->Count += Counts;
+			return;
+		}
+
+		Counts      -= ToWrap;
+		Start       += (ToWrap * Period);
+		Timer->Count = 0;
+		Flags       |= Registers->Overflow;
+
+		if (Timer->CompareA == 0)
+		  Flags |= Registers->MatchA;
+
+		if (Timer->CompareB == 0)
+		  Flags |= Registers->MatchB;
+
+		NoteRaised(Registers->Flags, Flags, Start);
+	}
+
+	if (Counts)
+	{
+		uint32_t Wrap = ((uint32_t)Timer->Top + 1);
+		uint32_t Until;
+
+		if (Counts >= (Until = Timer_CountsUntil(Timer, Timer->CompareA)))
+		{
+			NoteRaised(Registers->Flags, (Registers->MatchA & ~Flags), (Start + (Until * Period)));
+			Flags |= Registers->MatchA;
+		}
+
+		if (Counts >= (Until = Timer_CountsUntil(Timer, Timer->CompareB)))
+		{
+			NoteRaised(Registers->Flags, (Registers->MatchB & ~Flags), (Start + (Until * Period)));
+			Flags |= Registers->MatchB;
+		}
+
+		if (Timer->OverflowAtTop && (Counts >= (Until = (Wrap - Timer->Count))))
+		{
+			NoteRaised(Registers->Flags, (Registers->Overflow & ~Flags), (Start + (Until * Period)));
+			Flags |= Registers->Overflow;
+		}
+
+		Timer->Count = ((Timer->Count + Counts) % Wrap);
+	}
+
+	if (Flags)
+	  HostSim_SetBits(Registers->Flags, Flags);
+}
+
+/** Returns the number of counts until a timer next sets one of its flags. */
+static uint32_t Timer_CountsUntilEvent(const Timer_t* const Timer)
+{
+	uint32_t Counts = Timer_CountsUntil(Timer, Timer->CompareA);
+	uint32_t Other  = Timer_CountsUntil(Timer, Timer->CompareB);
+
+	if (Other < Counts)
+	  Counts = Other;
+
+	if (Timer->OverflowAtTop || (Timer->Count > Timer->Top))
+	{
+		Other = (Timer->Count > Timer->Top) ? ((uint32_t)Timer->Max - Timer->Count + 1)
+		                                    : ((uint32_t)Timer->Top + 1 - Timer->Count);
+
+		if (Other < Counts)
+		  Counts = Other;
+	}
+
+	return Counts;
+}
+
+/** Publishes the counter of each timer in its registers. */
+static void Timers_Publish(void)
+{
+	for (uint8_t Index = 0; Index < TIMER_COUNT; Index++)
+	{
+		const TimerRegisters_t* Registers = &TimerRegisters[Index];
+
+		HostSim_SetRegister(Registers->Counter, (uint8_t)Timers[Index].Count);
+
+		if (Registers->Wide)
+		  HostSim_SetRegister(Registers->Counter + 1, (uint8_t)(Timers[Index].Count >> 8));
+	}
+}
+
+/** Brings every timer up to the current time with the configuration it was last loaded with, and works out when
+ *  the next timer flag is due.
+ */
+static void Timers_Sync(void)
+{
+	uint64_t Now     = HostSim_Stats.Cycles;
+	uint64_t Elapsed = (Now - TimersSyncedAt);
+
+	NextTimerEvent = UINT64_MAX;
+	TimersSyncedAt = Now;
+
+	for (uint8_t Index = 0; Index < TIMER_COUNT; Index++)
+	{
+		Timer_t* Timer = &Timers[Index];
+
+		if (!(Timer->Prescale) || TimersFrozen)
+		  continue;
+
+		uint64_t Period = ScaledCycles(Timer->Prescale);
+		uint64_t Total  = (Timer->Residual + Elapsed);
+
+		Timer->Residual = (uint32_t)(Total % Period);
+
+		uint64_t Counts = (Total / Period);
+
+		//Whole periods of the counter set the same flags as a single one
+		if (Counts > ((uint64_t)Timer->Max + 1) * 2)
+		  Counts = (((Counts - ((uint64_t)Timer->Max + 1)) % ((uint64_t)Timer->Top + 1)) + ((uint64_t)Timer->Max + 1));
+
+		Timer_Advance(Index, (uint32_t)Counts, (Now - Timer->Residual));
+
+		uint64_t Event = (Now + ((uint64_t)Timer_CountsUntilEvent(Timer) * Period) - Timer->Residual);
+
+		if (Event < NextTimerEvent)
+		  NextTimerEvent = Event;
+	}
+
+	Timers_Publish();
+}
+
+/** Write handler of the timer configuration registers and of the clock controls, which brings the timers up to
+ *  date with their old configuration before loading the new one.
+ */
+static void Timers_ConfigWritten(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	(void)Previous;
+
+	Timers_Sync();
+
+	for (uint8_t Index = 0; Index < TIMER_COUNT; Index++)
+	{
+		const TimerRegisters_t* Registers = &TimerRegisters[Index];
+
+		if ((Address == Registers->Counter) || (Registers->Wide && (Address == (Registers->Counter + 1))))
+		{
+			Timers[Index].Count    = Registers->Wide ? ReadWide(Registers->Counter) : Written;
+			Timers[Index].Residual = 0;
+		}
+
+		Timer_Load(Index);
+	}
+
+	Timers_Sync();
+}
+
+/** Write handler of the interrupt flag registers, in which writing a one clears a flag. */
+static void Flags_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	uint8_t Phantom = (Address == 0x39) ? FLAG_PHANTOM_TIFR4 : FLAG_PHANTOM;
+
+	HostSim_DataSpace[Address] = ((Previous & ~Written) | Phantom);
+}
+
+/** Write handler of the system clock prescaler, which only takes a new setting straight after the change enable
+ *  bit has been written on its own.
+ */
+static void ClockPrescaler_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	if (Written & (1 << CLKPCE))
+	{
+		ClockChangeEnabled         = true;
+		HostSim_DataSpace[Address] = Previous;
+		return;
+	}
+
+	if (!(ClockChangeEnabled))
+	{
+		HostSim_DataSpace[Address] = Previous;
+		return;
+	}
+
+	ClockChangeEnabled = false;
+
+	Timers_Sync();
+	ClockShift = (Written & 0x0F);
+
+	if (ClockShift > 8)
+	  ClockShift = 8;
+
+	HostSim_DataSpace[Address] = ClockShift;
+	Timers_Sync();
+}
+
+/** Write handler of the PLL control, which starts the PLL locking when it is enabled. */
+static void PLL_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	if (!(Written & (1 << PLLE)))
+	{
+		HostSim_DataSpace[Address] = (Written & ~(1 << PLOCK));
+		PLLLocksAt = UINT64_MAX;
+	}
+	else if (!(Previous & (1 << PLLE)))
+	{
+		HostSim_DataSpace[Address] = (Written & ~(1 << PLOCK));
+		PLLLocksAt = (HostSim_Stats.Cycles + PLL_LOCK_CYCLES);
+	}
+	else
+	{
+		HostSim_DataSpace[Address] = ((Written & ~(1 << PLOCK)) | (Previous & (1 << PLOCK)));
+	}
+}
+
+/** Sets the lock flag of the PLL once it has had the time to lock since being enabled. */
+static void PLL_Update(void)
+{
+	if (HostSim_Stats.Cycles < PLLLocksAt)
+	  return;
+
+	PLLLocksAt = UINT64_MAX;
+	HostSim_SetBits(HOSTSIM_ADDRESS(PLLCSR), (1 << PLOCK));
+}
+
+/** Returns the highest priority interrupt which is both enabled and pending, ignoring the global interrupt
+ *  enable, or \c NULL if there is none.
+ */
+static const Vector_t* NextVector(void)
+{
+	for (uint8_t Index = 0; Index < (sizeof(Vectors) / sizeof(Vectors[0])); Index++)
+	{
+		const Vector_t* Vector = &Vectors[Index];
+
+		if (Vector->Handler == NULL)
+		  continue;
+
+		if (Vector->Pending != NULL)
+		{
+			if (Vector->Pending())
+			  return Vector;
+		}
+		else if ((HostSim_DataSpace[Vector->FlagAddress] & Vector->FlagMask) &&
+		         (HostSim_DataSpace[Vector->EnableAddress] & Vector->EnableMask))
+		{
+			return Vector;
+		}
+	}
+
+	return NULL;
+}
+
+/** Runs the handler of an interrupt as the CPU would, with interrupts disabled until it returns. */
+static void Interrupt(const Vector_t* const Vector)
+{
+	if (Vector->FlagMask)
+	  HostSim_ClearBits(Vector->FlagAddress, Vector->FlagMask);
+
+	SREG &= ~(1 << SREG_I);
+
+	HostSim_Stats.Cycles += ScaledCycles(HOSTSIM_INTERRUPT_CYCLES);
+	HostSim_Stats.Interrupts++;
+
+	uint8_t Index = (Vector - Vectors);
+
+	if (RaisedAt[Index] != UINT64_MAX)
+	{
+		HostSim_Latency_t* Latency = &Latencies[Index];
+		uint64_t           Cycles  = (HostSim_Stats.Cycles - RaisedAt[Index]);
+
+		if (Cycles > Latency->Worst)
+		  Latency->Worst = Cycles;
+
+		Latency->Total += Cycles;
+		Latency->Count++;
+
+		RaisedAt[Index] = UINT64_MAX;
+	}
+
+	Vector->Handler();
+	HostSim_Reconcile();
+
+	SimBoard_InterruptServiced();
+
+	SREG |= (1 << SREG_I);
+}
+
+/** Runs the handlers of all enabled and pending interrupts, while interrupts are globally enabled. */
+static void ServiceInterrupts(void)
+{
+	while (SREG & (1 << SREG_I))
+	{
+		const Vector_t* Vector = NextVector();
+
+		if (Vector == NULL)
+		  break;
+
+		Interrupt(Vector);
+	}
+}
+
+/** Moves the virtual clock forward to the given time, or to the end of the time slice or the next timer event if
+ *  either is sooner, and handles whichever was reached.
+ *
+ *  \param[in] Until     Time to move the clock forward to.
+ *  \param[in] Sleeping  Whether the time passes in a sleep mode, rather than in a busy wait.
+ */
+static void AdvanceTowards(uint64_t Until, const bool Sleeping)
+{
+	if (SliceEnd < Until)
+	  Until = SliceEnd;
+
+	if (NextTimerEvent < Until)
+	  Until = NextTimerEvent;
+
+	if (Until > HostSim_Stats.Cycles)
+	{
+		if (Sleeping)
+		  HostSim_Stats.SleepCycles += (Until - HostSim_Stats.Cycles);
+
+		HostSim_Stats.Cycles = Until;
+	}
+
+	if (HostSim_Stats.Cycles >= NextTimerEvent)
+	  Timers_Sync();
+
+	if (HostSim_Stats.Cycles >= SliceEnd)
+	  Yield();
+}
+
+/** Charges the firmware for the instructions leading up to an access, handing control back to the host side
+ *  once its time slice is used up.
+ */
+static void Tick(void)
+{
+	HostSim_Reconcile();
+
+	HostSim_Stats.Accesses++;
+	HostSim_Stats.Cycles += ScaledCycles(HOSTSIM_ACCESS_CYCLES);
+
+	if (HostSim_Stats.Cycles >= NextTimerEvent)
+	  Timers_Sync();
+
+	if (HostSim_Stats.Cycles >= SliceEnd)
+	  Yield();
+}
+
+/** Work done on every access of the firmware to a modelled register, before the register is handed back. */
+static void Step(void)
+{
+	Tick();
+	ServiceInterrupts();
+}
+
+/** Hands out the storage of a modelled register after an access, noting it as possibly written. */
+static volatile uint8_t* Access(const uint8_t Address, const bool Wide)
+{
+	volatile uint8_t* Banked = SimUSB_BankedRegister(Address);
+
+	if (Banked != NULL)
+	  return Banked;
+
+	for (uint8_t Index = 0; Index < TIMER_COUNT; Index++)
+	{
+		if ((Address & 0xFE) == (TimerRegisters[Index].Counter & 0xFE))
+		  Timers_Sync();
+	}
+
+	if (Address == HOSTSIM_ADDRESS(PLLCSR))
+	  PLL_Update();
+
+	LastAddress = Address;
+	LastWide    = Wide;
+	LastPending = true;
+
+	return &HostSim_DataSpace[Address];
+}
+
+volatile uint8_t* HostSim_Register(const uint8_t Address)
+{
+	Step();
+
+	return Access(Address, false);
+}
+
+volatile HostSim_Word_t* HostSim_Register16(const uint8_t Address)
+{
+	Step();
+
+	return (volatile HostSim_Word_t*)Access(Address, true);
+}
+
+volatile uint8_t* HostSim_EndpointFIFO(void)
+{
+	Step();
+
+	return SimUSB_FIFO();
+}
+
+uint16_t HostSim_EndpointByteCount(void)
+{
+	Step();
+
+	return SimUSB_ByteCount();
+}
+
+void HostSim_EnableInterrupts(void)
+{
+	/* Interrupts are delivered at the next register access rather than here, as the instruction following SEI
+	 * always runs before a pending interrupt, which sleeping straight after relies on */
+	Tick();
+
+	SREG |= (1 << SREG_I);
+}
+
+void HostSim_DisableInterrupts(void)
+{
+	/* Interrupts pending since the last access are delivered before they are masked, so that loops polling
+	 * only RAM between critical sections still see them, and still pass the time */
+	Step();
+
+	SREG &= ~(1 << SREG_I);
+}
+
+void HostSim_Sleep(void)
+{
+	bool ClockIOStopped = ((SMCR & ((1 << SM0) | (1 << SM1) | (1 << SM2))) != SLEEP_MODE_IDLE);
+
+	HostSim_Reconcile();
+
+	//Every mode other than idle stops the I/O clock, and with it the timers
+	if (ClockIOStopped)
+	{
+		Timers_Sync();
+		TimersFrozen = true;
+		Timers_Sync();
+	}
+
+	Asleep = true;
+
+	while (NextVector() == NULL)
+	  AdvanceTowards(UINT64_MAX, true);
+
+	Asleep = false;
+
+	if (ClockIOStopped)
+	{
+		Timers_Sync();
+		TimersFrozen = false;
+		Timers_Sync();
+	}
+
+	HostSim_Stats.Cycles += ScaledCycles(WAKEUP_CYCLES);
+
+	ServiceInterrupts();
+
+	if (MainLoopLoad)
+	  HostSim_Delay(MainLoopLoad);
+}
+
+void HostSim_Delay(const uint32_t Cycles)
+{
+	uint64_t Until = (HostSim_Stats.Cycles + ScaledCycles(Cycles));
+
+	HostSim_Reconcile();
+
+	while (HostSim_Stats.Cycles < Until)
+	{
+		AdvanceTowards(Until, false);
+		ServiceInterrupts();
+	}
+}
+
+void HostSim_Reset(void)
+{
+	memset((void*)HostSim_DataSpace, 0, sizeof(HostSim_DataSpace));
+	memset(WriteHandlers, 0, sizeof(WriteHandlers));
+	memset(Timers, 0, sizeof(Timers));
+	memset(&HostSim_Stats, 0, sizeof(HostSim_Stats));
+	HostSim_ClearLatencies();
+
+	SP     = RAMEND;
+	MCUSR  = (1 << PORF);
+	TIFR0  = FLAG_PHANTOM;
+	TIFR1  = FLAG_PHANTOM;
+	TIFR3  = FLAG_PHANTOM;
+	TIFR4  = FLAG_PHANTOM_TIFR4;
+	PCIFR  = FLAG_PHANTOM;
+	OCR4C  = 0xFF;
+
+	static const uint8_t TimerConfigRegisters[] =
+		{
+			0x44, 0x45, 0x46, 0x47, 0x48,
+			0x80, 0x81, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8A, 0x8B,
+			0x90, 0x91, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9A, 0x9B,
+			0xBE, 0xC1, 0xCF, 0xD0, 0xD1,
+			0x61, 0x64, 0x65,
+		};
+
+	for (uint8_t Index = 0; Index < sizeof(TimerConfigRegisters); Index++)
+	  HostSim_OnWrite(TimerConfigRegisters[Index], Timers_ConfigWritten);
+
+	HostSim_OnWrite(0x61, ClockPrescaler_Written);
+	HostSim_OnWrite(0x35, Flags_Written);
+	HostSim_OnWrite(0x36, Flags_Written);
+	HostSim_OnWrite(0x38, Flags_Written);
+	HostSim_OnWrite(0x39, Flags_Written);
+	HostSim_OnWrite(0x3B, Flags_Written);
+	HostSim_OnWrite(0x49, PLL_Written);
+
+	ClockShift         = 0;
+	ClockChangeEnabled = false;
+	PLLLocksAt         = UINT64_MAX;
+	TimersFrozen       = false;
+	TimersSyncedAt     = 0;
+	NextTimerEvent     = UINT64_MAX;
+	LastPending        = false;
+	Asleep             = false;
+	MainLoopLoad       = 0;
+	FirmwareReturned   = false;
+	SliceEnd           = 0;
+
+	SimUSB_Reset();
+	SimBoard_Reset();
+
+	memcpy(Published, (const void*)HostSim_DataSpace, sizeof(Published));
+
+	getcontext(&FirmwareContext);
+	FirmwareContext.uc_stack.ss_sp   = FirmwareStack;
+	FirmwareContext.uc_stack.ss_size = sizeof(FirmwareStack);
+	FirmwareContext.uc_link          = &HostContext;
+	makecontext(&FirmwareContext, FirmwareEntry, 0);
+}
+
+bool HostSim_Run(const uint32_t Cycles)
+{
+	if (FirmwareReturned)
+	  return false;
+
+	SliceEnd = (HostSim_Stats.Cycles + Cycles);
+	swapcontext(&HostContext, &FirmwareContext);
+
+	return !(FirmwareReturned);
+}
+
+uint64_t HostSim_GetCycles(void)
+{
+	return HostSim_Stats.Cycles;
+}
+
+bool HostSim_IsAsleep(void)
+{
+	return Asleep;
+}
+
+uint16_t HostSim_GetTimerCount(const uint8_t CounterAddress)
+{
+	HostSim_Reconcile();
+	Timers_Sync();
+
+	for (uint8_t Index = 0; Index < TIMER_COUNT; Index++)
+	{
+		if (TimerRegisters[Index].Counter == CounterAddress)
+		  return Timers[Index].Count;
+	}
+
+	return 0;
+}
+
+void HostSim_ClearLatencies(void)
+{
+	memset(Latencies, 0, sizeof(Latencies));
+
+	for (uint8_t Index = 0; Index < VECTOR_COUNT; Index++)
+	  RaisedAt[Index] = UINT64_MAX;
+}
+
+const HostSim_Latency_t* HostSim_GetLatency(const uint8_t FlagAddress, const uint8_t FlagMask)
+{
+	for (uint8_t Index = 0; Index < VECTOR_COUNT; Index++)
+	{
+		if ((Vectors[Index].FlagAddress == FlagAddress) && (Vectors[Index].FlagMask == FlagMask))
+		  return &Latencies[Index];
+	}
+
+	return NULL;
+}
+
+void HostSim_SetMainLoopLoad(const uint32_t Cycles)
+{
+	MainLoopLoad = Cycles;
+}
+
+uint8_t* HostSim_GetEEPROM(void)
+{
+	return EEPROM;
+}
+
+void HostSim_SetSerial(const uint8_t* const Serial)
+{
+	memcpy(&SignatureRow[0x0E], Serial, 10);
+}
+
+uint8_t boot_signature_byte_get(const uint16_t Address)
+{
+	return (Address < sizeof(SignatureRow)) ? SignatureRow[Address] : 0xFF;
+}
+
+/** Converts an EEPROM address pointer of the firmware into an offset into the simulated EEPROM, stopping the
+ *  simulation if the access would fall outside of it.
+ */
+static size_t EEPROM_Offset(const void* const Address, const size_t Length)
+{
+	uintptr_t Offset = (uintptr_t)Address;
+
+	if ((Offset + Length) > HOSTSIM_EEPROM_SIZE)
+	{
+		fprintf(stderr, "HostSim: EEPROM access of %zu bytes at 0x%lX is out of range\n", Length, (unsigned long)Offset);
+		abort();
+	}
+
+	return Offset;
+}
+
+uint8_t eeprom_read_byte(const uint8_t* Address)
+{
+	return EEPROM[EEPROM_Offset(Address, 1)];
+}
+
+uint16_t eeprom_read_word(const uint16_t* Address)
+{
+	size_t Offset = EEPROM_Offset(Address, 2);
+
+	return (EEPROM[Offset] | ((uint16_t)EEPROM[Offset + 1] << 8));
+}
+
+void eeprom_read_block(void* Destination, const void* Source, size_t Length)
+{
+	memcpy(Destination, &EEPROM[EEPROM_Offset(Source, Length)], Length);
+}
+
+void eeprom_write_byte(uint8_t* Address, uint8_t Value)
+{
+	EEPROM[EEPROM_Offset(Address, 1)] = Value;
+}
+
+void eeprom_write_word(uint16_t* Address, uint16_t Value)
+{
+	size_t Offset = EEPROM_Offset(Address, 2);
+
+	EEPROM[Offset]     = (uint8_t)Value;
+	EEPROM[Offset + 1] = (uint8_t)(Value >> 8);
+}
+
+void eeprom_write_block(const void* Source, void* Destination, size_t Length)
+{
+	memcpy(&EEPROM[EEPROM_Offset(Destination, Length)], Source, Length);
+}
+
+void eeprom_update_byte(uint8_t* Address, uint8_t Value)
+{
+	eeprom_write_byte(Address, Value);
+}
+
+void eeprom_update_word(uint16_t* Address, uint16_t Value)
+{
+	eeprom_write_word(Address, Value);
+}
+
+void eeprom_update_block(const void* Source, void* Destination, size_t Length)
+{
+	eeprom_write_block(Source, Destination, Length);
+}
+
+/** Fills the EEPROM with the erased value before the simulation starts. */
+static void __attribute__((constructor)) EEPROM_Erase(void)
+{
+	memset(EEPROM, 0xFF, sizeof(EEPROM));
+}
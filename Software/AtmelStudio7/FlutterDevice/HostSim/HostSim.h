@@ -0,0 +1,204 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for HostSim.c, the core of the host simulation: the virtual clock, the register file, interrupt
+ *  delivery, the timers and the non-volatile memories of the simulated ATmega32U4.
+ *
+ *  The firmware runs as a coroutine of the host program. Each access to a modelled register is a point at which
+ *  the simulated peripherals catch up with the firmware, the virtual clock advances and, once the time slice
+ *  granted by \ref HostSim_Run() is used up, control returns to the host side.
+ */
+
+#ifndef _HOSTSIM_H_
+#define _HOSTSIM_H_
+
+	/* Includes: */
+		#define HOSTSIM_MODEL
+
+		#include <avr/io.h>
+		#include <stdbool.h>
+		#include <stdint.h>
+
+	/* Macros: */
+		/** Clock frequency of the simulated device, in cycles per second. */
+		#define HOSTSIM_CLOCK_HZ           16000000UL
+
+		/** Cycles charged to the firmware for each access to a modelled register, standing in for the
+		 *  instructions executed between accesses.
+		 */
+		#define HOSTSIM_ACCESS_CYCLES      2
+
+		/** Cycles taken to enter and return from an interrupt handler. */
+		#define HOSTSIM_INTERRUPT_CYCLES   10
+
+		/** Size of the simulated EEPROM in bytes. */
+		#define HOSTSIM_EEPROM_SIZE        (E2END + 1)
+
+		/** Data space address of a register, for use with the register helpers below. */
+		#define HOSTSIM_ADDRESS(Register)  _SFR_ADDR(Register)
+
+	/* Type Defines: */
+		/** Type of a register write handler, called when the firmware has changed a register since the last time
+		 *  the simulated peripherals looked at it. The handler sees the previous and the written value, and leaves
+		 *  the value the register reads back as in \ref HostSim_DataSpace.
+		 *
+		 *  \param[in] Address   Data space address of the register.
+		 *  \param[in] Previous  Value of the register before the firmware wrote to it.
+		 *  \param[in] Written   Value written by the firmware.
+		 */
+		typedef void (*HostSim_WriteHandler_t)(const uint8_t Address, const uint8_t Previous, const uint8_t Written);
+
+		/** Statistics of the simulated CPU, in cycles of the virtual clock. */
+		typedef struct
+		{
+			uint64_t Cycles; /**< Cycles elapsed since the device was reset. */
+			uint64_t SleepCycles; /**< Cycles spent asleep. */
+			uint64_t Accesses; /**< Accesses to modelled registers. */
+			uint32_t Interrupts; /**< Interrupt handlers run. */
+		} HostSim_Stats_t;
+
+		/** Latencies of an interrupt, from its flag being raised to the first instruction of its handler, in
+		 *  cycles of the virtual clock.
+		 */
+		typedef struct
+		{
+			uint32_t Count; /**< Handlers run since the latencies were cleared. */
+			uint64_t Total; /**< Sum of the latencies. */
+			uint64_t Worst; /**< Longest latency. */
+		} HostSim_Latency_t;
+
+	/* External Variables: */
+		/** Statistics of the simulated CPU since the last reset. */
+		extern HostSim_Stats_t HostSim_Stats;
+
+	/* Function Prototypes: */
+		/** Resets the simulated device, restarting the firmware from its entry point at the next
+		 *  \ref HostSim_Run(). The EEPROM keeps its contents.
+		 */
+		void HostSim_Reset(void);
+
+		/** Lets the firmware run for the given number of cycles, returning once the virtual clock has reached the
+		 *  end of the slice or the firmware has returned from \c main().
+		 *
+		 *  \param[in] Cycles  Length of the time slice in cycles.
+		 *
+		 *  \return Boolean \c true if the firmware is still running, \c false if it has returned from \c main().
+		 */
+		bool HostSim_Run(const uint32_t Cycles);
+
+		/** Returns the current time of the virtual clock in cycles since the last reset. */
+		uint64_t HostSim_GetCycles(void);
+
+		/** Returns whether the firmware is currently asleep waiting for an interrupt. */
+		bool HostSim_IsAsleep(void);
+
+		/** Returns the count of a timer, brought up to the current time of the virtual clock.
+		 *
+		 *  \param[in] CounterAddress  Data space address of the low byte of the counter of the timer.
+		 *
+		 *  \return Current count of the timer, or zero if no timer has its counter at the address.
+		 */
+		uint16_t HostSim_GetTimerCount(const uint8_t CounterAddress);
+
+		/** Clears the latencies of every interrupt, which a reset also does. */
+		void HostSim_ClearLatencies(void);
+
+		/** Returns the latencies of the interrupt with the given flag since they were last cleared. They are
+		 *  measured for the timer interrupts, whose flags are raised at a known time.
+		 *
+		 *  \param[in] FlagAddress  Data space address of the register holding the interrupt flag.
+		 *  \param[in] FlagMask     Mask of the interrupt flag.
+		 *
+		 *  \return Pointer to the latencies, or \c NULL if no interrupt has the flag.
+		 */
+		const HostSim_Latency_t* HostSim_GetLatency(const uint8_t FlagAddress, const uint8_t FlagMask);
+
+		/** Sets the length of the application work the firmware is made to do each time it wakes from sleep,
+		 *  modelling a main loop busy with other tasks. The time is a busy wait, during which interrupts are
+		 *  serviced as usual. A reset sets no load.
+		 *
+		 *  \param[in] Cycles  Cycles of work per wakeup.
+		 */
+		void HostSim_SetMainLoopLoad(const uint32_t Cycles);
+
+		/** Registers the handler called when the firmware writes to the given register. Each register may have
+		 *  at most one handler.
+		 *
+		 *  \param[in] Address  Data space address of the register.
+		 *  \param[in] Handler  Handler to call on a write.
+		 */
+		void HostSim_OnWrite(const uint8_t Address, const HostSim_WriteHandler_t Handler);
+
+		/** Passes any register writes the firmware has made to the simulated peripherals. This is done on every
+		 *  register access, and must be done by the host side before it looks at a register.
+		 */
+		void HostSim_Reconcile(void);
+
+		/** Sets the value of a register from the side of the simulated hardware, without calling its handler.
+		 *
+		 *  \param[in] Address  Data space address of the register.
+		 *  \param[in] Value    New value of the register.
+		 */
+		void HostSim_SetRegister(const uint8_t Address, const uint8_t Value);
+
+		/** Sets bits of a register from the side of the simulated hardware, without calling its handler.
+		 *
+		 *  \param[in] Address  Data space address of the register.
+		 *  \param[in] Mask     Mask of the bits to set.
+		 */
+		void HostSim_SetBits(const uint8_t Address, const uint8_t Mask);
+
+		/** Clears bits of a register from the side of the simulated hardware, without calling its handler.
+		 *
+		 *  \param[in] Address  Data space address of the register.
+		 *  \param[in] Mask     Mask of the bits to clear.
+		 */
+		void HostSim_ClearBits(const uint8_t Address, const uint8_t Mask);
+
+		/** Returns the contents of the simulated EEPROM, which the host side may preload or inspect. */
+		uint8_t* HostSim_GetEEPROM(void);
+
+		/** Sets the ten serial number bytes of the signature row, which the firmware reports as its USB serial
+		 *  number string.
+		 *
+		 *  \param[in] Serial  Serial number bytes, in signature row order.
+		 */
+		void HostSim_SetSerial(const uint8_t* const Serial);
+
+		/** Entry point of the firmware, which is \c main() renamed by the host simulation build. */
+		int HostSim_FirmwareMain(void);
+
+		/* Hooks into the simulated peripherals, defined in their own files: */
+		void              SimUSB_Reset(void);
+		void              SimUSB_Reconcile(void);
+		volatile uint8_t* SimUSB_BankedRegister(const uint8_t Address);
+		volatile uint8_t* SimUSB_FIFO(void);
+		uint16_t          SimUSB_ByteCount(void);
+		bool              SimUSB_GeneralInterruptPending(void);
+		bool              SimUSB_EndpointInterruptPending(void);
+		void              SimBoard_Reset(void);
+		void              SimBoard_InterruptServiced(void);
+
+#endif
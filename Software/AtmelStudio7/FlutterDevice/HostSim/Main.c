@@ -0,0 +1,85 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Entry point of the host simulator. Without arguments every built in scenario is run; otherwise each argument
+ *  names a scenario, or a virtual host script to run when it is a file. The exit status is non-zero if any of
+ *  them failed, so the simulator can gate a build.
+ */
+
+#include "Scenarios.h"
+#include "Script.h"
+
+/** Runs a scenario by name, or a script if no scenario has the name, returning whether it passed. */
+static bool RunArgument(const char* const Argument)
+{
+	for (const Scenario_t* Scenario = Scenarios; Scenario->Name != NULL; Scenario++)
+	{
+		if (!(strcmp(Scenario->Name, Argument)))
+		{
+			printf("%s: %s\n", Scenario->Name, Scenario->Description);
+			return Scenario->Run();
+		}
+	}
+
+	FILE* Stream = fopen(Argument, "r");
+
+	if (Stream == NULL)
+	{
+		printf("%s: no such scenario or script\n", Argument);
+		return false;
+	}
+
+	printf("%s:\n", Argument);
+
+	bool Passed = Script_Run(Stream, Argument);
+
+	fclose(Stream);
+	return Passed;
+}
+
+int main(int argc, char** argv)
+{
+	uint8_t Failures = 0;
+
+	if (argc < 2)
+	{
+		for (const Scenario_t* Scenario = Scenarios; Scenario->Name != NULL; Scenario++)
+		{
+			if (!(RunArgument(Scenario->Name)))
+			  Failures++;
+		}
+	}
+	else
+	{
+		for (int Argument = 1; Argument < argc; Argument++)
+		{
+			if (!(RunArgument(argv[Argument])))
+			  Failures++;
+		}
+	}
+
+	printf("%s\n", (Failures ? "FAILED" : "PASSED"));
+	return (Failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
@@ -0,0 +1,1688 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Built in scenarios of the host simulator: enumeration as a desktop host performs it, the HID class requests
+ *  and reports of the application, and a throughput benchmark of the report endpoints.
+ */
+
+#include "Scenarios.h"
+
+#include <time.h>
+
+#include "../Descriptors.h"
+#include "../Protocol.h"
+#include "../Settings.h"
+#include "../Animation.h"
+#include "../Ladder.h"
+#include "../Gestures.h"
+#include "../Profile.h"
+
+#include <LUFA/Drivers/Board/LEDs.h>
+
+/* Macros: */
+	/** Request types used by the scenarios. */
+	#define REQTYPE_STANDARD_IN       0x80
+	#define REQTYPE_STANDARD_OUT      0x00
+	#define REQTYPE_CLASS_IN          0xA1
+	#define REQTYPE_CLASS_OUT         0x21
+
+	/** Frames the scenarios wait for the device to act on a report. */
+	#define SCENARIO_SETTLE_FRAMES    50
+
+	/** Frames the throughput benchmark runs for. */
+	#define THROUGHPUT_FRAMES         2000
+
+	/** Requests of each kind the control latency benchmark issues at every main loop load. */
+	#define CONTROL_LATENCY_REQUESTS  200
+
+	/** Cycles between the looks the control latency benchmark takes at the LEDs while waiting for a report to be
+	 *  applied.
+	 */
+	#define CONTROL_POLL_CYCLES       (HOSTSIM_CLOCK_HZ / 1000000)
+
+	/** Bus resets the interrupt latency benchmark issues, every other one preceded by a bus supply drop. */
+	#define LATENCY_BUS_EVENTS        400
+
+	/** Clicks the button scenario makes while the host is not reading reports, well over what the input queue
+	 *  holds.
+	 */
+	#define BUTTON_CLICKS             40
+
+	/** Default long press and double click times of the buttons, in units of \ref GESTURES_UNIT_MS, which the button
+	 *  scenario restores.
+	 */
+	#define BUTTON_LONG_PRESS_TIME    50
+	#define BUTTON_DOUBLE_CLICK_TIME  25
+
+	/** Turns the button scenario makes to fill the IN endpoint banks and the pending report transfer, so that the
+	 *  input after them waits in the input queue.
+	 */
+	#define BUTTON_ORDER_TURNS        4
+
+	/** Cycles per count of Timer 3, which times the encoder detents, and cycles of a whole period of its counter. */
+	#define ENCODER_TIMER_TICK        1024UL
+	#define ENCODER_TIMER_PERIOD      (65536UL * ENCODER_TIMER_TICK)
+
+	/** Times taken by a slowly and by a quickly turned detent. */
+	#define ENCODER_SLOW_DETENT       ((HOSTSIM_CLOCK_HZ / 1000) * 150)
+	#define ENCODER_FAST_DETENT       ((HOSTSIM_CLOCK_HZ / 1000) * 2)
+
+	/** Fewest steps a quickly turned detent must be worth under the default acceleration curve. */
+	#define ENCODER_FAST_STEPS        12
+
+	/** Time between the edges of the high rate encoder replay, 50us for 20000 edges per second, and between the
+	 *  bounces of a contact.
+	 */
+	#define REPLAY_EDGE_CYCLES        (HOSTSIM_CLOCK_HZ / 20000)
+	#define REPLAY_BOUNCE_CYCLES      (HOSTSIM_CLOCK_HZ / 500000)
+
+	/** Most frames the command scenario waits for changed settings to be saved, well over the deferral and the
+	 *  writing of a record at the slowest display refresh rate.
+	 */
+	#define SETTINGS_SAVE_FRAMES      20000
+
+	/** Slot of the settings store the torn write scenario preloads the newest record of a full ring into, and the
+	 *  sequence number it gives that record, so that the sequence numbers around the ring wrap through zero.
+	 */
+	#define TORN_NEWEST_SLOT          9
+	#define TORN_NEWEST_SEQUENCE      2
+
+	/** Times the reconfiguration scenario sets the configuration while reports are flowing, each a little later in
+	 *  the frame than the last, and the step between them in cycles.
+	 */
+	#define RECONFIGURE_COUNT         2000
+	#define RECONFIGURE_STEP_CYCLES   7
+
+	/** Control requests the profiling scenario issues while timing the USB controller interrupts. */
+	#define PROFILE_REQUESTS          200
+
+/** Serial number given to the simulated device, in signature row order. */
+static const uint8_t SimulatedSerial[10] = {0x59, 0x4E, 0x31, 0x33, 0x30, 0x37, 0x0D, 0x16, 0x0C, 0x21};
+
+/** Issues a control request without a data stage or with one in the given buffer. */
+static uint8_t Request(const uint8_t bmRequestType, const uint8_t bRequest, const uint16_t wValue,
+                       const uint16_t wIndex, const uint16_t wLength, void* const Data, uint16_t* const Transferred)
+{
+	VirtualHost_Request_t ThisRequest =
+		{
+			.bmRequestType = bmRequestType,
+			.bRequest      = bRequest,
+			.wValue        = wValue,
+			.wIndex        = wIndex,
+			.wLength       = wLength,
+		};
+
+	return VirtualHost_Control(&ThisRequest, Data, Transferred);
+}
+
+/** Reads a descriptor from the device, returning its length or -1 if the request failed. */
+static int16_t GetDescriptor(const uint8_t Type, const uint8_t Index, const uint16_t LanguageID,
+                             uint8_t* const Data, const uint16_t Length)
+{
+	uint16_t Transferred;
+
+	if (Request(REQTYPE_STANDARD_IN, REQ_GetDescriptor, ((Type << 8) | Index), LanguageID, Length,
+	            Data, &Transferred) != VIRTUALHOST_RESULT_OK)
+	{
+		return -1;
+	}
+
+	return Transferred;
+}
+
+/** Writes a feature page, or only selects it to be read back if \ref FEATURE_SELECT_ONLY is set in the page. */
+static uint8_t WriteFeature(const uint8_t Page, const uint8_t* const PageData, const uint8_t Length)
+{
+	uint8_t Feature[GENERIC_FEATURE_SIZE] = {Page};
+
+	memcpy(&Feature[FEATURE_DATA], PageData, MIN(Length, (sizeof(Feature) - FEATURE_DATA)));
+
+	return Request(REQTYPE_CLASS_OUT, HID_REQ_SetReport, (HID_REPORT_ITEM_Feature + 1) << 8, 0, sizeof(Feature),
+	               Feature, NULL);
+}
+
+/** Reads the data of a feature page, selecting it without writing it first. */
+static uint8_t ReadFeature(const uint8_t Page, uint8_t* const PageData)
+{
+	uint8_t  Feature[GENERIC_FEATURE_SIZE];
+	uint16_t Length;
+	uint8_t  Result;
+
+	if ((Result = WriteFeature((Page | FEATURE_SELECT_ONLY), NULL, 0)) != VIRTUALHOST_RESULT_OK)
+	  return Result;
+
+	if ((Result = Request(REQTYPE_CLASS_IN, HID_REQ_GetReport, (HID_REPORT_ITEM_Feature + 1) << 8, 0,
+	                      sizeof(Feature), Feature, &Length)) != VIRTUALHOST_RESULT_OK)
+	{
+		return Result;
+	}
+
+	if ((Length != GENERIC_FEATURE_SIZE) || (Feature[FEATURE_SELECTOR] != Page))
+	  return VIRTUALHOST_RESULT_STALL;
+
+	memcpy(PageData, &Feature[FEATURE_DATA], (GENERIC_FEATURE_SIZE - FEATURE_DATA));
+	return VIRTUALHOST_RESULT_OK;
+}
+
+bool Scenarios_Enumerate(void)
+{
+	uint8_t Data[256];
+	int16_t Length;
+
+	HostSim_SetSerial(SimulatedSerial);
+
+	SCENARIO_CHECK(VirtualHost_PowerOn(), "device did not attach to the bus");
+
+	//Desktop hosts read the start of the device descriptor at the default address, then reset again
+	VirtualHost_BusReset();
+	Length = GetDescriptor(DTYPE_Device, 0, 0, Data, 64);
+	SCENARIO_CHECK(Length == sizeof(USB_Descriptor_Device_t), "device descriptor length %d", Length);
+	SCENARIO_CHECK(Data[7] == FIXED_CONTROL_ENDPOINT_SIZE, "control endpoint size %u", Data[7]);
+
+	VirtualHost_BusReset();
+	SCENARIO_CHECK(VirtualHost_SetAddress(SCENARIO_DEVICE_ADDRESS) == VIRTUALHOST_RESULT_OK, "SET_ADDRESS failed");
+
+	Length = GetDescriptor(DTYPE_Device, 0, 0, Data, sizeof(USB_Descriptor_Device_t));
+	SCENARIO_CHECK(Length == sizeof(USB_Descriptor_Device_t), "device descriptor at new address, length %d", Length);
+	SCENARIO_CHECK((Data[8] | (Data[9] << 8)) == 0x2341, "vendor ID %02X%02X", Data[9], Data[8]);
+	SCENARIO_CHECK((Data[10] | (Data[11] << 8)) == 0x8036, "product ID %02X%02X", Data[11], Data[10]);
+
+	uint8_t SerialIndex = Data[16];
+
+	Length = GetDescriptor(DTYPE_Configuration, 0, 0, Data, sizeof(USB_Descriptor_Configuration_Header_t));
+	SCENARIO_CHECK(Length == sizeof(USB_Descriptor_Configuration_Header_t), "configuration header length %d", Length);
+
+	uint16_t TotalLength = (Data[2] | (Data[3] << 8));
+
+	Length = GetDescriptor(DTYPE_Configuration, 0, 0, Data, TotalLength);
+	SCENARIO_CHECK(Length == TotalLength, "configuration descriptor length %d of %u", Length, TotalLength);
+
+	Length = GetDescriptor(DTYPE_String, 0, 0, Data, 255);
+	SCENARIO_CHECK((Length >= 4) && (Data[2] == 0x09) && (Data[3] == 0x04), "language table");
+
+	//The serial number is the signature row serial, one upper case hex digit per nibble, low nibble first
+	Length = GetDescriptor(DTYPE_String, SerialIndex, 0x0409, Data, 255);
+	SCENARIO_CHECK(Length == (2 + (sizeof(SimulatedSerial) * 4)), "serial number string length %d", Length);
+
+	for (uint8_t Digit = 0; Digit < (sizeof(SimulatedSerial) * 2); Digit++)
+	{
+		uint8_t Nibble   = ((SimulatedSerial[Digit / 2] >> ((Digit & 1) ? 4 : 0)) & 0x0F);
+		char    Expected = (Nibble < 10) ? ('0' + Nibble) : ('A' + Nibble - 10);
+
+		SCENARIO_CHECK(Data[2 + (Digit * 2)] == Expected, "serial digit %u is '%c', expected '%c'", Digit,
+		               Data[2 + (Digit * 2)], Expected);
+	}
+
+	SCENARIO_CHECK(Request(REQTYPE_STANDARD_OUT, REQ_SetConfiguration, 1, 0, 0, NULL, NULL) == VIRTUALHOST_RESULT_OK,
+	               "SET_CONFIGURATION failed");
+	SCENARIO_CHECK((Request(REQTYPE_STANDARD_IN, REQ_GetConfiguration, 0, 0, 1, Data, NULL) == VIRTUALHOST_RESULT_OK) &&
+	               (Data[0] == 1), "GET_CONFIGURATION did not return the configuration");
+
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetLEDs() == LEDMASK_USB_READY, "LEDs %02X do not show the device ready", SimBoard_GetLEDs());
+
+	return true;
+}
+
+/** Scenario enumerating the device. */
+static bool Scenario_Enumerate(void)
+{
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	printf("  enumerated in %.1f ms, %lu control transfers, %lu transactions\n",
+	       (HostSim_GetCycles() * 1000.0) / HOSTSIM_CLOCK_HZ, (unsigned long)VirtualHost_Stats.ControlTransfers,
+	       (unsigned long)VirtualHost_Stats.Transactions);
+
+	return true;
+}
+
+/** Scenario exercising the HID class requests and the reports of the application. */
+static bool Scenario_HID(void)
+{
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Idle rate, in units of 4ms in the upper byte of the value
+	SCENARIO_CHECK(Request(REQTYPE_CLASS_OUT, HID_REQ_SetIdle, (25 << 8), 0, 0, NULL, NULL) == VIRTUALHOST_RESULT_OK,
+	               "SET_IDLE failed");
+	SCENARIO_CHECK((Request(REQTYPE_CLASS_IN, HID_REQ_GetIdle, 0, 0, 1, Data, NULL) == VIRTUALHOST_RESULT_OK) &&
+	               (Data[0] == 25), "GET_IDLE did not return the idle rate set");
+	SCENARIO_CHECK(Request(REQTYPE_CLASS_OUT, HID_REQ_SetIdle, 0, 0, 0, NULL, NULL) == VIRTUALHOST_RESULT_OK,
+	               "SET_IDLE failed");
+
+	SCENARIO_CHECK((Request(REQTYPE_CLASS_IN, HID_REQ_GetProtocol, 0, 0, 1, Data, NULL) == VIRTUALHOST_RESULT_OK) &&
+	               (Data[0] == 1), "GET_PROTOCOL did not return the report protocol");
+
+	//Feature reports select a page, then read it back
+	uint8_t Feature[GENERIC_FEATURE_SIZE] = {FEATURE_PAGE_PROBE, 4};
+
+	SCENARIO_CHECK(Request(REQTYPE_CLASS_OUT, HID_REQ_SetReport, (HID_REPORT_ITEM_Feature + 1) << 8, 0,
+	                       sizeof(Feature), Feature, NULL) == VIRTUALHOST_RESULT_OK, "SET_REPORT feature failed");
+	SCENARIO_CHECK(Request(REQTYPE_CLASS_IN, HID_REQ_GetReport, (HID_REPORT_ITEM_Feature + 1) << 8, 0,
+	                       sizeof(Feature), Data, &Length) == VIRTUALHOST_RESULT_OK, "GET_REPORT feature failed");
+	SCENARIO_CHECK((Length == GENERIC_FEATURE_SIZE) && (Data[FEATURE_SELECTOR] == FEATURE_PAGE_PROBE) &&
+	               (Data[FEATURE_DATA] == 4), "probe page did not read back the level written");
+
+	//Commands reach the display through the control endpoint and through the OUT endpoint alike
+	uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_NUMBER, 1, 42};
+
+	SCENARIO_CHECK(Request(REQTYPE_CLASS_OUT, HID_REQ_SetReport, (HID_REPORT_ITEM_Out + 1) << 8, 0,
+	                       sizeof(Command), Command, NULL) == VIRTUALHOST_RESULT_OK, "SET_REPORT output failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(42, SCENARIO_SETTLE_FRAMES), "display shows %d, not 42",
+	               SimBoard_GetDisplayNumber());
+
+	Command[2] = 17;
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(17, SCENARIO_SETTLE_FRAMES), "display shows %d, not 17",
+	               SimBoard_GetDisplayNumber());
+
+	//Drain the reports of the changes so far, then turn the encoder slowly enough for single steps
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK);
+
+	VirtualHost_TurnEncoder(3, (HOSTSIM_CLOCK_HZ / 1000) * 150);
+
+	int16_t Steps = 0;
+
+	while ((Steps < 3) && (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK))
+	{
+		Steps += (int8_t)Data[REPORT_IN_STEPS];
+	}
+
+	SCENARIO_CHECK(Steps == 3, "reports carried %d encoder steps, not 3", Steps);
+	SCENARIO_CHECK(Data[REPORT_IN_COUNT] == 20, "encoder count %u, not 20", Data[REPORT_IN_COUNT]);
+
+	//Requests the device does not support are stalled, without disturbing the next request
+	SCENARIO_CHECK(GetDescriptor(0x0F, 0, 0, Data, 5) < 0, "BOS descriptor request was not stalled");
+	SCENARIO_CHECK((Request(REQTYPE_STANDARD_IN, REQ_GetStatus, 0, 0, 2, Data, &Length) == VIRTUALHOST_RESULT_OK) &&
+	               (Length == 2), "GET_STATUS after a stall failed");
+
+	//A suspended device sleeps until the bus resumes
+	VirtualHost_Suspend();
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(HostSim_IsAsleep(), "device did not sleep while suspended");
+
+	VirtualHost_Resume();
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK((Request(REQTYPE_STANDARD_IN, REQ_GetConfiguration, 0, 0, 1, Data, NULL) == VIRTUALHOST_RESULT_OK) &&
+	               (Data[0] == 1), "device lost its configuration over suspend");
+
+	return true;
+}
+
+/** Starting point of a throughput measurement. */
+typedef struct
+{
+	uint64_t Cycles; /**< Cycles elapsed at the start. */
+	uint64_t SleepCycles; /**< Cycles spent asleep at the start. */
+	uint64_t Accesses; /**< Register accesses at the start. */
+	uint32_t FIFOAccesses; /**< Endpoint FIFO accesses at the start. */
+	clock_t  Clock; /**< Wall clock at the start. */
+} Measurement_t;
+
+/** Starts a throughput measurement. */
+static void StartMeasurement(Measurement_t* const Start)
+{
+	Start->Cycles       = HostSim_GetCycles();
+	Start->SleepCycles  = HostSim_Stats.SleepCycles;
+	Start->Accesses     = HostSim_Stats.Accesses;
+	Start->FIFOAccesses = SimUSB_Stats.FIFOAccesses;
+	Start->Clock        = clock();
+}
+
+/** Prints the rates of a throughput measurement that moved the given number of bytes. The firmware time per byte
+ *  covers everything the device did while awake, so it includes the fixed cost of each transfer.
+ */
+static void PrintThroughput(const char* const Name, const uint32_t Bytes, const Measurement_t* const Start)
+{
+	uint64_t Cycles      = (HostSim_GetCycles() - Start->Cycles);
+	uint64_t BusyCycles  = (Cycles - (HostSim_Stats.SleepCycles - Start->SleepCycles));
+	double   Seconds     = ((double)Cycles / HOSTSIM_CLOCK_HZ);
+	double   WallSeconds = ((double)(clock() - Start->Clock) / CLOCKS_PER_SEC);
+
+	printf("  %s: %lu bytes in %.3f s simulated, %.0f B/s, device busy %.1f%% of the time\n", Name,
+	       (unsigned long)Bytes, Seconds, (Bytes / Seconds), ((BusyCycles * 100.0) / Cycles));
+	printf("    per byte: %.2f busy cycles, %.2f register accesses, %.2f FIFO accesses; %.1fx real time\n",
+	       ((double)BusyCycles / Bytes), ((double)(HostSim_Stats.Accesses - Start->Accesses) / Bytes),
+	       ((double)(SimUSB_Stats.FIFOAccesses - Start->FIFOAccesses) / Bytes),
+	       ((WallSeconds > 0) ? (Seconds / WallSeconds) : 0));
+}
+
+/** Scenario measuring the report throughput of the device and the speed of the simulation. */
+static bool Scenario_Throughput(void)
+{
+	uint8_t  Report[GENERIC_REPORT_SIZE] = {COMMAND_SET_NUMBER, 1, 0};
+	uint8_t  Feature[GENERIC_FEATURE_SIZE];
+	uint32_t      Bytes;
+	Measurement_t Start;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//The configured device with the bus running and nothing to do, the load that sleeping the main loop takes away
+	StartMeasurement(&Start);
+	VirtualHost_RunFrames(THROUGHPUT_FRAMES);
+
+	uint64_t Cycles = (HostSim_GetCycles() - Start.Cycles);
+
+	printf("  idle: %.3f s simulated, device busy %.1f%% of the time\n", ((double)Cycles / HOSTSIM_CLOCK_HZ),
+	       (((Cycles - (HostSim_Stats.SleepCycles - Start.SleepCycles)) * 100.0) / Cycles));
+
+	//Output reports on the OUT endpoint, one per frame as the host schedules them
+	Bytes = 0;
+	StartMeasurement(&Start);
+
+	for (uint32_t Frame = 0; Frame < THROUGHPUT_FRAMES; Frame++)
+	{
+		Report[2] = (Frame % 100);
+
+		SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Report, sizeof(Report),
+		                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+		Bytes += sizeof(Report);
+	}
+
+	PrintThroughput("OUT reports", Bytes, &Start);
+
+	//Feature reports through the control endpoint, back to back
+	Bytes = 0;
+	StartMeasurement(&Start);
+
+	for (uint32_t Transfer = 0; Transfer < THROUGHPUT_FRAMES; Transfer++)
+	{
+		uint16_t Length;
+
+		SCENARIO_CHECK(Request(REQTYPE_CLASS_IN, HID_REQ_GetReport, (HID_REPORT_ITEM_Feature + 1) << 8, 0,
+		                       sizeof(Feature), Feature, &Length) == VIRTUALHOST_RESULT_OK, "GET_REPORT feature failed");
+		Bytes += Length;
+	}
+
+	PrintThroughput("feature reports", Bytes, &Start);
+
+	return true;
+}
+
+/** Sends a report of commands on the OUT endpoint, padded to the report size with \c COMMAND_END. */
+static uint8_t SendCommands(const uint8_t* const Commands, const uint8_t Length)
+{
+	uint8_t Report[GENERIC_REPORT_SIZE] = {0};
+
+	memcpy(Report, Commands, MIN(Length, sizeof(Report)));
+
+	return VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Report, sizeof(Report),
+	                                SCENARIO_SETTLE_FRAMES);
+}
+
+/** Renders a level through the ladder level map of the device, returning its ladder mask or 0xFF on failure. */
+static uint8_t ProbeLadder(const uint8_t Level)
+{
+	uint8_t Probe[GENERIC_FEATURE_SIZE - FEATURE_DATA];
+
+	if ((WriteFeature(FEATURE_PAGE_PROBE, &Level, 1) != VIRTUALHOST_RESULT_OK) ||
+	    (ReadFeature(FEATURE_PAGE_PROBE, Probe) != VIRTUALHOST_RESULT_OK) || (Probe[0] != Level))
+	{
+		return 0xFF;
+	}
+
+	return Probe[1];
+}
+
+uint8_t Scenarios_LadderLEDs(const uint8_t LadderMask)
+{
+	static const uint8_t LEDMasks[] = {LEDS_LED1, LEDS_LED2, LEDS_LED3, LEDS_LED4};
+
+	uint8_t LEDs = 0;
+
+	for (uint8_t LEDIndex = 0; LEDIndex < sizeof(LEDMasks); LEDIndex++)
+	{
+		if (LadderMask & (1 << LEDIndex))
+		  LEDs |= LEDMasks[LEDIndex];
+	}
+
+	return LEDs;
+}
+
+/** Latencies of one kind of control request over a control latency run. */
+typedef struct
+{
+	uint64_t Worst; /**< Longest request, in cycles. */
+	uint64_t Total; /**< Sum of the request times, in cycles. */
+} Latency_t;
+
+/** Adds the time taken by one request to the latencies. */
+static void AddLatency(Latency_t* const Latency, const uint64_t Cycles)
+{
+	if (Cycles > Latency->Worst)
+	  Latency->Worst = Cycles;
+
+	Latency->Total += Cycles;
+}
+
+/** Issues a control request and adds the time from its SETUP to the end of its status stage to the latencies. */
+static uint8_t TimedRequest(Latency_t* const Latency, const uint8_t bmRequestType, const uint8_t bRequest,
+                            const uint16_t wValue, const uint16_t wLength, void* const Data)
+{
+	uint64_t Start  = HostSim_GetCycles();
+	uint8_t  Result = Request(bmRequestType, bRequest, wValue, 0, wLength, Data, NULL);
+
+	AddLatency(Latency, (HostSim_GetCycles() - Start));
+
+	return Result;
+}
+
+/** Sends a \c COMMAND_SET_LEDS output report through the control endpoint or through the OUT endpoint, adding the
+ *  time until the device accepted the report and the time until it had set the LEDs to the latencies.
+ */
+static bool TimedSetLEDs(const bool ThroughOUTEndpoint, const uint8_t LadderMask, Latency_t* const Accepted,
+                         Latency_t* const Applied)
+{
+	uint8_t  Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_LEDS, 1, LadderMask};
+	uint64_t Start = HostSim_GetCycles();
+	uint8_t  Result;
+
+	if (ThroughOUTEndpoint)
+	{
+		Result = VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+		                                  SCENARIO_SETTLE_FRAMES);
+	}
+	else
+	{
+		Result = Request(REQTYPE_CLASS_OUT, HID_REQ_SetReport, (HID_REPORT_ITEM_Out + 1) << 8, 0, sizeof(Command),
+		                 Command, NULL);
+	}
+
+	if (Result != VIRTUALHOST_RESULT_OK)
+	  return false;
+
+	AddLatency(Accepted, (HostSim_GetCycles() - Start));
+
+	while (SimBoard_GetLEDs() != Scenarios_LadderLEDs(LadderMask))
+	{
+		if ((HostSim_GetCycles() - Start) > ((uint64_t)SCENARIO_SETTLE_FRAMES * VIRTUALHOST_FRAME_CYCLES))
+		  return false;
+
+		VirtualHost_Run(CONTROL_POLL_CYCLES);
+	}
+
+	AddLatency(Applied, (HostSim_GetCycles() - Start));
+
+	return true;
+}
+
+/** Converts a time in cycles to microseconds. */
+static double Microseconds(const double Cycles)
+{
+	return ((Cycles * 1000000.0) / HOSTSIM_CLOCK_HZ);
+}
+
+/** Scenario measuring the time the device takes to complete control requests while its main loop is busy with
+ *  other work, for standard requests and for HID class requests, and the time it takes to accept the same output
+ *  report through the control endpoint and through the OUT endpoint.
+ */
+static bool Scenario_Control(void)
+{
+	static const uint32_t Loads[] = {0, (HOSTSIM_CLOCK_HZ / 1000), (HOSTSIM_CLOCK_HZ / 200)};
+
+	uint8_t  Data[GENERIC_FEATURE_SIZE];
+	uint32_t Seed = 1;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	for (uint8_t LoadIndex = 0; LoadIndex < (sizeof(Loads) / sizeof(Loads[0])); LoadIndex++)
+	{
+		Latency_t Standard          = {0};
+		Latency_t Class             = {0};
+		Latency_t ControlAccepted   = {0};
+		Latency_t ControlApplied    = {0};
+		Latency_t InterruptAccepted = {0};
+		Latency_t InterruptApplied  = {0};
+
+		HostSim_SetMainLoopLoad(Loads[LoadIndex]);
+
+		for (uint16_t Iteration = 0; Iteration < CONTROL_LATENCY_REQUESTS; Iteration++)
+		{
+			//Issue each request at a different point of the main loop, from a fixed sequence so runs compare
+			Seed = ((Seed * 1103515245) + 12345);
+			VirtualHost_Run((Seed >> 8) % (Loads[LoadIndex] + (HOSTSIM_CLOCK_HZ / 1000)));
+
+			SCENARIO_CHECK(TimedRequest(&Standard, REQTYPE_STANDARD_IN, REQ_GetStatus, 0, 2,
+			                            Data) == VIRTUALHOST_RESULT_OK, "GET_STATUS failed");
+			SCENARIO_CHECK(TimedRequest(&Class, REQTYPE_CLASS_IN, HID_REQ_GetReport, (HID_REPORT_ITEM_Feature + 1) << 8,
+			                            sizeof(Data), Data) == VIRTUALHOST_RESULT_OK, "GET_REPORT feature failed");
+
+			//The same output report through either pipe, each changing the LEDs
+			SCENARIO_CHECK(TimedSetLEDs(false, 0x05, &ControlAccepted, &ControlApplied), "SET_REPORT output failed");
+			SCENARIO_CHECK(TimedSetLEDs(true, 0x0A, &InterruptAccepted, &InterruptApplied), "OUT report failed");
+		}
+
+		printf("  main loop load %.1f ms: GET_STATUS worst %.0f us, mean %.0f us; GET_REPORT worst %.0f us, mean %.0f us\n",
+		       Microseconds(Loads[LoadIndex]) / 1000, Microseconds(Standard.Worst),
+		       Microseconds((double)Standard.Total / CONTROL_LATENCY_REQUESTS), Microseconds(Class.Worst),
+		       Microseconds((double)Class.Total / CONTROL_LATENCY_REQUESTS));
+		printf("    output report accepted: SET_REPORT worst %.0f us, mean %.0f us; OUT endpoint worst %.0f us, mean %.0f us\n",
+		       Microseconds(ControlAccepted.Worst), Microseconds((double)ControlAccepted.Total / CONTROL_LATENCY_REQUESTS),
+		       Microseconds(InterruptAccepted.Worst), Microseconds((double)InterruptAccepted.Total / CONTROL_LATENCY_REQUESTS));
+		printf("    output report applied:  SET_REPORT worst %.0f us, mean %.0f us; OUT endpoint worst %.0f us, mean %.0f us\n",
+		       Microseconds(ControlApplied.Worst), Microseconds((double)ControlApplied.Total / CONTROL_LATENCY_REQUESTS),
+		       Microseconds(InterruptApplied.Worst), Microseconds((double)InterruptApplied.Total / CONTROL_LATENCY_REQUESTS));
+	}
+
+	HostSim_SetMainLoopLoad(0);
+
+	//The ladder is handed back to the status LEDs for the scenarios after this one
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_LEDS, 1, 0}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	return true;
+}
+
+/** Scenario measuring the latency of the display multiplex interrupt while the USB general interrupt handles
+ *  frames, bus resets and the bus supply being dropped and restored, which has it wait for the PLL to lock.
+ */
+static bool Scenario_Latency(void)
+{
+	const HostSim_Latency_t* Latency = HostSim_GetLatency(HOSTSIM_ADDRESS(TIFR0), (1 << OCF0A));
+
+	uint8_t  Data[1];
+	uint32_t Seed = 1;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	HostSim_ClearLatencies();
+
+	for (uint16_t Iteration = 0; Iteration < LATENCY_BUS_EVENTS; Iteration++)
+	{
+		//Start each event at a different point of the display multiplex, from a fixed sequence so runs compare
+		Seed = ((Seed * 1103515245) + 12345);
+		VirtualHost_Run((Seed >> 8) % (HOSTSIM_CLOCK_HZ / 100));
+
+		if (Iteration & 1)
+		{
+			SimUSB_SetVBUS(false);
+			VirtualHost_RunFrames(2);
+			SimUSB_SetVBUS(true);
+		}
+
+		VirtualHost_BusReset();
+	}
+
+	SCENARIO_CHECK(Latency->Count, "display was not multiplexed");
+
+	printf("  display multiplex interrupts: %lu, latency worst %.1f us, mean %.2f us\n", (unsigned long)Latency->Count,
+	       Microseconds(Latency->Worst), Microseconds((double)Latency->Total / Latency->Count));
+
+	//The device still enumerates after all of that
+	SCENARIO_CHECK(VirtualHost_SetAddress(SCENARIO_DEVICE_ADDRESS) == VIRTUALHOST_RESULT_OK, "SET_ADDRESS failed");
+	SCENARIO_CHECK(Request(REQTYPE_STANDARD_OUT, REQ_SetConfiguration, 1, 0, 0, NULL, NULL) == VIRTUALHOST_RESULT_OK,
+	               "SET_CONFIGURATION failed");
+	SCENARIO_CHECK((Request(REQTYPE_STANDARD_IN, REQ_GetConfiguration, 0, 0, 1, Data, NULL) == VIRTUALHOST_RESULT_OK) &&
+	               (Data[0] == 1), "GET_CONFIGURATION did not return the configuration");
+
+	return true;
+}
+
+/** Scenario clicking a button many more times than the input queue holds while the host is not reading reports,
+ *  then checking that every click is reported once the host reads them. A click, a double click and a turn queued
+ *  up behind a full IN endpoint must then be reported in that order, none of them merged into another's report.
+ */
+static bool Scenario_Buttons(void)
+{
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Without double clicks or long presses, every release of a button is a click of its own
+	uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_BUTTONS, 2, 0, 0};
+
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	for (uint16_t Click = 0; Click < BUTTON_CLICKS; Click++)
+	{
+		SimBoard_SetButtons(SIMBOARD_BUTTON1);
+		VirtualHost_RunFrames(30);
+		SimBoard_SetButtons(0);
+		VirtualHost_RunFrames(30);
+	}
+
+	uint16_t Clicks  = 0;
+	uint16_t Reports = 0;
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK)
+	{
+		SCENARIO_CHECK(!(Data[REPORT_IN_BUTTONS] & ~GESTURE_CLICK), "gestures %02X reported for single clicks",
+		               Data[REPORT_IN_BUTTONS]);
+
+		Clicks += (Data[REPORT_IN_BUTTONS] & GESTURE_CLICK) ? 1 : 0;
+		Reports++;
+	}
+
+	printf("  %u clicks while the host was not reading, %u reported in %u reports\n", BUTTON_CLICKS, Clicks, Reports);
+	SCENARIO_CHECK(Clicks == BUTTON_CLICKS, "%u clicks reported, not %u", Clicks, BUTTON_CLICKS);
+
+	//With the default timings back, a click and then a double click of the same button must arrive as two reports in
+	//that order, and a turn after them in a third, rather than being merged into a single report
+	Command[2] = BUTTON_LONG_PRESS_TIME;
+	Command[3] = BUTTON_DOUBLE_CLICK_TIME;
+
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK);
+
+	//The reports of the first turns fill the IN endpoint, so that the gestures and the turn after them queue up together
+	VirtualHost_TurnEncoder(BUTTON_ORDER_TURNS, ENCODER_SLOW_DETENT);
+
+	for (uint8_t Press = 0; Press < 3; Press++)
+	{
+		SimBoard_SetButtons(SIMBOARD_BUTTON1);
+		VirtualHost_RunFrames(30);
+		SimBoard_SetButtons(0);
+		VirtualHost_RunFrames(30);
+
+		//The first press is a click once the double click time has passed, the next two a double click
+		if (!(Press))
+		  VirtualHost_RunFrames(BUTTON_DOUBLE_CLICK_TIME * GESTURES_UNIT_MS * 2);
+	}
+
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	VirtualHost_TurnEncoder(1, ENCODER_SLOW_DETENT);
+
+	//The click may share a report with the turns before it, but the double click and the last turn come after it,
+	//each in a report of its own
+	uint8_t Stage = 0;
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK)
+	{
+		int8_t  Steps    = (int8_t)Data[REPORT_IN_STEPS];
+		uint8_t Gestures = Data[REPORT_IN_BUTTONS];
+
+		if (Stage == 0)
+		{
+			SCENARIO_CHECK(!(Gestures & ~GESTURE_CLICK), "gestures %02X reported before the click", Gestures);
+		}
+		else if (Stage == 1)
+		{
+			SCENARIO_CHECK((Gestures == GESTURE_DOUBLE_CLICK) && !(Steps), "report after the click has gestures %02X "
+			               "and %d steps, not just the double click", Gestures, Steps);
+		}
+		else
+		{
+			SCENARIO_CHECK((Stage == 2) && !(Gestures) && Steps, "report %u after the click has gestures %02X and %d "
+			               "steps, not just the last turn", Stage, Gestures, Steps);
+		}
+
+		if (Stage || Gestures)
+		  Stage++;
+	}
+
+	SCENARIO_CHECK(Stage == 3, "%u reports from the click on, not the click, the double click and the last turn",
+	               Stage);
+
+	return true;
+}
+
+/** Computes the CRC of a settings record, over all of its fields preceding the CRC. */
+static uint16_t RecordCRC(const Settings_Record_t* const Record)
+{
+	uint16_t CRC = 0xFFFF;
+
+	for (uint8_t Offset = 0; Offset < offsetof(Settings_Record_t, CRC); Offset++)
+	  CRC = _crc_ccitt_update(CRC, ((const uint8_t*)Record)[Offset]);
+
+	return CRC;
+}
+
+/** Finds the newest valid record of the settings store in the EEPROM, as the firmware does at boot. */
+static bool ReadSavedSettings(Settings_Record_t* const Newest)
+{
+	bool Found = false;
+
+	for (uint8_t Slot = 0; Slot < SETTINGS_SLOT_COUNT; Slot++)
+	{
+		Settings_Record_t SlotRecord;
+
+		memcpy(&SlotRecord, &HostSim_GetEEPROM()[Slot * SETTINGS_SLOT_SIZE], sizeof(SlotRecord));
+
+		if ((SlotRecord.Version != SETTINGS_VERSION) || (SlotRecord.CRC != RecordCRC(&SlotRecord)))
+		  continue;
+
+		if (!(Found) || ((int16_t)(SlotRecord.Sequence - Newest->Sequence) > 0))
+		  *Newest = SlotRecord;
+
+		Found = true;
+	}
+
+	return Found;
+}
+
+/** Lets the bus run until the device has saved a settings record newer than the given one. */
+static bool WaitForSave(const Settings_Record_t* const Previous, Settings_Record_t* const Saved)
+{
+	for (uint32_t Frame = 0; Frame < SETTINGS_SAVE_FRAMES; Frame += 10)
+	{
+		VirtualHost_RunFrames(10);
+
+		if (ReadSavedSettings(Saved) && (Saved->Sequence != Previous->Sequence))
+		  return true;
+	}
+
+	return false;
+}
+
+/** Scenario sending every command type through the OUT endpoint and checking its effect on the display, the LED
+ *  ladder, the reports and the saved settings, along with the malformed and legacy forms of the command stream.
+ */
+static bool Scenario_Commands(void)
+{
+	uint8_t           Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t          Length;
+	Settings_Record_t Before = {.Sequence = 0};
+	Settings_Record_t Saved;
+	uint8_t           EEPROM[HOSTSIM_EEPROM_SIZE];
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//The settings saved here are undone at the end, and the ladder handed back to the status LEDs, as the scenarios
+	//after this one start from the same device without its memory cleared
+	memcpy(EEPROM, HostSim_GetEEPROM(), sizeof(EEPROM));
+
+	ReadSavedSettings(&Before);
+
+	//Display and ladder commands, starting from the default thresholds of 15, 25, 35 and 50 and an instant meter
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_NUMBER, 1, 42}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(42, SCENARIO_SETTLE_FRAMES), "SET_NUMBER shows %d, not 42",
+	               SimBoard_GetDisplayNumber());
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_LEDS, 1, 0x05}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetLEDs() == Scenarios_LadderLEDs(0x05), "SET_LEDS lit LEDs %02X", SimBoard_GetLEDs());
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_LEVEL, 1, 30}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetLEDs() == Scenarios_LadderLEDs(0x03), "SET_LEVEL 30 lit LEDs %02X", SimBoard_GetLEDs());
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_METER_SAMPLES, 3, 60, 60, 20}, 5) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetLEDs() == Scenarios_LadderLEDs(0x01), "METER_SAMPLES ending at 20 lit LEDs %02X",
+	               SimBoard_GetLEDs());
+
+	//Several commands in one report are all executed, in order
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_NUMBER, 1, 7, COMMAND_SET_LEDS, 1, 0x06}, 6) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(7, SCENARIO_SETTLE_FRAMES), "first of two commands shows %d, not 7",
+	               SimBoard_GetDisplayNumber());
+	SCENARIO_CHECK(SimBoard_GetLEDs() == Scenarios_LadderLEDs(0x06), "second of two commands lit LEDs %02X", SimBoard_GetLEDs());
+
+	//Unknown commands and commands with too short a value are skipped whole, and the commands after them still run
+	SCENARIO_CHECK(SendCommands((uint8_t[]){0x7F, 2, 0xAA, 0xBB, COMMAND_SET_NUMBER, 1, 6}, 7) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(6, SCENARIO_SETTLE_FRAMES), "command after an unknown one shows %d, "
+	               "not 6", SimBoard_GetDisplayNumber());
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_THRESHOLDS, 3, 1, 1, 1, COMMAND_SET_NUMBER, 1, 5}, 8) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(5, SCENARIO_SETTLE_FRAMES), "command after a short one shows %d, not 5",
+	               SimBoard_GetDisplayNumber());
+	SCENARIO_CHECK(ProbeLadder(30) == 0x03, "thresholds too short were applied");
+
+	//A command overrunning the end of the report, brought up to its end behind an unknown command, ends the stream
+	//after the commands before it have run
+	uint8_t Overrun[GENERIC_REPORT_SIZE] = {COMMAND_SET_NUMBER, 1, 8, 0x7F, (GENERIC_REPORT_SIZE - 8)};
+
+	memcpy(&Overrun[GENERIC_REPORT_SIZE - 3], (uint8_t[]){COMMAND_SET_NUMBER, 5, 9}, 3);
+
+	SCENARIO_CHECK(SendCommands(Overrun, sizeof(Overrun)) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(8, SCENARIO_SETTLE_FRAMES), "command before an overrun shows %d, not 8",
+	               SimBoard_GetDisplayNumber());
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetDisplayNumber() == 8, "command overrunning the report showed %d",
+	               SimBoard_GetDisplayNumber());
+
+	//The legacy fixed format carries the number and the level without a length
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_LEGACY_VOLUME, 55, 40}, 3) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(55, SCENARIO_SETTLE_FRAMES), "legacy command shows %d, not 55",
+	               SimBoard_GetDisplayNumber());
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(SimBoard_GetLEDs() == Scenarios_LadderLEDs(0x07), "legacy level 40 lit LEDs %02X", SimBoard_GetLEDs());
+
+	//A traced report is answered by an IN report carrying its trace ID
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK);
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_NUMBER, 1, 12, COMMAND_TRACE, 1, 7}, 6) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+
+	bool Traced = false;
+
+	while (!(Traced) && (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                                             SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK))
+	{
+		Traced = (Data[REPORT_IN_TRACE_ID] == 7);
+	}
+
+	SCENARIO_CHECK(Traced, "no report carried the trace ID");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(12, SCENARIO_SETTLE_FRAMES), "traced report shows %d, not 12",
+	               SimBoard_GetDisplayNumber());
+
+	//An animation of two looping keyframes plays until stopped, then leaves its last number shown
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_ANIM_KEYFRAME, 5, 0x10, 2, 77, 0,
+	                                        ANIMATION_KEY_BRIGHTNESS_FLAGS(8, ANIMATION_KEY_STEP)}, 7) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_ANIM_KEYFRAME, 5, 0x11, 2, 78, 0,
+	                                        ANIMATION_KEY_BRIGHTNESS_FLAGS(8, ANIMATION_KEY_STEP)}, 7) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_ANIM_START, 3, 1, 2, ANIMATION_LOOP_FOREVER}, 5) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(77, SCENARIO_SETTLE_FRAMES * 2), "animation shows %d, not 77",
+	               SimBoard_GetDisplayNumber());
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(78, SCENARIO_SETTLE_FRAMES * 2), "animation shows %d, not 78",
+	               SimBoard_GetDisplayNumber());
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_ANIM_STOP, 0}, 2) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	int16_t Stopped = SimBoard_GetDisplayNumber();
+
+	SCENARIO_CHECK((Stopped == 77) || (Stopped == 78), "stopped animation shows %d", Stopped);
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES * 4);
+	SCENARIO_CHECK(SimBoard_GetDisplayNumber() == Stopped, "stopped animation went on to show %d",
+	               SimBoard_GetDisplayNumber());
+
+	//Settings commands are applied and saved, with out of range values clamped and unknown curves refused
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_THRESHOLDS, 4, 10, 20, 30, 40}, 6) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_BRIGHTNESS, 2, 3, 9}, 4) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_REFRESH, 1, 0}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_METER, 5, 128, 64, 0, 0, 3}, 7) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_ENCODER, 2, 50, ENCODER_CURVE_NONE}, 4) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_ENCODER, 2, 60, ENCODER_CURVE_COUNT}, 4) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_BUTTONS, 2, 40, 20}, 4) == VIRTUALHOST_RESULT_OK,
+	               "OUT report failed");
+
+	SCENARIO_CHECK(ProbeLadder(25) == 0x03, "new thresholds render level 25 as %02X", ProbeLadder(25));
+	SCENARIO_CHECK(WaitForSave(&Before, &Saved), "changed settings were not saved");
+
+	Settings_t* Stored = &Saved.Settings;
+
+	SCENARIO_CHECK(memcmp(Stored->Thresholds, (uint8_t[]){10, 20, 30, 40}, LADDER_LED_COUNT) == 0, "saved thresholds "
+	               "%u %u %u %u", Stored->Thresholds[0], Stored->Thresholds[1], Stored->Thresholds[2], Stored->Thresholds[3]);
+	SCENARIO_CHECK((Stored->Brightness[0] == 3) && (Stored->Brightness[1] == 9), "saved brightness %u %u",
+	               Stored->Brightness[0], Stored->Brightness[1]);
+	SCENARIO_CHECK(Stored->RefreshHz == DISPLAY_MIN_REFRESH_HZ, "refresh rate 0 saved as %u Hz", Stored->RefreshHz);
+	SCENARIO_CHECK((Stored->Meter.Attack == 128) && (Stored->Meter.Release == 64) && (Stored->Meter.PeakHold == 0) &&
+	               (Stored->Meter.PeakDecay == 0) && (Stored->Meter.SamplePeriod == 3), "saved meter ballistics");
+	SCENARIO_CHECK((Stored->RotaryMax == 50) && (Stored->RotaryCurve == ENCODER_CURVE_NONE), "saved encoder range %u "
+	               "and curve %u", Stored->RotaryMax, Stored->RotaryCurve);
+	SCENARIO_CHECK((Stored->Buttons.LongPress == 40) && (Stored->Buttons.DoubleClick == 20), "saved button timings");
+
+	//The saved encoder range limits the count
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK);
+
+	VirtualHost_TurnEncoder(60, ENCODER_SLOW_DETENT);
+
+	uint8_t Count = 0;
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK)
+	{
+		Count = Data[REPORT_IN_COUNT];
+	}
+
+	SCENARIO_CHECK(Count == 50, "encoder count reached %u, not the highest count of 50", Count);
+
+	//Values over the top of their range are clamped too, a single brightness level setting both digits
+	Before = Saved;
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_REFRESH, 1, 250, COMMAND_SET_BRIGHTNESS, 1, 20}, 6) ==
+	               VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(WaitForSave(&Before, &Saved), "changed settings were not saved");
+	SCENARIO_CHECK(Stored->RefreshHz == DISPLAY_MAX_REFRESH_HZ, "refresh rate 250 saved as %u Hz", Stored->RefreshHz);
+	SCENARIO_CHECK((Stored->Brightness[0] == DISPLAY_BRIGHTNESS_MAX) && (Stored->Brightness[1] == DISPLAY_BRIGHTNESS_MAX),
+	               "brightness 20 saved as %u %u", Stored->Brightness[0], Stored->Brightness[1]);
+
+	printf("  every command type, malformed streams and the legacy format handled, settings saved in record %u\n",
+	       Saved.Sequence);
+
+	SCENARIO_CHECK(SendCommands((uint8_t[]){COMMAND_SET_LEDS, 1, 0}, 3) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	memcpy(HostSim_GetEEPROM(), EEPROM, sizeof(EEPROM));
+
+	return true;
+}
+
+/** Checks the ladder level map of the device against the expected map, first reading the whole map back through
+ *  its feature pages and then rendering every level through the probe page, returning the number of mismatches.
+ */
+static uint16_t CheckLadderMap(const uint8_t* const Expected)
+{
+	uint16_t Mismatches = 0;
+
+	for (uint8_t Page = 0; Page < LADDER_PAGE_COUNT; Page++)
+	{
+		uint8_t PageData[GENERIC_FEATURE_SIZE - FEATURE_DATA];
+
+		if (ReadFeature((FEATURE_PAGE_LADDER + Page), PageData) != VIRTUALHOST_RESULT_OK)
+		{
+			printf("  ladder page %u could not be read\n", Page);
+			Mismatches += LADDER_PAGE_ENTRIES;
+			continue;
+		}
+
+		for (uint8_t Entry = 0; Entry < LADDER_PAGE_ENTRIES; Entry++)
+		{
+			uint8_t Level = ((Page * LADDER_PAGE_ENTRIES) + Entry);
+			uint8_t Mask  = ((PageData[Entry / 2] >> ((Entry & 1) ? 4 : 0)) & 0x0F);
+
+			if (Mask != Expected[Level])
+			{
+				printf("  read back level %u: expected %X, got %X\n", Level, Expected[Level], Mask);
+				Mismatches++;
+			}
+		}
+	}
+
+	uint8_t Level = 0;
+
+	do
+	{
+		uint8_t Mask = ProbeLadder(Level);
+
+		if (Mask != Expected[Level])
+		{
+			printf("  rendered level %u: expected %X, got %X\n", Level, Expected[Level], Mask);
+			Mismatches++;
+		}
+	}
+	while (++Level);
+
+	return Mismatches;
+}
+
+/** Fills a ladder level map as the device renders it from a threshold per LED. */
+static void ThresholdsToLadderMap(const uint8_t* const Thresholds, uint8_t* const Masks)
+{
+	uint8_t Level = 0;
+
+	do
+	{
+		Masks[Level] = 0;
+
+		for (uint8_t LEDIndex = 0; LEDIndex < LADDER_LED_COUNT; LEDIndex++)
+		{
+			if (Level >= Thresholds[LEDIndex])
+			  Masks[Level] |= (1 << LEDIndex);
+		}
+	}
+	while (++Level);
+}
+
+/** Scenario uploading a ladder level map through its feature pages and sweeping all 256 levels through the map
+ *  read back and through the renderer of the device, then doing the same with a map set from thresholds.
+ */
+static bool Scenario_LadderMap(void)
+{
+	static const uint8_t DefaultThresholds[LADDER_LED_COUNT] = {15, 25, 35, 50};
+	static const uint8_t Thresholds[LADDER_LED_COUNT]        = {1, 64, 128, 255};
+
+	uint8_t  Masks[256];
+	uint8_t  EEPROM[HOSTSIM_EEPROM_SIZE];
+	uint16_t Mismatches;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	memcpy(EEPROM, HostSim_GetEEPROM(), sizeof(EEPROM));
+
+	//A map no set of thresholds could produce, so every page and nibble is exercised
+	for (uint16_t Level = 0; Level < 256; Level++)
+	  Masks[Level] = (((Level * 7) + (Level >> 4)) & 0x0F);
+
+	for (uint8_t Page = 0; Page < LADDER_PAGE_COUNT; Page++)
+	{
+		uint8_t  PageData[LADDER_PAGE_SIZE];
+		uint8_t* PageMasks = &Masks[Page * LADDER_PAGE_ENTRIES];
+
+		for (uint8_t ByteIndex = 0; ByteIndex < LADDER_PAGE_SIZE; ByteIndex++)
+		  PageData[ByteIndex] = (PageMasks[ByteIndex * 2] | (PageMasks[(ByteIndex * 2) + 1] << 4));
+
+		SCENARIO_CHECK(WriteFeature((FEATURE_PAGE_LADDER + Page), PageData, sizeof(PageData)) == VIRTUALHOST_RESULT_OK,
+		               "ladder page %u could not be written", Page);
+	}
+
+	Mismatches = CheckLadderMap(Masks);
+	SCENARIO_CHECK(Mismatches == 0, "%u mismatches in the uploaded map", Mismatches);
+
+	uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_THRESHOLDS, LADDER_LED_COUNT};
+
+	memcpy(&Command[2], Thresholds, LADDER_LED_COUNT);
+	SCENARIO_CHECK(SendCommands(Command, sizeof(Command)) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	ThresholdsToLadderMap(Thresholds, Masks);
+	Mismatches = CheckLadderMap(Masks);
+	SCENARIO_CHECK(Mismatches == 0, "%u mismatches in the map set from thresholds", Mismatches);
+
+	//The default thresholds are restored, and the settings saved meanwhile undone, for the scenarios after this one
+	memcpy(&Command[2], DefaultThresholds, LADDER_LED_COUNT);
+	SCENARIO_CHECK(SendCommands(Command, sizeof(Command)) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	memcpy(HostSim_GetEEPROM(), EEPROM, sizeof(EEPROM));
+
+	printf("  all 256 levels of an uploaded map and of a threshold map read back and rendered as expected\n");
+	return true;
+}
+
+/** Reads the ladder level map of the device back through its feature pages. */
+static bool ReadLadderMap(uint8_t* const Masks)
+{
+	for (uint8_t Page = 0; Page < LADDER_PAGE_COUNT; Page++)
+	{
+		uint8_t PageData[GENERIC_FEATURE_SIZE - FEATURE_DATA];
+
+		if (ReadFeature((FEATURE_PAGE_LADDER + Page), PageData) != VIRTUALHOST_RESULT_OK)
+		  return false;
+
+		for (uint8_t Entry = 0; Entry < LADDER_PAGE_ENTRIES; Entry++)
+		  Masks[(Page * LADDER_PAGE_ENTRIES) + Entry] = ((PageData[Entry / 2] >> ((Entry & 1) ? 4 : 0)) & 0x0F);
+	}
+
+	return true;
+}
+
+/** Powers the device up from the EEPROM as it stands and checks that it loaded the settings with the given
+ *  thresholds, which the device builds its ladder level map from at boot.
+ */
+static bool BootsWithThresholds(const uint8_t* const Thresholds)
+{
+	uint8_t Expected[256];
+	uint8_t Masks[256];
+
+	if (!(Scenarios_Enumerate()) || !(ReadLadderMap(Masks)))
+	  return false;
+
+	ThresholdsToLadderMap(Thresholds, Expected);
+	return (memcmp(Masks, Expected, sizeof(Masks)) == 0);
+}
+
+/** Cuts the power at every byte of the record the device wrote between two images of the EEPROM, with the bytes
+ *  before the cut written and the byte at the cut either not yet started or erased but not yet programmed, then
+ *  powers the device back up and checks that it loaded the old settings until the new record is complete.
+ *
+ *  \return Number of boots that loaded the wrong settings.
+ */
+static uint16_t CutPowerDuringSave(const uint8_t* const Before, const uint8_t* const After,
+                                   const uint8_t* const OldThresholds, const uint8_t* const NewThresholds,
+                                   uint16_t* const Boots)
+{
+	uint8_t* EEPROM   = HostSim_GetEEPROM();
+	uint16_t Wrong    = 0;
+	uint16_t SlotBase = 0;
+
+	while ((SlotBase < HOSTSIM_EEPROM_SIZE) && (Before[SlotBase] == After[SlotBase]))
+	  SlotBase++;
+
+	SlotBase -= (SlotBase % SETTINGS_SLOT_SIZE);
+
+	for (uint8_t Cut = 0; Cut <= sizeof(Settings_Record_t); Cut++)
+	{
+		for (uint8_t Erased = 0; Erased < ((Cut < sizeof(Settings_Record_t)) ? 2 : 1); Erased++)
+		{
+			memcpy(EEPROM, Before, HOSTSIM_EEPROM_SIZE);
+			memcpy(&EEPROM[SlotBase], &After[SlotBase], Cut);
+
+			if (Erased)
+			  EEPROM[SlotBase + Cut] = 0xFF;
+
+			bool Complete = (memcmp(&EEPROM[SlotBase], &After[SlotBase], sizeof(Settings_Record_t)) == 0);
+
+			if (!(BootsWithThresholds(Complete ? NewThresholds : OldThresholds)))
+			{
+				printf("  power cut at byte %u%s of the record in slot %u did not load the %s settings\n", Cut,
+				       (Erased ? " while erased" : ""), (SlotBase / SETTINGS_SLOT_SIZE), (Complete ? "new" : "old"));
+				Wrong++;
+			}
+
+			(*Boots)++;
+		}
+	}
+
+	memcpy(EEPROM, After, HOSTSIM_EEPROM_SIZE);
+	return Wrong;
+}
+
+/** Scenario cutting the power at every byte of a settings save, first the first record of an erased store and then
+ *  a record written over the oldest of a full ring whose sequence numbers wrap, and checking that each boot loads
+ *  the last complete record or the defaults.
+ */
+static bool Scenario_SettingsTorn(void)
+{
+	static const uint8_t DefaultThresholds[LADDER_LED_COUNT] = {15, 25, 35, 50};
+	static const uint8_t FirstThresholds[LADDER_LED_COUNT]   = {10, 20, 30, 40};
+	static const uint8_t NewThresholds[LADDER_LED_COUNT]     = {5, 60, 120, 200};
+
+	uint8_t           EEPROM[HOSTSIM_EEPROM_SIZE];
+	uint8_t           Before[HOSTSIM_EEPROM_SIZE];
+	uint8_t           After[HOSTSIM_EEPROM_SIZE];
+	uint8_t           RingThresholds[LADDER_LED_COUNT];
+	uint8_t           Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_THRESHOLDS, LADDER_LED_COUNT};
+	Settings_Record_t Previous = {.Sequence = 0};
+	Settings_Record_t Saved;
+	uint16_t          Wrong;
+	uint16_t          Boots = 0;
+
+	memcpy(EEPROM, HostSim_GetEEPROM(), sizeof(EEPROM));
+
+	//The first record of an erased store, cut short, leaves the defaults
+	memset(HostSim_GetEEPROM(), 0xFF, HOSTSIM_EEPROM_SIZE);
+	SCENARIO_CHECK(BootsWithThresholds(DefaultThresholds), "erased store did not load the defaults");
+	memcpy(Before, HostSim_GetEEPROM(), sizeof(Before));
+
+	memcpy(&Command[2], FirstThresholds, LADDER_LED_COUNT);
+	SCENARIO_CHECK(SendCommands(Command, sizeof(Command)) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(WaitForSave(&Previous, &Saved), "changed settings were not saved");
+	memcpy(After, HostSim_GetEEPROM(), sizeof(After));
+
+	Wrong = CutPowerDuringSave(Before, After, DefaultThresholds, FirstThresholds, &Boots);
+	SCENARIO_CHECK(Wrong == 0, "%u boots into an erased store loaded the wrong settings", Wrong);
+
+	//A full ring, each record with its own thresholds, the newest followed by the oldest
+	for (uint8_t Slot = 0; Slot < SETTINGS_SLOT_COUNT; Slot++)
+	{
+		Settings_Record_t Record = Saved;
+
+		Record.Sequence = (TORN_NEWEST_SEQUENCE + Slot - TORN_NEWEST_SLOT);
+
+		if (Slot > TORN_NEWEST_SLOT)
+		  Record.Sequence -= SETTINGS_SLOT_COUNT;
+
+		for (uint8_t LEDIndex = 0; LEDIndex < LADDER_LED_COUNT; LEDIndex++)
+		  Record.Settings.Thresholds[LEDIndex] = (Slot + 1 + (LEDIndex * 40));
+
+		Record.CRC = RecordCRC(&Record);
+		memcpy(&HostSim_GetEEPROM()[Slot * SETTINGS_SLOT_SIZE], &Record, sizeof(Record));
+
+		if (Slot == TORN_NEWEST_SLOT)
+		{
+			Previous = Record;
+			memcpy(RingThresholds, Record.Settings.Thresholds, LADDER_LED_COUNT);
+		}
+	}
+
+	SCENARIO_CHECK(BootsWithThresholds(RingThresholds), "full ring did not load the record in slot %u",
+	               TORN_NEWEST_SLOT);
+	memcpy(Before, HostSim_GetEEPROM(), sizeof(Before));
+
+	memcpy(&Command[2], NewThresholds, LADDER_LED_COUNT);
+	SCENARIO_CHECK(SendCommands(Command, sizeof(Command)) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(WaitForSave(&Previous, &Saved), "changed settings were not saved");
+	SCENARIO_CHECK(Saved.Sequence == (uint16_t)(TORN_NEWEST_SEQUENCE + 1), "saved record has sequence %u",
+	               Saved.Sequence);
+	memcpy(After, HostSim_GetEEPROM(), sizeof(After));
+
+	Wrong = CutPowerDuringSave(Before, After, RingThresholds, NewThresholds, &Boots);
+	SCENARIO_CHECK(Wrong == 0, "%u boots into a full ring loaded the wrong settings", Wrong);
+
+	//The store is put back for the scenarios after this one, which power the device up from it again
+	memcpy(HostSim_GetEEPROM(), EEPROM, sizeof(EEPROM));
+
+	printf("  power cut at every byte of 2 saves, each of %u boots loaded the last complete record\n", Boots);
+	return true;
+}
+
+/** Suspends the bus and turns the encoder a detent while it is suspended, then reads back the low power statistics
+ *  once the bus has resumed, whether the device woke it or the host had to.
+ */
+static bool SuspendAndTurn(uint8_t* const Power)
+{
+	SCENARIO_CHECK(WriteFeature(FEATURE_PAGE_POWER, NULL, 0) == VIRTUALHOST_RESULT_OK, "power page could not be cleared");
+
+	VirtualHost_Suspend();
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	SCENARIO_CHECK(HostSim_IsAsleep(), "device did not sleep while suspended");
+
+	VirtualHost_TurnEncoder(1, ENCODER_SLOW_DETENT);
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+
+	if (VirtualHost_IsSuspended())
+	{
+		VirtualHost_Resume();
+		VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	}
+
+	SCENARIO_CHECK(ReadFeature(FEATURE_PAGE_POWER, Power) == VIRTUALHOST_RESULT_OK, "power page could not be read");
+
+	return true;
+}
+
+/** Scenario suspending the bus and checking the low power state the device entered, from the registers it
+ *  snapshotted as the core went to sleep, then checking that turning the encoder only wakes the bus once the host
+ *  has enabled remote wakeups.
+ */
+static bool Scenario_Suspend(void)
+{
+	uint8_t Power[GENERIC_FEATURE_SIZE - FEATURE_DATA];
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Without remote wakeups enabled, the encoder leaves the bus suspended until the host resumes it
+	uint32_t RemoteWakeups = VirtualHost_Stats.RemoteWakeups;
+
+	if (!(SuspendAndTurn(Power)))
+	  return false;
+
+	printf("  suspended with SMCR %02X, PRR0 %02X, PRR1 %02X, TCCR0B %02X, CLKPR %02X\n", Power[POWER_SLEEP_SMCR],
+	       Power[POWER_SLEEP_PRR0], Power[POWER_SLEEP_PRR1], Power[POWER_SLEEP_TCCR0B], Power[POWER_SLEEP_CLKPR]);
+
+	SCENARIO_CHECK(Power[POWER_SUSPENDS] == 1, "%u suspends counted, not 1", Power[POWER_SUSPENDS]);
+	SCENARIO_CHECK((Power[POWER_REMOTE_WAKEUPS] == 0) && (VirtualHost_Stats.RemoteWakeups == RemoteWakeups),
+	               "device woke the bus without remote wakeups enabled");
+	SCENARIO_CHECK((Power[POWER_SLEEP_SMCR] & ((1 << SM2) | (1 << SM1) | (1 << SM0))) == (1 << SM1),
+	               "core slept with SMCR %02X, not in power down", Power[POWER_SLEEP_SMCR]);
+	SCENARIO_CHECK((Power[POWER_SLEEP_PRR0] & POWER_PRR0_SUSPENDED) == POWER_PRR0_SUSPENDED,
+	               "PRR0 %02X does not power down TWI, Timer 0, SPI and the ADC", Power[POWER_SLEEP_PRR0]);
+	SCENARIO_CHECK((Power[POWER_SLEEP_PRR1] & POWER_PRR1_SUSPENDED) == POWER_PRR1_SUSPENDED,
+	               "PRR1 %02X does not power down USART1", Power[POWER_SLEEP_PRR1]);
+	SCENARIO_CHECK(!(Power[POWER_SLEEP_TCCR0B] & ((1 << CS02) | (1 << CS01) | (1 << CS00))),
+	               "display timer left running with TCCR0B %02X", Power[POWER_SLEEP_TCCR0B]);
+	SCENARIO_CHECK((Power[POWER_SLEEP_CLKPR] & 0x0F) == SUSPEND_CLOCK_DIVISION, "clock prescaled with CLKPR %02X",
+	               Power[POWER_SLEEP_CLKPR]);
+
+	//Once the host has enabled remote wakeups, the encoder wakes the bus by itself
+	SCENARIO_CHECK(Request(REQTYPE_STANDARD_OUT, REQ_SetFeature, FEATURE_SEL_DeviceRemoteWakeup, 0, 0, NULL, NULL) ==
+	               VIRTUALHOST_RESULT_OK, "SET_FEATURE of remote wakeups failed");
+
+	if (!(SuspendAndTurn(Power)))
+	  return false;
+
+	SCENARIO_CHECK(VirtualHost_Stats.RemoteWakeups == (RemoteWakeups + 1), "host saw %lu remote wakeups, not 1",
+	               (unsigned long)(VirtualHost_Stats.RemoteWakeups - RemoteWakeups));
+	SCENARIO_CHECK((Power[POWER_SUSPENDS] == 1) && (Power[POWER_REMOTE_WAKEUPS] == 1), "%u suspends and %u remote "
+	               "wakeups counted, not one of each", Power[POWER_SUSPENDS], Power[POWER_REMOTE_WAKEUPS]);
+
+	//The turns made while suspended are reported once the bus has resumed, at least a step for each detent as the
+	//suspended core times them on its prescaled clock, which may make them look fast enough to accelerate
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+	int16_t  Steps = 0;
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK)
+	{
+		Steps += (int8_t)Data[REPORT_IN_STEPS];
+	}
+
+	SCENARIO_CHECK(Steps >= 2, "reports carried %d steps for the two detents turned while suspended", Steps);
+
+	SCENARIO_CHECK(Request(REQTYPE_STANDARD_OUT, REQ_ClearFeature, FEATURE_SEL_DeviceRemoteWakeup, 0, 0, NULL, NULL) ==
+	               VIRTUALHOST_RESULT_OK, "CLEAR_FEATURE of remote wakeups failed");
+
+	return true;
+}
+
+#if defined(PROFILE_ENABLED)
+/** Scenario checking that the profiler times the USB endpoint interrupt, which takes every SETUP, as well as the
+ *  general interrupt, which takes every start of frame.
+ */
+static bool Scenario_Profile(void)
+{
+	const uint8_t ProbePage = (FEATURE_PAGE_PROFILE + (PROFILE_PROBE_USB_ISR * PROFILE_PAGE_COUNT));
+
+	uint8_t Data[GENERIC_FEATURE_SIZE];
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Writing a page of the probe latches and resets its statistics, so time only what happens in between
+	SCENARIO_CHECK(WriteFeature(ProbePage, NULL, 0) == VIRTUALHOST_RESULT_OK, "profile latch failed");
+
+	uint32_t StartFrames = VirtualHost_Stats.Frames;
+
+	for (uint16_t Iteration = 0; Iteration < PROFILE_REQUESTS; Iteration++)
+	{
+		SCENARIO_CHECK(Request(REQTYPE_STANDARD_IN, REQ_GetStatus, 0, 0, 2, Data, NULL) == VIRTUALHOST_RESULT_OK,
+		               "GET_STATUS failed");
+	}
+
+	uint32_t Frames = (VirtualHost_Stats.Frames - StartFrames);
+
+	SCENARIO_CHECK(WriteFeature(ProbePage, NULL, 0) == VIRTUALHOST_RESULT_OK, "profile latch failed");
+	SCENARIO_CHECK(ReadFeature(ProbePage, Data) == VIRTUALHOST_RESULT_OK, "profile read failed");
+
+	uint16_t Count = (Data[0] | (Data[1] << 8));
+	uint16_t Max   = (Data[4] | (Data[5] << 8));
+
+	printf("  %u requests over %lu frames: %u USB interrupts timed, longest %.1f us\n", PROFILE_REQUESTS,
+	       (unsigned long)Frames, Count, Microseconds(Max));
+
+	//Every SETUP is an endpoint interrupt of its own, while frames arriving during one are timed within it
+	SCENARIO_CHECK(Count > PROFILE_REQUESTS, "%u USB interrupts timed, expected more than %u", Count, PROFILE_REQUESTS);
+
+	return true;
+}
+#endif
+
+/** Turns the encoder, then reads reports until the device has none left, returning the encoder steps they carried. */
+static int16_t TurnAndCollect(const int16_t Detents, const uint32_t CyclesPerDetent)
+{
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+	int16_t  Steps = 0;
+
+	VirtualHost_TurnEncoder(Detents, CyclesPerDetent);
+
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length, 2) == VIRTUALHOST_RESULT_OK)
+	  Steps += (int8_t)Data[REPORT_IN_STEPS];
+
+	return Steps;
+}
+
+/** Lets the bus run until Timer 3, which times the encoder detents, reaches the given count. */
+static void RunUntilEncoderTimer(const uint16_t Count)
+{
+	uint16_t Ticks = (Count - HostSim_GetTimerCount(HOSTSIM_ADDRESS(TCNT3)));
+
+	VirtualHost_Run((uint64_t)Ticks * ENCODER_TIMER_TICK);
+}
+
+/** Scenario replaying timing traces of the encoder through its acceleration: slow and fast turns, fast turns across
+ *  the wrap of the timer timing the detents, and pauses shorter and longer than a whole period of that timer.
+ */
+static bool Scenario_EncoderTiming(void)
+{
+	int16_t Steps;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	TurnAndCollect(0, 0);
+
+	//Slow detents are worth a single step each
+	for (uint8_t Detent = 0; Detent < 3; Detent++)
+	{
+		Steps = TurnAndCollect(1, ENCODER_SLOW_DETENT);
+		SCENARIO_CHECK(Steps == 1, "slow detent %u was worth %d steps", Detent, Steps);
+	}
+
+	//Fast detents are accelerated once the period estimate has caught up, here timed to learn their length in ticks
+	uint16_t Start = HostSim_GetTimerCount(HOSTSIM_ADDRESS(TCNT3));
+
+	for (uint8_t Detent = 0; Detent < 8; Detent++)
+	  Steps = TurnAndCollect(1, ENCODER_FAST_DETENT);
+
+	uint16_t DetentTicks = (uint16_t)(HostSim_GetTimerCount(HOSTSIM_ADDRESS(TCNT3)) - Start) / 8;
+
+	printf("  fast detents %u timer ticks apart, the last worth %d steps\n", DetentTicks, Steps);
+	SCENARIO_CHECK(Steps >= ENCODER_FAST_STEPS, "fast detent was worth %d steps", Steps);
+
+	//Fast detents stay accelerated while the timer wraps between them, once the estimate has recovered from the
+	//pause before them
+	RunUntilEncoderTimer((uint16_t)(0 - (DetentTicks * 12)));
+
+	for (uint8_t Detent = 0; Detent < 16; Detent++)
+	{
+		Steps = TurnAndCollect(1, ENCODER_FAST_DETENT);
+		SCENARIO_CHECK((Detent < 10) || (Steps >= ENCODER_FAST_STEPS), "fast detent %u across the timer wrap was "
+		               "worth %d steps", Detent, Steps);
+	}
+
+	//A pause shorter than a timer period makes the next detent slow
+	VirtualHost_Run(HOSTSIM_CLOCK_HZ * 3);
+	Steps = TurnAndCollect(1, ENCODER_FAST_DETENT);
+	printf("  detent after a 3 s pause worth %d steps\n", Steps);
+	SCENARIO_CHECK(Steps == 1, "detent after a 3 s pause was worth %d steps", Steps);
+
+	//So do pauses of just over whole timer periods, even though the counts alone show only a few ticks as the timer
+	//wrapped once more since the last detent, which happened just before a wrap
+	static const uint8_t PausePeriods[] = {1, 2, 10};
+
+	for (uint8_t PauseIndex = 0; PauseIndex < sizeof(PausePeriods); PauseIndex++)
+	{
+		uint64_t Pause = ((PausePeriods[PauseIndex] * ENCODER_TIMER_PERIOD) + (DetentTicks * ENCODER_TIMER_TICK));
+
+		RunUntilEncoderTimer((uint16_t)(0 - (DetentTicks * 12) - 40));
+
+		for (uint8_t Detent = 0; Detent < 12; Detent++)
+		  TurnAndCollect(1, ENCODER_FAST_DETENT);
+
+		uint16_t LastDetent = HostSim_GetTimerCount(HOSTSIM_ADDRESS(TCNT3));
+
+		SCENARIO_CHECK(LastDetent >= (uint16_t)(0 - DetentTicks), "fast turn ended at timer count %u, not just before "
+		               "it wraps", LastDetent);
+
+		VirtualHost_Run(Pause);
+		Steps = TurnAndCollect(1, ENCODER_FAST_DETENT);
+		printf("  detent after a %.2f s pause across %u timer wraps worth %d steps\n", (double)Pause / HOSTSIM_CLOCK_HZ,
+		       (PausePeriods[PauseIndex] + 1), Steps);
+		SCENARIO_CHECK(Steps == 1, "detent after a %.2f s pause was worth %d steps", (double)Pause / HOSTSIM_CLOCK_HZ,
+		               Steps);
+	}
+
+	return true;
+}
+
+/** Scenario replaying a high rate quadrature edge trace into the encoder, with contact bounce and with states
+ *  skipped where both contacts change at once, checking that every detent is counted exactly once.
+ */
+static bool Scenario_EncoderReplay(void)
+{
+	static const uint8_t Sequence[] = {0x03, 0x02, 0x00, 0x01};
+	static const int16_t Runs[]     = {200, -150, 37, -87, 1, -1, 250, -3, 3, -120};
+
+	uint32_t Seed    = 1;
+	uint32_t Edges   = 0;
+	uint16_t Bounces = 0;
+	uint16_t Skips   = 0;
+	uint8_t  Phase   = 0;
+	uint8_t  State   = Sequence[0];
+	uint64_t Cycles  = 0;
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Without acceleration every detent is a single step, so steps counted are detents counted
+	uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_ENCODER, 2, 255, ENCODER_CURVE_NONE};
+
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	VirtualHost_RunFrames(SCENARIO_SETTLE_FRAMES);
+	TurnAndCollect(0, 0);
+
+	for (uint8_t Run = 0; Run < (sizeof(Runs) / sizeof(Runs[0])); Run++)
+	{
+		int8_t   Direction = (Runs[Run] < 0) ? -1 : 1;
+		uint16_t Detents   = (Runs[Run] < 0) ? -Runs[Run] : Runs[Run];
+		uint64_t Start     = HostSim_GetCycles();
+		int16_t  Steps     = 0;
+
+		for (uint16_t Detent = 0; Detent < Detents; Detent++)
+		{
+			//Up to one of the states between detents is skipped, both contacts changing at once, which the
+			//encoder must tolerate; the detent itself is always reached
+			Seed = ((Seed * 1103515245) + 12345);
+
+			uint8_t SkipQuarter = ((Seed >> 16) % 6);
+
+			for (uint8_t Quarter = 0; Quarter < sizeof(Sequence); Quarter++)
+			{
+				Phase = ((Phase + Direction) & (sizeof(Sequence) - 1));
+
+				if ((Quarter == SkipQuarter) && (Quarter < (sizeof(Sequence) - 1)))
+				{
+					Skips++;
+					continue;
+				}
+
+				//The contacts bounce back and forth a few times before they settle
+				Seed = ((Seed * 1103515245) + 12345);
+
+				for (uint8_t Bounce = ((Seed >> 16) % 4); Bounce > 0; Bounce--)
+				{
+					SimBoard_SetEncoder(Sequence[Phase]);
+					VirtualHost_Run(REPLAY_BOUNCE_CYCLES);
+					SimBoard_SetEncoder(State);
+					VirtualHost_Run(REPLAY_BOUNCE_CYCLES);
+
+					Bounces++;
+					Edges += (2 * __builtin_popcount(State ^ Sequence[Phase]));
+				}
+
+				Edges += __builtin_popcount(State ^ Sequence[Phase]);
+				State  = Sequence[Phase];
+
+				SimBoard_SetEncoder(State);
+				VirtualHost_Run(REPLAY_EDGE_CYCLES);
+			}
+		}
+
+		Cycles += (HostSim_GetCycles() - Start);
+
+		//The reports of a run queue up faster than they are polled, so they are collected until none are left
+		while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+		                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK)
+		{
+			Steps += (int8_t)Data[REPORT_IN_STEPS];
+		}
+
+		SCENARIO_CHECK(Steps == Runs[Run], "run %u of %d detents counted %d steps", Run, Runs[Run], Steps);
+	}
+
+	double Seconds = ((double)Cycles / HOSTSIM_CLOCK_HZ);
+
+	printf("  %lu edges in %.3f s, %.0f edges/s, with %u bounces and %u skipped states, all detents counted once\n",
+	       (unsigned long)Edges, Seconds, (Edges / Seconds), Bounces, Skips);
+
+	return true;
+}
+
+/** Scenario setting the configuration again and again while OUT and IN reports are flowing, with the request
+ *  arriving at a different point of the frame each time, then checking that reports still flow both ways.
+ */
+static bool Scenario_Reconfigure(void)
+{
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE];
+	uint16_t Length;
+	uint32_t Reports = 0;
+	uint8_t  EEPROM[HOSTSIM_EEPROM_SIZE];
+
+	if (!(Scenarios_Enumerate()))
+	  return false;
+
+	//Without acceleration the detents turned at the end are a step each, and the setting is undone at the end
+	memcpy(EEPROM, HostSim_GetEEPROM(), sizeof(EEPROM));
+
+	uint8_t Encoder[GENERIC_REPORT_SIZE] = {COMMAND_SET_ENCODER, 2, 255, ENCODER_CURVE_NONE};
+
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Encoder, sizeof(Encoder),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+
+	for (uint16_t Reconfigure = 0; Reconfigure < RECONFIGURE_COUNT; Reconfigure++)
+	{
+		uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_NUMBER, 1, (Reconfigure % 100)};
+
+		//An OUT report for the main loop to process, and an encoder step for it to report, in the same frame
+		VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command), 1);
+		VirtualHost_TurnEncoder(1, REPLAY_EDGE_CYCLES);
+		VirtualHost_Run((Reconfigure * RECONFIGURE_STEP_CYCLES) % VIRTUALHOST_FRAME_CYCLES);
+
+		SCENARIO_CHECK(Request(REQTYPE_STANDARD_OUT, REQ_SetConfiguration, 1, 0, 0, NULL, NULL) ==
+		               VIRTUALHOST_RESULT_OK, "SET_CONFIGURATION %u failed", Reconfigure);
+
+		if (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length, 2) ==
+		    VIRTUALHOST_RESULT_OK)
+		{
+			Reports++;
+		}
+	}
+
+	//Both report pipes still work once the configuration is left alone
+	while (VirtualHost_InterruptIn((GENERIC_IN_EPADDR & ENDPOINT_EPNUM_MASK), Data, &Length,
+	                               SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK);
+
+	uint8_t Command[GENERIC_REPORT_SIZE] = {COMMAND_SET_NUMBER, 1, 42};
+
+	SCENARIO_CHECK(VirtualHost_InterruptOut((GENERIC_OUT_EPADDR & ENDPOINT_EPNUM_MASK), Command, sizeof(Command),
+	                                        SCENARIO_SETTLE_FRAMES) == VIRTUALHOST_RESULT_OK, "OUT report failed");
+	SCENARIO_CHECK(VirtualHost_WaitForDisplay(42, SCENARIO_SETTLE_FRAMES), "display shows %d, not 42",
+	               SimBoard_GetDisplayNumber());
+
+	int16_t Steps = TurnAndCollect(3, ENCODER_SLOW_DETENT);
+
+	printf("  configuration set %u times while streaming, %lu reports read meanwhile\n", RECONFIGURE_COUNT,
+	       (unsigned long)Reports);
+	SCENARIO_CHECK(Steps == 3, "reports carried %d steps for 3 detents after reconfiguring", Steps);
+
+	memcpy(HostSim_GetEEPROM(), EEPROM, sizeof(EEPROM));
+
+	return true;
+}
+
+const Scenario_t Scenarios[] =
+	{
+		{.Name = "enumerate",  .Description = "Enumerate the device as a desktop host does", .Run = Scenario_Enumerate},
+		{.Name = "hid",        .Description = "HID class requests, reports and suspend",     .Run = Scenario_HID},
+		{.Name = "throughput", .Description = "Report throughput and simulation speed",      .Run = Scenario_Throughput},
+		{.Name = "control",    .Description = "Control request latency under main loop load", .Run = Scenario_Control},
+		{.Name = "latency",    .Description = "Display interrupt latency under USB bus events", .Run = Scenario_Latency},
+		{.Name = "commands",   .Description = "Every command type and malformed command streams", .Run = Scenario_Commands},
+		{.Name = "ladder-map", .Description = "Ladder level map upload, read back and render sweep", .Run = Scenario_LadderMap},
+		{.Name = "settings-torn", .Description = "Power cut at every byte of a settings save", .Run = Scenario_SettingsTorn},
+		{.Name = "suspend",    .Description = "Low power state while suspended and encoder remote wakeup", .Run = Scenario_Suspend},
+		{.Name = "buttons",    .Description = "Button clicks held back while the input queue is full, and gesture order", .Run = Scenario_Buttons},
+		{.Name = "encoder-replay", .Description = "High rate encoder edges with bounce and skipped states", .Run = Scenario_EncoderReplay},
+		{.Name = "encoder-timing", .Description = "Encoder acceleration over timing traces and long pauses", .Run = Scenario_EncoderTiming},
+		{.Name = "reconfigure", .Description = "Configuration set again and again while reports flow", .Run = Scenario_Reconfigure},
+		#if defined(PROFILE_ENABLED)
+		{.Name = "profile",    .Description = "Profiling of the USB controller interrupts", .Run = Scenario_Profile},
+		#endif
+		{.Name = NULL},
+	};
@@ -0,0 +1,76 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Scenarios.c.
+ */
+
+#ifndef _SCENARIOS_H_
+#define _SCENARIOS_H_
+
+	/* Includes: */
+		#include "VirtualHost.h"
+
+	/* Macros: */
+		/** Address the scenarios assign to the device during enumeration. */
+		#define SCENARIO_DEVICE_ADDRESS   5
+
+		/** Checks a condition within a scenario, reporting it and failing the scenario if it does not hold. */
+		#define SCENARIO_CHECK(Condition, ...)   do { if (!(Condition)) { printf("  FAIL %s:%d: ", __FILE__, __LINE__); \
+		                                                                 printf(__VA_ARGS__); printf("\n");           \
+		                                                                 return false; } } while (0)
+
+	/* Type Defines: */
+		/** Type define for a scenario, returning whether it passed. */
+		typedef bool (*Scenario_Function_t)(void);
+
+		/** Type define for an entry of the scenario table. */
+		typedef struct
+		{
+			const char*         Name; /**< Name the scenario is selected by on the command line. */
+			const char*         Description; /**< One line description of the scenario. */
+			Scenario_Function_t Run; /**< Function running the scenario. */
+		} Scenario_t;
+
+	/* External Variables: */
+		/** Table of the built in scenarios, terminated by an entry with a \c NULL name. */
+		extern const Scenario_t Scenarios[];
+
+	/* Function Prototypes: */
+		/** Powers the device on and enumerates it the way a desktop host does, leaving it configured at
+		 *  \ref SCENARIO_DEVICE_ADDRESS.
+		 *
+		 *  \return Boolean \c true if the device enumerated, \c false otherwise.
+		 */
+		bool Scenarios_Enumerate(void);
+
+		/** Converts a ladder mask, bit 0 for LED 1 through bit 3 for LED 4, to the board LEDs showing it.
+		 *
+		 *  \param[in] LadderMask  Ladder mask, as sent in \c COMMAND_SET_LEDS.
+		 *
+		 *  \return Mask of the board LEDs lit for the ladder mask.
+		 */
+		uint8_t Scenarios_LadderLEDs(const uint8_t LadderMask);
+
+#endif
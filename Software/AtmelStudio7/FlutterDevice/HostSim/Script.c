@@ -0,0 +1,264 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Line based scripts for the virtual host, so that new request sequences can be tried without rebuilding the
+ *  simulator. Each command runs to completion before the next line is read, and the last transfer is kept for
+ *  the \c expect commands that follow it.
+ */
+
+#include "Script.h"
+#include "Scenarios.h"
+
+/* Local Variables: */
+/** Data of the last transfer. */
+static uint8_t  LastData[SIMUSB_MAX_BANK_SIZE];
+
+/** Length of the data of the last transfer. */
+static uint16_t LastLength;
+
+/** Result of the last transfer, a value from \ref VirtualHost_Results_t. */
+static uint8_t  LastResult;
+
+/** Names of the transfer results, indexed by \ref VirtualHost_Results_t. */
+static const char* const ResultNames[] = {"OK", "STALL", "NAK", "TIMEOUT"};
+
+/** Parses a number argument, returning whether it was one. */
+static bool ParseNumber(const char* const Argument, long* const Value)
+{
+	char* End;
+
+	*Value = strtol(Argument, &End, 0);
+	return ((*End == '\0') && (End != Argument));
+}
+
+/** Parses the arguments from the given index on as data bytes, returning how many there were or -1 on error. */
+static int16_t ParseBytes(char** const Arguments, const uint16_t Count, uint8_t* const Data)
+{
+	for (uint16_t Index = 0; Index < Count; Index++)
+	{
+		long Value;
+
+		if (!(ParseNumber(Arguments[Index], &Value)) || (Value < 0) || (Value > 0xFF) ||
+		    (Index >= SIMUSB_MAX_BANK_SIZE))
+		{
+			return -1;
+		}
+
+		Data[Index] = (uint8_t)Value;
+	}
+
+	return Count;
+}
+
+/** Prints the data of the last transfer. */
+static void PrintLastTransfer(void)
+{
+	printf("  %s", ResultNames[LastResult]);
+
+	for (uint16_t Index = 0; Index < LastLength; Index++)
+	  printf(" %02X", LastData[Index]);
+
+	printf("\n");
+}
+
+/** Runs a single parsed command, returning \c false with a message in \c Error if it failed. */
+static bool RunCommand(char** const Arguments, const uint16_t Count, const char** const Error)
+{
+	const char* Command = Arguments[0];
+	long        Values[5];
+	uint8_t     Data[SIMUSB_MAX_BANK_SIZE];
+	int16_t     Length;
+
+	for (uint8_t Index = 0; (Index < 5) && ((Index + 1) < Count); Index++)
+	{
+		if (!(ParseNumber(Arguments[Index + 1], &Values[Index])))
+		  Values[Index] = -1;
+	}
+
+	#define REQUIRE(Condition, Message)   do { if (!(Condition)) { *Error = Message; return false; } } while (0)
+
+	if (!(strcmp(Command, "power")))
+	{
+		REQUIRE(VirtualHost_PowerOn(), "device did not attach");
+	}
+	else if (!(strcmp(Command, "enumerate")))
+	{
+		REQUIRE(Scenarios_Enumerate(), "enumeration failed");
+	}
+	else if (!(strcmp(Command, "reset")))
+	{
+		VirtualHost_BusReset();
+	}
+	else if (!(strcmp(Command, "suspend")))
+	{
+		VirtualHost_Suspend();
+	}
+	else if (!(strcmp(Command, "resume")))
+	{
+		VirtualHost_Resume();
+	}
+	else if (!(strcmp(Command, "frames")))
+	{
+		REQUIRE((Count == 2) && (Values[0] >= 0), "usage: frames N");
+		VirtualHost_RunFrames(Values[0]);
+	}
+	else if (!(strcmp(Command, "address")))
+	{
+		REQUIRE((Count == 2) && (Values[0] >= 0) && (Values[0] < 128), "usage: address N");
+		LastResult = VirtualHost_SetAddress(Values[0]);
+		LastLength = 0;
+	}
+	else if (!(strcmp(Command, "control")))
+	{
+		REQUIRE((Count >= 6) && (Values[0] >= 0) && (Values[1] >= 0) && (Values[2] >= 0) && (Values[3] >= 0) &&
+		        (Values[4] >= 0) && (Values[4] <= SIMUSB_MAX_BANK_SIZE),
+		        "usage: control bmRequestType bRequest wValue wIndex wLength [data...]");
+
+		VirtualHost_Request_t Request =
+			{
+				.bmRequestType = Values[0],
+				.bRequest      = Values[1],
+				.wValue        = Values[2],
+				.wIndex        = Values[3],
+				.wLength       = Values[4],
+			};
+
+		memset(LastData, 0, sizeof(LastData));
+
+		if (!(Request.bmRequestType & 0x80))
+		{
+			REQUIRE(ParseBytes(&Arguments[6], (Count - 6), LastData) >= 0, "bad data byte");
+		}
+
+		LastResult = VirtualHost_Control(&Request, LastData, &LastLength);
+		PrintLastTransfer();
+	}
+	else if (!(strcmp(Command, "out")))
+	{
+		REQUIRE((Count >= 2) && (Values[0] > 0), "usage: out EP data...");
+		REQUIRE((Length = ParseBytes(&Arguments[2], (Count - 2), Data)) >= 0, "bad data byte");
+
+		LastResult = VirtualHost_InterruptOut(Values[0], Data, Length, 500);
+		LastLength = 0;
+		PrintLastTransfer();
+	}
+	else if (!(strcmp(Command, "in")))
+	{
+		REQUIRE((Count >= 2) && (Count <= 3) && (Values[0] > 0), "usage: in EP [frames]");
+
+		LastResult = VirtualHost_InterruptIn(Values[0], LastData, &LastLength, ((Count == 3) ? Values[1] : 500));
+		PrintLastTransfer();
+	}
+	else if (!(strcmp(Command, "encoder")))
+	{
+		REQUIRE((Count >= 2) && (Count <= 3), "usage: encoder DETENTS [ms]");
+
+		long Detents = strtol(Arguments[1], NULL, 0);
+		long Time    = ((Count == 3) ? Values[1] : 150);
+
+		VirtualHost_TurnEncoder(Detents, (HOSTSIM_CLOCK_HZ / 1000) * Time);
+	}
+	else if (!(strcmp(Command, "buttons")))
+	{
+		REQUIRE((Count == 2) && (Values[0] >= 0), "usage: buttons MASK");
+		SimBoard_SetButtons(Values[0]);
+	}
+	else if (!(strcmp(Command, "expect")))
+	{
+		REQUIRE(LastResult == VIRTUALHOST_RESULT_OK, "last transfer failed");
+		REQUIRE((Length = ParseBytes(&Arguments[1], (Count - 1), Data)) >= 0, "bad data byte");
+		REQUIRE((LastLength >= Length) && !(memcmp(LastData, Data, Length)), "data does not match");
+	}
+	else if (!(strcmp(Command, "expect-stall")))
+	{
+		REQUIRE(LastResult == VIRTUALHOST_RESULT_STALL, "last transfer was not stalled");
+	}
+	else if (!(strcmp(Command, "expect-nak")))
+	{
+		REQUIRE(LastResult == VIRTUALHOST_RESULT_NAK, "last transfer did not time out on NAKs");
+	}
+	else if (!(strcmp(Command, "expect-display")))
+	{
+		REQUIRE((Count == 2) && (Values[0] >= 0), "usage: expect-display N");
+		REQUIRE(VirtualHost_WaitForDisplay(Values[0], 50), "display does not show the number");
+	}
+	else if (!(strcmp(Command, "expect-leds")))
+	{
+		REQUIRE((Count == 2) && (Values[0] >= 0) && (Values[0] <= 0x0F), "usage: expect-leds MASK");
+
+		for (uint8_t Frame = 0; (Frame < 50) && (SimBoard_GetLEDs() != Scenarios_LadderLEDs(Values[0])); Frame++)
+		  VirtualHost_RunFrames(1);
+
+		REQUIRE(SimBoard_GetLEDs() == Scenarios_LadderLEDs(Values[0]), "LEDs do not show the ladder mask");
+	}
+	else
+	{
+		*Error = "unknown command";
+		return false;
+	}
+
+	#undef REQUIRE
+
+	return true;
+}
+
+bool Script_Run(FILE* const Stream, const char* const Name)
+{
+	char     Line[SCRIPT_MAX_LINE];
+	uint32_t LineNumber = 0;
+
+	LastResult = VIRTUALHOST_RESULT_OK;
+	LastLength = 0;
+
+	while (fgets(Line, sizeof(Line), Stream) != NULL)
+	{
+		char*       Arguments[SCRIPT_MAX_ARGS];
+		uint16_t    Count = 0;
+		const char* Error = NULL;
+		char*       Comment;
+
+		LineNumber++;
+
+		if ((Comment = strchr(Line, '#')) != NULL)
+		  *Comment = '\0';
+
+		for (char* Token = strtok(Line, " \t\r\n"); (Token != NULL) && (Count < SCRIPT_MAX_ARGS);
+		     Token = strtok(NULL, " \t\r\n"))
+		{
+			Arguments[Count++] = Token;
+		}
+
+		if (!(Count))
+		  continue;
+
+		if (!(RunCommand(Arguments, Count, &Error)))
+		{
+			printf("%s:%lu: %s: %s\n", Name, (unsigned long)LineNumber, Arguments[0], Error);
+			return false;
+		}
+	}
+
+	return true;
+}
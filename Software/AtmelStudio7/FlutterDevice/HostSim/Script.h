@@ -0,0 +1,64 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Script.c.
+ */
+
+#ifndef _SCRIPT_H_
+#define _SCRIPT_H_
+
+	/* Includes: */
+		#include "VirtualHost.h"
+
+	/* Macros: */
+		/** Longest line accepted in a script. */
+		#define SCRIPT_MAX_LINE     512
+
+		/** Most arguments accepted on a script line. */
+		#define SCRIPT_MAX_ARGS     (SCRIPT_MAX_LINE / 2)
+
+	/* Function Prototypes: */
+		/** Runs a virtual host script, one command per line:
+		 *
+		 *  - \c power and \c enumerate power the device on, the latter also enumerating it;
+		 *  - \c reset, \c suspend, \c resume and \c frames \c N drive the bus;
+		 *  - \c address \c N assigns an address with SET_ADDRESS;
+		 *  - \c control \c bmRequestType \c bRequest \c wValue \c wIndex \c wLength \c [data...] performs a control
+		 *    transfer, sending the data bytes given for a host to device request;
+		 *  - \c out \c EP \c data... and \c in \c EP \c [frames] move an interrupt report;
+		 *  - \c encoder \c DETENTS \c [ms] and \c buttons \c MASK drive the board inputs;
+		 *  - \c expect \c data..., \c expect-stall, \c expect-nak, \c expect-display \c N and \c expect-leds \c MASK
+		 *    check the last transfer, the display and the LED ladder, failing the script if they do not match.
+		 *
+		 *  Numbers follow the C conventions, so \c 0x prefixes hexadecimal values. Text from a \c # is a comment.
+		 *
+		 *  \param[in] Stream  Script to run.
+		 *  \param[in] Name    Name of the script, used in error messages.
+		 *
+		 *  \return Boolean \c true if every command of the script succeeded, \c false otherwise.
+		 */
+		bool Script_Run(FILE* const Stream, const char* const Name);
+
+#endif
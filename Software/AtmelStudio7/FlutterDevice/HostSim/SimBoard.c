@@ -0,0 +1,128 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Simulated Swallowtail board. The encoder and buttons close contacts to ground against the pull-ups of port B,
+ *  and the display is observed after every interrupt, each digit showing the port F image present while its
+ *  active low enable on port B is driven.
+ */
+
+#include "SimBoard.h"
+
+/** Port B pin of the encoder \c CLK contact. */
+#define ENCODER_CLK_PIN        PB2
+
+/** Port B pins of the encoder contacts. */
+#define ENCODER_PINS           ((1 << PB2) | (1 << PB3))
+
+/** Port B pins of the buttons. */
+#define BUTTON_PINS            ((1 << PB0) | (1 << PB1))
+
+/** Port B enables of the ten's and one's place digits, active low. */
+#define DISPLAY_ENABLE_TENS    (1 << PB4)
+#define DISPLAY_ENABLE_ONES    (1 << PB5)
+
+/** Port D pins driving the LEDs. */
+#define LED_PINS               ((1 << PD0) | (1 << PD1) | (1 << PD2) | (1 << PD3))
+
+static uint8_t EncoderState;
+static uint8_t ButtonsPressed;
+static uint8_t DigitTens;
+static uint8_t DigitOnes;
+
+
+/** Drives the port B input pins from the state of the encoder and buttons, raising the pin change interrupt for
+ *  every enabled pin that changed.
+ */
+static void UpdatePortB(void)
+{
+	uint8_t Previous = PINB;
+	uint8_t Pins     = ((Previous & ~(ENCODER_PINS | BUTTON_PINS)) |
+	                    ((EncoderState << ENCODER_CLK_PIN) & ENCODER_PINS) |
+	                    (~ButtonsPressed & BUTTON_PINS));
+
+	HostSim_Reconcile();
+
+	PINB = Pins;
+
+	if ((Previous ^ Pins) & PCMSK0)
+	  HostSim_SetBits(HOSTSIM_ADDRESS(PCIFR), (1 << PCIF0));
+}
+
+void SimBoard_Reset(void)
+{
+	EncoderState   = SIMBOARD_ENCODER_DETENT;
+	ButtonsPressed = 0;
+	DigitTens      = SIMBOARD_DIGIT_BLANK;
+	DigitOnes      = SIMBOARD_DIGIT_BLANK;
+
+	//Every pin of port B is pulled high by the board or the pull-ups
+	PINB = 0xFF;
+}
+
+void SimBoard_InterruptServiced(void)
+{
+	if (!(PORTB & DISPLAY_ENABLE_TENS))
+	  DigitTens = (PORTF >> 4);
+
+	if (!(PORTB & DISPLAY_ENABLE_ONES))
+	  DigitOnes = (PORTF >> 4);
+}
+
+void SimBoard_SetEncoder(const uint8_t State)
+{
+	EncoderState = (State & 0x03);
+	UpdatePortB();
+}
+
+uint8_t SimBoard_GetEncoder(void)
+{
+	return EncoderState;
+}
+
+void SimBoard_SetButtons(const uint8_t Pressed)
+{
+	ButtonsPressed = (((Pressed & SIMBOARD_BUTTON1) ? (1 << PB0) : 0) |
+	                  ((Pressed & SIMBOARD_BUTTON2) ? (1 << PB1) : 0));
+	UpdatePortB();
+}
+
+uint8_t SimBoard_GetLEDs(void)
+{
+	return (PORTD & DDRD & LED_PINS);
+}
+
+void SimBoard_GetDisplay(uint8_t* const Tens, uint8_t* const Ones)
+{
+	*Tens = DigitTens;
+	*Ones = DigitOnes;
+}
+
+int16_t SimBoard_GetDisplayNumber(void)
+{
+	if ((DigitTens > 9) || (DigitOnes > 9))
+	  return -1;
+
+	return ((DigitTens * 10) + DigitOnes);
+}
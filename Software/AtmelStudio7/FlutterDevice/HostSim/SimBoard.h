@@ -0,0 +1,80 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for SimBoard.c, the simulated Swallowtail board around the ATmega32U4: the rotary encoder and
+ *  buttons driving port B, the LEDs on port D and the two digit seven segment display multiplexed from ports B
+ *  and F.
+ */
+
+#ifndef _SIMBOARD_H_
+#define _SIMBOARD_H_
+
+	/* Includes: */
+		#include "HostSim.h"
+
+	/* Macros: */
+		/** Quadrature state of the encoder contacts while the shaft rests in a detent, both open. */
+		#define SIMBOARD_ENCODER_DETENT    0x03
+
+		/** Mask of the first button in the masks of \ref SimBoard_SetButtons(). */
+		#define SIMBOARD_BUTTON1           (1 << 0)
+
+		/** Mask of the second button in the masks of \ref SimBoard_SetButtons(). */
+		#define SIMBOARD_BUTTON2           (1 << 1)
+
+		/** Value of a digit of \ref SimBoard_GetDisplay() which has not been shown since the last reset. */
+		#define SIMBOARD_DIGIT_BLANK       0xFF
+
+	/* Function Prototypes: */
+		/** Sets the quadrature state of the encoder contacts, raising the pin change interrupt if they changed.
+		 *
+		 *  \param[in] State  Contact state, with the \c CLK contact in bit 0 and the \c DT contact in bit 1, a set
+		 *                    bit being an open contact.
+		 */
+		void SimBoard_SetEncoder(const uint8_t State);
+
+		/** Returns the quadrature state of the encoder contacts last set. */
+		uint8_t SimBoard_GetEncoder(void);
+
+		/** Sets which buttons are held down.
+		 *
+		 *  \param[in] Pressed  Mask of \c SIMBOARD_BUTTON* masks of the buttons held down.
+		 */
+		void SimBoard_SetButtons(const uint8_t Pressed);
+
+		/** Returns the LEDs currently lit, as a mask of the port D pins driving them. */
+		uint8_t SimBoard_GetLEDs(void);
+
+		/** Returns the digits last shown by the display multiplexer.
+		 *
+		 *  \param[out] Tens  Digit shown on the ten's place, or \ref SIMBOARD_DIGIT_BLANK.
+		 *  \param[out] Ones  Digit shown on the one's place, or \ref SIMBOARD_DIGIT_BLANK.
+		 */
+		void SimBoard_GetDisplay(uint8_t* const Tens, uint8_t* const Ones);
+
+		/** Returns the decimal number on the display, or -1 if either digit is blank or not a decimal digit. */
+		int16_t SimBoard_GetDisplayNumber(void);
+
+#endif
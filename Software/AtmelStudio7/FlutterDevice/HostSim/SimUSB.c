@@ -0,0 +1,851 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Simulated USB device controller of the ATmega32U4, as seen through its registers by the firmware and through
+ *  bus transactions by the virtual host.
+ *
+ *  Each endpoint has its own copy of the registers banked by \c UENUM and up to two FIFO banks, used as a ring
+ *  between the firmware and the bus. The control endpoint instead has one bank for each direction, the OUT bank
+ *  also receiving SETUP packets. Data toggles and bus errors are not modelled, as the virtual host never loses a
+ *  packet.
+ */
+
+#include "SimUSB.h"
+
+#include <string.h>
+
+/** Offset of a banked endpoint register within the register copies of an endpoint. */
+#define EP_OFFSET(Register)           (HOSTSIM_ADDRESS(Register) - 0xE8)
+
+/** Banked register of an endpoint. */
+#define EP_REGISTER(Endpoint, Register) ((Endpoint)->Registers[EP_OFFSET(Register)])
+
+/** Number of register copies of each endpoint, spanning \c UEINTX to \c UEIENX. */
+#define EP_REGISTER_SPAN              9
+
+/** Index of the control endpoint bank holding data to send to the host. */
+#define CONTROL_BANK_IN               0
+
+/** Index of the control endpoint bank holding SETUP and OUT data received from the host. */
+#define CONTROL_BANK_OUT              1
+
+/** Interrupt flags of \c UEINTX which raise the endpoint interrupt when enabled in \c UEIENX. */
+#define EP_INTERRUPT_FLAGS            ((1 << TXINI) | (1 << STALLEDI) | (1 << RXOUTI) | (1 << RXSTPI) | \
+                                       (1 << NAKOUTI) | (1 << NAKINI))
+
+/** Interrupt flags of \c UDINT which raise the general interrupt when enabled in \c UDIEN. */
+#define DEVICE_INTERRUPT_FLAGS        ((1 << SUSPI) | (1 << SOFI) | (1 << EORSTI) | (1 << WAKEUPI) | \
+                                       (1 << EORSMI) | (1 << UPRSMI))
+
+/** FIFO bank of an endpoint. */
+typedef struct
+{
+	uint8_t  Data[SIMUSB_MAX_BANK_SIZE]; /**< Packet held by the bank. */
+	uint16_t Length; /**< Number of bytes held by the bank. */
+	uint16_t Position; /**< Number of bytes the firmware has read out of the bank. */
+} Bank_t;
+
+/** State of an endpoint. */
+typedef struct
+{
+	volatile uint8_t Registers[EP_REGISTER_SPAN]; /**< Banked registers as accessed by the firmware. */
+	uint8_t          Published[EP_REGISTER_SPAN]; /**< Banked registers as last seen by the controller. */
+	Bank_t           Banks[2]; /**< FIFO banks of the endpoint. */
+	uint8_t          BankCount; /**< Number of banks allocated. */
+	uint16_t         Size; /**< Size of each bank, in bytes. */
+	uint8_t          CPUBank; /**< Bank currently accessed by the firmware. */
+	uint8_t          BusyBanks; /**< Banks holding a packet, waiting for the host (IN) or the firmware (OUT). */
+	bool             Allocated; /**< Whether the endpoint has memory allocated and a valid configuration. */
+	bool             INCommitted; /**< Whether the IN bank of the control endpoint has been handed to the bus. */
+} Endpoint_t;
+
+SimUSB_Stats_t SimUSB_Stats;
+
+/** Endpoints of the controller, with an extra unused one selected by out of range values of \c UENUM. */
+static Endpoint_t  Endpoints[SIMUSB_ENDPOINTS + 1];
+static Endpoint_t* LastEndpoint;
+static uint8_t     Dummy;
+static bool        VBUSPresent;
+static bool        Suspended;
+static bool        RemoteWakeupSignalled;
+static uint16_t    FrameNumber;
+
+
+/** Returns the endpoint currently selected by \c UENUM. */
+static Endpoint_t* SelectedEndpoint(void)
+{
+	uint8_t Number = (UENUM & 0x07);
+
+	return &Endpoints[(Number < SIMUSB_ENDPOINTS) ? Number : SIMUSB_ENDPOINTS];
+}
+
+/** Sets a banked register of an endpoint from the side of the controller. */
+static void SetEndpointRegister(Endpoint_t* const Endpoint, const uint8_t Offset, const uint8_t Value)
+{
+	Endpoint->Registers[Offset] = Value;
+	Endpoint->Published[Offset] = Value;
+}
+
+/** Sets interrupt flags of an endpoint from the side of the controller. */
+static void SetEndpointFlags(Endpoint_t* const Endpoint, const uint8_t Mask)
+{
+	SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), (EP_REGISTER(Endpoint, UEINTX) | Mask));
+}
+
+/** Returns whether an endpoint is a control endpoint. */
+static inline bool IsControl(const Endpoint_t* const Endpoint)
+{
+	return !(EP_REGISTER(Endpoint, UECFG0X) & ((1 << EPTYPE1) | (1 << EPTYPE0)));
+}
+
+/** Returns whether an endpoint is an IN endpoint. */
+static inline bool IsIN(const Endpoint_t* const Endpoint)
+{
+	return (EP_REGISTER(Endpoint, UECFG0X) & (1 << EPDIR));
+}
+
+/** Returns whether an endpoint is enabled, configured and so answering transactions. */
+static inline bool IsActive(const Endpoint_t* const Endpoint)
+{
+	return (Endpoint->Allocated && (EP_REGISTER(Endpoint, UECONX) & (1 << EPEN)));
+}
+
+/** Returns whether the firmware is reading the OUT bank of the control endpoint rather than filling its IN bank. */
+static inline bool IsControlRead(const Endpoint_t* const Endpoint)
+{
+	return (EP_REGISTER(Endpoint, UEINTX) & ((1 << RXSTPI) | (1 << RXOUTI)));
+}
+
+/** Empties all banks of an endpoint. */
+static void FlushBanks(Endpoint_t* const Endpoint)
+{
+	for (uint8_t Index = 0; Index < 2; Index++)
+	{
+		Endpoint->Banks[Index].Length   = 0;
+		Endpoint->Banks[Index].Position = 0;
+	}
+
+	Endpoint->CPUBank     = 0;
+	Endpoint->BusyBanks   = 0;
+	Endpoint->INCommitted = false;
+}
+
+/** Updates the status bits of an endpoint which follow from the state of its banks. */
+static void Refresh(Endpoint_t* const Endpoint)
+{
+	uint8_t Flags  = (EP_REGISTER(Endpoint, UEINTX) & ~((1 << RWAL) | (1 << FIFOCON)));
+	uint8_t Status = (EP_REGISTER(Endpoint, UESTA0X) & ~((1 << CFGOK) | (1 << NBUSYBK1) | (1 << NBUSYBK0)));
+
+	if (!(Endpoint->Allocated))
+	{
+		Flags = 0;
+	}
+	else if (IsControl(Endpoint))
+	{
+		const Bank_t* OUTBank = &Endpoint->Banks[CONTROL_BANK_OUT];
+		const Bank_t* INBank  = &Endpoint->Banks[CONTROL_BANK_IN];
+
+		if (IsControlRead(Endpoint))
+		{
+			if (OUTBank->Position < OUTBank->Length)
+			  Flags |= (1 << RWAL);
+		}
+		else if (!(Endpoint->INCommitted) && (INBank->Length < Endpoint->Size))
+		{
+			Flags |= (1 << RWAL);
+		}
+
+		Status |= (1 << CFGOK);
+	}
+	else
+	{
+		const Bank_t* Bank = &Endpoint->Banks[Endpoint->CPUBank];
+
+		if (IsIN(Endpoint))
+		{
+			if (Endpoint->BusyBanks < Endpoint->BankCount)
+			{
+				Flags |= (1 << FIFOCON);
+
+				if (Bank->Length < Endpoint->Size)
+				  Flags |= (1 << RWAL);
+			}
+		}
+		else if (Endpoint->BusyBanks)
+		{
+			Flags |= (1 << FIFOCON);
+
+			if (Bank->Position < Bank->Length)
+			  Flags |= (1 << RWAL);
+		}
+
+		Status |= ((1 << CFGOK) | (Endpoint->BusyBanks << NBUSYBK0));
+	}
+
+	SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), Flags);
+	SetEndpointRegister(Endpoint, EP_OFFSET(UESTA0X), Status);
+	SetEndpointRegister(Endpoint, EP_OFFSET(UESTA1X), ((Endpoint->CPUBank << CURRBK0) |
+	                                                   (IsControlRead(Endpoint) ? 0 : (1 << CTRLDIR))));
+}
+
+/** Returns the total size of the endpoint memory allocated to the endpoints other than the given one. */
+static uint16_t AllocatedMemory(const Endpoint_t* const Except)
+{
+	uint16_t Total = 0;
+
+	for (uint8_t Number = 0; Number < SIMUSB_ENDPOINTS; Number++)
+	{
+		const Endpoint_t* Endpoint = &Endpoints[Number];
+
+		if ((Endpoint != Except) && Endpoint->Allocated)
+		  Total += (Endpoint->Size * Endpoint->BankCount);
+	}
+
+	return Total;
+}
+
+/** Allocates the memory of an endpoint according to its configuration, which succeeds if the configuration is
+ *  valid for the endpoint and enough memory is left.
+ */
+static void Allocate(Endpoint_t* const Endpoint)
+{
+	uint8_t Config    = EP_REGISTER(Endpoint, UECFG1X);
+	uint8_t SizeCode  = ((Config >> EPSIZE0) & 0x07);
+	uint8_t BankCode  = ((Config >> EPBK0) & 0x03);
+	uint8_t Number    = (uint8_t)(Endpoint - Endpoints);
+	uint16_t MaxSize  = (Number == 1) ? 256 : 64;
+
+	Endpoint->Size      = (8 << SizeCode);
+	Endpoint->BankCount = (BankCode ? 2 : 1);
+	Endpoint->Allocated = ((SizeCode <= 5) && (BankCode <= 1) && (Endpoint->Size <= MaxSize) &&
+	                       (Number < SIMUSB_ENDPOINTS) && !(IsControl(Endpoint) && (BankCode)) &&
+	                       ((AllocatedMemory(Endpoint) + (Endpoint->Size * Endpoint->BankCount)) <= SIMUSB_DPRAM_SIZE));
+
+	FlushBanks(Endpoint);
+	SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), 0);
+
+	if (Endpoint->Allocated && (IsControl(Endpoint) || IsIN(Endpoint)))
+	  SetEndpointFlags(Endpoint, (1 << TXINI));
+
+	Refresh(Endpoint);
+}
+
+/** Handles a write of the firmware to \c UEINTX, in which writing a zero clears a flag. Clearing \c FIFOCON hands
+ *  the current bank over to the bus (IN) or frees it (OUT), as does clearing \c TXINI or \c RXOUTI on the control
+ *  endpoint.
+ */
+static void UEINTX_Written(Endpoint_t* const Endpoint, const uint8_t Previous, const uint8_t Written)
+{
+	uint8_t Cleared = (Previous & ~Written & ~(1 << RWAL));
+
+	SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), (Previous & ~Cleared));
+
+	if (!(Endpoint->Allocated))
+	  return;
+
+	if (IsControl(Endpoint))
+	{
+		if (Cleared & ((1 << RXSTPI) | (1 << RXOUTI)))
+		{
+			Endpoint->Banks[CONTROL_BANK_OUT].Length   = 0;
+			Endpoint->Banks[CONTROL_BANK_OUT].Position = 0;
+		}
+
+		if ((Cleared & (1 << TXINI)) && !(Endpoint->INCommitted))
+		  Endpoint->INCommitted = true;
+	}
+	else if (Cleared & (1 << FIFOCON))
+	{
+		if (IsIN(Endpoint))
+		{
+			if (Endpoint->BusyBanks < Endpoint->BankCount)
+			{
+				Endpoint->BusyBanks++;
+				Endpoint->CPUBank = ((Endpoint->CPUBank + 1) % Endpoint->BankCount);
+
+				if (Endpoint->BusyBanks < Endpoint->BankCount)
+				{
+					Endpoint->Banks[Endpoint->CPUBank].Length = 0;
+					SetEndpointFlags(Endpoint, (1 << TXINI));
+				}
+			}
+		}
+		else if (Endpoint->BusyBanks)
+		{
+			Endpoint->Banks[Endpoint->CPUBank].Length   = 0;
+			Endpoint->Banks[Endpoint->CPUBank].Position = 0;
+			Endpoint->CPUBank = ((Endpoint->CPUBank + 1) % Endpoint->BankCount);
+			Endpoint->BusyBanks--;
+
+			if (Endpoint->BusyBanks)
+			  SetEndpointFlags(Endpoint, (1 << RXOUTI));
+		}
+	}
+
+	Refresh(Endpoint);
+}
+
+/** Handles a write of the firmware to \c UECONX. A STALL request is only withdrawn through \c STALLRQC, which like
+ *  \c RSTDT clears itself.
+ */
+static void UECONX_Written(Endpoint_t* const Endpoint, const uint8_t Previous, const uint8_t Written)
+{
+	uint8_t Value = ((Written & ~((1 << STALLRQC) | (1 << RSTDT))) | (Previous & (1 << STALLRQ)));
+
+	if (Written & (1 << STALLRQC))
+	  Value &= ~(1 << STALLRQ);
+
+	SetEndpointRegister(Endpoint, EP_OFFSET(UECONX), Value);
+
+	if ((Previous & (1 << EPEN)) && !(Value & (1 << EPEN)))
+	{
+		FlushBanks(Endpoint);
+		Refresh(Endpoint);
+	}
+}
+
+/** Handles a write of the firmware to \c UECFG1X, allocating or freeing the endpoint memory with \c ALLOC. */
+static void UECFG1X_Written(Endpoint_t* const Endpoint, const uint8_t Previous, const uint8_t Written)
+{
+	if ((Written & (1 << ALLOC)) && !(Previous & (1 << ALLOC)))
+	{
+		Allocate(Endpoint);
+	}
+	else if (!(Written & (1 << ALLOC)) && (Previous & (1 << ALLOC)))
+	{
+		Endpoint->Allocated = false;
+		FlushBanks(Endpoint);
+		Refresh(Endpoint);
+	}
+}
+
+void SimUSB_Reconcile(void)
+{
+	Endpoint_t* Endpoint = LastEndpoint;
+
+	if (Endpoint == NULL)
+	  return;
+
+	LastEndpoint = NULL;
+
+	for (uint8_t Offset = 0; Offset < EP_REGISTER_SPAN; Offset++)
+	{
+		uint8_t Previous = Endpoint->Published[Offset];
+		uint8_t Written  = Endpoint->Registers[Offset];
+
+		if (Written == Previous)
+		  continue;
+
+		Endpoint->Published[Offset] = Written;
+
+		if (Offset == EP_OFFSET(UEINTX))
+		  UEINTX_Written(Endpoint, Previous, Written);
+		else if (Offset == EP_OFFSET(UECONX))
+		  UECONX_Written(Endpoint, Previous, Written);
+		else if (Offset == EP_OFFSET(UECFG1X))
+		  UECFG1X_Written(Endpoint, Previous, Written);
+		else if ((Offset == EP_OFFSET(UESTA0X)) || (Offset == EP_OFFSET(UESTA1X)))
+		  SetEndpointRegister(Endpoint, Offset, Previous);
+	}
+}
+
+volatile uint8_t* SimUSB_BankedRegister(const uint8_t Address)
+{
+	if (Address == HOSTSIM_ADDRESS(UEINT))
+	{
+		uint8_t Pending = 0;
+
+		for (uint8_t Number = 0; Number < SIMUSB_ENDPOINTS; Number++)
+		{
+			const Endpoint_t* Endpoint = &Endpoints[Number];
+
+			if (EP_REGISTER(Endpoint, UEINTX) & EP_REGISTER(Endpoint, UEIENX) & EP_INTERRUPT_FLAGS)
+			  Pending |= (1 << Number);
+		}
+
+		HostSim_SetRegister(Address, Pending);
+		return NULL;
+	}
+
+	if ((Address != HOSTSIM_ADDRESS(UEINTX)) &&
+	    ((Address < HOSTSIM_ADDRESS(UECONX)) || (Address > HOSTSIM_ADDRESS(UEIENX))))
+	{
+		return NULL;
+	}
+
+	LastEndpoint = SelectedEndpoint();
+	return &LastEndpoint->Registers[Address - 0xE8];
+}
+
+volatile uint8_t* SimUSB_FIFO(void)
+{
+	Endpoint_t*       Endpoint = SelectedEndpoint();
+	Bank_t*           Bank     = NULL;
+	bool              Read;
+	volatile uint8_t* Byte     = &Dummy;
+
+	SimUSB_Stats.FIFOAccesses++;
+
+	if (!(Endpoint->Allocated))
+	  return Byte;
+
+	if (IsControl(Endpoint))
+	{
+		Read = IsControlRead(Endpoint);
+		Bank = &Endpoint->Banks[Read ? CONTROL_BANK_OUT : CONTROL_BANK_IN];
+
+		if (!(Read) && Endpoint->INCommitted)
+		  Bank = NULL;
+	}
+	else
+	{
+		Read = !(IsIN(Endpoint));
+
+		if (Read ? Endpoint->BusyBanks : (Endpoint->BusyBanks < Endpoint->BankCount))
+		  Bank = &Endpoint->Banks[Endpoint->CPUBank];
+	}
+
+	if (Bank != NULL)
+	{
+		if (Read && (Bank->Position < Bank->Length))
+		  Byte = &Bank->Data[Bank->Position++];
+		else if (!(Read) && (Bank->Length < Endpoint->Size))
+		  Byte = &Bank->Data[Bank->Length++];
+	}
+
+	Dummy = 0;
+	Refresh(Endpoint);
+
+	return Byte;
+}
+
+uint16_t SimUSB_ByteCount(void)
+{
+	Endpoint_t* Endpoint = SelectedEndpoint();
+	Bank_t*     Bank;
+
+	if (!(Endpoint->Allocated))
+	  return 0;
+
+	if (IsControl(Endpoint))
+	  Bank = &Endpoint->Banks[IsControlRead(Endpoint) ? CONTROL_BANK_OUT : CONTROL_BANK_IN];
+	else
+	  Bank = &Endpoint->Banks[Endpoint->CPUBank];
+
+	return (Bank->Length - Bank->Position);
+}
+
+/** Resets the controller state reached through the device registers, as done when the controller is disabled. */
+static void ResetDevice(void)
+{
+	memset(Endpoints, 0, sizeof(Endpoints));
+
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDCON), (1 << DETACH));
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDINT), 0);
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDIEN), 0);
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDADDR), 0);
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UENUM), 0);
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UEINT), 0);
+
+	LastEndpoint = NULL;
+	Suspended    = false;
+}
+
+/** Handles a write of the firmware to \c USBCON. Disabling the controller resets it, and enabling the VBUS pad
+ *  with the supply present is seen as a VBUS transition.
+ */
+static void USBCON_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	(void)Address;
+
+	if ((Previous & (1 << USBE)) && !(Written & (1 << USBE)))
+	  ResetDevice();
+
+	if (!(Previous & (1 << OTGPADE)) && (Written & (1 << OTGPADE)) && VBUSPresent)
+	  HostSim_SetBits(HOSTSIM_ADDRESS(USBINT), (1 << VBUSTI));
+}
+
+/** Handles a write of the firmware to an interrupt flag register in which writing a zero clears a flag. */
+static void ClearOnZero_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	HostSim_DataSpace[Address] = (Previous & Written);
+}
+
+/** Handles a write of the firmware to a read-only register, which is ignored. */
+static void ReadOnly_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	(void)Written;
+
+	HostSim_DataSpace[Address] = Previous;
+}
+
+/** Handles a write of the firmware to \c UDCON. A remote wakeup is signalled at once, after which \c RMWKUP clears
+ *  itself.
+ */
+static void UDCON_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	(void)Previous;
+
+	if (Written & (1 << RMWKUP))
+	{
+		if (Suspended && !(USBCON & (1 << FRZCLK)))
+		{
+			RemoteWakeupSignalled = true;
+			HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << UPRSMI));
+		}
+
+		HostSim_DataSpace[Address] = (Written & ~(1 << RMWKUP));
+	}
+}
+
+/** Handles a write of the firmware to \c UERST, resetting the FIFO of each endpoint whose bit is set. */
+static void UERST_Written(const uint8_t Address, const uint8_t Previous, const uint8_t Written)
+{
+	(void)Address;
+	(void)Previous;
+
+	for (uint8_t Number = 0; Number < SIMUSB_ENDPOINTS; Number++)
+	{
+		Endpoint_t* Endpoint = &Endpoints[Number];
+
+		if (!(Written & (1 << Number)) || !(Endpoint->Allocated))
+		  continue;
+
+		FlushBanks(Endpoint);
+		SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), (EP_REGISTER(Endpoint, UEINTX) & ~(1 << RXOUTI)));
+
+		if (IsIN(Endpoint))
+		  SetEndpointFlags(Endpoint, (1 << TXINI));
+
+		Refresh(Endpoint);
+	}
+}
+
+void SimUSB_Reset(void)
+{
+	memset(&SimUSB_Stats, 0, sizeof(SimUSB_Stats));
+
+	ResetDevice();
+
+	HostSim_SetRegister(HOSTSIM_ADDRESS(USBCON), (1 << FRZCLK));
+	HostSim_SetRegister(HOSTSIM_ADDRESS(USBSTA), ((1 << ID) | (VBUSPresent ? (1 << VBUS) : 0)));
+
+	RemoteWakeupSignalled = false;
+	FrameNumber           = 0;
+
+	HostSim_OnWrite(HOSTSIM_ADDRESS(USBCON),  USBCON_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(USBSTA),  ReadOnly_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(USBINT),  ClearOnZero_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UDCON),   UDCON_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UDINT),   ClearOnZero_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UDFNUML), ReadOnly_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UDFNUMH), ReadOnly_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UERST),   UERST_Written);
+	HostSim_OnWrite(HOSTSIM_ADDRESS(UEINT),   ReadOnly_Written);
+}
+
+bool SimUSB_GeneralInterruptPending(void)
+{
+	if (UDINT & UDIEN & DEVICE_INTERRUPT_FLAGS)
+	  return true;
+
+	return ((USBINT & (1 << VBUSTI)) && (USBCON & (1 << VBUSTE)));
+}
+
+bool SimUSB_EndpointInterruptPending(void)
+{
+	for (uint8_t Number = 0; Number < SIMUSB_ENDPOINTS; Number++)
+	{
+		const Endpoint_t* Endpoint = &Endpoints[Number];
+
+		if (EP_REGISTER(Endpoint, UEINTX) & EP_REGISTER(Endpoint, UEIENX) & EP_INTERRUPT_FLAGS)
+		  return true;
+	}
+
+	return false;
+}
+
+void SimUSB_SetVBUS(const bool Present)
+{
+	HostSim_Reconcile();
+
+	if (Present == VBUSPresent)
+	  return;
+
+	VBUSPresent = Present;
+
+	if (Present)
+	  HostSim_SetBits(HOSTSIM_ADDRESS(USBSTA), (1 << VBUS));
+	else
+	  HostSim_ClearBits(HOSTSIM_ADDRESS(USBSTA), (1 << VBUS));
+
+	if (USBCON & (1 << OTGPADE))
+	  HostSim_SetBits(HOSTSIM_ADDRESS(USBINT), (1 << VBUSTI));
+}
+
+bool SimUSB_IsAttached(void)
+{
+	HostSim_Reconcile();
+
+	return (VBUSPresent && (USBCON & (1 << USBE)) && !(UDCON & (1 << DETACH)));
+}
+
+/** Returns whether the device answers transactions sent to the given address. */
+static bool Responds(const uint8_t Address)
+{
+	if (!(SimUSB_IsAttached()) || Suspended)
+	  return false;
+
+	if ((USBCON & (1 << FRZCLK)) || !(PLLCSR & (1 << PLOCK)))
+	  return false;
+
+	if (UDADDR & (1 << ADDEN))
+	  return (Address == (UDADDR & 0x7F));
+	else
+	  return (Address == 0);
+}
+
+/** Handles activity on the bus, which sets WAKEUPI even with the controller clock frozen. The controller also
+ *  leaves its suspended state, clearing SUSPI, which LUFA relies on as it only clears WAKEUPI itself.
+ */
+static void BusActivity(void)
+{
+	Suspended = false;
+
+	HostSim_ClearBits(HOSTSIM_ADDRESS(UDINT), (1 << SUSPI));
+	HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << WAKEUPI));
+}
+
+void SimUSB_BusReset(void)
+{
+	if (!(SimUSB_IsAttached()))
+	  return;
+
+	BusActivity();
+
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDADDR), 0);
+
+	for (uint8_t Number = 0; Number < SIMUSB_ENDPOINTS; Number++)
+	{
+		Endpoint_t* Endpoint = &Endpoints[Number];
+
+		FlushBanks(Endpoint);
+		SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), 0);
+		SetEndpointRegister(Endpoint, EP_OFFSET(UECONX), (Number ? 0 : (EP_REGISTER(Endpoint, UECONX) & (1 << EPEN))));
+
+		if (Endpoint->Allocated && (IsControl(Endpoint) || IsIN(Endpoint)))
+		  SetEndpointFlags(Endpoint, (1 << TXINI));
+
+		Refresh(Endpoint);
+	}
+
+	HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << EORSTI));
+}
+
+void SimUSB_StartOfFrame(void)
+{
+	if (!(SimUSB_IsAttached()))
+	  return;
+
+	//Frames are only counted once the controller clock runs
+	BusActivity();
+
+	if (USBCON & (1 << FRZCLK))
+	  return;
+
+	FrameNumber = ((FrameNumber + 1) & 0x07FF);
+
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDFNUML), (uint8_t)FrameNumber);
+	HostSim_SetRegister(HOSTSIM_ADDRESS(UDFNUMH), (uint8_t)(FrameNumber >> 8));
+	HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << SOFI));
+}
+
+void SimUSB_Suspend(void)
+{
+	if (!(SimUSB_IsAttached()) || Suspended)
+	  return;
+
+	Suspended = true;
+	HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << SUSPI));
+}
+
+void SimUSB_Resume(void)
+{
+	if (!(SimUSB_IsAttached()))
+	  return;
+
+	BusActivity();
+	HostSim_SetBits(HOSTSIM_ADDRESS(UDINT), (1 << EORSMI));
+}
+
+bool SimUSB_TakeRemoteWakeup(void)
+{
+	HostSim_Reconcile();
+
+	bool Signalled = RemoteWakeupSignalled;
+
+	RemoteWakeupSignalled = false;
+	return Signalled;
+}
+
+uint16_t SimUSB_GetFrameNumber(void)
+{
+	return FrameNumber;
+}
+
+uint8_t SimUSB_Setup(const uint8_t Address, const uint8_t* const Request)
+{
+	Endpoint_t* Endpoint = &Endpoints[0];
+	Bank_t*     Bank     = &Endpoint->Banks[CONTROL_BANK_OUT];
+
+	if (!(Responds(Address)) || !(IsActive(Endpoint)))
+	  return SIMUSB_HANDSHAKE_TIMEOUT;
+
+	SimUSB_Stats.Setups++;
+
+	//A SETUP is always accepted, abandoning any transfer in progress and withdrawing a STALL
+	memcpy(Bank->Data, Request, SIMUSB_SETUP_LENGTH);
+	Bank->Length   = SIMUSB_SETUP_LENGTH;
+	Bank->Position = 0;
+
+	Endpoint->Banks[CONTROL_BANK_IN].Length = 0;
+	Endpoint->INCommitted = false;
+
+	SetEndpointRegister(Endpoint, EP_OFFSET(UECONX), (EP_REGISTER(Endpoint, UECONX) & ~(1 << STALLRQ)));
+	SetEndpointRegister(Endpoint, EP_OFFSET(UEINTX), ((EP_REGISTER(Endpoint, UEINTX) & ~(1 << RXOUTI)) |
+	                                                  (1 << RXSTPI) | (1 << TXINI)));
+	Refresh(Endpoint);
+
+	return SIMUSB_HANDSHAKE_ACK;
+}
+
+/** Answers a transaction on a halted endpoint with a STALL, returning whether it did so. */
+static bool Stalled(Endpoint_t* const Endpoint)
+{
+	if (!(EP_REGISTER(Endpoint, UECONX) & (1 << STALLRQ)))
+	  return false;
+
+	SimUSB_Stats.STALLs++;
+	SetEndpointFlags(Endpoint, (1 << STALLEDI));
+	return true;
+}
+
+/** Answers a transaction the endpoint is not ready for with a NAK, setting the given NAK flag. */
+static uint8_t NAK(Endpoint_t* const Endpoint, const uint8_t Flag)
+{
+	SimUSB_Stats.NAKs++;
+	SetEndpointFlags(Endpoint, (1 << Flag));
+	return SIMUSB_HANDSHAKE_NAK;
+}
+
+uint8_t SimUSB_In(const uint8_t Address, const uint8_t Endpoint, uint8_t* const Data, uint16_t* const Length)
+{
+	Endpoint_t* ThisEndpoint = &Endpoints[Endpoint & 0x07];
+	Bank_t*     Bank;
+
+	*Length = 0;
+
+	if (!(Responds(Address)) || (Endpoint >= SIMUSB_ENDPOINTS) || !(IsActive(ThisEndpoint)))
+	  return SIMUSB_HANDSHAKE_TIMEOUT;
+
+	if (!(IsControl(ThisEndpoint)) && !(IsIN(ThisEndpoint)))
+	  return SIMUSB_HANDSHAKE_TIMEOUT;
+
+	SimUSB_Stats.INs++;
+
+	if (Stalled(ThisEndpoint))
+	  return SIMUSB_HANDSHAKE_STALL;
+
+	if (IsControl(ThisEndpoint))
+	{
+		if (!(ThisEndpoint->INCommitted))
+		  return NAK(ThisEndpoint, NAKINI);
+
+		Bank = &ThisEndpoint->Banks[CONTROL_BANK_IN];
+		ThisEndpoint->INCommitted = false;
+	}
+	else
+	{
+		if (!(ThisEndpoint->BusyBanks))
+		  return NAK(ThisEndpoint, NAKINI);
+
+		Bank = &ThisEndpoint->Banks[(ThisEndpoint->CPUBank + ThisEndpoint->BankCount - ThisEndpoint->BusyBanks) %
+		                            ThisEndpoint->BankCount];
+		ThisEndpoint->BusyBanks--;
+	}
+
+	memcpy(Data, Bank->Data, Bank->Length);
+	*Length      = Bank->Length;
+	Bank->Length = 0;
+
+	SetEndpointFlags(ThisEndpoint, (1 << TXINI));
+	Refresh(ThisEndpoint);
+
+	return SIMUSB_HANDSHAKE_ACK;
+}
+
+uint8_t SimUSB_Out(const uint8_t Address, const uint8_t Endpoint, const uint8_t* const Data, const uint16_t Length)
+{
+	Endpoint_t* ThisEndpoint = &Endpoints[Endpoint & 0x07];
+	Bank_t*     Bank;
+
+	if (!(Responds(Address)) || (Endpoint >= SIMUSB_ENDPOINTS) || !(IsActive(ThisEndpoint)))
+	  return SIMUSB_HANDSHAKE_TIMEOUT;
+
+	if (!(IsControl(ThisEndpoint)) && IsIN(ThisEndpoint))
+	  return SIMUSB_HANDSHAKE_TIMEOUT;
+
+	SimUSB_Stats.OUTs++;
+
+	if (Stalled(ThisEndpoint))
+	  return SIMUSB_HANDSHAKE_STALL;
+
+	if (IsControl(ThisEndpoint))
+	{
+		if (IsControlRead(ThisEndpoint))
+		  return NAK(ThisEndpoint, NAKOUTI);
+
+		Bank = &ThisEndpoint->Banks[CONTROL_BANK_OUT];
+	}
+	else
+	{
+		if (ThisEndpoint->BusyBanks == ThisEndpoint->BankCount)
+		  return NAK(ThisEndpoint, NAKOUTI);
+
+		Bank = &ThisEndpoint->Banks[(ThisEndpoint->CPUBank + ThisEndpoint->BusyBanks) % ThisEndpoint->BankCount];
+		ThisEndpoint->BusyBanks++;
+	}
+
+	Bank->Length   = (Length < ThisEndpoint->Size) ? Length : ThisEndpoint->Size;
+	Bank->Position = 0;
+	memcpy(Bank->Data, Data, Bank->Length);
+
+	if (IsControl(ThisEndpoint) || (ThisEndpoint->BusyBanks == 1))
+	  SetEndpointFlags(ThisEndpoint, (1 << RXOUTI));
+
+	Refresh(ThisEndpoint);
+
+	return SIMUSB_HANDSHAKE_ACK;
+}
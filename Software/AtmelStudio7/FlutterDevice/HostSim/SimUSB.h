@@ -0,0 +1,131 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for SimUSB.c, the simulated USB device controller of the ATmega32U4. The functions here are the
+ *  bus side of the controller, called by the virtual host to drive the bus and issue transactions.
+ */
+
+#ifndef _SIMUSB_H_
+#define _SIMUSB_H_
+
+	/* Includes: */
+		#include "HostSim.h"
+
+	/* Macros: */
+		/** Number of endpoints of the controller, including the control endpoint. */
+		#define SIMUSB_ENDPOINTS           7
+
+		/** Size of the endpoint memory shared by all allocated endpoint banks, in bytes. */
+		#define SIMUSB_DPRAM_SIZE          832
+
+		/** Largest endpoint bank the controller supports, in bytes. */
+		#define SIMUSB_MAX_BANK_SIZE       256
+
+		/** Length of a SETUP packet, in bytes. */
+		#define SIMUSB_SETUP_LENGTH        8
+
+	/* Enums: */
+		/** Outcomes of a transaction issued to the device. */
+		enum SimUSB_Handshakes_t
+		{
+			SIMUSB_HANDSHAKE_ACK     = 0, /**< The device accepted or returned the data. */
+			SIMUSB_HANDSHAKE_NAK     = 1, /**< The device was not ready, and the transaction should be retried. */
+			SIMUSB_HANDSHAKE_STALL   = 2, /**< The endpoint is halted or the request is not supported. */
+			SIMUSB_HANDSHAKE_TIMEOUT = 3, /**< The device did not respond at all. */
+		};
+
+	/* Type Defines: */
+		/** Statistics of the traffic seen by the controller. */
+		typedef struct
+		{
+			uint32_t Setups; /**< SETUP transactions addressed to the device. */
+			uint32_t INs; /**< IN transactions addressed to the device. */
+			uint32_t OUTs; /**< OUT transactions addressed to the device. */
+			uint32_t NAKs; /**< Transactions answered with a NAK. */
+			uint32_t STALLs; /**< Transactions answered with a STALL. */
+			uint32_t FIFOAccesses; /**< Accesses of the firmware to an endpoint FIFO. */
+		} SimUSB_Stats_t;
+
+	/* External Variables: */
+		/** Statistics of the controller since the last reset of the simulated device. */
+		extern SimUSB_Stats_t SimUSB_Stats;
+
+	/* Function Prototypes: */
+		/** Applies or removes the bus supply. */
+		void SimUSB_SetVBUS(const bool Present);
+
+		/** Returns whether the device has its pull-up enabled, and so appears attached to the host. */
+		bool SimUSB_IsAttached(void);
+
+		/** Signals a reset on the bus, ending with the end of reset interrupt of the controller. */
+		void SimUSB_BusReset(void);
+
+		/** Sends a start of frame packet, advancing the frame number of the controller. */
+		void SimUSB_StartOfFrame(void);
+
+		/** Marks the bus as having been idle long enough for the device to suspend. */
+		void SimUSB_Suspend(void);
+
+		/** Signals a resume on the bus, waking the device from suspend. */
+		void SimUSB_Resume(void);
+
+		/** Returns and clears whether the device has signalled a remote wakeup since the last call. */
+		bool SimUSB_TakeRemoteWakeup(void);
+
+		/** Returns the frame number last sent to the device. */
+		uint16_t SimUSB_GetFrameNumber(void);
+
+		/** Issues a SETUP transaction to the control endpoint of the device.
+		 *
+		 *  \param[in] Address  Device address the transaction is sent to.
+		 *  \param[in] Request  Request of \ref SIMUSB_SETUP_LENGTH bytes.
+		 *
+		 *  \return Handshake of the device, a value from \ref SimUSB_Handshakes_t.
+		 */
+		uint8_t SimUSB_Setup(const uint8_t Address, const uint8_t* const Request);
+
+		/** Issues an IN transaction to an endpoint of the device.
+		 *
+		 *  \param[in]  Address   Device address the transaction is sent to.
+		 *  \param[in]  Endpoint  Number of the endpoint, without the direction bit.
+		 *  \param[out] Data      Buffer of at least \ref SIMUSB_MAX_BANK_SIZE bytes receiving the packet.
+		 *  \param[out] Length    Length of the packet received.
+		 *
+		 *  \return Handshake of the device, a value from \ref SimUSB_Handshakes_t.
+		 */
+		uint8_t SimUSB_In(const uint8_t Address, const uint8_t Endpoint, uint8_t* const Data, uint16_t* const Length);
+
+		/** Issues an OUT transaction to an endpoint of the device.
+		 *
+		 *  \param[in] Address   Device address the transaction is sent to.
+		 *  \param[in] Endpoint  Number of the endpoint, without the direction bit.
+		 *  \param[in] Data      Packet to send.
+		 *  \param[in] Length    Length of the packet, at most \ref SIMUSB_MAX_BANK_SIZE bytes.
+		 *
+		 *  \return Handshake of the device, a value from \ref SimUSB_Handshakes_t.
+		 */
+		uint8_t SimUSB_Out(const uint8_t Address, const uint8_t Endpoint, const uint8_t* const Data, const uint16_t Length);
+
+#endif
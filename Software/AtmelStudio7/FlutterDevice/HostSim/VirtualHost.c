@@ -0,0 +1,485 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  A full speed USB host for the simulated device. The host owns the passage of time: it runs the firmware
+ *  between its own bus events, sending a start of frame packet every millisecond while the bus is active,
+ *  charging each transaction the bus time it occupies, and letting the device suspend when frames stop.
+ */
+
+#include "VirtualHost.h"
+
+/* Macros: */
+	/** Token PIDs accepted by \ref VirtualHost_Transaction(). */
+	#define TOKEN_SETUP                  0x2D
+	#define TOKEN_IN                     0x69
+	#define TOKEN_OUT                    0xE1
+
+	/** Request direction bit in \c bmRequestType. */
+	#define REQUEST_DIRECTION_IN         0x80
+
+	/** Standard requests and descriptor types the host tracks while enumerating. */
+	#define REQUEST_SET_ADDRESS          0x05
+	#define REQUEST_GET_DESCRIPTOR       0x06
+	#define DESCRIPTOR_TYPE_DEVICE       0x01
+
+	/** Offset of \c bMaxPacketSize0 in the device descriptor. */
+	#define DEVICE_MAX_PACKET_SIZE0      7
+
+	/** Bytes of protocol overhead around the data of a transaction: token, packet framing and handshake. */
+	#define TRANSACTION_OVERHEAD         16
+
+/* Global Variables: */
+VirtualHost_Stats_t VirtualHost_Stats;
+
+/* Local Variables: */
+/** Whether the host sends start of frame packets. */
+static bool     BusActive;
+
+/** Whether the bus is held in reset, which keeps the device from suspending. */
+static bool     BusResetting;
+
+/** Whether the device has been told the bus is suspended. */
+static bool     BusSuspended;
+
+/** Time the next start of frame packet is due. */
+static uint64_t NextFrameAt;
+
+/** Time of the last bus activity. */
+static uint64_t LastActivityAt;
+
+/** Address transactions are sent to. */
+static uint8_t  DeviceAddress;
+
+/** Largest packet of the default control endpoint, learned from the device descriptor. */
+static uint8_t  MaxPacketSize0;
+
+/** Frame each interrupt endpoint was last polled in, indexed by direction and number. */
+static uint32_t PolledFrames[2][16];
+
+/** Position of the encoder in its quadrature sequence. */
+static uint8_t  EncoderPhase;
+
+/** Quadrature sequence of the encoder, in the order a step counting up passes through it. */
+static const uint8_t EncoderSequence[] = {0x03, 0x02, 0x00, 0x01};
+
+/** Runs the firmware up to the given time, sending frames and signalling suspend and resume on the way. */
+static void RunUntil(const uint64_t Time)
+{
+	while (HostSim_GetCycles() < Time)
+	{
+		uint64_t Now  = HostSim_GetCycles();
+		uint64_t Next = Time;
+
+		if (BusActive && (NextFrameAt < Next))
+		  Next = NextFrameAt;
+
+		if ((Next > Now) && !(HostSim_Run((uint32_t)(Next - Now))))
+		{
+			fprintf(stderr, "VirtualHost: firmware returned from main()\n");
+			exit(EXIT_FAILURE);
+		}
+
+		Now = HostSim_GetCycles();
+
+		if (BusActive && (Now >= NextFrameAt))
+		{
+			SimUSB_StartOfFrame();
+
+			VirtualHost_Stats.Frames++;
+			NextFrameAt   += VIRTUALHOST_FRAME_CYCLES;
+			LastActivityAt = Now;
+		}
+
+		if (!(BusActive) && !(BusResetting) && !(BusSuspended) &&
+		    ((Now - LastActivityAt) >= (VIRTUALHOST_SUSPEND_FRAMES * VIRTUALHOST_FRAME_CYCLES)))
+		{
+			SimUSB_Suspend();
+			BusSuspended = true;
+		}
+
+		//A host answers a remote wakeup by resuming the bus itself
+		if (BusSuspended && SimUSB_TakeRemoteWakeup())
+		{
+			VirtualHost_Stats.RemoteWakeups++;
+			VirtualHost_Resume();
+		}
+	}
+}
+
+/** Returns the bus time of a transaction carrying the given number of data bytes, in device cycles. */
+static uint32_t TransactionCycles(const uint16_t Length)
+{
+	//Twelve bits on the bus take sixteen cycles of the device
+	return (((uint32_t)Length + TRANSACTION_OVERHEAD) * 8 * 4) / 3;
+}
+
+bool VirtualHost_PowerOn(void)
+{
+	memset(&VirtualHost_Stats, 0, sizeof(VirtualHost_Stats));
+
+	BusActive      = false;
+	BusResetting   = false;
+	BusSuspended   = false;
+	NextFrameAt    = 0;
+	LastActivityAt = 0;
+	DeviceAddress  = 0;
+	MaxPacketSize0 = 8;
+	EncoderPhase   = 0;
+
+	memset(PolledFrames, 0xFF, sizeof(PolledFrames));
+
+	HostSim_Reset();
+	SimUSB_SetVBUS(true);
+
+	//The device is not suspended by an idle bus it has not attached to yet
+	BusResetting = true;
+
+	for (uint16_t Frame = 0; Frame < 1000; Frame++)
+	{
+		if (SimUSB_IsAttached())
+		{
+			BusResetting   = false;
+			LastActivityAt = HostSim_GetCycles();
+			return true;
+		}
+
+		VirtualHost_Run(VIRTUALHOST_FRAME_CYCLES);
+	}
+
+	BusResetting = false;
+	return false;
+}
+
+void VirtualHost_Run(const uint64_t Cycles)
+{
+	RunUntil(HostSim_GetCycles() + Cycles);
+}
+
+void VirtualHost_RunFrames(const uint32_t Frames)
+{
+	VirtualHost_Run((uint64_t)Frames * VIRTUALHOST_FRAME_CYCLES);
+}
+
+bool VirtualHost_WaitForDisplay(const int16_t Number, const uint32_t MaxFrames)
+{
+	for (uint32_t Frame = 0; Frame <= MaxFrames; Frame++)
+	{
+		if (SimBoard_GetDisplayNumber() == Number)
+		  return true;
+
+		VirtualHost_RunFrames(1);
+	}
+
+	return false;
+}
+
+void VirtualHost_BusReset(void)
+{
+	BusActive    = false;
+	BusResetting = true;
+	BusSuspended = false;
+
+	VirtualHost_RunFrames(VIRTUALHOST_RESET_FRAMES);
+	SimUSB_BusReset();
+
+	BusResetting   = false;
+	BusActive      = true;
+	DeviceAddress  = 0;
+	NextFrameAt    = HostSim_GetCycles() + VIRTUALHOST_FRAME_CYCLES;
+	LastActivityAt = HostSim_GetCycles();
+
+	VirtualHost_RunFrames(VIRTUALHOST_RECOVERY_FRAMES);
+}
+
+void VirtualHost_Suspend(void)
+{
+	BusActive      = false;
+	LastActivityAt = HostSim_GetCycles();
+
+	VirtualHost_RunFrames(VIRTUALHOST_SUSPEND_FRAMES + 1);
+}
+
+void VirtualHost_Resume(void)
+{
+	if (!(BusSuspended))
+	  return;
+
+	//Resume signalling holds the bus busy, after which frames start again
+	BusSuspended = false;
+	BusResetting = true;
+
+	SimUSB_Resume();
+	VirtualHost_RunFrames(VIRTUALHOST_RESUME_FRAMES);
+
+	BusResetting   = false;
+	BusActive      = true;
+	NextFrameAt    = HostSim_GetCycles();
+	LastActivityAt = HostSim_GetCycles();
+}
+
+bool VirtualHost_IsSuspended(void)
+{
+	return BusSuspended;
+}
+
+uint8_t VirtualHost_GetAddress(void)
+{
+	return DeviceAddress;
+}
+
+uint8_t VirtualHost_Transaction(const uint8_t Token, const uint8_t Endpoint, uint8_t* const Data,
+                                uint16_t* const Length)
+{
+	uint8_t Handshake;
+
+	VirtualHost_Stats.Transactions++;
+
+	switch (Token)
+	{
+		case TOKEN_SETUP:
+			Handshake = SimUSB_Setup(DeviceAddress, Data);
+			break;
+		case TOKEN_IN:
+			Handshake = SimUSB_In(DeviceAddress, Endpoint, Data, Length);
+			break;
+		default:
+			Handshake = SimUSB_Out(DeviceAddress, Endpoint, Data, *Length);
+			break;
+	}
+
+	//The firmware keeps running for as long as the transaction occupies the bus
+	VirtualHost_Run(TransactionCycles(((Handshake == SIMUSB_HANDSHAKE_ACK) ? *Length : 0)));
+
+	LastActivityAt = HostSim_GetCycles();
+	return Handshake;
+}
+
+/** Issues a transaction on the default control endpoint, retrying it while the device answers with a NAK. */
+static uint8_t ControlTransaction(const uint8_t Token, uint8_t* const Data, uint16_t* const Length)
+{
+	uint64_t Deadline = HostSim_GetCycles() + ((uint64_t)VIRTUALHOST_TIMEOUT_FRAMES * VIRTUALHOST_FRAME_CYCLES);
+	uint16_t Sent     = *Length;
+
+	for (;;)
+	{
+		uint8_t Handshake;
+
+		*Length   = Sent;
+		Handshake = VirtualHost_Transaction(Token, 0, Data, Length);
+
+		if (Handshake == SIMUSB_HANDSHAKE_ACK)
+		  return VIRTUALHOST_RESULT_OK;
+		else if (Handshake == SIMUSB_HANDSHAKE_STALL)
+		  return VIRTUALHOST_RESULT_STALL;
+		else if (Handshake == SIMUSB_HANDSHAKE_TIMEOUT)
+		  return VIRTUALHOST_RESULT_TIMEOUT;
+		else if (HostSim_GetCycles() >= Deadline)
+		  return VIRTUALHOST_RESULT_NAK;
+
+		VirtualHost_Run(VIRTUALHOST_RETRY_CYCLES);
+	}
+}
+
+uint8_t VirtualHost_Control(const VirtualHost_Request_t* const Request,
+                            void* const Data,
+                            uint16_t* const Transferred)
+{
+	uint8_t  Packet[SIMUSB_MAX_BANK_SIZE];
+	uint8_t* Buffer = (uint8_t*)Data;
+	uint16_t Length = VIRTUALHOST_REQUEST_SIZE;
+	uint16_t Done   = 0;
+	bool     IsIN   = (Request->bmRequestType & REQUEST_DIRECTION_IN);
+	uint8_t  Result;
+
+	Packet[0] = Request->bmRequestType;
+	Packet[1] = Request->bRequest;
+	Packet[2] = (uint8_t)Request->wValue;
+	Packet[3] = (uint8_t)(Request->wValue >> 8);
+	Packet[4] = (uint8_t)Request->wIndex;
+	Packet[5] = (uint8_t)(Request->wIndex >> 8);
+	Packet[6] = (uint8_t)Request->wLength;
+	Packet[7] = (uint8_t)(Request->wLength >> 8);
+
+	if (Transferred != NULL)
+	  *Transferred = 0;
+
+	if ((Result = ControlTransaction(TOKEN_SETUP, Packet, &Length)) != VIRTUALHOST_RESULT_OK)
+	  return Result;
+
+	//Data stage, ended by a short packet or once all the requested data has moved
+	while (Done < Request->wLength)
+	{
+		if (IsIN)
+		{
+			Length = 0;
+
+			if ((Result = ControlTransaction(TOKEN_IN, Packet, &Length)) != VIRTUALHOST_RESULT_OK)
+			  return Result;
+
+			if (Length > (Request->wLength - Done))
+			  Length = (Request->wLength - Done);
+
+			memcpy(&Buffer[Done], Packet, Length);
+			Done += Length;
+
+			if (Length < MaxPacketSize0)
+			  break;
+		}
+		else
+		{
+			Length = (Request->wLength - Done);
+
+			if (Length > MaxPacketSize0)
+			  Length = MaxPacketSize0;
+
+			memcpy(Packet, &Buffer[Done], Length);
+
+			if ((Result = ControlTransaction(TOKEN_OUT, Packet, &Length)) != VIRTUALHOST_RESULT_OK)
+			  return Result;
+
+			Done += Length;
+		}
+	}
+
+	//Status stage, a zero length packet in the opposite direction to the data
+	Length = 0;
+
+	if ((Result = ControlTransaction((IsIN ? TOKEN_OUT : TOKEN_IN), Packet, &Length)) != VIRTUALHOST_RESULT_OK)
+	  return Result;
+
+	if ((Request->bRequest == REQUEST_GET_DESCRIPTOR) && ((Request->wValue >> 8) == DESCRIPTOR_TYPE_DEVICE) &&
+	    (Done > DEVICE_MAX_PACKET_SIZE0))
+	{
+		MaxPacketSize0 = Buffer[DEVICE_MAX_PACKET_SIZE0];
+	}
+
+	if (Transferred != NULL)
+	  *Transferred = Done;
+
+	VirtualHost_Stats.ControlTransfers++;
+	return VIRTUALHOST_RESULT_OK;
+}
+
+uint8_t VirtualHost_SetAddress(const uint8_t Address)
+{
+	VirtualHost_Request_t Request =
+		{
+			.bmRequestType = 0x00,
+			.bRequest      = REQUEST_SET_ADDRESS,
+			.wValue        = Address,
+			.wIndex        = 0,
+			.wLength       = 0,
+		};
+
+	uint8_t Result = VirtualHost_Control(&Request, NULL, NULL);
+
+	if (Result == VIRTUALHOST_RESULT_OK)
+	{
+		VirtualHost_RunFrames(VIRTUALHOST_SET_ADDRESS_FRAMES);
+		DeviceAddress = Address;
+	}
+
+	return Result;
+}
+
+/** Runs the bus until the next polling slot of an interrupt endpoint, which is once per frame for each
+ *  endpoint and direction.
+ */
+static void WaitForPollSlot(const uint8_t Token, const uint8_t Endpoint)
+{
+	uint32_t* LastPolled = &PolledFrames[(Token == TOKEN_IN) ? 1 : 0][Endpoint & 0x0F];
+	uint64_t Now        = HostSim_GetCycles();
+	uint64_t Slot       = (Now - (Now % VIRTUALHOST_FRAME_CYCLES)) + VIRTUALHOST_POLL_OFFSET;
+
+	if ((Now / VIRTUALHOST_FRAME_CYCLES) == *LastPolled)
+	  Slot += VIRTUALHOST_FRAME_CYCLES;
+
+	RunUntil(Slot);
+
+	*LastPolled = (HostSim_GetCycles() / VIRTUALHOST_FRAME_CYCLES);
+}
+
+uint8_t VirtualHost_InterruptIn(const uint8_t Endpoint, uint8_t* const Data, uint16_t* const Length,
+                                const uint32_t MaxFrames)
+{
+	for (uint32_t Frame = 0; Frame < MaxFrames; Frame++)
+	{
+		WaitForPollSlot(TOKEN_IN, Endpoint);
+
+		switch (VirtualHost_Transaction(TOKEN_IN, Endpoint, Data, Length))
+		{
+			case SIMUSB_HANDSHAKE_ACK:
+				return VIRTUALHOST_RESULT_OK;
+			case SIMUSB_HANDSHAKE_STALL:
+				return VIRTUALHOST_RESULT_STALL;
+			case SIMUSB_HANDSHAKE_TIMEOUT:
+				return VIRTUALHOST_RESULT_TIMEOUT;
+		}
+	}
+
+	*Length = 0;
+	return VIRTUALHOST_RESULT_NAK;
+}
+
+uint8_t VirtualHost_InterruptOut(const uint8_t Endpoint, const uint8_t* const Data, const uint16_t Length,
+                                 const uint32_t MaxFrames)
+{
+	uint8_t Packet[SIMUSB_MAX_BANK_SIZE];
+
+	memcpy(Packet, Data, Length);
+
+	for (uint32_t Frame = 0; Frame < MaxFrames; Frame++)
+	{
+		uint16_t Sent = Length;
+
+		WaitForPollSlot(TOKEN_OUT, Endpoint);
+
+		switch (VirtualHost_Transaction(TOKEN_OUT, Endpoint, Packet, &Sent))
+		{
+			case SIMUSB_HANDSHAKE_ACK:
+				return VIRTUALHOST_RESULT_OK;
+			case SIMUSB_HANDSHAKE_STALL:
+				return VIRTUALHOST_RESULT_STALL;
+			case SIMUSB_HANDSHAKE_TIMEOUT:
+				return VIRTUALHOST_RESULT_TIMEOUT;
+		}
+	}
+
+	return VIRTUALHOST_RESULT_NAK;
+}
+
+void VirtualHost_TurnEncoder(const int16_t Detents, const uint32_t CyclesPerDetent)
+{
+	int8_t   Direction = (Detents < 0) ? -1 : 1;
+	uint16_t Steps     = (uint16_t)((Detents < 0) ? -Detents : Detents) * sizeof(EncoderSequence);
+
+	for (uint16_t Step = 0; Step < Steps; Step++)
+	{
+		EncoderPhase = (uint8_t)(EncoderPhase + Direction) % sizeof(EncoderSequence);
+
+		SimBoard_SetEncoder(EncoderSequence[EncoderPhase]);
+		VirtualHost_Run(CyclesPerDetent / sizeof(EncoderSequence));
+	}
+}
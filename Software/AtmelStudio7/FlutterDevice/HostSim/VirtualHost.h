@@ -0,0 +1,211 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for VirtualHost.c, a full speed USB host driving the simulated device. The host keeps the bus
+ *  timing: start of frame packets every millisecond, suspend once the bus has been idle for 3ms, and the bus
+ *  time taken by each transaction, during all of which the firmware runs.
+ */
+
+#ifndef _VIRTUALHOST_H_
+#define _VIRTUALHOST_H_
+
+	/* Includes: */
+		#include "HostSim.h"
+		#include "SimUSB.h"
+		#include "SimBoard.h"
+
+		#include <stdio.h>
+		#include <stdlib.h>
+		#include <string.h>
+
+	/* Macros: */
+		/** Length of a USB frame, in cycles of the simulated device. */
+		#define VIRTUALHOST_FRAME_CYCLES         (HOSTSIM_CLOCK_HZ / 1000)
+
+		/** Cycles the host waits before retrying a control transaction answered with a NAK. */
+		#define VIRTUALHOST_RETRY_CYCLES         200
+
+		/** Frames after which the host gives up on a transaction the device keeps answering with a NAK. */
+		#define VIRTUALHOST_TIMEOUT_FRAMES       500
+
+		/** Frames the host leaves the device after a SET_ADDRESS request before using the new address. */
+		#define VIRTUALHOST_SET_ADDRESS_FRAMES   2
+
+		/** Frames of bus idle after which the device suspends. */
+		#define VIRTUALHOST_SUSPEND_FRAMES       3
+
+		/** Frames a bus reset is signalled for. */
+		#define VIRTUALHOST_RESET_FRAMES         10
+
+		/** Frames the host leaves the device to recover from a bus reset before sending it requests. */
+		#define VIRTUALHOST_RECOVERY_FRAMES      10
+
+		/** Frames a resume is signalled for. */
+		#define VIRTUALHOST_RESUME_FRAMES        20
+
+		/** Offset into each frame at which interrupt endpoints are polled, in cycles. */
+		#define VIRTUALHOST_POLL_OFFSET          (VIRTUALHOST_FRAME_CYCLES / 2)
+
+		/** Size of a SETUP request in bytes. */
+		#define VIRTUALHOST_REQUEST_SIZE         SIMUSB_SETUP_LENGTH
+
+	/* Enums: */
+		/** Results of the transfers issued by the virtual host. */
+		enum VirtualHost_Results_t
+		{
+			VIRTUALHOST_RESULT_OK      = 0, /**< The transfer completed. */
+			VIRTUALHOST_RESULT_STALL   = 1, /**< The device stalled the transfer. */
+			VIRTUALHOST_RESULT_NAK     = 2, /**< The device answered every attempt with a NAK until the host gave up. */
+			VIRTUALHOST_RESULT_TIMEOUT = 3, /**< The device did not answer at all. */
+		};
+
+	/* Type Defines: */
+		/** Standard USB control request. */
+		typedef struct
+		{
+			uint8_t  bmRequestType; /**< Direction, type and recipient of the request. */
+			uint8_t  bRequest; /**< Request code. */
+			uint16_t wValue; /**< Request specific value. */
+			uint16_t wIndex; /**< Request specific index. */
+			uint16_t wLength; /**< Length of the data stage. */
+		} VirtualHost_Request_t;
+
+		/** Statistics of the bus traffic of the virtual host. */
+		typedef struct
+		{
+			uint32_t Frames; /**< Start of frame packets sent. */
+			uint32_t Transactions; /**< Transactions issued, including those answered with a NAK. */
+			uint32_t ControlTransfers; /**< Control transfers completed. */
+			uint32_t RemoteWakeups; /**< Remote wakeups seen from the device. */
+		} VirtualHost_Stats_t;
+
+	/* External Variables: */
+		/** Statistics of the virtual host since the last \ref VirtualHost_PowerOn(). */
+		extern VirtualHost_Stats_t VirtualHost_Stats;
+
+	/* Function Prototypes: */
+		/** Resets the simulated device with the bus supply present, and runs it until it attaches to the bus.
+		 *
+		 *  \return Boolean \c true if the device attached within a second, \c false otherwise.
+		 */
+		bool VirtualHost_PowerOn(void);
+
+		/** Lets the bus run for the given number of cycles, sending frames if the bus is active. */
+		void VirtualHost_Run(const uint64_t Cycles);
+
+		/** Lets the bus run for the given number of frames. */
+		void VirtualHost_RunFrames(const uint32_t Frames);
+
+		/** Runs the bus until the device shows the given number on its display, or the frames run out.
+		 *
+		 *  \param[in] Number     Number expected on the display.
+		 *  \param[in] MaxFrames  Frames to wait for at most.
+		 *
+		 *  \return Boolean \c true if the display showed the number in time, \c false otherwise.
+		 */
+		bool VirtualHost_WaitForDisplay(const int16_t Number, const uint32_t MaxFrames);
+
+		/** Resets the bus, leaving the device at the default address and the bus active once the device has had its
+		 *  reset recovery time.
+		 */
+		void VirtualHost_BusReset(void);
+
+		/** Stops sending frames until the device has suspended. */
+		void VirtualHost_Suspend(void);
+
+		/** Resumes a suspended bus. */
+		void VirtualHost_Resume(void);
+
+		/** Returns whether the bus is currently suspended. */
+		bool VirtualHost_IsSuspended(void);
+
+		/** Returns the address the host sends transactions to. */
+		uint8_t VirtualHost_GetAddress(void);
+
+		/** Performs a control transfer with the device, retrying transactions answered with a NAK.
+		 *
+		 *  \param[in]     Request      Request to send.
+		 *  \param[in,out] Data         Data stage buffer of \c wLength bytes, sent or filled depending on the
+		 *                              direction of the request.
+		 *  \param[out]    Transferred  Number of bytes transferred in the data stage, may be \c NULL.
+		 *
+		 *  \return Result of the transfer, a value from \ref VirtualHost_Results_t.
+		 */
+		uint8_t VirtualHost_Control(const VirtualHost_Request_t* const Request,
+		                            void* const Data,
+		                            uint16_t* const Transferred);
+
+		/** Assigns an address to the device with a SET_ADDRESS request, and sends transactions to it from then on.
+		 *
+		 *  \param[in] Address  New address of the device.
+		 *
+		 *  \return Result of the transfer, a value from \ref VirtualHost_Results_t.
+		 */
+		uint8_t VirtualHost_SetAddress(const uint8_t Address);
+
+		/** Issues a single transaction, without retries.
+		 *
+		 *  \param[in]     Token     PID of the token, \c 0x2D for SETUP, \c 0x69 for IN or \c 0xE1 for OUT.
+		 *  \param[in]     Endpoint  Number of the endpoint, without the direction bit.
+		 *  \param[in,out] Data      Packet to send, or buffer of \ref SIMUSB_MAX_BANK_SIZE bytes receiving one.
+		 *  \param[in,out] Length    Length of the packet sent or received.
+		 *
+		 *  \return Handshake of the device, a value from \ref SimUSB_Handshakes_t.
+		 */
+		uint8_t VirtualHost_Transaction(const uint8_t Token, const uint8_t Endpoint, uint8_t* const Data,
+		                                uint16_t* const Length);
+
+		/** Polls an interrupt IN endpoint once per frame until it returns a packet or the frames run out.
+		 *
+		 *  \param[in]  Endpoint   Number of the endpoint, without the direction bit.
+		 *  \param[out] Data       Buffer of \ref SIMUSB_MAX_BANK_SIZE bytes receiving the packet.
+		 *  \param[out] Length     Length of the packet received.
+		 *  \param[in]  MaxFrames  Frames to poll for at most.
+		 *
+		 *  \return Result of the transfer, a value from \ref VirtualHost_Results_t.
+		 */
+		uint8_t VirtualHost_InterruptIn(const uint8_t Endpoint, uint8_t* const Data, uint16_t* const Length,
+		                                const uint32_t MaxFrames);
+
+		/** Sends a packet to an interrupt OUT endpoint, retrying once per frame while the device answers with a NAK.
+		 *
+		 *  \param[in] Endpoint   Number of the endpoint, without the direction bit.
+		 *  \param[in] Data       Packet to send.
+		 *  \param[in] Length     Length of the packet.
+		 *  \param[in] MaxFrames  Frames to retry for at most.
+		 *
+		 *  \return Result of the transfer, a value from \ref VirtualHost_Results_t.
+		 */
+		uint8_t VirtualHost_InterruptOut(const uint8_t Endpoint, const uint8_t* const Data, const uint16_t Length,
+		                                 const uint32_t MaxFrames);
+
+		/** Turns the encoder shaft by a number of detents, driving each quarter step of the quadrature sequence.
+		 *
+		 *  \param[in] Detents         Signed number of detents, positive for the direction counting up.
+		 *  \param[in] CyclesPerDetent Time taken by each detent, in cycles.
+		 */
+		void VirtualHost_TurnEncoder(const int16_t Detents, const uint32_t CyclesPerDetent);
+
+#endif
@@ -0,0 +1,38 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc bootloader header, used by the host simulation build. Only the signature
+ *  row is provided, which the simulated device fills with a fixed signature and serial number.
+ */
+
+#ifndef _HOSTSIM_AVR_BOOT_H_
+#define _HOSTSIM_AVR_BOOT_H_
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Function Prototypes: */
+		uint8_t boot_signature_byte_get(const uint16_t Address);
+
+#endif
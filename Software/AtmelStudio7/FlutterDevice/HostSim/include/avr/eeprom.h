@@ -0,0 +1,53 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc EEPROM header, used by the host simulation build. EEPROM addresses are
+ *  offsets into the simulated EEPROM array, exactly as on the target; writes complete immediately.
+ */
+
+#ifndef _HOSTSIM_AVR_EEPROM_H_
+#define _HOSTSIM_AVR_EEPROM_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <stddef.h>
+		#include <avr/io.h>
+
+	/* Macros: */
+		#define EEMEM
+		#define eeprom_is_ready()       1
+		#define eeprom_busy_wait()      do { } while (0)
+
+	/* Function Prototypes: */
+		uint8_t  eeprom_read_byte(const uint8_t* Address);
+		uint16_t eeprom_read_word(const uint16_t* Address);
+		void     eeprom_read_block(void* Destination, const void* Source, size_t Length);
+		void     eeprom_write_byte(uint8_t* Address, uint8_t Value);
+		void     eeprom_write_word(uint16_t* Address, uint16_t Value);
+		void     eeprom_write_block(const void* Source, void* Destination, size_t Length);
+		void     eeprom_update_byte(uint8_t* Address, uint8_t Value);
+		void     eeprom_update_word(uint16_t* Address, uint16_t Value);
+		void     eeprom_update_block(const void* Source, void* Destination, size_t Length);
+
+#endif
@@ -0,0 +1,60 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc interrupt header, used by the host simulation build.
+ *
+ *  An ISR becomes an ordinary function named after its vector, which the simulated CPU calls when the interrupt
+ *  is enabled and pending. The attributes of \c ISR() become statements run before the body, so that
+ *  \c ISR_NOBLOCK handlers re-enable interrupts on entry as they do on the target. Naked handlers are not
+ *  supported, as the simulated CPU has no AVR stack frame to inspect.
+ */
+
+#ifndef _HOSTSIM_AVR_INTERRUPT_H_
+#define _HOSTSIM_AVR_INTERRUPT_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Function Prototypes: */
+		void HostSim_EnableInterrupts(void);
+		void HostSim_DisableInterrupts(void);
+
+	/* Macros: */
+		#define sei()                   HostSim_EnableInterrupts()
+		#define cli()                   HostSim_DisableInterrupts()
+		#define reti()                  return
+
+		#define ISR_BLOCK
+		#define ISR_NOBLOCK             sei();
+		#define ISR_NAKED
+		#define ISR_ALIASOF(Vector)
+
+		#define ISR(Vector, ...)        static void Vector##_Body(void);               \
+		                                void Vector(void);                              \
+		                                void Vector(void) { __VA_ARGS__ Vector##_Body(); } \
+		                                static void Vector##_Body(void)
+
+		#define EMPTY_INTERRUPT(Vector) void Vector(void); void Vector(void) { }
+
+#endif
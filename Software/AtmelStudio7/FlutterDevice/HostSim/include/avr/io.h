@@ -0,0 +1,487 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc device header of the ATmega32U4, used by the host simulation build.
+ *
+ *  Every register keeps its data space address, so that the firmware and the unmodified AVR8 LUFA core are
+ *  compiled exactly as they are for the target. Plain registers (ports, sleep and analog control) are simply
+ *  bytes of \ref HostSim_DataSpace. The registers of the USB controller, the timers, the pin change interrupt
+ *  and the clock and power reduction controls are instead routed through \ref HostSim_Register(), which gives
+ *  the simulated peripherals a chance to act on the previous access, advances the virtual clock and delivers
+ *  any pending interrupt before handing back the storage of the register. Endpoint registers are banked by
+ *  \c UENUM as on the real part.
+ *
+ *  Files of the simulation model itself define \c HOSTSIM_MODEL before including this header, which maps the
+ *  modelled registers straight onto their storage instead.
+ */
+
+#ifndef _HOSTSIM_AVR_IO_H_
+#define _HOSTSIM_AVR_IO_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <avr/sfr_defs.h>
+
+	/* Type Defines: */
+		/** Type of a 16-bit register, which in the data space is not necessarily aligned. */
+		typedef uint16_t __attribute__((__may_alias__, __aligned__(1))) HostSim_Word_t;
+
+	/* External Variables: */
+		/** I/O and extended I/O register space of the simulated device, indexed by data space address. */
+		extern volatile uint8_t HostSim_DataSpace[0x100];
+
+	/* Function Prototypes: */
+		volatile uint8_t*        HostSim_Register(const uint8_t Address);
+		volatile HostSim_Word_t* HostSim_Register16(const uint8_t Address);
+		volatile uint8_t*        HostSim_EndpointFIFO(void);
+		uint16_t                 HostSim_EndpointByteCount(void);
+
+	/* Macros: */
+		#define _SFR_MEM8(Address)        HostSim_DataSpace[Address]
+		#define _SFR_MEM16(Address)       (*(volatile HostSim_Word_t*)&HostSim_DataSpace[Address])
+		#define _SFR_IO8(Address)         _SFR_MEM8((Address) + 0x20)
+		#define _SFR_IO16(Address)        _SFR_MEM16((Address) + 0x20)
+		#define _SFR_ADDR(Register)       ((uint8_t)((volatile uint8_t*)&(Register) - HostSim_DataSpace))
+		#define _SFR_IO_ADDR(Register)    (_SFR_ADDR(Register) - 0x20)
+
+		#if defined(HOSTSIM_MODEL)
+			#define _SFR_MODEL8(Address)  _SFR_MEM8(Address)
+			#define _SFR_MODEL16(Address) _SFR_MEM16(Address)
+		#else
+			#define _SFR_MODEL8(Address)  (*HostSim_Register(Address))
+			#define _SFR_MODEL16(Address) (*HostSim_Register16(Address))
+		#endif
+
+		/* Ports */
+		#define PINB       _SFR_IO8(0x03)
+		#define DDRB       _SFR_IO8(0x04)
+		#define PORTB      _SFR_IO8(0x05)
+		#define PINC       _SFR_IO8(0x06)
+		#define DDRC       _SFR_IO8(0x07)
+		#define PORTC      _SFR_IO8(0x08)
+		#define PIND       _SFR_IO8(0x09)
+		#define DDRD       _SFR_IO8(0x0A)
+		#define PORTD      _SFR_IO8(0x0B)
+		#define PINE       _SFR_IO8(0x0C)
+		#define DDRE       _SFR_IO8(0x0D)
+		#define PORTE      _SFR_IO8(0x0E)
+		#define PINF       _SFR_IO8(0x0F)
+		#define DDRF       _SFR_IO8(0x10)
+		#define PORTF      _SFR_IO8(0x11)
+
+		/* Interrupt flags, which are cleared by writing a one to them */
+		#define TIFR0      _SFR_MODEL8(0x35)
+		#define TIFR1      _SFR_MODEL8(0x36)
+		#define TIFR3      _SFR_MODEL8(0x38)
+		#define TIFR4      _SFR_MODEL8(0x39)
+		#define PCIFR      _SFR_MODEL8(0x3B)
+		#define EIFR       _SFR_IO8(0x1C)
+		#define EIMSK      _SFR_IO8(0x1D)
+
+		/* General purpose, EEPROM and timer 0 */
+		#define GPIOR0     _SFR_IO8(0x1E)
+		#define EECR       _SFR_IO8(0x1F)
+		#define EEDR       _SFR_IO8(0x20)
+		#define EEAR       _SFR_IO16(0x21)
+		#define GTCCR      _SFR_IO8(0x23)
+		#define TCCR0A     _SFR_MODEL8(0x44)
+		#define TCCR0B     _SFR_MODEL8(0x45)
+		#define TCNT0      _SFR_MODEL8(0x46)
+		#define OCR0A      _SFR_MODEL8(0x47)
+		#define OCR0B      _SFR_MODEL8(0x48)
+		#define PLLCSR     _SFR_MODEL8(0x49)
+		#define GPIOR1     _SFR_IO8(0x2A)
+		#define GPIOR2     _SFR_IO8(0x2B)
+		#define ACSR       _SFR_IO8(0x30)
+		#define PLLFRQ     _SFR_IO8(0x32)
+
+		/* System control */
+		#define SMCR       _SFR_IO8(0x33)
+		#define MCUSR      _SFR_IO8(0x34)
+		#define MCUCR      _SFR_IO8(0x35)
+		#define SPMCSR     _SFR_IO8(0x37)
+		#define SP         _SFR_IO16(0x3D)
+		#define SPL        _SFR_IO8(0x3D)
+		#define SPH        _SFR_IO8(0x3E)
+		#define SREG       _SFR_IO8(0x3F)
+		#define WDTCSR     _SFR_MEM8(0x60)
+		#define CLKPR      _SFR_MODEL8(0x61)
+		#define PRR0       _SFR_MODEL8(0x64)
+		#define PRR1       _SFR_MODEL8(0x65)
+		#define OSCCAL     _SFR_MEM8(0x66)
+		#define PCICR      _SFR_MODEL8(0x68)
+		#define EICRA      _SFR_MEM8(0x69)
+		#define EICRB      _SFR_MEM8(0x6A)
+		#define PCMSK0     _SFR_MODEL8(0x6B)
+		#define TIMSK0     _SFR_MODEL8(0x6E)
+		#define TIMSK1     _SFR_MODEL8(0x6F)
+		#define TIMSK3     _SFR_MODEL8(0x71)
+		#define TIMSK4     _SFR_MODEL8(0x72)
+
+		/* Analog */
+		#define ADC        _SFR_MEM16(0x78)
+		#define ADCSRA     _SFR_MEM8(0x7A)
+		#define ADCSRB     _SFR_MEM8(0x7B)
+		#define ADMUX      _SFR_MEM8(0x7C)
+		#define DIDR2      _SFR_MEM8(0x7D)
+		#define DIDR0      _SFR_MEM8(0x7E)
+		#define DIDR1      _SFR_MEM8(0x7F)
+
+		/* Timer 1 */
+		#define TCCR1A     _SFR_MODEL8(0x80)
+		#define TCCR1B     _SFR_MODEL8(0x81)
+		#define TCCR1C     _SFR_MEM8(0x82)
+		#define TCNT1      _SFR_MODEL16(0x84)
+		#define ICR1       _SFR_MODEL16(0x86)
+		#define OCR1A      _SFR_MODEL16(0x88)
+		#define OCR1B      _SFR_MODEL16(0x8A)
+		#define OCR1C      _SFR_MODEL16(0x8C)
+
+		/* Timer 3 */
+		#define TCCR3A     _SFR_MODEL8(0x90)
+		#define TCCR3B     _SFR_MODEL8(0x91)
+		#define TCCR3C     _SFR_MEM8(0x92)
+		#define TCNT3      _SFR_MODEL16(0x94)
+		#define ICR3       _SFR_MODEL16(0x96)
+		#define OCR3A      _SFR_MODEL16(0x98)
+		#define OCR3B      _SFR_MODEL16(0x9A)
+		#define OCR3C      _SFR_MODEL16(0x9C)
+
+		/* Timer 4 */
+		#define TCNT4      _SFR_MODEL8(0xBE)
+		#define TC4H       _SFR_MODEL8(0xBF)
+		#define TCCR4A     _SFR_MODEL8(0xC0)
+		#define TCCR4B     _SFR_MODEL8(0xC1)
+		#define TCCR4C     _SFR_MEM8(0xC2)
+		#define TCCR4D     _SFR_MEM8(0xC3)
+		#define TCCR4E     _SFR_MEM8(0xC4)
+		#define OCR4A      _SFR_MEM8(0xCF)
+		#define OCR4B      _SFR_MEM8(0xD0)
+		#define OCR4C      _SFR_MODEL8(0xD1)
+		#define OCR4D      _SFR_MEM8(0xD2)
+
+		/* USB controller */
+		#define UHWCON     _SFR_MODEL8(0xD7)
+		#define USBCON     _SFR_MODEL8(0xD8)
+		#define USBSTA     _SFR_MODEL8(0xD9)
+		#define USBINT     _SFR_MODEL8(0xDA)
+		#define UDCON      _SFR_MODEL8(0xE0)
+		#define UDINT      _SFR_MODEL8(0xE1)
+		#define UDIEN      _SFR_MODEL8(0xE2)
+		#define UDADDR     _SFR_MODEL8(0xE3)
+		#define UDFNUM     _SFR_MODEL16(0xE4)
+		#define UDFNUML    _SFR_MODEL8(0xE4)
+		#define UDFNUMH    _SFR_MODEL8(0xE5)
+		#define UDMFN      _SFR_MODEL8(0xE6)
+		#define UEINTX     _SFR_MODEL8(0xE8)
+		#define UENUM      _SFR_MODEL8(0xE9)
+		#define UERST      _SFR_MODEL8(0xEA)
+		#define UECONX     _SFR_MODEL8(0xEB)
+		#define UECFG0X    _SFR_MODEL8(0xEC)
+		#define UECFG1X    _SFR_MODEL8(0xED)
+		#define UESTA0X    _SFR_MODEL8(0xEE)
+		#define UESTA1X    _SFR_MODEL8(0xEF)
+		#define UEIENX     _SFR_MODEL8(0xF0)
+		#define UEINT      _SFR_MODEL8(0xF4)
+
+		#if defined(HOSTSIM_MODEL)
+			#define UEDATX     _SFR_MEM8(0xF1)
+			#define UEBCLX     _SFR_MEM8(0xF2)
+			#define UEBCHX     _SFR_MEM8(0xF3)
+		#else
+			#define UEDATX     (*HostSim_EndpointFIFO())
+			#define UEBCLX     ((uint8_t)HostSim_EndpointByteCount())
+			#define UEBCHX     ((uint8_t)(HostSim_EndpointByteCount() >> 8))
+		#endif
+
+		/* Port pins */
+		#define PB0        0
+		#define PB1        1
+		#define PB2        2
+		#define PB3        3
+		#define PB4        4
+		#define PB5        5
+		#define PB6        6
+		#define PB7        7
+		#define PC6        6
+		#define PC7        7
+		#define PD0        0
+		#define PD1        1
+		#define PD2        2
+		#define PD3        3
+		#define PD4        4
+		#define PD5        5
+		#define PD6        6
+		#define PD7        7
+		#define PE2        2
+		#define PE6        6
+		#define PF0        0
+		#define PF1        1
+		#define PF4        4
+		#define PF5        5
+		#define PF6        6
+		#define PF7        7
+
+		/* TIFR0, TIMSK0, TCCR0A, TCCR0B */
+		#define TOV0       0
+		#define OCF0A      1
+		#define OCF0B      2
+		#define TOIE0      0
+		#define OCIE0A     1
+		#define OCIE0B     2
+		#define WGM00      0
+		#define WGM01      1
+		#define COM0B0     4
+		#define COM0B1     5
+		#define COM0A0     6
+		#define COM0A1     7
+		#define CS00       0
+		#define CS01       1
+		#define CS02       2
+		#define WGM02      3
+
+		/* TIFR1, TIMSK1, TCCR1A, TCCR1B */
+		#define TOV1       0
+		#define OCF1A      1
+		#define OCF1B      2
+		#define OCF1C      3
+		#define ICF1       5
+		#define TOIE1      0
+		#define OCIE1A     1
+		#define OCIE1B     2
+		#define OCIE1C     3
+		#define ICIE1      5
+		#define WGM10      0
+		#define WGM11      1
+		#define CS10       0
+		#define CS11       1
+		#define CS12       2
+		#define WGM12      3
+		#define WGM13      4
+
+		/* TIFR3, TIMSK3, TCCR3A, TCCR3B */
+		#define TOV3       0
+		#define OCF3A      1
+		#define OCF3B      2
+		#define OCF3C      3
+		#define ICF3       5
+		#define TOIE3      0
+		#define OCIE3A     1
+		#define OCIE3B     2
+		#define OCIE3C     3
+		#define WGM30      0
+		#define WGM31      1
+		#define CS30       0
+		#define CS31       1
+		#define CS32       2
+		#define WGM32      3
+		#define WGM33      4
+
+		/* TIFR4, TIMSK4, TCCR4B */
+		#define TOV4       2
+		#define OCF4B      5
+		#define OCF4A      6
+		#define OCF4D      7
+		#define TOIE4      2
+		#define OCIE4B     5
+		#define OCIE4A     6
+		#define OCIE4D     7
+		#define CS40       0
+		#define CS41       1
+		#define CS42       2
+		#define CS43       3
+
+		/* PCIFR, PCICR, PCMSK0 */
+		#define PCIF0      0
+		#define PCIE0      0
+		#define PCINT0     0
+		#define PCINT1     1
+		#define PCINT2     2
+		#define PCINT3     3
+		#define PCINT4     4
+		#define PCINT5     5
+		#define PCINT6     6
+		#define PCINT7     7
+
+		/* SMCR */
+		#define SE         0
+		#define SM0        1
+		#define SM1        2
+		#define SM2        3
+
+		/* MCUSR, MCUCR */
+		#define PORF       0
+		#define EXTRF      1
+		#define BORF       2
+		#define WDRF       3
+		#define JTRF       4
+		#define IVCE       0
+		#define IVSEL      1
+		#define PUD        4
+		#define JTD        7
+
+		/* SPMCSR */
+		#define SPMEN      0
+		#define PGERS      1
+		#define PGWRT      2
+		#define BLBSET     3
+		#define RWWSRE     4
+		#define SIGRD      5
+		#define RWWSB      6
+		#define SPMIE      7
+
+		/* WDTCSR */
+		#define WDP0       0
+		#define WDP1       1
+		#define WDP2       2
+		#define WDE        3
+		#define WDCE       4
+		#define WDP3       5
+		#define WDIE       6
+		#define WDIF       7
+
+		/* CLKPR */
+		#define CLKPS0     0
+		#define CLKPS1     1
+		#define CLKPS2     2
+		#define CLKPS3     3
+		#define CLKPCE     7
+
+		/* PRR0, PRR1 */
+		#define PRADC      0
+		#define PRUSART0   1
+		#define PRSPI      2
+		#define PRTIM1     3
+		#define PRTIM0     5
+		#define PRTIM2     6
+		#define PRTWI      7
+		#define PRUSART1   0
+		#define PRTIM3     3
+		#define PRTIM4     4
+		#define PRUSB      7
+
+		/* EECR */
+		#define EERE       0
+		#define EEPE       1
+		#define EEMPE      2
+		#define EERIE      3
+
+		/* ACSR, ADCSRA */
+		#define ACD        7
+		#define ADEN       7
+
+		/* PLLCSR, PLLFRQ */
+		#define PLOCK      0
+		#define PLLE       1
+		#define PINDIV     4
+		#define PDIV0      0
+		#define PDIV1      1
+		#define PDIV2      2
+		#define PDIV3      3
+		#define PLLTM0     4
+		#define PLLTM1     5
+		#define PLLUSB     6
+		#define PINMUX     7
+
+		/* UHWCON, USBCON, USBSTA, USBINT */
+		#define UVREGE     0
+		#define VBUSTE     0
+		#define OTGPADE    4
+		#define FRZCLK     5
+		#define USBE       7
+		#define VBUS       0
+		#define ID         1
+		#define SPEED      3
+		#define VBUSTI     0
+
+		/* UDCON, UDINT, UDIEN, UDADDR */
+		#define DETACH     0
+		#define RMWKUP     1
+		#define LSM        2
+		#define RSTCPU     3
+		#define SUSPI      0
+		#define MSOFI      1
+		#define SOFI       2
+		#define EORSTI     3
+		#define WAKEUPI    4
+		#define EORSMI     5
+		#define UPRSMI     6
+		#define SUSPE      0
+		#define MSOFE      1
+		#define SOFE       2
+		#define EORSTE     3
+		#define WAKEUPE    4
+		#define EORSME     5
+		#define UPRSME     6
+		#define ADDEN      7
+
+		/* UEINTX, UECONX, UECFG0X, UECFG1X, UESTA0X, UESTA1X, UEIENX */
+		#define TXINI      0
+		#define STALLEDI   1
+		#define RXOUTI     2
+		#define RXSTPI     3
+		#define NAKOUTI    4
+		#define RWAL       5
+		#define NAKINI     6
+		#define FIFOCON    7
+		#define EPEN       0
+		#define RSTDT      3
+		#define STALLRQC   4
+		#define STALLRQ    5
+		#define EPDIR      0
+		#define EPTYPE0    6
+		#define EPTYPE1    7
+		#define ALLOC      1
+		#define EPBK0      2
+		#define EPBK1      3
+		#define EPSIZE0    4
+		#define EPSIZE1    5
+		#define EPSIZE2    6
+		#define NBUSYBK0   0
+		#define NBUSYBK1   1
+		#define DTSEQ0     2
+		#define DTSEQ1     3
+		#define UNDERFI    5
+		#define OVERFI     6
+		#define CFGOK      7
+		#define CURRBK0    0
+		#define CURRBK1    1
+		#define CTRLDIR    2
+		#define TXINE      0
+		#define STALLEDE   1
+		#define RXOUTE     2
+		#define RXSTPE     3
+		#define NAKOUTE    4
+		#define NAKINE     6
+		#define FLERRE     7
+		#define EPINT0     0
+
+		/* Memory sizes */
+		#define RAMSTART     0x0100
+		#define RAMEND       0x0AFF
+		#define E2END        0x03FF
+		#define FLASHEND     0x7FFF
+		#define SPM_PAGESIZE 128
+
+#endif
@@ -0,0 +1,51 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc program space header, used by the host simulation build. The host has a
+ *  single address space, so program space reads are ordinary reads.
+ */
+
+#ifndef _HOSTSIM_AVR_PGMSPACE_H_
+#define _HOSTSIM_AVR_PGMSPACE_H_
+
+	/* Includes: */
+		#include <stdint.h>
+		#include <string.h>
+
+	/* Macros: */
+		#define PROGMEM
+		#define PSTR(String)            (String)
+
+		#define pgm_read_byte(Address)  (*(const uint8_t*)(Address))
+		#define pgm_read_word(Address)  (*(const uint16_t*)(Address))
+		#define pgm_read_dword(Address) (*(const uint32_t*)(Address))
+		//Replaces the 16-bit pointer read LUFA defines when it is included before this header
+		#undef  pgm_read_ptr
+		#define pgm_read_ptr(Address)   (*(void* const*)(Address))
+
+		#define memcpy_P                memcpy
+		#define strlen_P                strlen
+		#define printf_P                printf
+
+#endif
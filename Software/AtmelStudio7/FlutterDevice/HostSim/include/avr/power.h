@@ -0,0 +1,65 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc power reduction header, used by the host simulation build.
+ */
+
+#ifndef _HOSTSIM_AVR_POWER_H_
+#define _HOSTSIM_AVR_POWER_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Type Defines: */
+		typedef enum
+		{
+			clock_div_1   = 0,
+			clock_div_2   = 1,
+			clock_div_4   = 2,
+			clock_div_8   = 3,
+			clock_div_16  = 4,
+			clock_div_32  = 5,
+			clock_div_64  = 6,
+			clock_div_128 = 7,
+			clock_div_256 = 8,
+		} clock_div_t;
+
+	/* Macros: */
+		#define clock_prescale_set(Division)  do { CLKPR = (1 << CLKPCE); CLKPR = (Division); } while (0)
+		#define clock_prescale_get()          ((clock_div_t)(CLKPR & 0x0F))
+
+		#define power_all_enable()      do { PRR0 = 0; PRR1 = 0; } while (0)
+		#define power_all_disable()     do { PRR0 = 0xAD; PRR1 = 0x99; } while (0)
+		#define power_adc_disable()     do { PRR0 |= (1 << PRADC); } while (0)
+		#define power_spi_disable()     do { PRR0 |= (1 << PRSPI); } while (0)
+		#define power_twi_disable()     do { PRR0 |= (1 << PRTWI); } while (0)
+		#define power_timer0_disable()  do { PRR0 |= (1 << PRTIM0); } while (0)
+		#define power_timer0_enable()   do { PRR0 &= ~(1 << PRTIM0); } while (0)
+		#define power_timer1_disable()  do { PRR0 |= (1 << PRTIM1); } while (0)
+		#define power_timer1_enable()   do { PRR0 &= ~(1 << PRTIM1); } while (0)
+		#define power_usart1_disable()  do { PRR1 |= (1 << PRUSART1); } while (0)
+		#define power_usb_disable()     do { PRR1 |= (1 << PRUSB); } while (0)
+		#define power_usb_enable()      do { PRR1 &= ~(1 << PRUSB); } while (0)
+
+#endif
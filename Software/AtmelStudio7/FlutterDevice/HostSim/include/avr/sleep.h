@@ -0,0 +1,52 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc sleep header, used by the host simulation build. Sleeping hands the host
+ *  side the rest of the current time slice until an enabled interrupt becomes pending.
+ */
+
+#ifndef _HOSTSIM_AVR_SLEEP_H_
+#define _HOSTSIM_AVR_SLEEP_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Function Prototypes: */
+		void HostSim_Sleep(void);
+
+	/* Macros: */
+		#define SLEEP_MODE_IDLE         (0)
+		#define SLEEP_MODE_ADC          (1 << SM0)
+		#define SLEEP_MODE_PWR_DOWN     (1 << SM1)
+		#define SLEEP_MODE_PWR_SAVE     ((1 << SM0) | (1 << SM1))
+		#define SLEEP_MODE_STANDBY      ((1 << SM1) | (1 << SM2))
+		#define SLEEP_MODE_EXT_STANDBY  ((1 << SM0) | (1 << SM1) | (1 << SM2))
+
+		#define set_sleep_mode(Mode)    do { SMCR = ((SMCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (Mode)); } while (0)
+		#define sleep_enable()          do { SMCR |=  (1 << SE); } while (0)
+		#define sleep_disable()         do { SMCR &= ~(1 << SE); } while (0)
+		#define sleep_cpu()             do { if (SMCR & (1 << SE)) HostSim_Sleep(); } while (0)
+		#define sleep_mode()            do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+
+#endif
@@ -0,0 +1,51 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc watchdog header, used by the host simulation build. The watchdog is not
+ *  simulated, so the supervisor of \c WATCHDOG_ENABLED builds is inert on the host.
+ */
+
+#ifndef _HOSTSIM_AVR_WDT_H_
+#define _HOSTSIM_AVR_WDT_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Macros: */
+		#define WDTO_15MS               0
+		#define WDTO_30MS               1
+		#define WDTO_60MS               2
+		#define WDTO_120MS              3
+		#define WDTO_250MS              4
+		#define WDTO_500MS              5
+		#define WDTO_1S                 6
+		#define WDTO_2S                 7
+		#define WDTO_4S                 8
+		#define WDTO_8S                 9
+
+		#define wdt_reset()             do { } while (0)
+		#define wdt_enable(Timeout)     do { WDTCSR = ((1 << WDE) | ((Timeout) & 0x07) | (((Timeout) & 0x08) << 2)); } while (0)
+		#define wdt_disable()           do { WDTCSR = 0; } while (0)
+
+#endif
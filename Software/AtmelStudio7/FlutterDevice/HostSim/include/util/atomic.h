@@ -0,0 +1,72 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc atomic block helpers, used by the host simulation build. As on the target,
+ *  the previous interrupt state is restored however the block is left.
+ */
+
+#ifndef _HOSTSIM_UTIL_ATOMIC_H_
+#define _HOSTSIM_UTIL_ATOMIC_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/interrupt.h>
+
+	/* Inline Functions: */
+		static inline uint8_t HostSim_AtomicEnter(void)
+		{
+			cli();
+			return 1;
+		}
+
+		static inline void HostSim_AtomicRestore(const uint8_t* const SavedSREG)
+		{
+			if (*SavedSREG & 0x80)
+			  sei();
+			else
+			  cli();
+		}
+
+		static inline void HostSim_AtomicForceOn(const uint8_t* const Unused)
+		{
+			(void)Unused;
+			sei();
+		}
+
+		static inline void HostSim_AtomicForceOff(const uint8_t* const Unused)
+		{
+			(void)Unused;
+			cli();
+		}
+
+	/* Macros: */
+		#define ATOMIC_BLOCK(Type)      for (Type, HostSim_AtomicToDo = HostSim_AtomicEnter(); HostSim_AtomicToDo; HostSim_AtomicToDo = 0)
+		#define NONATOMIC_BLOCK(Type)   for (Type, HostSim_AtomicToDo = (sei(), 1); HostSim_AtomicToDo; HostSim_AtomicToDo = 0)
+
+		#define ATOMIC_RESTORESTATE     uint8_t HostSim_AtomicSREG __attribute__((__cleanup__(HostSim_AtomicRestore))) = SREG
+		#define ATOMIC_FORCEON          uint8_t HostSim_AtomicSREG __attribute__((__cleanup__(HostSim_AtomicForceOn))) = 0
+		#define NONATOMIC_RESTORESTATE  uint8_t HostSim_AtomicSREG __attribute__((__cleanup__(HostSim_AtomicRestore))) = SREG
+		#define NONATOMIC_FORCEOFF      uint8_t HostSim_AtomicSREG __attribute__((__cleanup__(HostSim_AtomicForceOff))) = 0
+
+#endif
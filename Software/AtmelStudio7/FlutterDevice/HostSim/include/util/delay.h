@@ -0,0 +1,42 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Host replacement for the avr-libc busy wait delays, used by the host simulation build. A delay advances the
+ *  virtual clock by the number of cycles it would spin for on the target, servicing interrupts meanwhile.
+ */
+
+#ifndef _HOSTSIM_UTIL_DELAY_H_
+#define _HOSTSIM_UTIL_DELAY_H_
+
+	/* Includes: */
+		#include <stdint.h>
+
+	/* Function Prototypes: */
+		void HostSim_Delay(const uint32_t Cycles);
+
+	/* Macros: */
+		#define _delay_ms(Milliseconds) HostSim_Delay((uint32_t)((Milliseconds) * (F_CPU / 1000.0)))
+		#define _delay_us(Microseconds) HostSim_Delay((uint32_t)((Microseconds) * (F_CPU / 1000000.0)))
+
+#endif
@@ -0,0 +1,79 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display report throughput benchmark. This script sends output
+    reports to the device back to back for a fixed time and prints the
+    sustained reports/s and bytes/s, so that firmware built with the default
+    8 byte reports can be compared against one built with
+    GENERIC_FULL_SPEED_REPORTS. Each report is filled with as many SET_LEVEL
+    commands as fit, so the command bytes/s figure shows how many commands the
+    device can take in per second. With --input, input reports are counted
+    instead while the encoder is turned as fast as possible.
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import argparse
+import time
+from flutter_device import open_device
+
+
+def benchmark_output(flutter, seconds):
+    # Fill the report with level commands, sweeping the level so the LEDs show progress
+    report_count = 0
+    command_count = 0
+    start = time.time()
+    while (time.time() - start) < seconds:
+        stream = flutter.commands()
+        try:
+            while True:
+                stream.set_level(report_count & 0x3F)
+                command_count += 1
+        except ValueError:
+            pass
+
+        flutter.send_commands(stream)
+        report_count += 1
+
+    return report_count, command_count * 3, time.time() - start
+
+
+def benchmark_input(flutter, seconds):
+    report_count = 0
+    missed_count = 0
+    start = time.time()
+    while (time.time() - start) < seconds:
+        report = flutter.read_input(timeout=100)
+        if report is None:
+            continue
+
+        report_count += 1
+        missed_count += report.missed
+
+    return report_count, missed_count, time.time() - start
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure Flutter Display report throughput.")
+    parser.add_argument("--seconds", type=float, default=5.0, help="length of the measurement")
+    parser.add_argument("--input", action="store_true", help="count input reports instead of sending output reports")
+    args = parser.parse_args()
+
+    flutter = open_device()
+    print("Report length {0} bytes, OUT endpoint {1}".format(
+          flutter.report_length, "present" if flutter.out_endpoint is not None else "absent (SET_REPORT)"))
+
+    if args.input:
+        print("Turn the encoder for {0:.0f} seconds...".format(args.seconds))
+        report_count, missed_count, elapsed = benchmark_input(flutter, args.seconds)
+        print("{0} input reports in {1:.2f}s: {2:.1f} reports/s, {3:.0f} bytes/s, {4} missed".format(
+              report_count, elapsed, report_count / elapsed,
+              report_count * flutter.report_length / elapsed, missed_count))
+    else:
+        report_count, command_bytes, elapsed = benchmark_output(flutter, args.seconds)
+        print("{0} output reports in {1:.2f}s: {2:.1f} reports/s, {3:.0f} bytes/s, {4:.0f} command bytes/s".format(
+              report_count, elapsed, report_count / elapsed,
+              report_count * flutter.report_length / elapsed, command_bytes / elapsed))
+
+if __name__ == '__main__':
+    main()
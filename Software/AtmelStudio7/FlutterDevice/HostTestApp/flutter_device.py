@@ -0,0 +1,407 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display host library. This module opens a Flutter Display over
+    libusb, sends it output reports and decodes the input reports it sends.
+    Output reports carry a stream of [type][length][value] commands, built
+    with the CommandStream class, so several commands share one report.
+    Output reports go over the interrupt OUT endpoint when the firmware has
+    one, falling back to a control SET_REPORT request. Run it directly to print
+    the encoder and button input of every attached unit as it arrives, along
+    with any gaps in the report sequence numbers.
+
+    Each unit reports a unique USB serial number. open_device() opens the unit
+    with the serial number given, or in the FLUTTER_SERIAL environment
+    variable, and otherwise the first unit found; open_devices() opens them
+    all, and each can then be driven from its own thread.
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import os
+import sys
+import threading
+from collections import namedtuple
+import usb.core
+import usb.util
+
+# Flutter Display VID, PID and default report payload length (firmware built
+# with GENERIC_FULL_SPEED_REPORTS uses 64 byte reports, read from the endpoints)
+device_vid = 0x2341
+device_pid = 0x8036
+report_length = 8
+
+# Offsets of the fields within an IN report
+REPORT_IN_SEQUENCE = 0
+REPORT_IN_STEPS = 1
+REPORT_IN_BUTTONS = 2
+REPORT_IN_COUNT = 3
+REPORT_IN_TRACE_ID = 4
+REPORT_IN_TRACE_ARRIVED = 5
+REPORT_IN_TRACE_SHOWN = 6
+
+# Feature report layout, ladder level map pages, the render probe page, the low
+# power statistics page, the stall watchdog pages (only answered by firmware
+# built with WATCHDOG_ENABLED) and the profiling statistics pages (only answered
+# by firmware built with PROFILE_ENABLED)
+feature_length = 8
+FEATURE_SELECT_ONLY = 0x80
+FEATURE_PAGE_LADDER = 0x00
+FEATURE_PAGE_WATCHDOG = 0x30
+FEATURE_PAGE_PROBE = 0x40
+FEATURE_PAGE_POWER = 0x48
+FEATURE_PAGE_PROFILE = 0x50
+LADDER_PAGE_ENTRIES = 8
+LADDER_PAGE_COUNT = 256 // LADDER_PAGE_ENTRIES
+PROFILE_PAGE_COUNT = 8
+PROFILE_PAGE_BUCKETS = 3
+PROFILE_BUCKET_COUNT = 17
+WATCHDOG_STALL_RECORDS = 4
+WATCHDOG_ADDRESS_UNKNOWN = 0xFFFF
+
+# Profiling probes, in firmware probe order
+PROFILE_PROBES = ["HID task", "USB task", "USB ISR", "Display ISR"]
+
+# Command types understood in an output report command stream
+COMMAND_END = 0x00
+COMMAND_SET_NUMBER = 0x01
+COMMAND_SET_LEDS = 0x02
+COMMAND_SET_LEVEL = 0x03
+COMMAND_SET_THRESHOLDS = 0x04
+COMMAND_SET_BRIGHTNESS = 0x05
+COMMAND_SET_REFRESH = 0x06
+COMMAND_METER_SAMPLES = 0x07
+COMMAND_SET_METER = 0x08
+COMMAND_ANIM_KEYFRAME = 0x09
+COMMAND_ANIM_START = 0x0A
+COMMAND_ANIM_STOP = 0x0B
+COMMAND_SET_ENCODER = 0x0C
+COMMAND_TRACE = 0x0D
+COMMAND_SET_BUTTONS = 0x0E
+
+# Trace ID of IN reports without a trace result
+TRACE_ID_NONE = 0
+
+# Button gesture flags, GESTURE_BITS bits per button in the IN report buttons field
+GESTURE_CLICK = 0x01
+GESTURE_DOUBLE_CLICK = 0x02
+GESTURE_LONG_PRESS = 0x04
+GESTURE_BITS = 3
+GESTURE_NAMES = [(GESTURE_CLICK, "click"), (GESTURE_DOUBLE_CLICK, "double click"), (GESTURE_LONG_PRESS, "long press")]
+BUTTON_COUNT = 2
+
+# Animation keyframe flags and loop count
+ANIMATION_KEY_STEP = 0x01
+ANIMATION_LOOP_FOREVER = 0
+
+InputReport = namedtuple("InputReport", ["sequence", "steps", "button_edges", "count", "missed",
+                                         "trace_id", "trace_arrived", "trace_shown"])
+ProfileStats = namedtuple("ProfileStats", ["count", "min", "max", "sum", "histogram"])
+WatchdogStats = namedtuple("WatchdogStats", ["stalls", "reset_flags", "max_cycles", "max_frames", "records"])
+StallRecord = namedtuple("StallRecord", ["address", "device_state"])
+PowerStats = namedtuple("PowerStats", ["suspends", "remote_wakeups", "smcr", "prr0", "prr1", "tccr0b", "clkpr"])
+
+
+class CommandStream(object):
+    def __init__(self, length=report_length):
+        self.length = length
+        self.data = []
+
+    def add(self, command_type, value):
+        value = list(value)
+        if len(self.data) + 2 + len(value) > self.length:
+            raise ValueError("Command 0x%02X does not fit in the report" % command_type)
+        self.data += [command_type, len(value)] + value
+        return self
+
+    def set_number(self, number):
+        return self.add(COMMAND_SET_NUMBER, [number & 0xFF])
+
+    def set_leds(self, mask):
+        return self.add(COMMAND_SET_LEDS, [mask & 0x0F])
+
+    def set_level(self, level):
+        return self.add(COMMAND_SET_LEVEL, [level & 0xFF])
+
+    def set_thresholds(self, thresholds):
+        return self.add(COMMAND_SET_THRESHOLDS, [threshold & 0xFF for threshold in thresholds])
+
+    def set_brightness(self, level, ones_level=None):
+        # One level sets both digits, two levels set the ten's then the one's digit
+        if ones_level is None:
+            return self.add(COMMAND_SET_BRIGHTNESS, [level & 0x0F])
+        return self.add(COMMAND_SET_BRIGHTNESS, [level & 0x0F, ones_level & 0x0F])
+
+    def set_refresh(self, refresh_hz):
+        return self.add(COMMAND_SET_REFRESH, [refresh_hz & 0xFF])
+
+    def meter_samples(self, samples):
+        return self.add(COMMAND_METER_SAMPLES, [sample & 0xFF for sample in samples])
+
+    def set_meter(self, attack, release, peak_hold=0, peak_decay=0, sample_period=1):
+        # Attack and release are fractions of 256 per frame (255 is instant), times are in display frames
+        return self.add(COMMAND_SET_METER, [attack & 0xFF, release & 0xFF, peak_hold & 0xFF,
+                                            peak_decay & 0xFF, sample_period & 0xFF])
+
+    def anim_keyframe(self, slot, index, frames, number, level, brightness, flags=0):
+        # Frames is the time in display frames taken to reach this keyframe from the previous one
+        return self.add(COMMAND_ANIM_KEYFRAME, [((slot & 0x0F) << 4) | (index & 0x0F), frames & 0xFF,
+                                                number & 0xFF, level & 0xFF,
+                                                ((brightness & 0x0F) << 4) | (flags & 0x0F)])
+
+    def anim_start(self, slot, keyframes, loops=ANIMATION_LOOP_FOREVER):
+        return self.add(COMMAND_ANIM_START, [slot & 0xFF, keyframes & 0xFF, loops & 0xFF])
+
+    def anim_stop(self):
+        return self.add(COMMAND_ANIM_STOP, [])
+
+    def set_encoder(self, max_count, accel_curve):
+        # Accel curve is 0 for none, 1 for gentle and 2 for steep
+        return self.add(COMMAND_SET_ENCODER, [max_count & 0xFF, accel_curve & 0xFF])
+
+    def set_buttons(self, long_press_ms, double_click_ms):
+        # Times are sent in 10ms units, zero disables the gesture
+        return self.add(COMMAND_SET_BUTTONS, [min(long_press_ms // 10, 0xFF), min(double_click_ms // 10, 0xFF)])
+
+    def trace(self, trace_id):
+        # The trace is returned in an IN report once the display shows the changes of the whole report
+        if trace_id == TRACE_ID_NONE:
+            raise ValueError("Trace ID 0x%02X is reserved" % trace_id)
+        return self.add(COMMAND_TRACE, [trace_id & 0xFF])
+
+    def report(self):
+        # The zero padding of the report doubles as the end of stream marker
+        return self.data + [COMMAND_END] * (self.length - len(self.data))
+
+
+class FlutterDevice(object):
+    def __init__(self, device):
+        self.device = device
+        self.serial_number = device_serial_number(device)
+        self.last_sequence = None
+
+        if device.is_kernel_driver_active(0):
+            try:
+                device.detach_kernel_driver(0)
+            except usb.core.USBError as exception:
+                sys.exit("Could not detatch kernel driver: %s" % str(exception))
+
+        try:
+            device.set_configuration()
+        except usb.core.USBError as exception:
+            sys.exit("Could not set configuration: %s" % str(exception))
+
+        interface = device[0][(0, 0)]
+        self.in_endpoint = usb.util.find_descriptor(interface, custom_match=lambda e:
+            usb.util.endpoint_direction(e.bEndpointAddress) == usb.util.ENDPOINT_IN)
+        self.out_endpoint = usb.util.find_descriptor(interface, custom_match=lambda e:
+            usb.util.endpoint_direction(e.bEndpointAddress) == usb.util.ENDPOINT_OUT)
+        self.report_length = self.in_endpoint.wMaxPacketSize
+
+    def commands(self):
+        return CommandStream(self.report_length)
+
+    def write_report(self, report_data):
+        # Zero-extend the report to the length the device expects
+        report_data = list(report_data) + [0] * (self.report_length - len(report_data))
+
+        if self.out_endpoint is not None:
+            number_of_bytes_written = self.device.write(self.out_endpoint.bEndpointAddress, report_data)
+        else:
+            number_of_bytes_written = self.device.ctrl_transfer(  # Set Report control request
+                0b00100001,  # bmRequestType (constant for this control request)
+                0x09,        # bmRequest (constant for this control request)
+                0x0200,      # wValue (MSB is report type, LSB is report number)
+                0,           # wIndex (interface number)
+                report_data  # report data to be sent
+            )
+        assert number_of_bytes_written == len(report_data)
+
+    def send_commands(self, stream):
+        self.write_report(stream.report())
+
+    def set_feature(self, report_data):
+        report_data = list(report_data) + [0] * (feature_length - len(report_data))
+        number_of_bytes_written = self.device.ctrl_transfer(  # Set Report control request
+            0b00100001,  # bmRequestType (constant for this control request)
+            0x09,        # bmRequest (constant for this control request)
+            0x0300,      # wValue (MSB is report type, LSB is report number)
+            0,           # wIndex (interface number)
+            report_data  # report data to be sent
+        )
+        assert number_of_bytes_written == len(report_data)
+
+    def get_feature(self, page):
+        # Select the page without writing it, then read it back
+        self.set_feature([page | FEATURE_SELECT_ONLY])
+        return list(self.device.ctrl_transfer(  # Get Report control request
+            0b10100001,  # bmRequestType (constant for this control request)
+            0x01,        # bmRequest (constant for this control request)
+            0x0300,      # wValue (MSB is report type, LSB is report number)
+            0,           # wIndex (interface number)
+            feature_length
+        ))
+
+    def write_ladder_map(self, masks):
+        # Masks of all 256 levels, packed two to a byte with even levels in the low nibble
+        for page in range(LADDER_PAGE_COUNT):
+            entries = masks[page * LADDER_PAGE_ENTRIES:(page + 1) * LADDER_PAGE_ENTRIES]
+            packed = [(entries[i] & 0x0F) | ((entries[i + 1] & 0x0F) << 4) for i in range(0, len(entries), 2)]
+            self.set_feature([FEATURE_PAGE_LADDER + page] + packed)
+
+    def read_ladder_map(self):
+        masks = []
+        for page in range(LADDER_PAGE_COUNT):
+            report = self.get_feature(FEATURE_PAGE_LADDER + page)
+            for packed in report[1:1 + LADDER_PAGE_ENTRIES // 2]:
+                masks += [packed & 0x0F, packed >> 4]
+        return masks
+
+    def probe_ladder(self, level):
+        # Returns the ladder mask the device renders for a level
+        self.set_feature([FEATURE_PAGE_PROBE, level])
+        report = self.get_feature(FEATURE_PAGE_PROBE)
+        assert report[1] == level
+        return report[2]
+
+    def read_profile(self, probe):
+        # Latching a probe's statistics resets them on the device, so each read covers the time since the last one
+        first_page = FEATURE_PAGE_PROFILE + probe * PROFILE_PAGE_COUNT
+        self.set_feature([first_page])
+
+        words = []
+        for page in range(PROFILE_PAGE_COUNT):
+            report = self.get_feature(first_page + page)
+            words += [report[1 + i * 2] | (report[2 + i * 2] << 8) for i in range(PROFILE_PAGE_BUCKETS)]
+
+        return ProfileStats(count=words[0], min=words[1], max=words[2], sum=words[3] | (words[4] << 16),
+                            histogram=words[2 * PROFILE_PAGE_BUCKETS:][:PROFILE_BUCKET_COUNT])
+
+    def read_power(self, clear=False):
+        # The registers are those last seen by the firmware as it went to sleep while suspended
+        report = self.get_feature(FEATURE_PAGE_POWER)
+        if clear:
+            self.set_feature([FEATURE_PAGE_POWER])
+        return PowerStats(*report[1:8])
+
+    def read_watchdog(self, clear=False):
+        # Stall records survive the watchdog reset, oldest first; the longest iteration covers the time since start-up
+        summary = self.get_feature(FEATURE_PAGE_WATCHDOG)
+        records = []
+        for page in range(1, 1 + min(summary[1], WATCHDOG_STALL_RECORDS)):
+            report = self.get_feature(FEATURE_PAGE_WATCHDOG + page)
+            records.append(StallRecord(address=report[1] | (report[2] << 8), device_state=report[3]))
+
+        if clear:
+            self.set_feature([FEATURE_PAGE_WATCHDOG])
+
+        return WatchdogStats(stalls=summary[2], reset_flags=summary[3], max_cycles=summary[4] | (summary[5] << 8),
+                             max_frames=summary[6] | (summary[7] << 8), records=records)
+
+    def read_input(self, timeout=1000):
+        # Reports are only sent when there is new input, so a timeout just means nothing happened
+        try:
+            data = self.device.read(self.in_endpoint.bEndpointAddress, self.in_endpoint.wMaxPacketSize, timeout)
+        except usb.core.USBTimeoutError:
+            return None
+
+        sequence = data[REPORT_IN_SEQUENCE]
+        missed = 0
+        if self.last_sequence is not None:
+            missed = (sequence - self.last_sequence - 1) & 0xFF
+        self.last_sequence = sequence
+
+        steps = data[REPORT_IN_STEPS]
+        if steps >= 0x80:
+            steps -= 0x100
+
+        return InputReport(sequence, steps, data[REPORT_IN_BUTTONS], data[REPORT_IN_COUNT], missed,
+                           data[REPORT_IN_TRACE_ID], data[REPORT_IN_TRACE_ARRIVED], data[REPORT_IN_TRACE_SHOWN])
+
+
+def decode_gestures(button_field):
+    # Returns (button number, gesture name) pairs, buttons numbered from 1
+    return [(button + 1, name) for button in range(BUTTON_COUNT) for flag, name in GESTURE_NAMES
+            if (button_field >> (button * GESTURE_BITS)) & flag]
+
+
+def device_serial_number(device):
+    # Firmware from before serial numbers were reported has none
+    if not device.iSerialNumber:
+        return None
+    try:
+        return usb.util.get_string(device, device.iSerialNumber)
+    except (usb.core.USBError, ValueError):
+        return None
+
+
+def find_devices():
+    # Every attached unit, in serial number order so that units keep their position between runs
+    devices = list(usb.core.find(find_all=True, idVendor=device_vid, idProduct=device_pid))
+    return sorted(devices, key=lambda device: device_serial_number(device) or "")
+
+
+def open_devices():
+    devices = find_devices()
+
+    if not devices:
+        sys.exit("Could not find USB device.")
+
+    return [FlutterDevice(device) for device in devices]
+
+
+def open_device(serial_number=None):
+    if serial_number is None:
+        serial_number = os.environ.get("FLUTTER_SERIAL")
+
+    devices = find_devices()
+    if serial_number is not None:
+        devices = [device for device in devices if device_serial_number(device) == serial_number]
+
+    if not devices:
+        sys.exit("Could not find USB device{0}.".format(
+                 "" if serial_number is None else " with serial number " + serial_number))
+
+    return FlutterDevice(devices[0])
+
+
+def print_input(flutter, lock):
+    while (True):
+        report = flutter.read_input()
+        if report is None:
+            continue
+
+        # Units print from their own threads, so each report is printed whole
+        with lock:
+            if report.missed:
+                print("[{0}] Missed {1} report(s)".format(flutter.serial_number, report.missed))
+
+            print("[{0}] Sequence {1:3}: steps {2:+4}, buttons 0x{3:02X}, count {4}".format(
+                  flutter.serial_number, report.sequence, report.steps, report.button_edges, report.count))
+
+            for button, gesture in decode_gestures(report.button_edges):
+                print("[{0}]   Button {1}: {2}".format(flutter.serial_number, button, gesture))
+
+
+def main():
+    units = open_devices()
+    lock = threading.Lock()
+
+    for flutter in units:
+        print("Connected to device 0x%04X/0x%04X - %s [%s], serial number %s" %
+              (flutter.device.idVendor, flutter.device.idProduct,
+               usb.util.get_string(flutter.device, flutter.device.iProduct),
+               usb.util.get_string(flutter.device, flutter.device.iManufacturer),
+               flutter.serial_number))
+
+    threads = [threading.Thread(target=print_input, args=(flutter, lock)) for flutter in units]
+    for thread in threads:
+        thread.daemon = True
+        thread.start()
+
+    while any(thread.is_alive() for thread in threads):
+        for thread in threads:
+            thread.join(1)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,77 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display multi-unit test. This script opens every attached unit,
+    shows each unit's position in serial number order on its display so the
+    units can be told apart, then drives all of them at once for a while, one
+    thread per unit, each sweeping its own LED ladder. It prints each unit's
+    serial number and the reports written to it, and fails if a write to any
+    unit fails. Set FLUTTER_SERIAL to a serial number listed here to have the
+    other scripts use that unit.
+
+    Usage: multi_unit.py [seconds]
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import sys
+import time
+import threading
+import usb.core
+from flutter_device import open_devices
+
+
+def drive(flutter, unit, seconds, results):
+    writes = 0
+    deadline = time.time() + seconds
+
+    try:
+        while time.time() < deadline:
+            # Sweep each unit's ladder at its own phase, so crossed reports would show on the wrong unit
+            level = (writes * 5 + unit * 64) & 0xFF
+            flutter.send_commands(flutter.commands().set_number(unit + 1).set_level(level))
+            writes += 1
+    except usb.core.USBError as exception:
+        results[unit] = (writes, str(exception))
+        return
+
+    results[unit] = (writes, None)
+
+
+def main():
+    seconds = float(sys.argv[1]) if len(sys.argv) > 1 else 5.0
+    units = open_devices()
+
+    for unit, flutter in enumerate(units):
+        print("Unit {0}: serial number {1}".format(unit + 1, flutter.serial_number))
+
+    serial_numbers = [flutter.serial_number for flutter in units]
+    if None in serial_numbers or len(set(serial_numbers)) != len(serial_numbers):
+        print("Units without unique serial numbers cannot be told apart")
+
+    results = {}
+    threads = [threading.Thread(target=drive, args=(flutter, unit, seconds, results))
+               for unit, flutter in enumerate(units)]
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+
+    failures = 0
+    for unit, flutter in enumerate(units):
+        writes, error = results[unit]
+        print("Unit {0}: {1} reports ({2:.0f}/s){3}".format(unit + 1, writes, writes / seconds,
+                                                           ", failed: " + error if error else ""))
+        if error:
+            failures += 1
+
+        # Leave the unit showing its number with the ladder off
+        if not error:
+            flutter.send_commands(flutter.commands().set_level(0))
+
+    if failures:
+        sys.exit("{0} unit(s) failed".format(failures))
+    print("All {0} unit(s) driven".format(len(units)))
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,69 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display profiling statistics. This script reads the firmware's
+    self-profiling statistics through the feature report and prints the count,
+    minimum, mean and maximum duration of each probe, followed by a histogram
+    of the durations in power of two buckets. Reading the statistics resets
+    them, so with an interval given the statistics of each interval are
+    printed in turn. The firmware must be built with PROFILE_ENABLED.
+
+    Usage: profile_stats.py [interval seconds]
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import sys
+import time
+from flutter_device import open_device, PROFILE_PROBES
+
+cpu_hz = 16000000
+bar_width = 40
+
+
+def cycles_to_us(cycles):
+    return cycles * 1000000.0 / cpu_hz
+
+
+def bucket_range(bucket):
+    # Bucket n counts durations of n significant bits
+    if bucket == 0:
+        return 0, 0
+    return 1 << (bucket - 1), (1 << bucket) - 1
+
+
+def print_stats(name, stats):
+    if stats.count == 0:
+        print("{0}: no runs".format(name))
+        return
+
+    mean = float(stats.sum) / stats.count
+    print("{0}: {1} runs, min {2} / mean {3:.0f} / max {4} cycles ({5:.1f} / {6:.1f} / {7:.1f} us)".format(
+          name, stats.count, stats.min, mean, stats.max,
+          cycles_to_us(stats.min), cycles_to_us(mean), cycles_to_us(stats.max)))
+
+    peak = max(stats.histogram)
+    for bucket, runs in enumerate(stats.histogram):
+        if runs == 0:
+            continue
+        low, high = bucket_range(bucket)
+        bar = "#" * max(1, runs * bar_width // peak)
+        print("  {0:5}-{1:<5} {2:5} {3}".format(low, high, runs, bar))
+
+
+def main():
+    interval = float(sys.argv[1]) if len(sys.argv) > 1 else None
+    flutter = open_device()
+
+    while (True):
+        for probe, name in enumerate(PROFILE_PROBES):
+            print_stats(name, flutter.read_profile(probe))
+
+        if interval is None:
+            break
+
+        print("")
+        time.sleep(interval)
+
+if __name__ == '__main__':
+    main()
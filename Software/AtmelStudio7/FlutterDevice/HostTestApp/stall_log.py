@@ -0,0 +1,62 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display stall log. This script reads the main loop stall records
+    the firmware's watchdog kept across its resets, and the longest main loop
+    iteration since the last start-up, then optionally clears them. Each stall
+    address is the byte address of the instruction the stalled code was
+    interrupted at, which avr-addr2line maps back to a source line:
+
+        avr-addr2line -f -e FLUTTER.elf 0x<address>
+
+    The firmware must be built with WATCHDOG_ENABLED.
+
+    Usage: stall_log.py [--clear]
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import sys
+from flutter_device import open_device, WATCHDOG_ADDRESS_UNKNOWN
+
+cpu_hz = 16000000
+
+# MCUSR reset flags, lowest bit first
+reset_flag_names = ["power on", "external", "brown out", "watchdog", "JTAG"]
+
+# USB_Device_States_t values
+device_state_names = ["unattached", "powered", "default", "addressed", "configured", "suspended"]
+
+
+def describe_flags(flags):
+    names = [name for bit, name in enumerate(reset_flag_names) if flags & (1 << bit)]
+    return ", ".join(names) if names else "none (cleared by the bootloader)"
+
+
+def main():
+    clear = "--clear" in sys.argv[1:]
+    flutter = open_device()
+
+    stats = flutter.read_watchdog(clear)
+
+    print("Last reset: {0}".format(describe_flags(stats.reset_flags)))
+    if stats.max_cycles == 0xFFFF:
+        print("Longest main loop iteration: {0} USB frames".format(stats.max_frames))
+    else:
+        print("Longest main loop iteration: {0} cycles ({1:.1f} us)".format(
+              stats.max_cycles, stats.max_cycles * 1000000.0 / cpu_hz))
+
+    print("{0} stall(s) logged, last {1} kept:".format(stats.stalls, len(stats.records)))
+    for record in stats.records:
+        if record.address == WATCHDOG_ADDRESS_UNKNOWN:
+            address = "unknown (interrupts disabled)"
+        else:
+            address = "0x{0:04X}".format(record.address)
+        state = device_state_names[record.device_state] if record.device_state < len(device_state_names) else "?"
+        print("  {0}, USB {1}".format(address, state))
+
+    if clear:
+        print("Cleared")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,182 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display command stream test. This script builds output reports
+    with the CommandStream class and replays them through the host simulator
+    in ../HostSim, so the host side encoder is checked against the firmware's
+    decoder without a unit attached. It checks that reports are zero padded
+    to their full length with COMMAND_END, that the device stops decoding at
+    COMMAND_END, that a report filled to its last byte is decoded without one,
+    and that a command that does not fit is rejected without changing the
+    stream.
+
+    Usage: test_command_stream.py [--report-length N] [path to FlutterSim]
+
+    The report length must be that of the simulator, 64 for one built with
+    FULL_SPEED=1. The PyUSB library is not needed.
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import types
+
+try:
+    import usb.core
+    import usb.util
+except ImportError:
+    # Only the command encoder is used, so the USB library is stood in for when it is not installed
+    usb = types.ModuleType("usb")
+    usb.core = types.ModuleType("usb.core")
+    usb.util = types.ModuleType("usb.util")
+    sys.modules.update({"usb": usb, "usb.core": usb.core, "usb.util": usb.util})
+
+from flutter_device import CommandStream, COMMAND_END, COMMAND_SET_LEDS, report_length
+
+default_simulator = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "HostSim", "Build", "FlutterSim")
+
+# Number of the interrupt OUT endpoint, as in the simulator's scripts
+out_endpoint = 2
+
+
+class Script(object):
+    def __init__(self, length):
+        self.length = length
+        self.lines = ["enumerate"]
+
+        # Start from a known ladder, so that commands which must not run can be seen not to have
+        self.send("Ladder off", CommandStream(length).set_leds(0).report())
+        self.expect("expect-leds 0")
+
+    def send(self, comment, report):
+        # Reports are written at the device's full length, as FlutterDevice.write_report() does
+        assert len(report) == self.length
+        self.lines += ["", "# " + comment, "out {0} {1}".format(out_endpoint, format_bytes(report))]
+
+    def expect(self, line):
+        self.lines.append(line)
+
+    def run(self, simulator):
+        with tempfile.NamedTemporaryFile("w", suffix=".txt", delete=False) as script:
+            script.write("\n".join(self.lines) + "\n")
+
+        try:
+            result = subprocess.run([simulator, script.name], stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                                    universal_newlines=True)
+        finally:
+            os.remove(script.name)
+
+        if result.returncode != 0:
+            print(result.stdout)
+            print("Simulator failed the replayed reports")
+            return 1
+        return 0
+
+
+def format_bytes(data):
+    return " ".join("0x{0:02X}".format(byte) for byte in data)
+
+
+def check(condition, message):
+    if not condition:
+        print(message)
+        return 1
+    return 0
+
+
+def check_padding(script):
+    # A short stream is zero padded to the whole report, the zeros reading as COMMAND_END
+    stream = CommandStream(script.length).set_number(42)
+    report = stream.report()
+    failures = check(len(report) == script.length, "Padded report is {0} bytes, not {1}".format(len(report),
+                                                                                               script.length))
+    failures += check(report[:3] == stream.data and all(byte == COMMAND_END for byte in report[3:]),
+                      "Report {0} is not padded with COMMAND_END".format(format_bytes(report)))
+
+    script.send("Padded report", report)
+    script.expect("expect-display 42")
+
+    # The device stops at the first COMMAND_END, so a command at the end of the padding is ignored, where a decoder
+    # stepping over the padding as empty commands would find it
+    report = CommandStream(script.length).set_number(7).report()
+    report[-3:] = [COMMAND_SET_LEDS, 1, 0x0F]
+    script.send("Command after COMMAND_END", report)
+    script.expect("expect-display 7")
+    script.expect("frames 50")
+    script.expect("expect-leds 0")
+    return failures
+
+
+def check_full(script):
+    # Fill the report to its last byte, so the device has no COMMAND_END to stop at
+    stream = CommandStream(script.length)
+    filler = script.length - 6
+    if filler % 2:
+        stream.set_brightness(15)
+        filler -= 3
+    for _ in range(filler // 2):
+        stream.anim_stop()
+    stream.set_number(99).set_leds(0x0A)
+
+    report = stream.report()
+    failures = check(report == stream.data and len(report) == script.length,
+                     "Full report {0} is not the stream alone".format(format_bytes(report)))
+
+    script.send("Report filled to the last byte", report)
+    script.expect("expect-display 99")
+    script.expect("expect-leds 0x0A")
+    return failures
+
+
+def check_overflow(script):
+    failures = 0
+
+    # A command one byte too long for the space left is rejected, leaving the stream as it was
+    stream = CommandStream(script.length).set_number(5)
+    try:
+        stream.meter_samples([0] * (script.length - 4))
+        failures += check(False, "Command one byte over the report was accepted")
+    except ValueError:
+        pass
+    failures += check(stream.data == CommandStream(script.length).set_number(5).data,
+                      "Rejected command changed the stream to {0}".format(format_bytes(stream.data)))
+
+    # One byte shorter fits exactly
+    try:
+        CommandStream(script.length).set_number(5).meter_samples([0] * (script.length - 5))
+    except ValueError:
+        failures += check(False, "Command filling the report exactly was rejected")
+
+    # A command longer than a whole report never fits
+    try:
+        CommandStream(script.length).meter_samples([0] * (script.length - 1))
+        failures += check(False, "Command longer than the report was accepted")
+    except ValueError:
+        pass
+
+    script.send("Stream left by a rejected command", stream.report())
+    script.expect("expect-display 5")
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Replays CommandStream reports through the host simulator.")
+    parser.add_argument("simulator", nargs="?", default=default_simulator, help="path to FlutterSim")
+    parser.add_argument("--report-length", type=int, default=report_length, help="report length of the simulator")
+    args = parser.parse_args()
+
+    script = Script(args.report_length)
+
+    failures = check_padding(script)
+    failures += check_full(script)
+    failures += check_overflow(script)
+    failures += script.run(args.simulator)
+
+    if failures:
+        sys.exit("{0} check(s) failed".format(failures))
+    print("Command stream checked")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,64 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display ladder level map test. This script uploads a level map to
+    the device through its feature report, reads the whole map back, then
+    sweeps all 256 levels through the device's renderer and checks each
+    rendered LED mask against the map. It is repeated with a map set from
+    thresholds, and the default thresholds are restored at the end.
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import sys
+from flutter_device import open_device
+
+default_thresholds = [15, 25, 35, 50]
+
+
+def thresholds_to_map(thresholds):
+    return [sum(1 << led for led, threshold in enumerate(thresholds) if level >= threshold)
+            for level in range(256)]
+
+
+def check_map(flutter, expected):
+    failures = 0
+
+    masks = flutter.read_ladder_map()
+    for level in range(256):
+        if masks[level] != expected[level]:
+            print("Read back level {0}: expected 0x{1:X}, got 0x{2:X}".format(level, expected[level], masks[level]))
+            failures += 1
+
+    for level in range(256):
+        mask = flutter.probe_ladder(level)
+        if mask != expected[level]:
+            print("Rendered level {0}: expected 0x{1:X}, got 0x{2:X}".format(level, expected[level], mask))
+            failures += 1
+
+    return failures
+
+
+def main():
+    flutter = open_device()
+    failures = 0
+
+    # A map no set of thresholds could produce, so every page and nibble is exercised
+    uploaded = [(level * 7 + (level >> 4)) & 0x0F for level in range(256)]
+    flutter.write_ladder_map(uploaded)
+    failures += check_map(flutter, uploaded)
+    print("Uploaded map checked")
+
+    thresholds = [1, 64, 128, 255]
+    flutter.send_commands(flutter.commands().set_thresholds(thresholds))
+    failures += check_map(flutter, thresholds_to_map(thresholds))
+    print("Threshold map checked")
+
+    flutter.send_commands(flutter.commands().set_thresholds(default_thresholds))
+
+    if failures:
+        sys.exit("{0} mismatch(es)".format(failures))
+    print("All 256 levels match")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,120 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display suspend test. This script suspends the bus to the device
+    through Linux runtime power management, resumes it, and checks the low
+    power statistics feature page: the suspend must have been counted, and the
+    registers snapshotted as the device went to sleep must show power down
+    sleep mode, the display timer stopped and powered down, and the prescaled
+    clock. With --remote-wakeup it instead asks for the encoder to be turned
+    while suspended, and checks that the device woke the bus itself.
+
+    Usage: test_suspend.py [--remote-wakeup]
+
+    Must be run with write access to the device's sysfs power attributes
+    (usually as root).
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import sys
+import time
+import usb.util
+from flutter_device import open_device
+
+# Register values expected while suspended (ATmega32U4): power down sleep mode,
+# TWI, Timer 0, SPI, ADC and USART1 powered down, Timer 0 stopped and the clock
+# divided by 8
+expected_smcr = 0x04
+expected_prr0 = 0xA5
+expected_prr1 = 0x01
+expected_tccr0b = 0x00
+expected_clkpr = 0x03
+
+suspend_timeout = 5.0
+wakeup_timeout = 30.0
+
+
+def sysfs_path(device):
+    return "/sys/bus/usb/devices/{0}-{1}/power/".format(device.bus, ".".join(str(port) for port in device.port_numbers))
+
+
+def write_power(path, name, value):
+    with open(path + name, "w") as attribute:
+        attribute.write(value)
+
+
+def runtime_status(path):
+    with open(path + "runtime_status") as attribute:
+        return attribute.read().strip()
+
+
+def wait_status(path, status, timeout):
+    deadline = time.time() + timeout
+    while runtime_status(path) != status:
+        if time.time() > deadline:
+            return False
+        time.sleep(0.1)
+    return True
+
+
+def check_register(name, value, expected):
+    if value != expected:
+        print("{0}: expected 0x{1:02X}, got 0x{2:02X}".format(name, expected, value))
+        return 1
+    return 0
+
+
+def main():
+    remote_wakeup = "--remote-wakeup" in sys.argv[1:]
+    flutter = open_device()
+    path = sysfs_path(flutter.device)
+    failures = 0
+
+    flutter.read_power(clear=True)
+
+    # Close the device so that the open handle does not hold it awake, then let the kernel suspend it
+    usb.util.dispose_resources(flutter.device)
+    write_power(path, "autosuspend_delay_ms", "0")
+    write_power(path, "control", "auto")
+
+    if not wait_status(path, "suspended", suspend_timeout):
+        write_power(path, "control", "on")
+        sys.exit("Device was not suspended by the host")
+    print("Device suspended")
+
+    if remote_wakeup:
+        print("Turn the encoder to wake the host")
+        woken = wait_status(path, "active", wakeup_timeout)
+
+    write_power(path, "control", "on")
+    wait_status(path, "active", suspend_timeout)
+    print("Device resumed")
+
+    stats = flutter.read_power()
+    print("Suspends {0}, remote wakeups {1}".format(stats.suspends, stats.remote_wakeups))
+
+    if stats.suspends == 0:
+        print("Suspend was not seen by the device")
+        failures += 1
+
+    failures += check_register("SMCR", stats.smcr & 0x0E, expected_smcr)
+    failures += check_register("PRR0", stats.prr0 & expected_prr0, expected_prr0)
+    failures += check_register("PRR1", stats.prr1 & expected_prr1, expected_prr1)
+    failures += check_register("TCCR0B", stats.tccr0b, expected_tccr0b)
+    failures += check_register("CLKPR", stats.clkpr & 0x0F, expected_clkpr)
+
+    if remote_wakeup:
+        if stats.remote_wakeups == 0:
+            print("No remote wakeup was signalled (is remote wakeup enabled for the device by the host?)")
+            failures += 1
+        elif not woken:
+            print("Remote wakeup was signalled but the host did not resume the bus")
+            failures += 1
+
+    if failures:
+        sys.exit("{0} check(s) failed".format(failures))
+    print("Low power state checked")
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,91 @@
+#!/usr/bin/env python
+
+"""
+    Flutter Display update latency trace. This script sends a run of display
+    updates, each tagged with a trace ID, and waits for the device to return
+    each trace once the display shows the update. The device reports how many
+    USB frames (milliseconds) ago the update arrived and was first shown, so
+    together with the host's own send and receive times each update's latency
+    splits into:
+
+        host to device   send call to arrival at the device, including the
+                         host stack, the bus and the OUT polling interval
+        device to glass  arrival to the first display frame showing it
+        host to glass    the sum of the two
+
+    The p50, p99 and max of each are printed. The receive time includes the
+    delivery of the IN report, so host to device is an overestimate by up to
+    one IN polling interval. Run it with different refresh rates, report sizes
+    or polling intervals to compare them.
+
+    Requires the PyUSB library (http://sourceforge.net/apps/trac/pyusb/).
+"""
+
+import argparse
+import time
+from flutter_device import open_device
+
+trace_timeout = 0.5
+
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(fraction * len(ordered)))]
+
+
+def trace_update(flutter, trace_id, number):
+    sent = time.time()
+    flutter.send_commands(flutter.commands().set_number(number).trace(trace_id))
+
+    while (time.time() - sent) < trace_timeout:
+        report = flutter.read_input(timeout=int(trace_timeout * 1000))
+        if report is None or report.trace_id != trace_id:
+            continue
+
+        # Frame ages are in milliseconds, counted back from when the IN report was created
+        received = time.time()
+        shown = received - report.trace_shown / 1000.0
+        device_to_glass = (report.trace_arrived - report.trace_shown) / 1000.0
+        return (shown - sent) - device_to_glass, device_to_glass, shown - sent
+
+    return None
+
+
+def print_distribution(name, values):
+    print("{0:16} p50 {1:6.2f} ms, p99 {2:6.2f} ms, max {3:6.2f} ms".format(
+          name, percentile(values, 0.5) * 1000, percentile(values, 0.99) * 1000, max(values) * 1000))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Measure Flutter Display host to glass update latency.")
+    parser.add_argument("--count", type=int, default=500, help="number of traced updates")
+    parser.add_argument("--interval", type=float, default=0.02, help="seconds between updates")
+    args = parser.parse_args()
+
+    flutter = open_device()
+    results = []
+    lost = 0
+
+    for update in range(args.count):
+        # IDs run from 1 to 255, skipping the reserved ID
+        trace_id = (update % 255) + 1
+        result = trace_update(flutter, trace_id, update % 100)
+
+        if result is None:
+            lost += 1
+        else:
+            results.append(result)
+
+        time.sleep(args.interval)
+
+    if not results:
+        print("No traces returned, {0} lost".format(lost))
+        return
+
+    print("{0} traced updates, {1} lost".format(len(results), lost))
+    print_distribution("Host to device", [result[0] for result in results])
+    print_distribution("Device to glass", [result[1] for result in results])
+    print_distribution("Host to glass", [result[2] for result in results])
+
+if __name__ == '__main__':
+    main()
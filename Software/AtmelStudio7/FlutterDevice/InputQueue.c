@@ -0,0 +1,156 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Lock-free single producer, single consumer queue carrying user input events from the encoder and button
+ *  interrupts to the HID report builder in the main loop. The producer side is only ever called from interrupt
+ *  handlers, which do not nest, so together they act as a single producer.
+ *
+ *  Encoder steps are never dropped: if the queue is full, they are accumulated by the producer and pushed as soon
+ *  as space becomes available again. Repeated edges of the same button while the queue is full are counted, up to
+ *  255 of each, and pushed as one event apiece so that no click is lost to the one before it.
+ */
+
+#include "InputQueue.h"
+
+/** Ring buffer of queued events. */
+static InputQueue_Event_t Events[INPUT_QUEUE_SIZE];
+
+/** Index of the next slot to be written, only modified by the producer. */
+static volatile uint8_t Head;
+
+/** Index of the next slot to be read, only modified by the consumer. */
+static volatile uint8_t Tail;
+
+/** Encoder steps that could not be queued yet because the queue was full, only accessed by the producer. */
+static int16_t OverflowSteps;
+
+/** Button edges that could not be queued yet because the queue was full, only accessed by the producer. */
+static uint8_t OverflowEdges;
+
+/** Further edges held back behind each edge of \ref OverflowEdges, by bit of the edge mask, only accessed by the
+ *  producer.
+ */
+static uint8_t OverflowRepeats[8];
+
+/** Moves as much of the held back input as possible into the queue. */
+static void InputQueue_PushOverflow(void)
+{
+	uint8_t CurrentHead = Head;
+
+	while (OverflowSteps || OverflowEdges)
+	{
+		if ((uint8_t)(CurrentHead - Tail) >= INPUT_QUEUE_SIZE)
+		  break;
+
+		InputQueue_Event_t* Event = &Events[CurrentHead & (INPUT_QUEUE_SIZE - 1)];
+
+		Event->Steps       = MAX(MIN(OverflowSteps, INT8_MAX), INT8_MIN);
+		Event->ButtonEdges = OverflowEdges;
+
+		OverflowSteps -= Event->Steps;
+
+		//Each repeat of an edge just queued goes into the next event
+		uint8_t Edges = OverflowEdges;
+		OverflowEdges = 0;
+
+		for (uint8_t Bit = 0; Edges; Bit++, Edges >>= 1)
+		{
+			if ((Edges & 1) && OverflowRepeats[Bit])
+			{
+				OverflowRepeats[Bit]--;
+				OverflowEdges |= (1 << Bit);
+			}
+		}
+
+		CurrentHead++;
+	}
+
+	GCC_MEMORY_BARRIER();
+	Head = CurrentHead;
+}
+
+/** Queues a user input event. This must only be called from interrupt context.
+ *
+ *  \param[in] Steps        Signed number of encoder steps turned.
+ *  \param[in] ButtonEdges  Mask of button edges seen.
+ */
+void InputQueue_Push(const int8_t Steps,
+                     const uint8_t ButtonEdges)
+{
+	/* New input always goes behind anything still held back, so that events stay in order */
+	OverflowSteps += Steps;
+
+	uint8_t Edges = ButtonEdges;
+
+	for (uint8_t Bit = 0; Edges; Bit++, Edges >>= 1)
+	{
+		if (!(Edges & 1))
+		  continue;
+
+		if (!(OverflowEdges & (1 << Bit)))
+		  OverflowEdges |= (1 << Bit);
+		else if (OverflowRepeats[Bit] != UINT8_MAX)
+		  OverflowRepeats[Bit]++;
+	}
+
+	InputQueue_PushOverflow();
+}
+
+/** Retries queuing any input held back while the queue was full. This must only be called from interrupt context,
+ *  and should be called periodically so that held back input is delivered even if no new input arrives.
+ */
+void InputQueue_Flush(void)
+{
+	InputQueue_PushOverflow();
+}
+
+/** Retrieves the oldest queued event without removing it from the queue. This must only be called from the
+ *  main loop.
+ *
+ *  \param[out] Event  Location where the event is to be stored.
+ *
+ *  \return Boolean \c true if an event was retrieved, \c false if the queue is empty.
+ */
+bool InputQueue_Peek(InputQueue_Event_t* const Event)
+{
+	uint8_t CurrentTail = Tail;
+
+	if (CurrentTail == Head)
+	  return false;
+
+	GCC_MEMORY_BARRIER();
+	*Event = Events[CurrentTail & (INPUT_QUEUE_SIZE - 1)];
+	return true;
+}
+
+/** Removes the oldest queued event, previously retrieved with \ref InputQueue_Peek(). This must only be called
+ *  from the main loop.
+ */
+void InputQueue_Pop(void)
+{
+	GCC_MEMORY_BARRIER();
+	Tail = (Tail + 1);
+}
+
@@ -0,0 +1,58 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for InputQueue.c.
+ */
+
+#ifndef _INPUT_QUEUE_H_
+#define _INPUT_QUEUE_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of events the queue can hold, must be a power of two no larger than 128. */
+		#define INPUT_QUEUE_SIZE         16
+
+	/* Type Defines: */
+		/** Type define for a single user input event, queued from interrupt context for the HID report builder. */
+		typedef struct
+		{
+			int8_t  Steps; /**< Signed number of encoder steps turned, after acceleration. */
+			uint8_t ButtonEdges; /**< Mask of button edges seen. */
+		} InputQueue_Event_t;
+
+	/* Function Prototypes: */
+		void InputQueue_Push(const int8_t Steps,
+		                     const uint8_t ButtonEdges);
+		void InputQueue_Flush(void);
+		bool InputQueue_Peek(InputQueue_Event_t* const Event) ATTR_NON_NULL_PTR_ARG(1);
+		void InputQueue_Pop(void);
+
+#endif
+
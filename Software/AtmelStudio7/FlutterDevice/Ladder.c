@@ -0,0 +1,106 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Level map of the LED ladder. Every level from 0 to 255 maps through a table in RAM to the ladder LEDs lit for
+ *  it, so rendering a level is a single lookup however the map was defined. The table is either expanded from a
+ *  threshold per LED, or written directly by the host a page at a time, with each page packing the 4-bit masks of
+ *  \ref LADDER_PAGE_ENTRIES consecutive levels two to a byte, even levels in the low nibble.
+ */
+
+#include "Ladder.h"
+
+/** Ladder LEDs lit for each level, with bit 0 for LED 1 through bit 3 for LED 4. */
+uint8_t Ladder_LevelMasks[256];
+
+/** Sets the level map from a threshold per LED, lighting each LED at every level that has reached its threshold.
+ *
+ *  \param[in] Thresholds  Level at which each LED of the ladder lights up, from LED 1.
+ */
+void Ladder_SetThresholds(const uint8_t* const Thresholds)
+{
+	uint8_t Level = 0;
+
+	do
+	{
+		uint8_t Mask = 0;
+
+		for (uint8_t LEDIndex = 0; LEDIndex < LADDER_LED_COUNT; LEDIndex++)
+		{
+			if (Level >= Thresholds[LEDIndex])
+			  Mask |= (1 << LEDIndex);
+		}
+
+		Ladder_LevelMasks[Level] = Mask;
+	}
+	while (++Level);
+}
+
+/** Writes one page of the level map.
+ *
+ *  \param[in] Page         Index of the page, less than \ref LADDER_PAGE_COUNT.
+ *  \param[in] PackedMasks  \ref LADDER_PAGE_SIZE bytes of packed masks, even levels in the low nibble.
+ *
+ *  \return Boolean \c true if the page was written, \c false if the page index is out of range.
+ */
+bool Ladder_WritePage(const uint8_t Page,
+                      const uint8_t* const PackedMasks)
+{
+	if (Page >= LADDER_PAGE_COUNT)
+	  return false;
+
+	uint8_t* Masks = &Ladder_LevelMasks[Page * LADDER_PAGE_ENTRIES];
+
+	for (uint8_t ByteIndex = 0; ByteIndex < LADDER_PAGE_SIZE; ByteIndex++)
+	{
+		*(Masks++) = (PackedMasks[ByteIndex] & 0x0F);
+		*(Masks++) = (PackedMasks[ByteIndex] >> 4);
+	}
+
+	return true;
+}
+
+/** Reads one page of the level map.
+ *
+ *  \param[in]  Page         Index of the page, less than \ref LADDER_PAGE_COUNT.
+ *  \param[out] PackedMasks  Location where the \ref LADDER_PAGE_SIZE bytes of packed masks are to be stored.
+ *
+ *  \return Boolean \c true if the page was read, \c false if the page index is out of range.
+ */
+bool Ladder_ReadPage(const uint8_t Page,
+                     uint8_t* const PackedMasks)
+{
+	if (Page >= LADDER_PAGE_COUNT)
+	  return false;
+
+	const uint8_t* Masks = &Ladder_LevelMasks[Page * LADDER_PAGE_ENTRIES];
+
+	for (uint8_t ByteIndex = 0; ByteIndex < LADDER_PAGE_SIZE; ByteIndex++)
+	{
+		PackedMasks[ByteIndex] = (Masks[0] | (Masks[1] << 4));
+		Masks += 2;
+	}
+
+	return true;
+}
@@ -0,0 +1,75 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Ladder.c.
+ */
+
+#ifndef _LADDER_H_
+#define _LADDER_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of LEDs in the LED ladder. */
+		#define LADDER_LED_COUNT         4
+
+		/** Number of levels mapped by each page of the level map, two per byte. */
+		#define LADDER_PAGE_ENTRIES      8
+
+		/** Size in bytes of a packed page of the level map. */
+		#define LADDER_PAGE_SIZE         (LADDER_PAGE_ENTRIES / 2)
+
+		/** Number of pages in the level map. */
+		#define LADDER_PAGE_COUNT        (256 / LADDER_PAGE_ENTRIES)
+
+	/* External Variables: */
+		extern uint8_t Ladder_LevelMasks[256];
+
+	/* Inline Functions: */
+		/** Maps a level to the ladder LEDs to light for it, as a mask with bit 0 for LED 1 through bit 3 for LED 4.
+		 *
+		 *  \param[in] Level  Level to map.
+		 *
+		 *  \return Mask of the ladder LEDs to light.
+		 */
+		static inline uint8_t Ladder_LevelToMask(const uint8_t Level) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+		static inline uint8_t Ladder_LevelToMask(const uint8_t Level)
+		{
+			return Ladder_LevelMasks[Level];
+		}
+
+	/* Function Prototypes: */
+		void Ladder_SetThresholds(const uint8_t* const Thresholds) ATTR_NON_NULL_PTR_ARG(1);
+		bool Ladder_WritePage(const uint8_t Page,
+		                      const uint8_t* const PackedMasks) ATTR_NON_NULL_PTR_ARG(2);
+		bool Ladder_ReadPage(const uint8_t Page,
+		                     uint8_t* const PackedMasks) ATTR_NON_NULL_PTR_ARG(2);
+
+#endif
+
@@ -0,0 +1,185 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Level meter engine for the LED ladder. The host sends batches of raw level samples, which are played back one
+ *  at a time as the meter's target, and the displayed level follows the target with separate attack and release
+ *  ballistics. A peak indicator holds the highest displayed level for a while before decaying back down.
+ *
+ *  The meter is stepped once per display frame from the main loop, which is also where samples arrive from the
+ *  host, so none of its state is shared with interrupt context.
+ */
+
+#include "Meter.h"
+
+/** Ballistics of the meter, set by the host. The defaults follow each sample immediately with no peak
+ *  indicator, matching a ladder set directly from the last level received.
+ */
+static Meter_Config_t Config =
+	{
+		.Attack       = METER_COEFF_INSTANT,
+		.Release      = METER_COEFF_INSTANT,
+		.PeakHold     = 0,
+		.PeakDecay    = 0,
+		.SamplePeriod = 1,
+	};
+
+/** Ring buffer of samples waiting to be played back. */
+static uint8_t Samples[METER_SAMPLE_QUEUE_SIZE];
+
+/** Index of the next sample slot to be written. */
+static uint8_t SamplesHead;
+
+/** Index of the next sample to be played back. */
+static uint8_t SamplesTail;
+
+/** Frames left before the next queued sample is played back. */
+static uint8_t SampleFramesLeft;
+
+/** Level the meter is moving towards, in 8.8 fixed point. */
+static uint16_t TargetLevel;
+
+/** Level currently displayed, in 8.8 fixed point. */
+static uint16_t DisplayLevel;
+
+/** Level of the peak indicator, in 8.8 fixed point. */
+static uint16_t PeakLevel;
+
+/** Frames left before the peak indicator starts to decay. */
+static uint8_t PeakFramesLeft;
+
+/** Moves a level towards a target by a fraction of the distance between them, always by at least one
+ *  fixed point step so that the target is eventually reached.
+ *
+ *  \param[in] Level   Current level, in 8.8 fixed point.
+ *  \param[in] Target  Target level, in 8.8 fixed point.
+ *  \param[in] Coeff   Fraction (out of 256) of the distance to cover, or \ref METER_COEFF_INSTANT.
+ *
+ *  \return New level, in 8.8 fixed point.
+ */
+static uint16_t Meter_Approach(const uint16_t Level,
+                               const uint16_t Target,
+                               const uint8_t Coeff)
+{
+	if (Coeff == METER_COEFF_INSTANT)
+	  return Target;
+
+	if (Target > Level)
+	  return Level + MAX(((uint32_t)(Target - Level) * Coeff) >> 8, 1);
+	else if (Target < Level)
+	  return Level - MAX(((uint32_t)(Level - Target) * Coeff) >> 8, 1);
+
+	return Level;
+}
+
+/** Sets the ballistics of the meter.
+ *
+ *  \param[in] NewConfig  New meter ballistics.
+ */
+void Meter_SetConfig(const Meter_Config_t* const NewConfig)
+{
+	Config = *NewConfig;
+
+	if (!(Config.SamplePeriod))
+	  Config.SamplePeriod = 1;
+
+	if (!(Config.PeakHold))
+	  PeakLevel = 0;
+}
+
+/** Queues level samples to be played back by the meter, one every \c SamplePeriod frames. When the queue is full
+ *  the oldest samples are dropped, so the meter never lags the host by more than a queue's worth of samples.
+ *
+ *  \param[in] NewSamples  Level samples to queue, oldest first.
+ *  \param[in] Count       Number of samples to queue.
+ */
+void Meter_PushSamples(const uint8_t* NewSamples,
+                       uint8_t Count)
+{
+	while (Count--)
+	{
+		if ((uint8_t)(SamplesHead - SamplesTail) >= METER_SAMPLE_QUEUE_SIZE)
+		  SamplesTail++;
+
+		Samples[SamplesHead++ & (METER_SAMPLE_QUEUE_SIZE - 1)] = *(NewSamples++);
+	}
+}
+
+/** Steps the meter by one display frame. This plays back the next queued sample when it is due, then moves the
+ *  displayed level and the peak indicator on by their ballistics.
+ */
+void Meter_Task(void)
+{
+	if (SampleFramesLeft)
+	  SampleFramesLeft--;
+
+	//Once the queue runs dry the last sample stays the target, so a slow host sees the meter settle
+	if (!(SampleFramesLeft) && (SamplesHead != SamplesTail))
+	{
+		TargetLevel      = (uint16_t)Samples[SamplesTail++ & (METER_SAMPLE_QUEUE_SIZE - 1)] << 8;
+		SampleFramesLeft = Config.SamplePeriod;
+	}
+
+	DisplayLevel = Meter_Approach(DisplayLevel, TargetLevel,
+	                              (TargetLevel > DisplayLevel) ? Config.Attack : Config.Release);
+
+	if (!(Config.PeakHold))
+	  return;
+
+	if (DisplayLevel >= PeakLevel)
+	{
+		PeakLevel      = DisplayLevel;
+		PeakFramesLeft = Config.PeakHold;
+	}
+	else if (PeakFramesLeft)
+	{
+		PeakFramesLeft--;
+	}
+	else
+	{
+		uint16_t Decay = ((uint16_t)Config.PeakDecay << 4);
+		PeakLevel = ((PeakLevel - DisplayLevel) > Decay) ? (PeakLevel - Decay) : DisplayLevel;
+	}
+}
+
+/** Retrieves the level currently displayed by the meter.
+ *
+ *  \return Displayed level, from 0 to 255.
+ */
+uint8_t Meter_GetLevel(void)
+{
+	return (DisplayLevel >> 8);
+}
+
+/** Retrieves the level of the peak indicator.
+ *
+ *  \param[out] Peak  Location where the peak level, from 0 to 255, is to be stored.
+ *
+ *  \return Boolean \c true if the peak indicator is enabled, \c false otherwise.
+ */
+bool Meter_GetPeak(uint8_t* const Peak)
+{
+	*Peak = (PeakLevel >> 8);
+	return (Config.PeakHold != 0);
+}
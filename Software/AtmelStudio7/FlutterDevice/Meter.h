@@ -0,0 +1,69 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Meter.c.
+ */
+
+#ifndef _METER_H_
+#define _METER_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Number of level samples that can be waiting to be played back, must be a power of two no larger
+		 *  than 128.
+		 */
+		#define METER_SAMPLE_QUEUE_SIZE  16
+
+		/** Attack or release coefficient which moves the meter to its target in a single frame. */
+		#define METER_COEFF_INSTANT      0xFF
+
+	/* Type Defines: */
+		/** Type define for the ballistics of the meter. All times are counted in display frames. */
+		typedef struct
+		{
+			uint8_t Attack; /**< Fraction (out of 256) of the distance to a higher target covered each frame. */
+			uint8_t Release; /**< Fraction (out of 256) of the distance to a lower target covered each frame. */
+			uint8_t PeakHold; /**< Frames the peak is held before decaying, zero to disable the peak indicator. */
+			uint8_t PeakDecay; /**< Levels, in sixteenths, the peak falls each frame once its hold has expired, zero
+			                    *   to hold the peak forever, until the level rises to a new one.
+			                    */
+			uint8_t SamplePeriod; /**< Frames each queued sample is the target for before the next is played. */
+		} Meter_Config_t;
+
+	/* Function Prototypes: */
+		void    Meter_SetConfig(const Meter_Config_t* const Config) ATTR_NON_NULL_PTR_ARG(1);
+		void    Meter_PushSamples(const uint8_t* Samples,
+		                          uint8_t Count) ATTR_NON_NULL_PTR_ARG(1);
+		void    Meter_Task(void);
+		uint8_t Meter_GetLevel(void) ATTR_WARN_UNUSED_RESULT;
+		bool    Meter_GetPeak(uint8_t* const Peak) ATTR_NON_NULL_PTR_ARG(1);
+
+#endif
+
@@ -0,0 +1,171 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Self-profiling of the firmware. Probes around the USB tasks and inside the interrupt handlers time each run
+ *  against the free running Timer 1, which counts CPU cycles, and gather the count, minimum, maximum, sum and a
+ *  log2 histogram of the durations. The host reads them back through the feature report: a probe's statistics are
+ *  first latched, which resets them for the next measurement, then read a page at a time.
+ *
+ *  Probes in main context include the time spent in any interrupt that preempts them. When \c PROFILE_ENABLED is
+ *  not set the probes compile to nothing and this module is empty.
+ */
+
+#include "Profile.h"
+
+#if defined(PROFILE_ENABLED)
+/** Cycle count at the start of the current run of each probe. */
+uint16_t Profile_StartCycles[PROFILE_PROBE_COUNT];
+
+/** Statistics gathered by each probe since it was last latched. */
+static Profile_Stats_t Stats[PROFILE_PROBE_COUNT];
+
+/** Statistics of the probe last latched, read back a page at a time. */
+static Profile_Stats_t Latched;
+
+/** Probe whose statistics are held in \ref Latched. */
+static uint8_t LatchedProbe;
+
+/** Clears the statistics of a probe. */
+static void Profile_Clear(Profile_Stats_t* const ProbeStats)
+{
+	memset(ProbeStats, 0, sizeof(Profile_Stats_t));
+	ProbeStats->Min = 0xFFFF;
+}
+
+/** Starts Timer 1 counting CPU cycles, and clears the statistics of all probes. The timer runs at the same rate
+ *  as for the scheduler's cycle accounting, so the two can share it.
+ */
+void Profile_Init(void)
+{
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	for (uint8_t Probe = 0; Probe < PROFILE_PROBE_COUNT; Probe++)
+	  Profile_Clear(&Stats[Probe]);
+
+	Profile_Clear(&Latched);
+	LatchedProbe = 0;
+}
+
+/** Adds a timed run to the statistics of a probe. This must be called with interrupts disabled, or from the one
+ *  context the probe is timed from.
+ *
+ *  \param[in] Probe   Probe the run was timed by, a \c PROFILE_PROBE_* value.
+ *  \param[in] Cycles  Duration of the run in CPU cycles.
+ */
+void Profile_Record(const uint8_t Probe,
+                    const uint16_t Cycles)
+{
+	Profile_Stats_t* ProbeStats = &Stats[Probe];
+
+	if (ProbeStats->Count == 0xFFFF)
+	  return;
+
+	ProbeStats->Count++;
+	ProbeStats->Sum += Cycles;
+
+	if (Cycles < ProbeStats->Min)
+	  ProbeStats->Min = Cycles;
+
+	if (Cycles > ProbeStats->Max)
+	  ProbeStats->Max = Cycles;
+
+	uint8_t  Bucket    = 0;
+	uint16_t Remaining = Cycles;
+
+	while (Remaining)
+	{
+		Bucket++;
+		Remaining >>= 1;
+	}
+
+	ProbeStats->Histogram[Bucket]++;
+}
+
+/** Copies the statistics of a probe to be read back with \ref Profile_ReadPage(), and resets them.
+ *
+ *  \param[in] Probe  Probe to latch, a \c PROFILE_PROBE_* value.
+ */
+void Profile_Latch(const uint8_t Probe)
+{
+	if (Probe >= PROFILE_PROBE_COUNT)
+	  return;
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	Latched = Stats[Probe];
+	Profile_Clear(&Stats[Probe]);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	LatchedProbe = Probe;
+}
+
+/** Reads a page of the latched statistics of a probe, little endian. Pages of a probe other than the one last
+ *  latched read as zero.
+ *
+ *  \param[in]  Probe  Probe to read, a \c PROFILE_PROBE_* value.
+ *  \param[in]  Page   Page to read, less than \ref PROFILE_PAGE_COUNT.
+ *  \param[out] Data   Buffer of \ref PROFILE_PAGE_SIZE bytes to read the page into.
+ */
+void Profile_ReadPage(const uint8_t Probe,
+                      const uint8_t Page,
+                      uint8_t* const Data)
+{
+	uint16_t Words[PROFILE_PAGE_BUCKETS] = {0};
+
+	if (Probe == LatchedProbe)
+	{
+		if (Page == 0)
+		{
+			Words[0] = Latched.Count;
+			Words[1] = (Latched.Count ? Latched.Min : 0);
+			Words[2] = Latched.Max;
+		}
+		else if (Page == 1)
+		{
+			Words[0] = (uint16_t)Latched.Sum;
+			Words[1] = (uint16_t)(Latched.Sum >> 16);
+		}
+		else if (Page < PROFILE_PAGE_COUNT)
+		{
+			for (uint8_t Word = 0; Word < PROFILE_PAGE_BUCKETS; Word++)
+			{
+				uint8_t Bucket = ((Page - 2) * PROFILE_PAGE_BUCKETS + Word);
+
+				if (Bucket < PROFILE_BUCKET_COUNT)
+				  Words[Word] = Latched.Histogram[Bucket];
+			}
+		}
+	}
+
+	for (uint8_t Word = 0; Word < PROFILE_PAGE_BUCKETS; Word++)
+	{
+		Data[Word * 2]     = (uint8_t)Words[Word];
+		Data[Word * 2 + 1] = (uint8_t)(Words[Word] >> 8);
+	}
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Profile.c.
+ */
+
+#ifndef _PROFILE_H_
+#define _PROFILE_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+		#include <string.h>
+
+		#include "Config/AppConfig.h"
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Probe timing each run of the HID class driver task. */
+		#define PROFILE_PROBE_HID_TASK       0
+
+		/** Probe timing each run of the USB management task, including any control requests it services. */
+		#define PROFILE_PROBE_USB_TASK       1
+
+		/** Probe timing each USB controller interrupt, general or endpoint, including any other USB controller
+		 *  interrupt nested within it.
+		 */
+		#define PROFILE_PROBE_USB_ISR        2
+
+		/** Probe timing each display multiplex interrupt. */
+		#define PROFILE_PROBE_DISPLAY_ISR    3
+
+		/** Number of profiling probes. */
+		#define PROFILE_PROBE_COUNT          4
+
+		/** Number of buckets of the duration histogram of each probe. Bucket \c n counts the durations of \c n
+		 *  significant bits, so bucket 0 counts zero cycles and bucket 16 counts 32768 to 65535 cycles.
+		 */
+		#define PROFILE_BUCKET_COUNT         17
+
+		/** Number of pages the latched statistics of a probe are read through. Page 0 holds the count, minimum and
+		 *  maximum, page 1 the sum of the durations and pages 2 onwards the histogram buckets.
+		 */
+		#define PROFILE_PAGE_COUNT           8
+
+		/** Number of histogram buckets held in each histogram page. */
+		#define PROFILE_PAGE_BUCKETS         3
+
+		/** Size in bytes of each page of latched probe statistics. */
+		#define PROFILE_PAGE_SIZE            (PROFILE_PAGE_BUCKETS * sizeof(uint16_t))
+
+		#if defined(PROFILE_ENABLED) || defined(__DOXYGEN__)
+			/** Starts timing a run of the given probe. This compiles to nothing unless \c PROFILE_ENABLED is set. */
+			#define PROFILE_BEGIN(Probe)     Profile_Begin(Probe)
+
+			/** Finishes timing a run of the given probe and adds it to the probe's statistics. This compiles to
+			 *  nothing unless \c PROFILE_ENABLED is set.
+			 */
+			#define PROFILE_END(Probe)       Profile_End(Probe)
+		#else
+			#define PROFILE_BEGIN(Probe)
+			#define PROFILE_END(Probe)
+		#endif
+
+	/* Type Defines: */
+		/** Type define for the statistics gathered by a probe. Durations are in CPU cycles, and a run longer than
+		 *  65535 cycles wraps around.
+		 */
+		typedef struct
+		{
+			uint16_t Count; /**< Number of runs timed, saturating at 0xFFFF where the statistics stop changing. */
+			uint16_t Min; /**< Shortest run. */
+			uint16_t Max; /**< Longest run. */
+			uint32_t Sum; /**< Sum of the durations of all runs timed, for their mean. */
+			uint16_t Histogram[PROFILE_BUCKET_COUNT]; /**< Runs timed by number of significant bits of the duration. */
+		} Profile_Stats_t;
+
+	#if defined(PROFILE_ENABLED)
+	/* External Variables: */
+		extern uint16_t Profile_StartCycles[PROFILE_PROBE_COUNT];
+
+	/* Function Prototypes: */
+		void Profile_Init(void);
+		void Profile_Record(const uint8_t Probe,
+		                    const uint16_t Cycles);
+		void Profile_Latch(const uint8_t Probe);
+		void Profile_ReadPage(const uint8_t Probe,
+		                      const uint8_t Page,
+		                      uint8_t* const Data);
+
+	/* Inline Functions: */
+		/** Reads the free running Timer 1 cycle counter. The 16-bit read shares the timer's temporary register with
+		 *  any interrupt that also reads a 16-bit timer register, so it is made with interrupts disabled.
+		 */
+		static inline uint16_t Profile_ReadCycles(void) ATTR_ALWAYS_INLINE;
+		static inline uint16_t Profile_ReadCycles(void)
+		{
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			uint16_t Cycles = TCNT1;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+
+			return Cycles;
+		}
+
+		/** Starts timing a run of a probe, see \ref PROFILE_BEGIN(). */
+		static inline void Profile_Begin(const uint8_t Probe) ATTR_ALWAYS_INLINE;
+		static inline void Profile_Begin(const uint8_t Probe)
+		{
+			Profile_StartCycles[Probe] = Profile_ReadCycles();
+		}
+
+		/** Finishes timing a run of a probe, see \ref PROFILE_END(). */
+		static inline void Profile_End(const uint8_t Probe) ATTR_ALWAYS_INLINE;
+		static inline void Profile_End(const uint8_t Probe)
+		{
+			Profile_Record(Probe, (Profile_ReadCycles() - Profile_StartCycles[Probe]));
+		}
+	#endif
+
+#endif
+
@@ -0,0 +1,237 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Report and command protocol of the device, shared by the firmware and the host simulator. This header must
+ *  not include any of the board drivers, as they define their state in their headers.
+ */
+
+#ifndef _PROTOCOL_H_
+#define _PROTOCOL_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+
+	/* Macros: */
+		/** LED mask for the library LED driver, to indicate that the USB interface is not ready. The \c LEDS_LED*
+		 *  masks are those of the board LED driver, which must be included to use the \c LEDMASK_* masks.
+		 */
+		#define LEDMASK_USB_NOTREADY      LEDS_LED1
+
+		/** LED mask for the library LED driver, to indicate that the USB interface is enumerating. */
+		#define LEDMASK_USB_ENUMERATING  (LEDS_LED2 | LEDS_LED3)
+
+		/** LED mask for the library LED driver, to indicate that the USB interface is ready. */
+		#define LEDMASK_USB_READY        (LEDS_LED2 | LEDS_LED4)
+
+		/** LED mask for the library LED driver, to indicate that an error has occurred in the USB interface. */
+		#define LEDMASK_USB_ERROR        (LEDS_LED1 | LEDS_LED3)
+		
+		/** Byte mask for the library 4201AS driver, to indicate that the USB device is not ready. */
+		#define BYTEMASK_USB_NOTREADY    0b00001101 //11
+		
+		/** Byte mask for the library 4201AS driver, to indicate that the USB interface is enumerating. */
+		#define BYTEMASK_USB_ENUMERATING  0b00000000 //0
+		
+		/** Byte mask for the library 4201AS driver, to indicate that the USB interface is ready. */
+		#define BYTEMASK_USB_READY        0b00001100 //10
+
+		/** Offset in the IN report of the report sequence number, incremented for every report sent so that the host
+		 *  can detect lost reports.
+		 */
+		#define REPORT_IN_SEQUENCE        0
+
+		/** Offset in the IN report of the signed number of encoder steps turned since the previous report. */
+		#define REPORT_IN_STEPS           1
+
+		/** Offset in the IN report of the mask of button gestures recognised since the previous report, with the
+		 *  \c GESTURE_* flags of button 1 in the lowest \ref GESTURE_BITS bits followed by those of button 2. The
+		 *  gestures followed the steps of the same report, and a further gesture of a button already in the report
+		 *  is sent in a later report, so that the host sees the input in order.
+		 */
+		#define REPORT_IN_BUTTONS         2
+
+		/** Offset in the IN report of the current encoder count. */
+		#define REPORT_IN_COUNT           3
+
+		/** Offset in the IN report of the ID of a completed update latency trace, or \ref TRACE_ID_NONE. */
+		#define REPORT_IN_TRACE_ID        4
+
+		/** Offset in the IN report of the number of USB frames since the traced report arrived. */
+		#define REPORT_IN_TRACE_ARRIVED   5
+
+		/** Offset in the IN report of the number of USB frames since the display first showed the traced report's
+		 *  changes.
+		 */
+		#define REPORT_IN_TRACE_SHOWN     6
+
+		/** Command setting the number shown on the display. Value: number (1 byte). */
+		#define COMMAND_SET_NUMBER        0x01
+
+		/** Command setting the LED ladder directly. Value: mask with bit 0 for LED 1 through bit 3 for LED 4 (1 byte). */
+		#define COMMAND_SET_LEDS          0x02
+
+		/** Command setting the LED ladder from the level thresholds. Value: level (1 byte). */
+		#define COMMAND_SET_LEVEL         0x03
+
+		/** Command setting the level thresholds of each LED of the ladder. Value: one threshold per LED (4 bytes). */
+		#define COMMAND_SET_THRESHOLDS    0x04
+
+		/** Command setting the display brightness from 0 to 15 without rewriting the digits. Value: level of both
+		 *  digits (1 byte), or level of the ten's then the one's digit (2 bytes).
+		 */
+		#define COMMAND_SET_BRIGHTNESS    0x05
+
+		/** Command setting the display refresh rate. Value: rate in Hz, clamped to \ref DISPLAY_MIN_REFRESH_HZ and
+		 *  \ref DISPLAY_MAX_REFRESH_HZ (1 byte).
+		 */
+		#define COMMAND_SET_REFRESH       0x06
+
+		/** Command queuing level samples for the LED ladder meter, played back one per sample period. Value: one
+		 *  level per byte, oldest first (1 or more bytes).
+		 */
+		#define COMMAND_METER_SAMPLES     0x07
+
+		/** Command setting the ballistics of the LED ladder meter. Value: attack, release, peak hold frames, peak
+		 *  decay and sample period frames (5 bytes), as in \ref Meter_Config_t.
+		 */
+		#define COMMAND_SET_METER         0x08
+
+		/** Command storing a keyframe of an animation sequence. Value: slot in the high nibble and keyframe index in
+		 *  the low nibble, then the frames, number, level and brightness/flags of \ref Animation_Keyframe_t (5 bytes).
+		 */
+		#define COMMAND_ANIM_KEYFRAME     0x09
+
+		/** Command starting a stored animation sequence. Value: slot, number of keyframes and number of plays, zero
+		 *  to loop until stopped (3 bytes).
+		 */
+		#define COMMAND_ANIM_START        0x0A
+
+		/** Command stopping the running animation, leaving its last number and level shown at the saved brightness.
+		 *  Value: none.
+		 */
+		#define COMMAND_ANIM_STOP         0x0B
+
+		/** Command setting the encoder count range and acceleration. Value: highest count, then the acceleration
+		 *  curve as an \c ENCODER_CURVE_* value (2 bytes). The command is ignored if the curve is unknown.
+		 */
+		#define COMMAND_SET_ENCODER       0x0C
+
+		/** Command tagging the report it is sent in for update latency tracing, returned in a later IN report once
+		 *  the display shows the report's changes. Value: trace ID, never \ref TRACE_ID_NONE (1 byte).
+		 */
+		#define COMMAND_TRACE             0x0D
+
+		/** Command setting the button gesture timings. Value: long press time and double click time in units of
+		 *  \ref GESTURES_UNIT_MS, zero disabling the gesture, as in \ref Gestures_Config_t (2 bytes).
+		 */
+		#define COMMAND_SET_BUTTONS       0x0E
+
+		/** Legacy fixed format command, sent without a length as the first byte of a report and followed by the
+		 *  number and the level.
+		 */
+		#define COMMAND_LEGACY_VOLUME     0x80
+
+		/** Offset in the feature report of the page selector. */
+		#define FEATURE_SELECTOR          0
+
+		/** Offset in the feature report of the page data. */
+		#define FEATURE_DATA              1
+
+		/** Feature page selector flag which only selects the page to be read back by the next GET_FEATURE,
+		 *  without writing it.
+		 */
+		#define FEATURE_SELECT_ONLY       0x80
+
+		/** First feature page of the ladder level map, followed by the rest of its \ref LADDER_PAGE_COUNT pages. The
+		 *  page data is the \ref LADDER_PAGE_SIZE bytes of packed ladder masks of \ref LADDER_PAGE_ENTRIES levels.
+		 */
+		#define FEATURE_PAGE_LADDER       0x00
+
+		/** Feature page rendering a level through the ladder level map. Writing it takes the level in its first data
+		 *  byte, and reading it back returns that level followed by the ladder mask rendered for it.
+		 */
+		#define FEATURE_PAGE_PROBE        0x40
+
+		/** First feature page of the main loop stall watchdog statistics, followed by the rest of its
+		 *  \ref WATCHDOG_PAGE_COUNT pages. Reading a page returns \ref WATCHDOG_PAGE_SIZE bytes: the summary of
+		 *  the stall log and the longest main loop iteration on the first page, then one stall record per page.
+		 *  Writing the first page clears them. Only present when \c WATCHDOG_ENABLED is set.
+		 */
+		#define FEATURE_PAGE_WATCHDOG     0x30
+
+		/** Feature page of the low power statistics. Reading it returns the number of bus suspends and of remote
+		 *  wakeups signalled by the encoder, followed by the \c SMCR, \c PRR0, \c PRR1, \c TCCR0B and \c CLKPR
+		 *  registers as they were when the core last went to sleep while suspended. Writing it clears the counts.
+		 */
+		#define FEATURE_PAGE_POWER        0x48
+
+		/** First feature page of the firmware profiling statistics, followed by the rest of the
+		 *  \ref PROFILE_PAGE_COUNT pages of the first probe and then those of each further probe. Writing any page
+		 *  of a probe latches and resets its statistics, and reading a page returns \ref PROFILE_PAGE_SIZE bytes of
+		 *  the statistics last latched. Only present when \c PROFILE_ENABLED is set.
+		 */
+		#define FEATURE_PAGE_PROFILE      0x50
+
+		/** Offsets in the data of \ref FEATURE_PAGE_POWER of the number of bus suspends, of the number of remote
+		 *  wakeups, and of the registers snapshotted as the core last went to sleep while suspended.
+		 */
+		#define POWER_SUSPENDS            0
+		#define POWER_REMOTE_WAKEUPS      1
+		#define POWER_SLEEP_SMCR          2
+		#define POWER_SLEEP_PRR0          3
+		#define POWER_SLEEP_PRR1          4
+		#define POWER_SLEEP_TCCR0B        5
+		#define POWER_SLEEP_CLKPR         6
+
+		/** Number of bytes of data of \ref FEATURE_PAGE_POWER. */
+		#define POWER_PAGE_SIZE           7
+
+		/** Peripherals powered down while the bus is suspended, as the bits of \c PRR0 and of \c PRR1. */
+		#define POWER_PRR0_SUSPENDED      ((1 << PRTWI) | (1 << PRTIM0) | (1 << PRSPI) | (1 << PRADC))
+		#define POWER_PRR1_SUSPENDED      (1 << PRUSART1)
+
+		/** System clock prescaler setting, as the \c CLKPS bits of \c CLKPR, used while the bus is suspended to
+		 *  divide the clock down to 2MHz.
+		 */
+		#define SUSPEND_CLOCK_DIVISION    ((1 << CLKPS1) | (1 << CLKPS0))
+
+		/** Acceleration curves of \ref COMMAND_SET_ENCODER: none, gentle and steep, and the number of curves. These
+		 *  are the \c ROTARY_ACCEL_* values of the encoder driver, which the firmware checks when it is built.
+		 */
+		#define ENCODER_CURVE_NONE        0
+		#define ENCODER_CURVE_GENTLE      1
+		#define ENCODER_CURVE_STEEP       2
+		#define ENCODER_CURVE_COUNT       3
+
+		/** Range \ref COMMAND_SET_REFRESH clamps the display refresh rate to, in Hz, and the highest level of
+		 *  \ref COMMAND_SET_BRIGHTNESS. These are the limits of the 4201AS driver, which the firmware checks when it
+		 *  is built.
+		 */
+		#define DISPLAY_MIN_REFRESH_HZ    31
+		#define DISPLAY_MAX_REFRESH_HZ    240
+		#define DISPLAY_BRIGHTNESS_MAX    15
+
+#endif
+
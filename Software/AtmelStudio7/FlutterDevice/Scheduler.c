@@ -0,0 +1,157 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Event driven scheduler for the main loop. Interrupt handlers post event flags, and the main loop sleeps in
+ *  idle mode until at least one event is pending instead of spinning on the USB tasks. Idle mode keeps the USB
+ *  controller and timers running, so any of the USB general, encoder pin change or display timer interrupts
+ *  will wake the core again. While the bus is suspended the application selects power down mode instead, so
+ *  that only the USB controller and the encoder pin change interrupt can wake it.
+ */
+
+#include "Scheduler.h"
+
+/** Mask of \c SCHED_EVENT_* flags posted since the main loop last collected them. */
+volatile uint8_t Scheduler_PendingEvents;
+
+#if defined(SCHED_CYCLE_ACCOUNTING)
+/** Number of Timer 1 overflows, extending the timer to a 32-bit cycle counter. */
+static volatile uint16_t TimerOverflows;
+
+/** Cycle count at the start of the current accounting window. */
+static uint32_t WindowStart;
+
+/** Number of cycles spent asleep in the current accounting window. */
+static uint32_t IdleCycles;
+
+/** CPU busy percentage over the last complete accounting window. Kept in a global so that it can also be
+ *  inspected directly from a debugger or simulator.
+ */
+volatile uint8_t Scheduler_BusyPercent;
+
+ISR(TIMER1_OVF_vect, ISR_BLOCK)
+{
+	TimerOverflows++;
+}
+
+/** Reads the free running Timer 1 as a 32-bit cycle count, accounting for an overflow that is still pending. */
+static uint32_t Scheduler_ReadCycles(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t Low  = TCNT1;
+	uint16_t High = TimerOverflows;
+
+	if ((TIFR1 & (1 << TOV1)) && (Low < 0x8000))
+	  High++;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	return (((uint32_t)High << 16) | Low);
+}
+
+/** Returns the CPU busy percentage measured over the last complete accounting window of one second. */
+uint8_t Scheduler_GetBusyPercent(void)
+{
+	return Scheduler_BusyPercent;
+}
+#endif
+
+/** Configures the sleep mode used while waiting for events, and the cycle accounting timer if enabled. */
+void Scheduler_Init(void)
+{
+	Scheduler_PendingEvents = 0;
+
+	set_sleep_mode(SLEEP_MODE_IDLE);
+
+	#if defined(SCHED_CYCLE_ACCOUNTING)
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+	TIMSK1 = (1 << TOIE1);
+
+	WindowStart = Scheduler_ReadCycles();
+	IdleCycles  = 0;
+	#endif
+}
+
+/** Waits until at least one event is pending, sleeping the core in the meantime, and collects the pending events.
+ *
+ *  \param[in] AllowSleep  Whether the core may be put to sleep. When \c false (e.g. while the USB interface still
+ *                         needs to be polled to enumerate) \ref SCHED_EVENT_USB is always returned immediately.
+ *
+ *  \return Mask of the \c SCHED_EVENT_* flags that were pending.
+ */
+uint8_t Scheduler_WaitForEvents(const bool AllowSleep)
+{
+	GlobalInterruptDisable();
+
+	#if !defined(SCHED_NO_SLEEP)
+	if (AllowSleep && !(Scheduler_PendingEvents))
+	{
+		#if defined(SCHED_CYCLE_ACCOUNTING)
+		uint32_t SleepStart = Scheduler_ReadCycles();
+		#endif
+
+		/* The instruction following SEI is always executed before any pending interrupt is serviced, so an
+		 * event posted after the check above still wakes the core instead of being slept through */
+		sleep_enable();
+		GlobalInterruptEnable();
+		sleep_cpu();
+		sleep_disable();
+
+		#if defined(SCHED_CYCLE_ACCOUNTING)
+		IdleCycles += (Scheduler_ReadCycles() - SleepStart);
+		#endif
+
+		GlobalInterruptDisable();
+	}
+	#endif
+
+	uint8_t Events = Scheduler_PendingEvents;
+	Scheduler_PendingEvents = 0;
+
+	GlobalInterruptEnable();
+
+	#if defined(SCHED_NO_SLEEP)
+	Events |= SCHED_EVENT_USB;
+	#else
+	if (!(AllowSleep))
+	  Events |= SCHED_EVENT_USB;
+	#endif
+
+	#if defined(SCHED_CYCLE_ACCOUNTING)
+	uint32_t WindowLength = (Scheduler_ReadCycles() - WindowStart);
+
+	if (WindowLength >= F_CPU)
+	{
+		Scheduler_BusyPercent = (100 - (uint8_t)(IdleCycles / (WindowLength / 100)));
+		WindowStart += WindowLength;
+		IdleCycles   = 0;
+	}
+	#endif
+
+	return Events;
+}
+
@@ -0,0 +1,88 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Scheduler.c.
+ */
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/sleep.h>
+		#include <avr/interrupt.h>
+		#include <stdbool.h>
+
+		#include "Config/AppConfig.h"
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Event flag posted when the USB interface needs servicing (start of frame or pending enumeration). */
+		#define SCHED_EVENT_USB          (1 << 0)
+
+		/** Event flag posted by the rotary encoder ISR when a detent has been counted. */
+		#define SCHED_EVENT_ENCODER      (1 << 1)
+
+		/** Event flag posted by the display ISR when a multiplex frame has completed. */
+		#define SCHED_EVENT_DISPLAY      (1 << 2)
+
+		/** Event flag posted by the button sampling ISR when a button gesture has been recognised. */
+		#define SCHED_EVENT_BUTTONS      (1 << 3)
+
+	/* External Variables: */
+		extern volatile uint8_t Scheduler_PendingEvents;
+
+		#if defined(SCHED_CYCLE_ACCOUNTING)
+		extern volatile uint8_t Scheduler_BusyPercent;
+		#endif
+
+	/* Inline Functions: */
+		/** Marks one or more events as pending, waking the main loop if it is asleep. This may be called from
+		 *  both interrupt and main context.
+		 *
+		 *  \param[in] Events  Mask of \c SCHED_EVENT_* flags to post.
+		 */
+		static inline void Scheduler_PostEvent(const uint8_t Events) ATTR_ALWAYS_INLINE;
+		static inline void Scheduler_PostEvent(const uint8_t Events)
+		{
+			uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+			GlobalInterruptDisable();
+
+			Scheduler_PendingEvents |= Events;
+
+			SetGlobalInterruptMask(CurrentGlobalInt);
+		}
+
+	/* Function Prototypes: */
+		void    Scheduler_Init(void);
+		uint8_t Scheduler_WaitForEvents(const bool AllowSleep);
+
+		#if defined(SCHED_CYCLE_ACCOUNTING)
+		uint8_t Scheduler_GetBusyPercent(void) ATTR_WARN_UNUSED_RESULT;
+		#endif
+
+#endif
+
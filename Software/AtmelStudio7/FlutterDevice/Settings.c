@@ -0,0 +1,160 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Log-structured settings store in EEPROM. The EEPROM is divided into a ring of fixed size slots, and each save
+ *  appends a complete record with a sequence number and a CRC into the slot after the current one, never over it.
+ *  At boot the valid record with the newest sequence number is loaded, so a save cut short by power loss fails its
+ *  CRC and the previous record stays current. Spreading the records around the ring spreads the wear over every
+ *  cell, and saves are deferred until the settings have been left alone for a while so that a burst of changes
+ *  from the host costs a single record.
+ *
+ *  Records are written one byte per call of \ref Settings_Task(), only once the EEPROM is ready, so the main loop
+ *  never waits on the multi-millisecond EEPROM write cycle.
+ */
+
+#include "Settings.h"
+
+/** Current device settings. Modules are configured from these at boot, and any change to them must be followed by
+ *  a call to \ref Settings_Changed() to have it saved.
+ */
+Settings_t Settings;
+
+/** Current record, or the record being written while a save is in progress. */
+static Settings_Record_t Record;
+
+/** Slot of the current record. */
+static uint8_t CurrentSlot;
+
+/** Offset of the next byte of \ref Record to write, or the record size when no save is in progress. */
+static uint8_t WriteOffset = sizeof(Settings_Record_t);
+
+/** Display frames left before changed settings are saved, zero if there are no unsaved changes. */
+static uint8_t DeferFrames;
+
+/** Computes the CRC of a record.
+ *
+ *  \param[in] ThisRecord  Record to compute the CRC of.
+ *
+ *  \return CRC-CCITT of all fields of the record preceding the CRC.
+ */
+static uint16_t Settings_RecordCRC(const Settings_Record_t* const ThisRecord)
+{
+	const uint8_t* Data = (const uint8_t*)ThisRecord;
+	uint16_t       CRC  = 0xFFFF;
+
+	for (uint8_t Offset = 0; Offset < offsetof(Settings_Record_t, CRC); Offset++)
+	  CRC = _crc_ccitt_update(CRC, Data[Offset]);
+
+	return CRC;
+}
+
+/** Retrieves the address of a record slot in EEPROM. */
+static inline uint8_t* Settings_SlotAddress(const uint8_t Slot)
+{
+	return (uint8_t*)((uint16_t)Slot * SETTINGS_SLOT_SIZE);
+}
+
+/** Loads the current settings from the newest valid record in the store, or the defaults if there is none. This
+ *  reads the sequence number of each slot, and only reads and checks the whole record of slots newer than the best
+ *  found so far.
+ *
+ *  \param[in] Defaults  Settings to use when the store holds no valid record, located in FLASH memory.
+ */
+void Settings_Init(const Settings_t* const Defaults)
+{
+	bool Found = false;
+
+	for (uint8_t Slot = 0; Slot < SETTINGS_SLOT_COUNT; Slot++)
+	{
+		Settings_Record_t SlotRecord;
+		uint16_t          Sequence = eeprom_read_word((const uint16_t*)Settings_SlotAddress(Slot));
+
+		//Sequence numbers wrap, so compare them by their distance
+		if (Found && ((int16_t)(Sequence - Record.Sequence) <= 0))
+		  continue;
+
+		eeprom_read_block(&SlotRecord, Settings_SlotAddress(Slot), sizeof(Settings_Record_t));
+
+		if ((SlotRecord.Version != SETTINGS_VERSION) || (SlotRecord.CRC != Settings_RecordCRC(&SlotRecord)))
+		  continue;
+
+		Record      = SlotRecord;
+		CurrentSlot = Slot;
+		Found       = true;
+	}
+
+	if (!(Found))
+	{
+		memcpy_P(&Record.Settings, Defaults, sizeof(Settings_t));
+		Record.Sequence = 0;
+		CurrentSlot     = (SETTINGS_SLOT_COUNT - 1);
+	}
+
+	Settings    = Record.Settings;
+	WriteOffset = sizeof(Settings_Record_t);
+	DeferFrames = 0;
+}
+
+/** Notes that the current settings have changed, deferring their save until they have been left unchanged for
+ *  \ref SETTINGS_DEFER_FRAMES display frames.
+ */
+void Settings_Changed(void)
+{
+	DeferFrames = SETTINGS_DEFER_FRAMES;
+}
+
+/** Advances the settings store by one display frame, starting a deferred save when it is due and writing the next
+ *  byte of a save in progress once the EEPROM is ready for it.
+ */
+void Settings_Task(void)
+{
+	if (WriteOffset < sizeof(Settings_Record_t))
+	{
+		if (!(eeprom_is_ready()))
+		  return;
+
+		eeprom_update_byte(Settings_SlotAddress(CurrentSlot) + WriteOffset, ((uint8_t*)&Record)[WriteOffset]);
+		WriteOffset++;
+		return;
+	}
+
+	if (!(DeferFrames) || --DeferFrames)
+	  return;
+
+	//Changes that were undone again need no new record
+	if (memcmp(&Record.Settings, &Settings, sizeof(Settings_t)) == 0)
+	  return;
+
+	Record.Sequence++;
+	Record.Version  = SETTINGS_VERSION;
+	Record.Settings = Settings;
+	Record.CRC      = Settings_RecordCRC(&Record);
+
+	//The new record goes into the next slot of the ring, the current one stays valid until it is complete
+	if (++CurrentSlot == SETTINGS_SLOT_COUNT)
+	  CurrentSlot = 0;
+
+	WriteOffset = 0;
+}
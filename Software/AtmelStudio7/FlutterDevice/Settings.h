@@ -0,0 +1,93 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Settings.c.
+ */
+
+#ifndef _SETTINGS_H_
+#define _SETTINGS_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/eeprom.h>
+		#include <avr/pgmspace.h>
+		#include <util/crc16.h>
+		#include <stdbool.h>
+		#include <stddef.h>
+		#include <string.h>
+
+		#include <LUFA/Common/Common.h>
+
+		#include "Ladder.h"
+		#include "Meter.h"
+		#include "Gestures.h"
+
+	/* Macros: */
+		/** Version of the \ref Settings_t layout, records of any other version are ignored. */
+		#define SETTINGS_VERSION         2
+
+		/** Size in bytes of each record slot of the settings store in EEPROM. */
+		#define SETTINGS_SLOT_SIZE       32
+
+		/** Number of record slots in the settings store, filling the EEPROM. */
+		#define SETTINGS_SLOT_COUNT      ((E2END + 1) / SETTINGS_SLOT_SIZE)
+
+		/** Display frames without any further change before changed settings are written to EEPROM, so that a run of
+		 *  changes from the host is written as a single record.
+		 */
+		#define SETTINGS_DEFER_FRAMES    200
+
+	/* Type Defines: */
+		/** Type define for the persistent device settings. */
+		typedef struct
+		{
+			uint8_t           RotaryMax; /**< Highest value of the encoder count. */
+			uint8_t           RotaryCurve; /**< Acceleration curve of the encoder, a \c ROTARY_ACCEL_* value. */
+			uint8_t           Thresholds[LADDER_LED_COUNT]; /**< Level at which each LED of the ladder lights up. */
+			uint8_t           Brightness[2]; /**< Brightness level of the ten's then the one's digit. */
+			uint8_t           RefreshHz; /**< Refresh rate of the display in Hz. */
+			Meter_Config_t    Meter; /**< Ballistics of the level meter. */
+			Gestures_Config_t Buttons; /**< Gesture timings of the buttons. */
+		} Settings_t;
+
+		/** Type define for a record of the settings store, written whole into one slot. */
+		typedef struct
+		{
+			uint16_t   Sequence; /**< Sequence number of the record, the valid record with the newest is current. */
+			uint8_t    Version; /**< Layout version of the settings, \ref SETTINGS_VERSION. */
+			Settings_t Settings; /**< Settings held by the record. */
+			uint16_t   CRC; /**< CRC-CCITT of all preceding fields of the record. */
+		} Settings_Record_t;
+
+	/* External Variables: */
+		extern Settings_t Settings;
+
+	/* Function Prototypes: */
+		void Settings_Init(const Settings_t* const Defaults) ATTR_NON_NULL_PTR_ARG(1);
+		void Settings_Changed(void);
+		void Settings_Task(void);
+
+#endif
+
@@ -0,0 +1,145 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Update latency tracing. The host tags a report of commands with a trace ID, and the device stamps the USB frame
+ *  number the report arrived in and the frame number the display first showed a frame holding its changes, then
+ *  returns both in the next IN report as their ages in frames at the time the report was created. From its own
+ *  send and receive times the host can then split the host to glass latency into its host, bus and display parts.
+ *
+ *  Only one trace is followed at a time: a trace arriving before the previous one was returned replaces it, and
+ *  the host sees the previous one as lost.
+ */
+
+#include "Trace.h"
+
+/** States of the trace being followed. */
+enum Trace_States_t
+{
+	TRACE_STATE_Idle      = 0, /**< No trace is being followed. */
+	TRACE_STATE_Arrived   = 1, /**< The traced report is being processed. */
+	TRACE_STATE_Published = 2, /**< The traced report has been processed, waiting for its frame to be shown. */
+	TRACE_STATE_Shown     = 3, /**< The traced frame has been shown, waiting to be returned to the host. */
+};
+
+/** State of the trace being followed, a \ref Trace_States_t value. Only the display ISR moves it from published to
+ *  shown, and only main context moves it otherwise.
+ */
+static volatile uint8_t State;
+
+/** ID of the trace being followed. */
+static uint8_t CurrentID;
+
+/** Serial number of the display frame holding the changes of the traced report. */
+static uint8_t TraceSerial;
+
+/** USB frame number the traced report arrived in. */
+static uint16_t ArrivalFrame;
+
+/** USB frame number the traced frame was first shown in. */
+static uint16_t ShownFrame;
+
+/** Returns the number of frames from one USB frame number to a later one, saturated to \ref TRACE_AGE_MAX. */
+static uint8_t Trace_Age(const uint16_t From,
+                         const uint16_t To)
+{
+	uint16_t Age = ((To - From) & TRACE_FRAME_MASK);
+
+	return (Age > TRACE_AGE_MAX) ? TRACE_AGE_MAX : Age;
+}
+
+/** Starts following a trace, replacing any trace that has not yet been returned. This must be called from main
+ *  context while processing the traced report.
+ *
+ *  \param[in] TraceID  Trace ID sent by the host, never \ref TRACE_ID_NONE.
+ *  \param[in] Frame    Current USB frame number.
+ */
+void Trace_Arrived(const uint8_t TraceID,
+                   const uint16_t Frame)
+{
+	//Stop the display ISR looking at the trace before it is rewritten
+	State = TRACE_STATE_Idle;
+
+	CurrentID    = TraceID;
+	ArrivalFrame = Frame;
+
+	State = TRACE_STATE_Arrived;
+}
+
+/** Marks the end of the processing of a report, so that a trace it carried waits for the frame holding its
+ *  changes to be shown. This must be called from main context after every report is processed.
+ *
+ *  \param[in] FrameSerial  Serial number of the last display frame completed.
+ */
+void Trace_Published(const uint8_t FrameSerial)
+{
+	if (State != TRACE_STATE_Arrived)
+	  return;
+
+	TraceSerial = FrameSerial;
+	GCC_MEMORY_BARRIER();
+	State = TRACE_STATE_Published;
+}
+
+/** Stamps the trace being followed once the display shows its frame. This is called from the display ISR at the
+ *  end of each multiplex frame.
+ *
+ *  \param[in] ShownSerial  Serial number of the display frame being shown.
+ *  \param[in] Frame        Current USB frame number.
+ */
+void Trace_FrameShown(const uint8_t ShownSerial,
+                      const uint16_t Frame)
+{
+	if (State != TRACE_STATE_Published)
+	  return;
+
+	//Serial numbers wrap, so the frame is shown once the shown serial has reached it
+	if ((int8_t)(ShownSerial - TraceSerial) < 0)
+	  return;
+
+	ShownFrame = Frame;
+	State      = TRACE_STATE_Shown;
+}
+
+/** Retrieves the result of a trace once its frame has been shown, ending the trace.
+ *
+ *  \param[in]  Frame   Current USB frame number, that the ages are measured to.
+ *  \param[out] Result  Buffer of 3 bytes to write the trace ID, the age of the arrival stamp and the age of the
+ *                      shown stamp into, in frames.
+ *
+ *  \return Boolean \c true if a trace result was retrieved, \c false otherwise.
+ */
+bool Trace_GetResult(const uint16_t Frame,
+                     uint8_t* const Result)
+{
+	if (State != TRACE_STATE_Shown)
+	  return false;
+
+	Result[0] = CurrentID;
+	Result[1] = Trace_Age(ArrivalFrame, Frame);
+	Result[2] = Trace_Age(ShownFrame, Frame);
+
+	State = TRACE_STATE_Idle;
+	return true;
+}
@@ -0,0 +1,58 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *
+ *  Header file for Trace.c.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <stdbool.h>
+
+		#include <LUFA/Common/Common.h>
+
+	/* Macros: */
+		/** Trace ID reported when there is no trace result, so never used by the host for a trace. */
+		#define TRACE_ID_NONE            0
+
+		/** Mask of the 11 significant bits of a USB frame number. */
+		#define TRACE_FRAME_MASK         0x07FF
+
+		/** Largest frame count reported, longer times saturate to it. */
+		#define TRACE_AGE_MAX            0xFF
+
+	/* Function Prototypes: */
+		void Trace_Arrived(const uint8_t TraceID,
+		                   const uint16_t Frame);
+		void Trace_Published(const uint8_t FrameSerial);
+		void Trace_FrameShown(const uint8_t ShownSerial,
+		                      const uint16_t Frame);
+		bool Trace_GetResult(const uint16_t Frame,
+		                     uint8_t* const Result) ATTR_NON_NULL_PTR_ARG(2);
+
+#endif
+
@@ -0,0 +1,248 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Main loop stall supervisor. The watchdog runs in interrupt and reset mode and is kicked at the end of every main
+ *  loop iteration, so an iteration that blocks for \ref WATCHDOG_TIMEOUT first fires the watchdog interrupt. This
+ *  records the address the stalled code was interrupted at in a log kept in the \c .noinit section, and the device
+ *  is reset when the timeout passes again. A stall with interrupts disabled only shows up as the reset, and is
+ *  logged at the next start-up with an unknown address, provided the bootloader leaves the reset flags intact.
+ *
+ *  The longest main loop iteration since start-up is also tracked, in CPU cycles against the free running Timer 1
+ *  and in USB frames. The host reads the log and the longest iteration through the feature report, and clears
+ *  them by writing the summary page. When \c WATCHDOG_ENABLED is not set the watchdog stays disabled and this
+ *  module is empty.
+ */
+
+#include "Watchdog.h"
+
+#if defined(WATCHDOG_ENABLED)
+/** Value of \c Magic while the stall log holds valid records. */
+#define WATCHDOG_LOG_MAGIC           0x5747
+
+/** Log of the latest stalls, left uninitialised by the C runtime so that it survives a watchdog reset. */
+static struct
+{
+	uint16_t         Magic; /**< \ref WATCHDOG_LOG_MAGIC once initialised, anything else after a power on. */
+	uint8_t          Next; /**< Index of the record to write next. */
+	uint8_t          Count; /**< Number of valid records. */
+	uint8_t          Stalls; /**< Number of stalls since the log was cleared, saturating at 0xFF. */
+	bool             Recorded; /**< Set when the watchdog interrupt has logged the stall of the coming reset. */
+	Watchdog_Stall_t Records[WATCHDOG_STALL_RECORDS]; /**< Stall records, oldest at \c (Next - Count). */
+} StallLog ATTR_NO_INIT;
+
+/** Reset flags read from \c MCUSR at start-up. */
+static uint8_t ResetCause;
+
+/** Cycle count at the start of the current main loop iteration. */
+static uint16_t IterationCycles;
+
+/** USB frame number at the start of the current main loop iteration. */
+static uint16_t IterationFrame;
+
+/** Longest main loop iteration in CPU cycles, saturating at 0xFFFF. */
+static uint16_t MaxIterationCycles;
+
+/** Longest main loop iteration in USB frames. */
+static uint16_t MaxIterationFrames;
+
+/** Adds a stall to the log, overwriting the oldest record once it is full. */
+static void Watchdog_LogStall(const uint16_t Address)
+{
+	StallLog.Records[StallLog.Next] = (Watchdog_Stall_t)
+		{
+			.Address     = Address,
+			.DeviceState = USB_DeviceState,
+		};
+
+	StallLog.Next = ((StallLog.Next + 1) % WATCHDOG_STALL_RECORDS);
+
+	if (StallLog.Count < WATCHDOG_STALL_RECORDS)
+	  StallLog.Count++;
+
+	if (StallLog.Stalls < 0xFF)
+	  StallLog.Stalls++;
+}
+
+/** Reads the free running Timer 1 cycle counter, with interrupts disabled for the 16-bit read. */
+static uint16_t Watchdog_ReadCycles(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	uint16_t Cycles = TCNT1;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	return Cycles;
+}
+
+/** Takes over the watchdog from the bootloader or fuses, validates the stall log left from before the reset and
+ *  logs a stall the watchdog interrupt could not record, then starts the watchdog and Timer 1. This must run first
+ *  at start-up, as a watchdog reset leaves the watchdog running with its shortest timeout. The timer runs at the
+ *  same rate as for the scheduler's cycle accounting and the profiling probes, so they can share it.
+ */
+void Watchdog_Init(void)
+{
+	uint8_t ResetFlags = MCUSR;
+
+	MCUSR = 0;
+	wdt_disable();
+
+	ResetCause = ResetFlags;
+
+	if ((ResetFlags & ((1 << PORF) | (1 << BORF))) || (StallLog.Magic != WATCHDOG_LOG_MAGIC) ||
+	    (StallLog.Next >= WATCHDOG_STALL_RECORDS) || (StallLog.Count > WATCHDOG_STALL_RECORDS))
+	{
+		Watchdog_Clear();
+	}
+	else if ((ResetFlags & (1 << WDRF)) && !(StallLog.Recorded))
+	{
+		Watchdog_LogStall(WATCHDOG_ADDRESS_UNKNOWN);
+	}
+
+	StallLog.Recorded  = false;
+	MaxIterationCycles = 0;
+	MaxIterationFrames = 0;
+
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	Watchdog_BeginIteration();
+	Watchdog_Start();
+}
+
+/** Starts the watchdog in interrupt and reset mode with the \ref WATCHDOG_TIMEOUT timeout. */
+void Watchdog_Start(void)
+{
+	uint8_t Prescaler = (((WATCHDOG_TIMEOUT & 0x08) ? (1 << WDP3) : 0) | (WATCHDOG_TIMEOUT & 0x07));
+
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	/* The new configuration must be written within four cycles of enabling the change */
+	wdt_reset();
+	WDTCSR = ((1 << WDCE) | (1 << WDE));
+	WDTCSR = ((1 << WDIE) | (1 << WDE) | Prescaler);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Stops the watchdog until it is started again with \ref Watchdog_Start(). */
+void Watchdog_Stop(void)
+{
+	wdt_disable();
+}
+
+/** Marks the start of the work of a main loop iteration, see \ref WATCHDOG_BEGIN_ITERATION(). */
+void Watchdog_BeginIteration(void)
+{
+	IterationCycles = Watchdog_ReadCycles();
+	IterationFrame  = USB_Device_GetFrameNumber();
+}
+
+/** Marks the end of the work of a main loop iteration and kicks the watchdog, see \ref WATCHDOG_END_ITERATION().
+ *  Timer 1 wraps after 65536 cycles, so an iteration spanning four or more USB frames is taken as saturating the
+ *  cycle count. USB frames are only counted while the bus is active.
+ */
+void Watchdog_EndIteration(void)
+{
+	wdt_reset();
+
+	uint16_t Cycles = (Watchdog_ReadCycles() - IterationCycles);
+	uint16_t Frames = ((USB_Device_GetFrameNumber() - IterationFrame) & 0x7FF);
+
+	if (Frames >= 4)
+	  Cycles = 0xFFFF;
+
+	if (Cycles > MaxIterationCycles)
+	  MaxIterationCycles = Cycles;
+
+	if (Frames > MaxIterationFrames)
+	  MaxIterationFrames = Frames;
+}
+
+/** Clears the stall log and the longest main loop iteration. */
+void Watchdog_Clear(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	memset(&StallLog, 0, sizeof(StallLog));
+	StallLog.Magic = WATCHDOG_LOG_MAGIC;
+
+	MaxIterationCycles = 0;
+	MaxIterationFrames = 0;
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Reads a page of the watchdog statistics, little endian. Page 0 holds the number of stall records, the number
+ *  of stalls, the reset flags at start-up and the longest main loop iteration in cycles and in USB frames. Pages
+ *  1 onwards hold the address and USB device state of each stall record, oldest first, and read as zero past the
+ *  last record.
+ *
+ *  \param[in]  Page  Page to read, less than \ref WATCHDOG_PAGE_COUNT.
+ *  \param[out] Data  Buffer of \ref WATCHDOG_PAGE_SIZE bytes to read the page into.
+ */
+void Watchdog_ReadPage(const uint8_t Page,
+                       uint8_t* const Data)
+{
+	memset(Data, 0, WATCHDOG_PAGE_SIZE);
+
+	if (Page == 0)
+	{
+		Data[0] = StallLog.Count;
+		Data[1] = StallLog.Stalls;
+		Data[2] = ResetCause;
+		Data[3] = (uint8_t)MaxIterationCycles;
+		Data[4] = (uint8_t)(MaxIterationCycles >> 8);
+		Data[5] = (uint8_t)MaxIterationFrames;
+		Data[6] = (uint8_t)(MaxIterationFrames >> 8);
+	}
+	else if (Page <= StallLog.Count)
+	{
+		uint8_t Index = ((StallLog.Next + WATCHDOG_STALL_RECORDS - StallLog.Count + (Page - 1)) % WATCHDOG_STALL_RECORDS);
+
+		Data[0] = (uint8_t)StallLog.Records[Index].Address;
+		Data[1] = (uint8_t)(StallLog.Records[Index].Address >> 8);
+		Data[2] = StallLog.Records[Index].DeviceState;
+	}
+}
+
+/** Watchdog interrupt, fired when a main loop iteration has run for \ref WATCHDOG_TIMEOUT. Nothing needs to be
+ *  preserved since the device resets on the next timeout, so the handler is naked and the program counter of the
+ *  stalled code is still on top of the stack, as a big endian word address.
+ */
+ISR(WDT_vect, ISR_NAKED)
+{
+	__asm__ __volatile__ ("clr __zero_reg__");
+
+	const uint8_t* ReturnAddress = ((const uint8_t*)SP + 1);
+
+	Watchdog_LogStall((((uint16_t)ReturnAddress[0] << 8) | ReturnAddress[1]) << 1);
+	StallLog.Recorded = true;
+
+	for (;;);
+}
+#endif
@@ -0,0 +1,113 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+/** \file
+ *
+ *  Header file for Watchdog.c.
+ */
+
+#ifndef _WATCHDOG_H_
+#define _WATCHDOG_H_
+
+	/* Includes: */
+		#include <avr/io.h>
+		#include <avr/wdt.h>
+		#include <avr/interrupt.h>
+		#include <stdbool.h>
+		#include <string.h>
+
+		#include "Config/AppConfig.h"
+
+		#include <LUFA/Common/Common.h>
+		#include <LUFA/Drivers/USB/USB.h>
+
+	/* Macros: */
+		#if !defined(WATCHDOG_TIMEOUT) || defined(__DOXYGEN__)
+			/** Watchdog timeout as a \c WDTO_* value. A main loop iteration running this long is recorded as a stall,
+			 *  and the device is reset once the same time has passed again.
+			 */
+			#define WATCHDOG_TIMEOUT             WDTO_250MS
+		#endif
+
+		/** Number of stall records kept across resets, the oldest being overwritten by new ones. */
+		#define WATCHDOG_STALL_RECORDS       4
+
+		/** Stall record address of a stall that did not let the watchdog interrupt run, so only the reset was seen. */
+		#define WATCHDOG_ADDRESS_UNKNOWN     0xFFFF
+
+		/** Number of pages the watchdog statistics are read through. Page 0 holds the summary and pages 1 onwards
+		 *  the stall records, oldest first.
+		 */
+		#define WATCHDOG_PAGE_COUNT          (1 + WATCHDOG_STALL_RECORDS)
+
+		/** Size in bytes of each page of the watchdog statistics. */
+		#define WATCHDOG_PAGE_SIZE           7
+
+		#if defined(WATCHDOG_ENABLED) || defined(__DOXYGEN__)
+			/** Marks the start of the work of a main loop iteration, once its events have been collected. This
+			 *  compiles to nothing unless \c WATCHDOG_ENABLED is set.
+			 */
+			#define WATCHDOG_BEGIN_ITERATION()  Watchdog_BeginIteration()
+
+			/** Marks the end of the work of a main loop iteration, kicking the watchdog. This compiles to nothing
+			 *  unless \c WATCHDOG_ENABLED is set.
+			 */
+			#define WATCHDOG_END_ITERATION()    Watchdog_EndIteration()
+
+			/** Stops the watchdog while the main loop is legitimately blocked, such as while suspended. This compiles
+			 *  to nothing unless \c WATCHDOG_ENABLED is set.
+			 */
+			#define WATCHDOG_PAUSE()            Watchdog_Stop()
+
+			/** Restarts the watchdog after \ref WATCHDOG_PAUSE(). This compiles to nothing unless \c WATCHDOG_ENABLED
+			 *  is set.
+			 */
+			#define WATCHDOG_RESUME()           Watchdog_Start()
+		#else
+			#define WATCHDOG_BEGIN_ITERATION()
+			#define WATCHDOG_END_ITERATION()
+			#define WATCHDOG_PAUSE()
+			#define WATCHDOG_RESUME()
+		#endif
+
+	/* Type Defines: */
+		/** Type define for a stall record, written by the watchdog interrupt and kept across the reset that follows. */
+		typedef struct
+		{
+			uint16_t Address; /**< Byte address of the instruction the stall was interrupted at, or \ref WATCHDOG_ADDRESS_UNKNOWN. */
+			uint8_t  DeviceState; /**< USB device state at the time of the stall, a \c USB_Device_States_t value. */
+		} Watchdog_Stall_t;
+
+	#if defined(WATCHDOG_ENABLED)
+	/* Function Prototypes: */
+		void Watchdog_Init(void);
+		void Watchdog_Start(void);
+		void Watchdog_Stop(void);
+		void Watchdog_BeginIteration(void);
+		void Watchdog_EndIteration(void);
+		void Watchdog_Clear(void);
+		void Watchdog_ReadPage(const uint8_t Page,
+		                       uint8_t* const Data);
+	#endif
+
+#endif
+
@@ -249,6 +249,11 @@
 			/** Selects the Swallowtail ATmega32U4 specific board drivers, including the driver for the board LEDs. */
 			#define BOARD_SWALLOWTAIL		   61
 
+			/** Selects the Swallowtail board drivers for the host simulator build, where the board is modelled on the
+			 *  host and its registers are provided by the simulator instead of the AVR hardware.
+			 */
+			#define BOARD_HOSTSIM              62
+
 			#if !defined(__DOXYGEN__)
 				#define BOARD_                 BOARD_NONE
 
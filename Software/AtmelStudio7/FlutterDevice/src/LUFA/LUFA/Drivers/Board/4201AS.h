@@ -94,8 +94,15 @@
 		#if (BOARD == BOARD_NONE)
 			static inline void       SS_4201AS_Init(void) {}
 			static inline void       SS_4201AS_Disable(void) {}
-			static inline void SS_4201AS_WriteByte(uint8_t byteNum) {}
-		#elif (BOARD == BOARD_SWALLOWTAIL)
+			static inline void SS_4201AS_SetNum(const uint8_t byteNum) {}
+			static inline void SS_4201AS_SetHex(const uint8_t byteNum) {}
+			static inline void SS_4201AS_WriteByte(void) {}
+			static inline void SS_4201AS_SetBrightness(const uint8_t Digit, uint8_t Level) {}
+			static inline void SS_4201AS_SetAllBrightness(const uint8_t Level) {}
+			static inline void SS_4201AS_SetRefreshRate(uint8_t RefreshHz) {}
+			static inline uint8_t SS_4201AS_GetFrameSerial(void) { return 0; }
+			static inline uint8_t SS_4201AS_GetShownSerial(void) { return 0; }
+		#elif (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
 			#include "AVR8/SWALLOWTAIL/4201AS.h"
 		#else
 			#include "Board/4201AS.h"
@@ -142,6 +149,18 @@
 			#if !defined(EN_10)
 			#define EN_10	0
 			#endif
+
+			#if !defined(SS_4201AS_DIGITS)
+			#define SS_4201AS_DIGITS          2
+			#define SS_4201AS_DIGIT_TENS      0
+			#define SS_4201AS_DIGIT_ONES      1
+			#define SS_4201AS_BRIGHTNESS_MAX  15
+			#endif
+
+			#if !defined(SS_4201AS_MIN_REFRESH_HZ)
+			#define SS_4201AS_MIN_REFRESH_HZ  1
+			#define SS_4201AS_MAX_REFRESH_HZ  255
+			#endif
 		#endif
 
 	/* Pseudo-Functions for Doxygen: */
@@ -153,14 +172,74 @@
 		 */
 		static inline void SS_4201AS_Init(void);
 
-		/** Disables the board 4201AS driver, releasing the I/O pins back to their default high-impedance input mode. */
+		/** Disables the board 4201AS driver, stopping the multiplexer and leaving both digits blanked. */
 		static inline void SS_4201AS_Disable(void);
 		
-		/** Write the byte number to the two digit seven segment display. */
-		static inline void SS_4201AS_WriteByteHex(uint8_t byteNum);
+		/** Sets the number shown on the two digit seven segment display, as its two lowest decimal digits. The
+		 *  new digits are written to the back frame and swapped in by the multiplexer at the end of the frame
+		 *  being shown, so the digits are never torn and the caller never blocks.
+		 *
+		 *  \param[in] byteNum  Number to show.
+		 */
+		static inline void SS_4201AS_SetNum(const uint8_t byteNum);
+
+		/** Sets the byte shown on the two digit seven segment display as two hexadecimal digits, in the same way
+		 *  as \ref SS_4201AS_SetNum().
+		 *
+		 *  \param[in] byteNum  Byte to show.
+		 */
+		static inline void SS_4201AS_SetHex(const uint8_t byteNum);
+
+		/** Starts writing a new frame of the display, returning the back frame of \c SS_4201AS_DIGITS port images
+		 *  to fill. The frame is shown once \ref SS_4201AS_EndFrame() is called. Frames must only be written from
+		 *  a single context.
+		 *
+		 *  \return Pointer to the back frame.
+		 */
+		static inline uint8_t* SS_4201AS_BeginFrame(void);
+
+		/** Publishes the frame started with \ref SS_4201AS_BeginFrame(), to be swapped in by the multiplexer at the
+		 *  end of the frame being shown.
+		 */
+		static inline void SS_4201AS_EndFrame(void);
+
+		/** Returns the serial number of the last frame completed, whether by \ref SS_4201AS_EndFrame() or by any of
+		 *  the functions that set the digits. Serial numbers count up from zero, wrapping after 255.
+		 *
+		 *  \return Serial number of the last frame completed.
+		 */
+		static inline uint8_t SS_4201AS_GetFrameSerial(void);
+
+		/** Returns the serial number of the frame last swapped in to be shown by the multiplexer. Once this has
+		 *  caught up with a serial number returned by \ref SS_4201AS_GetFrameSerial(), that frame or a newer one is
+		 *  on the display. This may be called from the frame complete event.
+		 *
+		 *  \return Serial number of the frame being shown.
+		 */
+		static inline uint8_t SS_4201AS_GetShownSerial(void);
+
+		/** Sets the brightness of one digit, by blanking it part way through its share of each refresh period. The
+		 *  digits are not rewritten.
+		 *
+		 *  \param[in] Digit  Index of the digit, \c SS_4201AS_DIGIT_TENS or \c SS_4201AS_DIGIT_ONES.
+		 *  \param[in] Level  Brightness level from 0 to \c SS_4201AS_BRIGHTNESS_MAX (full on), clamped.
+		 */
+		static inline void SS_4201AS_SetBrightness(const uint8_t Digit, uint8_t Level);
+
+		/** Sets the brightness of all digits, as \ref SS_4201AS_SetBrightness().
+		 *
+		 *  \param[in] Level  Brightness level from 0 to \c SS_4201AS_BRIGHTNESS_MAX (full on), clamped.
+		 */
+		static inline void SS_4201AS_SetAllBrightness(const uint8_t Level);
+
+		/** Sets the rate at which the whole display is refreshed, which is also the rate of the frame complete event.
+		 *
+		 *  \param[in] RefreshHz  Refresh rate in Hz, clamped to \c SS_4201AS_MIN_REFRESH_HZ and \c SS_4201AS_MAX_REFRESH_HZ.
+		 */
+		static inline void SS_4201AS_SetRefreshRate(uint8_t RefreshHz);
 
-		/** Write the byte number to the two digit seven segment display. */
-		static inline void SS_4201AS_WriteByte(uint8_t byteNum);
+		/** Shows the next digit of the front frame. This is called from the display timer ISR. */
+		static inline void SS_4201AS_WriteByte(void);
 		
 	#endif
 
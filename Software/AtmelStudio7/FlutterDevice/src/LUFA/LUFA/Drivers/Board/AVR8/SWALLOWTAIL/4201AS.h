@@ -104,121 +104,217 @@
 			#define NO_EN		0
 			
 			/** Control Register A Set-up */
-			#define CCRA		(0b00000000)
+			#define CCRA		(0b00000010) //CTC mode, the digit period is set by OCR0A
 			
 			/** Control Register B Set-up */
 			#define CCRB		(0b00000101) //clk/1024 prescaler 
 			
 			/** Interrupt Mask */
-			#define TMSK		(0b00000010) //Trigger every overflow (~0.01632sec)
-			
-			/** Compare Value */
-			#define CMP_VAL		(250)
-			
+			#define TMSK		(0b00000110) //Compare A starts each digit, compare B blanks it for dimming
+
+			/** Timer/Counter0 ticks per second at the clk/1024 prescaler. */
+			#define SS_4201AS_TICKS_PER_SEC   (F_CPU / 1024)
+
+			/** Lowest refresh rate of the whole display in Hz, limited by the 8-bit digit period. */
+			#define SS_4201AS_MIN_REFRESH_HZ  ((SS_4201AS_TICKS_PER_SEC / SS_4201AS_DIGITS / 255) + 1)
+
+			/** Highest refresh rate of the whole display in Hz, keeping at least two timer ticks per brightness level. */
+			#define SS_4201AS_MAX_REFRESH_HZ  240
+
+			/** Refresh rate of the whole display in Hz after \ref SS_4201AS_Init(). */
+			#define SS_4201AS_DEFAULT_REFRESH_HZ  100
+
+			/** Highest (full on) digit brightness level, with 0 as the dimmest level. */
+			#define SS_4201AS_BRIGHTNESS_MAX  15
+
+			/** Number of digits multiplexed on the display. */
+			#define SS_4201AS_DIGITS          2
+
+			/** Index of the ten's place digit within a display frame. */
+			#define SS_4201AS_DIGIT_TENS      0
+
+			/** Index of the one's place digit within a display frame. */
+			#define SS_4201AS_DIGIT_ONES      1
+
+			/** Converts a BCD digit value to its port F image. */
+			#define SS_4201AS_DIGIT_IMAGE(x)  (((x) << 4) & ALL_BITS)
+
+		/* Function Prototypes: */
+			/** Event hook fired from the display ISR each time both digits have been multiplexed once. This must be
+			 *  implemented by the application, and must be short as it runs in interrupt context.
+			 */
+			void EVENT_SS_4201AS_FrameComplete(void);
+
+			#if defined(SS_4201AS_INTERRUPT_HOOKS)
+			/** Event hooks fired on entry to and exit from the display multiplex ISR, so that the application can
+			 *  instrument the time spent in it. These only exist if the \c SS_4201AS_INTERRUPT_HOOKS token is
+			 *  supplied to the compiler, and must then be implemented by the application.
+			 */
+			void EVENT_SS_4201AS_InterruptEntry(void);
+			void EVENT_SS_4201AS_InterruptExit(void);
+			#endif
+
 		/* Global Variables */
-		uint8_t buffer = 0; //Holds the number to be written
-		uint8_t ones = 0; //Ones place of the number
-		uint8_t tens = 0; //Tens place of the number
-		uint8_t sw = 0; //Switching between tens & ones place
-		
+		uint8_t displayFrames[2][SS_4201AS_DIGITS]; //Front and back frames of port F images, one per digit
+		volatile uint8_t displayFront = 0; //Index of the frame being shown by the multiplexer
+		volatile bool displayPending = false; //Set once the back frame is complete and may be swapped in
+		volatile uint8_t displayPublished = 0; //Serial number of the last frame completed, counting up
+		volatile uint8_t displayShown = 0; //Serial number of the frame last swapped in by the multiplexer
+		uint8_t displayDigit = 0; //Digit the multiplexer shows next
+		uint8_t displayBrightness[SS_4201AS_DIGITS]; //Brightness level of each digit
+		volatile uint8_t displayOnTicks[SS_4201AS_DIGITS]; //Compare B value blanking each digit, past the period for full on
+		const uint8_t displayEnables[SS_4201AS_DIGITS] = {EN_10, EN_1}; //Enable of each digit, active low
+
 		/* Inline Functions: */
 		#if !defined(__DOXYGEN__)
+			static inline void SS_4201AS_UpdateOnTicks(void)
+			{
+				//Each brightness level is a sixteenth of the digit period, the top level never reaches compare B
+				uint16_t PeriodTicks = (uint16_t)OCR0A + 1;
+
+				for (uint8_t Digit = 0; Digit < SS_4201AS_DIGITS; Digit++)
+				  displayOnTicks[Digit] = (PeriodTicks * (displayBrightness[Digit] + 1)) >> 4;
+			}
+
+			static inline void SS_4201AS_SetBrightness(const uint8_t Digit, uint8_t Level)
+			{
+				if (Level > SS_4201AS_BRIGHTNESS_MAX)
+				  Level = SS_4201AS_BRIGHTNESS_MAX;
+
+				displayBrightness[Digit] = Level;
+				SS_4201AS_UpdateOnTicks();
+			}
+
+			static inline void SS_4201AS_SetAllBrightness(const uint8_t Level)
+			{
+				for (uint8_t Digit = 0; Digit < SS_4201AS_DIGITS; Digit++)
+				  SS_4201AS_SetBrightness(Digit, Level);
+			}
+
+			static inline void SS_4201AS_SetRefreshRate(uint8_t RefreshHz)
+			{
+				if (RefreshHz < SS_4201AS_MIN_REFRESH_HZ)
+				  RefreshHz = SS_4201AS_MIN_REFRESH_HZ;
+				else if (RefreshHz > SS_4201AS_MAX_REFRESH_HZ)
+				  RefreshHz = SS_4201AS_MAX_REFRESH_HZ;
+
+				//Each digit is shown for an equal share of the refresh period
+				OCR0A = (SS_4201AS_TICKS_PER_SEC / SS_4201AS_DIGITS / RefreshHz) - 1;
+				SS_4201AS_UpdateOnTicks();
+			}
+
 			static inline void SS_4201AS_Init(void)
 			{
-				//I/O Port Configuration
+				//I/O Port Configuration, with both digits blanked until the first frame
 				DDRB  |=  ALL_EN;
 				DDRF  |= ALL_BITS;
-				PORTB &= ~ALL_EN;
+				PORTB |=  ALL_EN;
 				PORTF &= ~ALL_BITS;
 				//Timer/Counter0 Configuration
+				SS_4201AS_SetRefreshRate(SS_4201AS_DEFAULT_REFRESH_HZ);
+				SS_4201AS_SetAllBrightness(SS_4201AS_BRIGHTNESS_MAX);
 				TCCR0A = CCRA;
 				TCCR0B = CCRB;
 				TIMSK0 = TMSK;
-				OCR0A = CMP_VAL;
 			}
-			
-			static inline void SS_4201AS_WriteByteHex(uint8_t byteNum){
-				if(sw == 1){
-					/* Write the low byte of the incoming byte to the first segment
-					This requires the Enable for the first segment (EN_1) to be low
-					and the second segment (EN_10) to be high. */
-					//Enable the first segment, disable the second
-					PORTB = ~EN_1;
-					PORTB = EN_10;
-					//Loop though the input and assign the lower byte to the portf
-					buffer = (byteNum & 0xFF) << 4;
-					PORTF = buffer;
-					//_delay_ms(5);
-				}
-				else if(sw == 0){
-					/*Write the high byte of the incoming byte to the second segment
-					This requires the Enable for the second segment (EN_10) to be low
-					and the first segment (EN_1) to be high. */
-					//Enable the second segment, disable the first
-					PORTB = EN_1;
-					PORTB = ~EN_10;
-					//Loop though the input and assign the higher byte to the portf
-					buffer = byteNum;
-					PORTF = buffer;
-					//_delay_ms(5);
-				}
-				//Switch the segment we are on
-				if(sw == 0){
-					sw = 1;
-				}
-				else{
-					sw = 0;
-				}
+
+			static inline void SS_4201AS_Disable(void)
+			{
+				//Stop the multiplexer, leaving both digits blanked by their enables rather than floating
+				TIMSK0 = 0;
+				TCCR0B = 0;
+				PORTB |=  ALL_EN;
+				PORTF &= ~ALL_BITS;
 			}
-			
-			static inline void SS_4201AS_SetNum(uint8_t byteNum){
-				//Sets the global to be sent out the display
-				buffer = byteNum; //Holds the number to be written
-				ones = byteNum%10; //Ones place of the number
-				tens = (byteNum/10)%10; //Tens place of the number
+
+			static inline uint8_t* SS_4201AS_BeginFrame(void)
+			{
+				/* Withdraw any completed frame first, so the ISR cannot swap the back frame to the front
+				while it is being written. The front index is then stable until the frame is ended. */
+				displayPending = false;
+				GCC_MEMORY_BARRIER();
+				return displayFrames[displayFront ^ 1];
 			}
-			
-			static inline void SS_4201AS_WriteByte(){
-				if(sw == 1){
-					/* Write the low byte of the incoming byte to the first segment
-					This requires the Enable for the first segment (EN_1) to be low
-					and the second segment (EN_10) to be high. */
-					//Enable the first segment, disable the second
-					PORTB = ~EN_1;
-					PORTB = EN_10;
-					//Loop though the input and assign the lower byte to the portf
-					buffer = (ones & 0xFF) << 4;
-					PORTF = buffer;
-					//_delay_ms(5);
-				}
-				else if(sw == 0){
-					/* Write the high byte of the incoming byte to the second segment
-					This requires the Enable for the second segment (EN_10) to be low
-					and the first segment (EN_1) to be high. 
-					//Enable the second segment, disable the first*/
-					PORTB = EN_1;
-					PORTB = ~EN_10;
-					//Loop though the input and assign the higher byte to the portf
-					buffer = (tens & 0xFF) << 4;;
-					PORTF = buffer;
-					//_delay_ms(5);
-				}
-				//Switch the segment we are on
-				if(sw == 0){
-					sw = 1;
-				}
-				else{
-					sw = 0;
-				}
+
+			static inline void SS_4201AS_EndFrame(void)
+			{
+				//Publish the back frame, the ISR swaps it in at the end of the current multiplex frame
+				displayPublished++;
+				GCC_MEMORY_BARRIER();
+				displayPending = true;
 			}
-			
+
+			static inline uint8_t SS_4201AS_GetFrameSerial(void)
+			{
+				return displayPublished;
+			}
+
+			static inline uint8_t SS_4201AS_GetShownSerial(void)
+			{
+				return displayShown;
+			}
+
+			static inline void SS_4201AS_SetHex(const uint8_t byteNum)
+			{
+				/* High nibble on the ten's place, low nibble on the one's place. The digit bits are the
+				high nibble of port F, so each nibble is its own port image without any shifting back. */
+				uint8_t* Frame = SS_4201AS_BeginFrame();
+				Frame[SS_4201AS_DIGIT_TENS] = (byteNum & ALL_BITS);
+				Frame[SS_4201AS_DIGIT_ONES] = SS_4201AS_DIGIT_IMAGE(byteNum);
+				SS_4201AS_EndFrame();
+			}
+
+			static inline void SS_4201AS_SetNum(const uint8_t byteNum)
+			{
+				//Sets the digits to be sent out the display
+				uint8_t* Frame = SS_4201AS_BeginFrame();
+				Frame[SS_4201AS_DIGIT_TENS] = SS_4201AS_DIGIT_IMAGE((byteNum / 10) % 10);
+				Frame[SS_4201AS_DIGIT_ONES] = SS_4201AS_DIGIT_IMAGE(byteNum % 10);
+				SS_4201AS_EndFrame();
+			}
+
+			static inline void SS_4201AS_WriteByte(void)
+			{
+				/* Blank both digits while the segment data changes so the previous digit does not ghost,
+				then enable the digit being shown. The enables are active low. */
+				PORTB |= ALL_EN;
+				PORTF  = (PORTF & ~ALL_BITS) | displayFrames[displayFront][displayDigit];
+				PORTB &= ~displayEnables[displayDigit];
+				//Blank the digit again once its share of the period has passed
+				OCR0B  = displayOnTicks[displayDigit];
+				//Switch the digit we are on
+				if (++displayDigit == SS_4201AS_DIGITS)
+				  displayDigit = 0;
+			}
+
 			/* Interrupt Service Routines */
-			//Triggers once the timer has elapsed 20ms (~50Hz refresh rate)
+			//Triggers at the start of each digit period, twice per display refresh
 			ISR(TIMER0_COMPA_vect){
-				//Display the value of the buffer
+				#if defined(SS_4201AS_INTERRUPT_HOOKS)
+				EVENT_SS_4201AS_InterruptEntry();
+				#endif
+				//Display the next digit of the front frame
 				SS_4201AS_WriteByte();
+				//Both digits have been shown once the multiplexer wraps back to the tens place
+				if(displayDigit == 0){
+					//Swap in a completed back frame between multiplex frames so digits are never torn
+					if(displayPending){
+						displayFront ^= 1;
+						displayShown = displayPublished;
+						displayPending = false;
+					}
+					EVENT_SS_4201AS_FrameComplete();
+				}
+				#if defined(SS_4201AS_INTERRUPT_HOOKS)
+				EVENT_SS_4201AS_InterruptExit();
+				#endif
 			}
-			
+
+			//Triggers once the digit being shown has been on for its brightness
+			ISR(TIMER0_COMPB_vect){
+				PORTB |= ALL_EN;
+			}
+
 		#endif
 
 	/* Disable C linkage for C++ Compilers: */
@@ -35,6 +35,7 @@
 
 /* Includes: */
 #include "../../../../Common/Common.h"
+#include <avr/interrupt.h>
 
 /* Enable C linkage for C++ Compilers: */
 #if defined(__cplusplus)
@@ -57,12 +58,60 @@ extern "C" {
 	/** Button mask for all the buttons on the board. */
 	#define BUTTONS_ALL_BUTTONS    (BUTTONS_BUTTON1 | BUTTONS_BUTTON2)
 
+	/** Rate at which the buttons are sampled for debouncing, in Hz. A button must read the same for four samples
+	 *  in a row (20ms) before its debounced state follows.
+	 */
+	#define BUTTONS_SAMPLE_HZ      200
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+	/* Macros: */
+	/** Timer 4 Control Register B Set-up, clk/1024 */
+	#define BUTTONS_CCRB           ((1 << CS43) | (1 << CS41) | (1 << CS40))
+
+	/** Timer 4 TOP value giving an overflow at the sample rate */
+	#define BUTTONS_SAMPLE_TOP     ((F_CPU / 1024 / BUTTONS_SAMPLE_HZ) - 1)
+
+	/* Global Variables */
+	/* Two bit vertical counter, one bit of each button in each byte, counting the samples in a row that differ
+	from the debounced state. The counter is held at 3 while they agree, and the debounced state toggles when it
+	counts down through 0. */
+	uint8_t buttonsCount0 = 0xFF;
+	uint8_t buttonsCount1 = 0xFF;
+	volatile uint8_t buttonsState = 0; //Debounced mask of the buttons held down
+	#endif
+
+	/* Function Prototypes: */
+	/** Event hook fired from the button sampling ISR at \ref BUTTONS_SAMPLE_HZ with the debounced mask of the
+	 *  buttons held down, so that the application can time gestures. This must be implemented by the application,
+	 *  and must be short as it runs in interrupt context.
+	 */
+	void EVENT_Buttons_Sampled(const uint8_t Pressed);
+
 	/* Inline Functions: */
 	#if !defined(__DOXYGEN__)
 	static inline void Buttons_Init(void)
 	{
 		DDRB  &= ~BUTTONS_ALL_BUTTONS;
 		PORTB |=  BUTTONS_ALL_BUTTONS;
+
+		//Timer/Counter4 Configuration, overflowing at the sample rate
+		buttonsCount0 = 0xFF;
+		buttonsCount1 = 0xFF;
+		buttonsState  = 0;
+		TCCR4A = 0;
+		TC4H   = 0;
+		OCR4C  = BUTTONS_SAMPLE_TOP;
+		TCCR4B = BUTTONS_CCRB;
+		TIFR4  = (1 << TOV4);
+		TIMSK4 = (1 << TOIE4);
+	}
+
+	static inline void Buttons_Disable(void)
+	{
+		TIMSK4 = 0;
+		TCCR4B = 0;
+		PORTB &= ~BUTTONS_ALL_BUTTONS;
 	}
 
 	static inline uint8_t Buttons_GetStatus(void) ATTR_WARN_UNUSED_RESULT;
@@ -70,6 +119,26 @@ extern "C" {
 	{
 		return ((PINB & BUTTONS_ALL_BUTTONS) ^ BUTTONS_ALL_BUTTONS);
 	}
+
+	static inline uint8_t Buttons_GetDebounced(void) ATTR_WARN_UNUSED_RESULT;
+	static inline uint8_t Buttons_GetDebounced(void)
+	{
+		return buttonsState;
+	}
+	#endif
+
+	/* Interrupt Service Routines: */
+	#if !defined(__DOXYGEN__)
+	//Samples all of the buttons at once, debouncing each in its own bit of the vertical counter
+	ISR(TIMER4_OVF_vect){
+		uint8_t Changed = (Buttons_GetStatus() ^ buttonsState);
+
+		buttonsCount0  = ~(buttonsCount0 & Changed);
+		buttonsCount1  = (buttonsCount0 ^ (buttonsCount1 & Changed));
+		buttonsState  ^= (Changed & buttonsCount0 & buttonsCount1);
+
+		EVENT_Buttons_Sampled(buttonsState);
+	}
 	#endif
 
 	/* Disable C linkage for C++ Compilers: */
@@ -52,9 +52,8 @@
 
 	/* Includes: */
 		#include "../../../../Common/Common.h"
-		#include <avr/sfr_defs.h>
+		#include <avr/pgmspace.h>
 		#include <avr/interrupt.h>
-		#include <util/delay.h>
 
 	/* Enable C linkage for C++ Compilers: */
 		#if defined(__cplusplus)
@@ -69,7 +68,46 @@
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Macros: */
-	
+			/** Quadrature state of the shaft while it is resting in a detent (both contacts open, pulled high). */
+			#define ROTARY_STATE_DETENT    0x03
+
+			/** Minimum number of quarter steps seen since the last detent for a detent to be counted. Two is
+			 *  enough to tell the direction, and tolerates a single missed edge when the shaft is spun quickly.
+			 */
+			#define ROTARY_MIN_QUARTERS    2
+
+			/** Number of entries in each acceleration curve. */
+			#define ROTARY_ACCEL_BUCKETS   16
+
+			/** Width of each acceleration curve bucket, as a power of two of Timer 3 ticks (64us at 16MHz). A shift
+			 *  of 7 gives buckets of ~8ms, so the curves cover inter-detent periods from 0 to ~130ms.
+			 */
+			#define ROTARY_ACCEL_SHIFT     7
+
+			/** Timer 3 Control Register B Set-up */
+			#define ROTARY_CCRB            ((1 << CS32) | (1 << CS30)) //clk/1024 free running timebase
+
+		/* Global Variables */
+		/** Quarter step transition table, indexed by (previous state << 2) | current state where a state
+		 *  is (DT << 1) | CLK. Valid Gray code transitions give +1 (CLK leading) or -1 (DT leading), while
+		 *  no change and invalid double transitions (bounce) give 0.
+		 */
+		static const int8_t PROGMEM rotaryTransitions[16] =
+			{
+				 0, +1, -1,  0,
+				-1,  0,  0, +1,
+				+1,  0,  0, -1,
+				 0, -1, +1,  0,
+			};
+
+		uint8_t rotaryState = ROTARY_STATE_DETENT; //Last sampled state of the encoder contacts
+		int8_t  rotaryQuarters = 0; //Quarter steps taken since the shaft left the last detent
+		volatile int16_t rotaryDelta = 0; //Steps accumulated by the ISR and not yet collected
+		uint8_t rotaryCurve = 0; //Acceleration curve currently in use, none until one is selected
+		uint16_t rotaryLastDetent = 0; //Timer 3 value at the previous detent
+		volatile uint8_t rotaryOverflows = 0; //Timer 3 overflows serviced since the previous detent, saturating at 2
+		uint16_t rotaryPeriod = UINT16_MAX; //Smoothed inter-detent period estimate, in Timer 3 ticks
+		int8_t  rotaryLastDir = 0; //Direction of the previous detent
 	#endif
 
 	/* Public Interface - May be used in end-application: */
@@ -85,63 +123,226 @@
 
 			/** Bit mask for none of the board bits. */
 			#define NO_BITS     0
+
+			/** Acceleration curve where every detent moves the count by exactly one. */
+			#define ROTARY_ACCEL_NONE      0
+
+			/** Acceleration curve giving up to 6 steps per detent for fast spins. */
+			#define ROTARY_ACCEL_GENTLE    1
+
+			/** Acceleration curve giving up to 16 steps per detent, covering a 0-100 range in a single flick. */
+			#define ROTARY_ACCEL_STEEP     2
+
+			/** Number of acceleration curves available to \ref Rotary_SetAccelCurve(). */
+			#define ROTARY_ACCEL_CURVES    3
 			
 			
 		/* Global Variables */
 		uint8_t max = 0;
 		uint8_t count = 0;
-		uint8_t i = 0;
+
+	#if !defined(__DOXYGEN__)
+		/** Acceleration curves, giving the number of steps applied for a single detent. Each curve is indexed by
+		 *  the estimated inter-detent period in buckets of (1 << ROTARY_ACCEL_SHIFT) timer ticks, fastest first.
+		 */
+		static const uint8_t PROGMEM rotaryAccelCurves[][ROTARY_ACCEL_BUCKETS] =
+			{
+				[ROTARY_ACCEL_NONE]   = { 1,  1,  1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1},
+				[ROTARY_ACCEL_GENTLE] = { 6,  5,  4, 3, 3, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1, 1},
+				[ROTARY_ACCEL_STEEP]  = {16, 12, 10, 8, 6, 5, 4, 3, 3, 2, 2, 2, 1, 1, 1, 1},
+			};
+	#endif
 		
+		/* Function Prototypes: */
+			/** Event hook fired from the encoder ISR each time a detent is counted, with the signed number of steps
+			 *  it was worth after acceleration. This must be implemented by the application, and must be short as
+			 *  it runs in interrupt context.
+			 */
+			void EVENT_Rotary_Turned(const int8_t Steps);
+
 		/* Inline Functions: */
 		#if !defined(__DOXYGEN__)
+			static inline uint8_t Rotary_ReadState(void)
+			{
+				return ((PINB & ROTARY_BITS) >> PB2);
+			}
+
 			static inline void Rotary_Init(uint8_t maxCount)
 			{
 				//I/O Port Configuration
 				DDRB  &= ~ROTARY_BITS;
 				PORTB |=  ROTARY_BITS;
 				max = maxCount;
+
+				//Timer/Counter3 Configuration, used to time the interval between detents
+				TCCR3A = 0;
+				TCCR3B = ROTARY_CCRB;
+				TIFR3  = (1 << TOV3);
+				TIMSK3 = (1 << TOIE3);
+
+				//Pin Change Interrupt Configuration (PCINT2 & PCINT3 share the PCINT0 vector)
+				rotaryState = Rotary_ReadState();
+				PCMSK0 |= ((1 << PCINT2) | (1 << PCINT3));
+				PCIFR   = (1 << PCIF0);
+				PCICR  |= (1 << PCIE0);
 			}
-			
+
+			static inline void Rotary_Disable(void)
+			{
+				PCMSK0 &= ~((1 << PCINT2) | (1 << PCINT3));
+				PORTB  &= ~ROTARY_BITS;
+				TIMSK3  = 0;
+				TCCR3B  = 0;
+			}
+
+			static inline void Rotary_SetAccelCurve(uint8_t curve)
+			{
+				if (curve < ROTARY_ACCEL_CURVES)
+				{
+					rotaryCurve = curve;
+				}
+			}
+
+			/** Atomically collects the steps accumulated by the encoder ISR since the last call. Positive
+			 *  values are clockwise steps, negative values counter-clockwise.
+			 */
+			static inline int16_t Rotary_GetDelta(void) ATTR_WARN_UNUSED_RESULT;
+			static inline int16_t Rotary_GetDelta(void)
+			{
+				uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+				GlobalInterruptDisable();
+
+				int16_t Delta = rotaryDelta;
+				rotaryDelta = 0;
+
+				SetGlobalInterruptMask(CurrentGlobalInt);
+				return Delta;
+			}
+
+			static inline void Rotary_SetMax(uint8_t maxCount)
+			{
+				max = maxCount;
+				if (count > max)
+				{
+					count = max;
+				}
+			}
+
+			static inline void Rotary_SetCount(uint8_t newCount)
+			{
+				count = (newCount > max) ? max : newCount;
+			}
+
 			static inline void Rotary_GetCount(uint8_t* mode)
 			{
-				if (i == 0)
+				//Apply the collected detents, clamping the count to 0..max
+				int16_t newCount = (int16_t)count + Rotary_GetDelta();
+
+				if (newCount < 0)
 				{
-					//If any Encoder pins show falling edge execute loop
-					if ((bit_is_clear(PINB,2)) || (bit_is_clear(PINB,3)))
-					{
-						i = 1;
-						_delay_ms(10);
-						//If DT is second to go LOW
-						if (bit_is_clear(PINB,2))
-						{
-							// Increment binary count if count is less than the max value
-							if (count < max)
-							{
-								count++;
-							}
-						}
-						//If CLK is second to go LOW
-						if (bit_is_clear(PINB,3))
-						{
-							//If binary count is greater than 0 decrease count by 1
-							if (count > 0)
-							{
-								count--;
-							}
-						}
-					}
+					newCount = 0;
 				}
-				//*mode = count;
-				//Wait till shaft position reset
-				if ((bit_is_set(PINB,2)) && (bit_is_set(PINB,3) ))
+				else if (newCount > max)
 				{
-					i = 0;
+					newCount = max;
 				}
-				return;
+
+				count = newCount;
+				*mode = count;
 			}
 			
+			/** Estimates the shaft velocity from the time since the previous detent and returns the number of
+			 *  steps the new detent is worth under the active acceleration curve.
+			 */
+			static inline uint8_t Rotary_Accelerate(int8_t dir)
+			{
+				uint16_t now       = TCNT3;
+				uint16_t interval  = (now - rotaryLastDetent);
+				uint8_t  overflows = rotaryOverflows;
+
+				//An overflow still pending with the count low happened before it was read, so it belongs to this detent
+				if ((TIFR3 & (1 << TOV3)) && !(now & 0x8000))
+				{
+					TIFR3 = (1 << TOV3);
+					overflows++;
+				}
+
+				//A single overflow is the counter wrapping past the last detent, unless the count has come round to it
+				//again; any more mean a whole timer period went by, however small the counts make the interval look
+				if ((overflows > 1) || (overflows && (now >= rotaryLastDetent)))
+				{
+					interval = UINT16_MAX;
+				}
+
+				rotaryOverflows  = 0;
+				rotaryLastDetent = now;
+
+				//Average with the previous period, restarting the estimate whenever the direction changes
+				if (dir == rotaryLastDir)
+				{
+					rotaryPeriod = (rotaryPeriod >> 1) + (interval >> 1);
+				}
+				else
+				{
+					rotaryPeriod = interval;
+				}
+
+				rotaryLastDir = dir;
+
+				uint16_t bucket = (rotaryPeriod >> ROTARY_ACCEL_SHIFT);
+				if (bucket >= ROTARY_ACCEL_BUCKETS)
+				{
+					bucket = (ROTARY_ACCEL_BUCKETS - 1);
+				}
+
+				return pgm_read_byte(&rotaryAccelCurves[rotaryCurve][bucket]);
+			}
+
 			/* Interrupt Service Routines */
-			
+			//Counts the Timer 3 overflows between detents, so that pauses of more than a timer period are told apart
+			ISR(TIMER3_OVF_vect){
+				if (rotaryOverflows < 2)
+				{
+					rotaryOverflows++;
+				}
+			}
+
+			//Triggers on every edge of either encoder contact
+			ISR(PCINT0_vect){
+				uint8_t newState = Rotary_ReadState();
+
+				//Ignore changes on the other port B pins sharing this vector
+				if (newState == rotaryState)
+				{
+					return;
+				}
+
+				rotaryQuarters += (int8_t)pgm_read_byte(&rotaryTransitions[(rotaryState << 2) | newState]);
+				rotaryState     = newState;
+
+				//A detent is only counted once the shaft settles back into the rest position
+				if (newState == ROTARY_STATE_DETENT)
+				{
+					int8_t steps = 0;
+
+					if (rotaryQuarters >= ROTARY_MIN_QUARTERS)
+					{
+						steps = Rotary_Accelerate(+1);
+					}
+					else if (rotaryQuarters <= -ROTARY_MIN_QUARTERS)
+					{
+						steps = -Rotary_Accelerate(-1);
+					}
+
+					rotaryQuarters = 0;
+
+					if (steps)
+					{
+						rotaryDelta += steps;
+						EVENT_Rotary_Turned(steps);
+					}
+				}
+			}
 			
 		#endif
 
@@ -161,7 +161,7 @@
 			#include "AVR8/POLOLUMICRO/Board.h"
 		#elif (BOARD == BOARD_XPLAINED_MINI)
 			#include "AVR8/XPLAINED_MINI/Board.h"
-		#elif (BOARD == BOARD_SWALLOWTAIL)
+		#elif (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
 			#include "AVR8/SWALLOWTAIL/Board.h"
 		#else
 			#include "Board/Board.h"
@@ -57,7 +57,8 @@
  *  actions can be taken.
  *
  *  If the \c BOARD value is set to \c BOARD_USER, this will include the \c /Board/Buttons.h file in the user project
- *  directory. Otherwise, it will include the appropriate built in board driver header file.
+ *  directory. Otherwise, it will include the appropriate built in board driver header file. If the BOARD value is
+ *  set to \c BOARD_NONE, this driver is silently disabled.
  *
  *  For possible \c BOARD makefile values, see \ref Group_BoardTypes.
  *
@@ -94,7 +95,10 @@
 		#include "../../Common/Common.h"
 
 		#if (BOARD == BOARD_NONE)
-			#error The Board Buttons driver cannot be used if the makefile BOARD option is not set.
+			static inline void    Buttons_Init(void) {}
+			static inline void    Buttons_Disable(void) {}
+			static inline uint8_t Buttons_GetStatus(void) { return 0; }
+			static inline uint8_t Buttons_GetDebounced(void) { return 0; }
 		#elif (BOARD == BOARD_USBKEY)
 			#include "AVR8/USBKEY/Buttons.h"
 		#elif (BOARD == BOARD_STK525)
@@ -133,12 +137,27 @@
 			#include "UC3/EVK1100/Buttons.h"
 		#elif (BOARD == BOARD_EVK1104)
 			#include "UC3/EVK1104/Buttons.h"
-		#elif (BOARD == BOARD_SWALLOWTAIL)
+		#elif (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
 			#include "AVR8/SWALLOWTAIL/Buttons.h"
 		#else
 			#include "Board/Buttons.h"
 		#endif
 
+	/* Preprocessor Checks: */
+		#if !defined(__DOXYGEN__)
+			#if !defined(BUTTONS_BUTTON1)
+			#define BUTTONS_BUTTON1       0
+			#endif
+
+			#if !defined(BUTTONS_BUTTON2)
+			#define BUTTONS_BUTTON2       0
+			#endif
+
+			#if !defined(BUTTONS_SAMPLE_HZ)
+			#define BUTTONS_SAMPLE_HZ     200
+			#endif
+		#endif
+
 	/* Pseudo-Functions for Doxygen: */
 	#if defined(__DOXYGEN__)
 		/** Initializes the BUTTONS driver, so that the current button position can be read. This sets the appropriate
@@ -153,6 +172,14 @@
 		 *  \return Mask indicating which board buttons are currently pressed.
 		 */
 		static inline uint_reg_t Buttons_GetStatus(void) ATTR_WARN_UNUSED_RESULT;
+
+		/** Returns a mask indicating which board buttons are held down after debouncing, on boards which sample their
+		 *  buttons from a timer interrupt (currently \c BOARD_SWALLOWTAIL and \c BOARD_HOSTSIM). Such boards fire
+		 *  \c EVENT_Buttons_Sampled() with the same mask from the sampling interrupt.
+		 *
+		 *  \return Mask indicating which board buttons are held down.
+		 */
+		static inline uint_reg_t Buttons_GetDebounced(void) ATTR_WARN_UNUSED_RESULT;
 	#endif
 
 #endif
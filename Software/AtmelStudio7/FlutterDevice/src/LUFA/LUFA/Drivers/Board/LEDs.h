@@ -211,7 +211,7 @@
 			#include "AVR8/POLOLUMICRO/LEDs.h"
 		#elif (BOARD == BOARD_XPLAINED_MINI)
 			#include "AVR8/XPLAINED_MINI/LEDs.h"
-		#elif (BOARD == BOARD_SWALLOWTAIL)
+		#elif (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
 			#include "AVR8/SWALLOWTAIL/LEDs.h"
 		#else
 			#include "Board/LEDs.h"
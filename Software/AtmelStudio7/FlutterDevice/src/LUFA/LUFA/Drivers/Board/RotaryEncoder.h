@@ -70,10 +70,14 @@
 		#include "../../Common/Common.h"
 
 		#if (BOARD == BOARD_NONE)
-			static inline void       Rotary_Init(void) {}
-			static inline void       Rotary_GetCount(void) {}
-			static inline void Rotary_Disable(uint8_t byteNum) {}
-		#elif (BOARD == BOARD_SWALLOWTAIL)
+			static inline void       Rotary_Init(uint8_t maxCount) {}
+			static inline void       Rotary_Disable(void) {}
+			static inline int16_t    Rotary_GetDelta(void) { return 0; }
+			static inline void       Rotary_SetCount(uint8_t newCount) {}
+			static inline void       Rotary_SetMax(uint8_t maxCount) {}
+			static inline void       Rotary_SetAccelCurve(uint8_t curve) {}
+			static inline void       Rotary_GetCount(uint8_t* mode) {}
+		#elif (BOARD == BOARD_SWALLOWTAIL) || (BOARD == BOARD_HOSTSIM)
 			#include "AVR8/SWALLOWTAIL/RotaryEncoder.h"
 		#else
 			#include "Board/RotaryEncoder.h"
@@ -81,22 +85,62 @@
 
 	/* Preprocessor Checks: */
 		#if !defined(__DOXYGEN__)
+			#if !defined(ROTARY_ACCEL_NONE)
+			#define ROTARY_ACCEL_NONE      0
+			#endif
 
+			#if !defined(ROTARY_ACCEL_GENTLE)
+			#define ROTARY_ACCEL_GENTLE    0
+			#endif
+
+			#if !defined(ROTARY_ACCEL_STEEP)
+			#define ROTARY_ACCEL_STEEP     0
+			#endif
+
+			#if !defined(ROTARY_ACCEL_CURVES)
+			#define ROTARY_ACCEL_CURVES    1
+			#endif
 		#endif
 
 	/* Pseudo-Functions for Doxygen: */
 	#if defined(__DOXYGEN__)
-		/** Initializes the board Rotary Encoder driver uses I/O Port D 0 & 1.
+		/** Initializes the board Rotary Encoder driver. The encoder contacts are sampled from the pin change
+		 *  interrupt, so global interrupts must be enabled for any steps to be counted.
 		 *
 		 *  This must be called before any Rotary Encoder driver functions are used.
+		 *
+		 *  \param[in] maxCount  Upper limit of the count maintained by \ref Rotary_GetCount().
 		 */
 		static inline void Rotary_Init(uint8_t maxCount);
 
 		/** Disables the board Rotary Encoder driver, releasing the I/O pins back to their default high-impedance input mode. */
 		static inline void Rotary_Disable(void);
-		
-		/** Write the byte number to the two digit seven segment display. */
-		static inline uint8_t Rotary_GetCount();
+
+		/** Atomically retrieves and clears the signed number of steps turned since the last call, after acceleration.
+		 *  This never blocks.
+		 *
+		 *  \return Number of steps turned, positive for clockwise.
+		 */
+		static inline int16_t Rotary_GetDelta(void);
+
+		/** Selects the acceleration curve applied to each detent, based on the time since the previous detent. Fast
+		 *  spins are worth several steps per detent, so the whole range can be swept in a handful of detents.
+		 *
+		 *  \param[in] curve  Curve to use, a \c ROTARY_ACCEL_* value. Unknown curves are ignored.
+		 */
+		static inline void Rotary_SetAccelCurve(uint8_t curve);
+
+		/** Overrides the current count, e.g. to follow a value changed by the host. The value is clamped to the maximum. */
+		static inline void Rotary_SetCount(uint8_t newCount);
+
+		/** Changes the highest value of the count, clamping the current count to it. */
+		static inline void Rotary_SetMax(uint8_t maxCount);
+
+		/** Applies the steps turned since the last call to the count, clamped between zero and the maximum.
+		 *
+		 *  \param[out] mode  Location where the updated count is stored.
+		 */
+		static inline void Rotary_GetCount(uint8_t* mode);
 		
 	#endif
 
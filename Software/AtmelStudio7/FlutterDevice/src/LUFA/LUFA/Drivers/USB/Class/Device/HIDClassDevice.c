@@ -150,6 +150,29 @@ bool HID_Device_ConfigureEndpoints(USB_ClassInfo_HID_Device_t* const HIDInterfac
 	if (!(Endpoint_ConfigureEndpointTable(&HIDInterfaceInfo->Config.ReportINEndpoint, 1)))
 	  return false;
 
+	if (HIDInterfaceInfo->Config.ReportOUTEndpoint.Address)
+	{
+		HIDInterfaceInfo->Config.ReportOUTEndpoint.Type = EP_TYPE_INTERRUPT;
+
+		if (!(Endpoint_ConfigureEndpointTable(&HIDInterfaceInfo->Config.ReportOUTEndpoint, 1)))
+		  return false;
+	}
+
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	HIDInterfaceInfo->State.ReportINTransfer.Address  = HIDInterfaceInfo->Config.ReportINEndpoint.Address;
+	HIDInterfaceInfo->State.ReportINTransfer.Buffer   = HIDInterfaceInfo->Config.ReportINBuffer;
+
+	if (HIDInterfaceInfo->Config.ReportOUTEndpoint.Address)
+	{
+		HIDInterfaceInfo->State.ReportOUTTransfer.Address  = HIDInterfaceInfo->Config.ReportOUTEndpoint.Address;
+		HIDInterfaceInfo->State.ReportOUTTransfer.Buffer   = HIDInterfaceInfo->Config.ReportOUTBuffer;
+		HIDInterfaceInfo->State.ReportOUTTransfer.Length   = HIDInterfaceInfo->Config.ReportOUTBufferSize;
+		HIDInterfaceInfo->State.ReportOUTTransfer.Callback = HIDInterfaceInfo->Config.ReportOUTReceived;
+
+		Endpoint_Transfer_Submit(&HIDInterfaceInfo->State.ReportOUTTransfer);
+	}
+	#endif
+
 	return true;
 }
 
@@ -158,6 +181,34 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 	if (USB_DeviceState != DEVICE_STATE_Configured)
 	  return;
 
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	USB_Endpoint_Transfer_t* ReportOUTTransfer = &HIDInterfaceInfo->State.ReportOUTTransfer;
+
+	if (HIDInterfaceInfo->Config.ReportOUTEndpoint.Address && (ReportOUTTransfer->Status == ENDPOINT_TRANSFER_Complete))
+	{
+		CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, 0, HID_REPORT_ITEM_Out, ReportOUTTransfer->Buffer,
+		                                     ReportOUTTransfer->BytesTransferred);
+
+		Endpoint_Transfer_Submit(ReportOUTTransfer);
+	}
+	#else
+	if (HIDInterfaceInfo->Config.ReportOUTEndpoint.Address)
+	{
+		Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.ReportOUTEndpoint.Address);
+
+		if (Endpoint_IsOUTReceived())
+		{
+			uint8_t* ReportOUTData = (uint8_t*)HIDInterfaceInfo->Config.ReportOUTBuffer;
+			uint16_t ReportOUTSize = MIN(Endpoint_BytesInEndpoint(), HIDInterfaceInfo->Config.ReportOUTBufferSize);
+
+			Endpoint_Read_Stream_LE(ReportOUTData, ReportOUTSize, NULL);
+			Endpoint_ClearOUT();
+
+			CALLBACK_HID_Device_ProcessHIDReport(HIDInterfaceInfo, 0, HID_REPORT_ITEM_Out, ReportOUTData, ReportOUTSize);
+		}
+	}
+	#endif
+
 	if (HIDInterfaceInfo->State.PrevFrameNum == USB_Device_GetFrameNumber())
 	{
 		#if defined(USB_DEVICE_OPT_LOWSPEED)
@@ -168,9 +219,13 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 		#endif
 	}
 
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	if (!(Endpoint_Transfer_IsPending(&HIDInterfaceInfo->State.ReportINTransfer)))
+	#else
 	Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.ReportINEndpoint.Address);
 
 	if (Endpoint_IsReadWriteAllowed())
+	#endif
 	{
 		uint8_t  ReportINData[HIDInterfaceInfo->Config.PrevReportINBufferSize];
 		uint8_t  ReportID     = 0;
@@ -193,6 +248,21 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 		{
 			HIDInterfaceInfo->State.IdleMSRemaining = HIDInterfaceInfo->State.IdleCount;
 
+			#if defined(INTERRUPT_DATA_ENDPOINTS)
+			USB_Endpoint_Transfer_t* ReportINTransfer = &HIDInterfaceInfo->State.ReportINTransfer;
+			uint8_t* ReportINBuffer = (uint8_t*)ReportINTransfer->Buffer;
+
+			ReportINTransfer->Length = ReportINSize;
+
+			if (ReportID)
+			{
+				*(ReportINBuffer++) = ReportID;
+				ReportINTransfer->Length++;
+			}
+
+			memcpy(ReportINBuffer, ReportINData, ReportINSize);
+			Endpoint_Transfer_Submit(ReportINTransfer);
+			#else
 			Endpoint_SelectEndpoint(HIDInterfaceInfo->Config.ReportINEndpoint.Address);
 
 			if (ReportID)
@@ -201,6 +271,7 @@ void HID_Device_USBTask(USB_ClassInfo_HID_Device_t* const HIDInterfaceInfo)
 			Endpoint_Write_Stream_LE(ReportINData, ReportINSize, NULL);
 
 			Endpoint_ClearIN();
+			#endif
 		}
 
 		HIDInterfaceInfo->State.PrevFrameNum = USB_Device_GetFrameNumber();
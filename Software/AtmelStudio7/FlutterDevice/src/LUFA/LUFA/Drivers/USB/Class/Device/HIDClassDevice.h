@@ -75,9 +75,13 @@
 			 *  within the user application, and passed to each of the HID class driver functions as the
 			 *  \c HIDInterfaceInfo parameter. This stores each HID interface's configuration and state information.
 			 *
-			 *  \note Due to technical limitations, the HID device class driver does not utilize a separate OUT
-			 *        endpoint for host->device communications. Instead, the host->device data (if any) is sent to
-			 *        the device via the control endpoint.
+			 *  \note Host->device reports are always accepted via the control endpoint. If \c ReportOUTEndpoint is given a
+			 *        non-zero address, output reports sent by the host over that interrupt OUT endpoint are also read by
+			 *        \ref HID_Device_USBTask() and passed to \ref CALLBACK_HID_Device_ProcessHIDReport().
+			 *
+			 *  \note When the \c INTERRUPT_DATA_ENDPOINTS token is defined, reports on the IN and OUT endpoints are moved by the
+			 *        endpoint interrupt (see \ref Group_EndpointTransfer), and \ref HID_Device_USBTask() never waits on the
+			 *        bus. The report callbacks are still run from \ref HID_Device_USBTask().
 			 */
 			typedef struct
 			{
@@ -86,6 +90,9 @@
 					uint8_t  InterfaceNumber; /**< Interface number of the HID interface within the device. */
 
 					USB_Endpoint_Table_t ReportINEndpoint; /**< Data IN HID report endpoint configuration table. */
+					USB_Endpoint_Table_t ReportOUTEndpoint; /**< Data OUT HID report endpoint configuration table. This is optional,
+					                                         *   and is not used if its address is left as zero.
+					                                         */
 
 					void*    PrevReportINBuffer; /**< Pointer to a buffer where the previously created HID input report can be
 					                              *  stored by the driver, for comparison purposes to detect report changes that
@@ -105,6 +112,26 @@
 					                                  *  exclusively (i.e. \c PrevReportINBuffer is \c NULL) this value must still be
 					                                  *  set to the size of the largest report the device can issue to the host.
 					                                  */
+					void*    ReportOUTBuffer; /**< Pointer to a buffer where output reports received on the OUT endpoint are stored
+					                           *   before being passed to \ref CALLBACK_HID_Device_ProcessHIDReport(). This must be
+					                           *   set if the OUT endpoint is used. Report IDs are not stripped from reports received
+					                           *   on the OUT endpoint.
+					                           */
+					uint8_t  ReportOUTBufferSize; /**< Size in bytes of the given output report buffer. Any bytes of a received report
+					                               *   beyond this size are discarded.
+					                               */
+					#if defined(INTERRUPT_DATA_ENDPOINTS) || defined(__DOXYGEN__)
+					void*    ReportINBuffer; /**< Pointer to a buffer holding the input report being sent by the endpoint interrupt.
+					                          *   This must be big enough for the largest input report plus its report ID, if
+					                          *   any. Only present when the \c INTERRUPT_DATA_ENDPOINTS token is defined.
+					                          */
+					Endpoint_TransferCallback_t ReportOUTReceived; /**< Optional function run from the endpoint interrupt once
+					                                                *   an output report has been received on the OUT endpoint,
+					                                                *   or its transfer aborted, for example to wake a sleeping
+					                                                *   main loop to call \ref HID_Device_USBTask(). Only present
+					                                                *   when the \c INTERRUPT_DATA_ENDPOINTS token is defined.
+					                                                */
+					#endif
 				} Config; /**< Config data for the USB class interface within the device. All elements in this section
 				           *   <b>must</b> be set or the interface will fail to enumerate and operate correctly.
 				           */
@@ -115,6 +142,10 @@
 					uint16_t IdleCount; /**< Report idle period, in milliseconds, set by the host. */
 					uint16_t IdleMSRemaining; /**< Total number of milliseconds remaining before the idle period elapsed - this
 				                               *   should be decremented by the user application if non-zero each millisecond. */
+					#if defined(INTERRUPT_DATA_ENDPOINTS) || defined(__DOXYGEN__)
+					USB_Endpoint_Transfer_t ReportINTransfer; /**< Transfer sending the last input report from \c ReportINBuffer. */
+					USB_Endpoint_Transfer_t ReportOUTTransfer; /**< Transfer receiving the next output report into \c ReportOUTBuffer. */
+					#endif
 				} State; /**< State data for the USB class interface within the device. All elements in this section
 				          *   are reset to their defaults when the interface is enumerated.
 				          */
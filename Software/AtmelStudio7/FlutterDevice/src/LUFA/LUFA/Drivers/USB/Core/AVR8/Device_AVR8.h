@@ -256,6 +256,11 @@
 			}
 			#endif
 
+		/* Function Prototypes: */
+			#if !defined(NO_INTERNAL_SERIAL) && (USE_INTERNAL_SERIAL != NO_DESCRIPTOR)
+			void USB_Device_InitInternalSerialDescriptor(void);
+			#endif
+
 	#endif
 
 	/* Disable C linkage for C++ Compilers: */
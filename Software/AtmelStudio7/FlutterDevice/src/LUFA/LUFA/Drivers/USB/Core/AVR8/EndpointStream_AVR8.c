@@ -38,6 +38,31 @@
 
 #include "EndpointStream_AVR8.h"
 
+/* Moves a burst of bytes which is known to fit in (or be held by) the selected endpoint bank with the byte transfer
+ * of the template being instantiated, eight bytes per loop iteration so that the loop overhead is paid once per eight
+ * bytes rather than once per byte. Banks hold at most 256 bytes, so eight bit counters suffice. */
+#define  ENDPOINT_STREAM_BURST(BufferPtr, Count)   do {                                                              \
+                                                       uint8_t BlocksLeft = ((Count) >> 3);                          \
+                                                       uint8_t BytesLeft  = ((Count) & 0x07);                        \
+                                                                                                                     \
+                                                       while (BlocksLeft--)                                          \
+                                                       {                                                             \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                       }                                                             \
+                                                                                                                     \
+                                                       while (BytesLeft--)                                           \
+                                                       {                                                             \
+                                                           TEMPLATE_TRANSFER_BYTE(BufferPtr); TEMPLATE_BUFFER_MOVE(BufferPtr, 1); \
+                                                       }                                                             \
+                                                   } while (0)
+
 #if !defined(CONTROL_ONLY_DEVICE)
 uint8_t Endpoint_Discard_Stream(uint16_t Length,
                                 uint16_t* const BytesProcessed)
@@ -126,6 +151,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(*BufferPtr)
+#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Write_Stream_BE
@@ -134,6 +160,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(*BufferPtr)
+#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_LE
@@ -142,6 +169,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            0
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *BufferPtr = Endpoint_Read_8()
+#define  TEMPLATE_BURST_LENGTH()                 Endpoint_BytesInEndpoint()
 #include "Template/Template_Endpoint_RW.c"
 
 #define  TEMPLATE_FUNC_NAME                        Endpoint_Read_Stream_BE
@@ -150,6 +178,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 #define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 #define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
 #define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         *BufferPtr = Endpoint_Read_8()
+#define  TEMPLATE_BURST_LENGTH()                 Endpoint_BytesInEndpoint()
 #include "Template/Template_Endpoint_RW.c"
 
 #if defined(ARCH_HAS_FLASH_ADDRESS_SPACE)
@@ -159,6 +188,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            0
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(pgm_read_byte(BufferPtr))
+	#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 	#include "Template/Template_Endpoint_RW.c"
 
 	#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_PStream_BE
@@ -167,6 +197,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(pgm_read_byte(BufferPtr))
+	#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 	#include "Template/Template_Endpoint_RW.c"
 #endif
 
@@ -177,6 +208,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            0
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(eeprom_read_byte(BufferPtr))
+	#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 	#include "Template/Template_Endpoint_RW.c"
 
 	#define  TEMPLATE_FUNC_NAME                        Endpoint_Write_EStream_BE
@@ -185,6 +217,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         Endpoint_Write_8(eeprom_read_byte(BufferPtr))
+	#define  TEMPLATE_BURST_LENGTH()                 (Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint())
 	#include "Template/Template_Endpoint_RW.c"
 
 	#define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_LE
@@ -193,6 +226,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            0
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr += Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_update_byte(BufferPtr, Endpoint_Read_8())
+	#define  TEMPLATE_BURST_LENGTH()                 Endpoint_BytesInEndpoint()
 	#include "Template/Template_Endpoint_RW.c"
 
 	#define  TEMPLATE_FUNC_NAME                        Endpoint_Read_EStream_BE
@@ -201,6 +235,7 @@ uint8_t Endpoint_Null_Stream(uint16_t Length,
 	#define  TEMPLATE_BUFFER_OFFSET(Length)            (Length - 1)
 	#define  TEMPLATE_BUFFER_MOVE(BufferPtr, Amount)   BufferPtr -= Amount
 	#define  TEMPLATE_TRANSFER_BYTE(BufferPtr)         eeprom_update_byte(BufferPtr, Endpoint_Read_8())
+	#define  TEMPLATE_BURST_LENGTH()                 Endpoint_BytesInEndpoint()
 	#include "Template/Template_Endpoint_RW.c"
 #endif
 
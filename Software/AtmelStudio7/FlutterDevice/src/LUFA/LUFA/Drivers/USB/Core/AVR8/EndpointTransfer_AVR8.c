@@ -0,0 +1,200 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+#include "../../../../Common/Common.h"
+#if (ARCH == ARCH_AVR8)
+
+#define  __INCLUDE_FROM_USB_DRIVER
+#include "../USBMode.h"
+
+#if defined(USB_CAN_BE_DEVICE) && defined(INTERRUPT_DATA_ENDPOINTS)
+
+#include "../Endpoint.h"
+#include "../EndpointTransfer.h"
+
+/** Head of the transfer queue of each endpoint, indexed by endpoint number. The control endpoint's entry is unused. */
+static USB_Endpoint_Transfer_t* TransferQueues[ENDPOINT_TOTAL_ENDPOINTS];
+
+bool Endpoint_Transfer_Submit(USB_Endpoint_Transfer_t* const Transfer)
+{
+	uint8_t EndpointNumber = (Transfer->Address & ENDPOINT_EPNUM_MASK);
+
+	if (!(EndpointNumber) || (EndpointNumber >= ENDPOINT_TOTAL_ENDPOINTS))
+	  return false;
+
+	/* The status is tested and the transfer queued without interruption, as an interrupt reconfiguring the
+	 * endpoints may reset and resubmit the same transfer in between */
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	if (Transfer->Status == ENDPOINT_TRANSFER_Pending)
+	{
+		SetGlobalInterruptMask(CurrentGlobalInt);
+		return false;
+	}
+
+	Transfer->BytesTransferred = 0;
+	Transfer->Next             = NULL;
+	Transfer->Status           = ENDPOINT_TRANSFER_Pending;
+
+	USB_Endpoint_Transfer_t** QueueTail = &TransferQueues[EndpointNumber];
+
+	while (*QueueTail != NULL)
+	  QueueTail = &(*QueueTail)->Next;
+
+	*QueueTail = Transfer;
+
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+
+	Endpoint_SelectEndpoint(EndpointNumber);
+	UEIENX |= ((Transfer->Address & ENDPOINT_DIR_IN) ? (1 << TXINE) : (1 << RXOUTE));
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+
+	return true;
+}
+
+void Endpoint_Transfer_AbortAll(void)
+{
+	uint_reg_t CurrentGlobalInt = GetGlobalInterruptMask();
+	GlobalInterruptDisable();
+
+	for (uint8_t EndpointNumber = 1; EndpointNumber < ENDPOINT_TOTAL_ENDPOINTS; EndpointNumber++)
+	{
+		USB_Endpoint_Transfer_t* Transfer;
+
+		while ((Transfer = TransferQueues[EndpointNumber]) != NULL)
+		{
+			TransferQueues[EndpointNumber] = Transfer->Next;
+			Transfer->Status               = ENDPOINT_TRANSFER_Aborted;
+
+			if (Transfer->Callback != NULL)
+			  Transfer->Callback(Transfer);
+		}
+	}
+
+	SetGlobalInterruptMask(CurrentGlobalInt);
+}
+
+/** Moves as much of the given transfer as the selected endpoint's banks allow, one bank at a time.
+ *
+ *  \param[in,out] Transfer  Transfer at the head of the selected endpoint's queue.
+ *
+ *  \return Boolean \c true if the transfer has completed, \c false if it must wait for the host.
+ */
+static bool Endpoint_Transfer_MoveBanks(USB_Endpoint_Transfer_t* const Transfer)
+{
+	for (;;)
+	{
+		uint8_t* DataStream   = ((uint8_t*)Transfer->Buffer + Transfer->BytesTransferred);
+		uint16_t BytesLeft    = (Transfer->Length - Transfer->BytesTransferred);
+		uint16_t BytesInBurst;
+
+		if (Transfer->Address & ENDPOINT_DIR_IN)
+		{
+			if (!(Endpoint_IsINReady()))
+			  return false;
+
+			/* With all of the data sent, this bank is the zero length packet ending the transfer */
+			if (!(BytesLeft))
+			{
+				Endpoint_ClearIN();
+				return true;
+			}
+
+			BytesInBurst = MIN(BytesLeft, Endpoint_GetEndpointSize() - Endpoint_BytesInEndpoint());
+			Transfer->BytesTransferred += BytesInBurst;
+
+			while (BytesInBurst--)
+			  Endpoint_Write_8(*(DataStream++));
+
+			bool BankFull = (Endpoint_BytesInEndpoint() == Endpoint_GetEndpointSize());
+
+			Endpoint_ClearIN();
+
+			/* A host reading more than was sent only sees the end of the transfer once a packet is short */
+			if ((Transfer->BytesTransferred == Transfer->Length) &&
+			    !(BankFull && (Transfer->Length < Transfer->HostLength)))
+			{
+				return true;
+			}
+		}
+		else
+		{
+			if (!(Endpoint_IsOUTReceived()))
+			  return false;
+
+			uint16_t BytesInEndpoint = Endpoint_BytesInEndpoint();
+
+			BytesInBurst = MIN(BytesLeft, BytesInEndpoint);
+			Transfer->BytesTransferred += BytesInBurst;
+
+			while (BytesInBurst--)
+			  *(DataStream++) = Endpoint_Read_8();
+
+			Endpoint_ClearOUT();
+
+			if ((Transfer->BytesTransferred == Transfer->Length) || (BytesInEndpoint < Endpoint_GetEndpointSize()))
+			  return true;
+		}
+	}
+}
+
+void Endpoint_Transfer_ProcessInterrupts(void)
+{
+	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
+	uint8_t InterruptedEndpoints = Endpoint_GetEndpointInterrupts();
+
+	for (uint8_t EndpointNumber = 1; EndpointNumber < ENDPOINT_TOTAL_ENDPOINTS; EndpointNumber++)
+	{
+		if (!(InterruptedEndpoints & (1 << EndpointNumber)))
+		  continue;
+
+		Endpoint_SelectEndpoint(EndpointNumber);
+
+		USB_Endpoint_Transfer_t* Transfer;
+
+		while (((Transfer = TransferQueues[EndpointNumber]) != NULL) && Endpoint_Transfer_MoveBanks(Transfer))
+		{
+			TransferQueues[EndpointNumber] = Transfer->Next;
+			Transfer->Status               = ENDPOINT_TRANSFER_Complete;
+
+			if (Transfer->Callback != NULL)
+			  Transfer->Callback(Transfer);
+
+			Endpoint_SelectEndpoint(EndpointNumber);
+		}
+
+		/* An empty queue leaves the endpoint's bank for the next transfer to pick up, with its interrupt disabled
+		 * so that it does not fire again until then */
+		if (TransferQueues[EndpointNumber] == NULL)
+		  UEIENX &= ~((1 << TXINE) | (1 << RXOUTE));
+	}
+
+	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,100 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *  \brief Interrupt driven endpoint transfers for the AVR8 microcontrollers.
+ *  \copydetails Group_EndpointTransfer_AVR8
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the USB driver
+ *        dispatch header located in LUFA/Drivers/USB/USB.h.
+ */
+
+/** \ingroup Group_EndpointTransfer
+ *  \defgroup Group_EndpointTransfer_AVR8 Interrupt Driven Endpoint Transfers (AVR8)
+ *  \brief Interrupt driven endpoint transfers for the Atmel AVR8 architecture.
+ *
+ *  Each data endpoint keeps a queue of transfer descriptors. While its queue is not empty the endpoint's \c TXINI
+ *  or \c RXOUTI interrupt is enabled, and \c USB_COM_vect fills or empties as many banks as the controller allows
+ *  each time it fires before moving on to the next transfer in the queue.
+ *
+ *  @{
+ */
+
+#ifndef __ENDPOINT_TRANSFER_AVR8_H__
+#define __ENDPOINT_TRANSFER_AVR8_H__
+
+	/* Includes: */
+		#include "../../../../Common/Common.h"
+		#include "../USBMode.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_USB_DRIVER)
+			#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Function Prototypes: */
+			#if defined(INTERRUPT_DATA_ENDPOINTS) || defined(__DOXYGEN__)
+			/** Queues a transfer on the data endpoint given by its \c Address, behind any transfers already queued there.
+			 *  The \c Address, \c Buffer, \c Length and \c Callback of the transfer must be set beforehand, and the
+			 *  endpoint must already be configured, as configuring an endpoint disables its interrupts.
+			 *
+			 *  Each transfer starts with a new packet. An IN transfer ending with a full packet is followed by a zero
+			 *  length packet only when it is shorter than its \c HostLength, as the host otherwise waits for more data.
+			 *
+			 *  \param[in,out] Transfer  Transfer descriptor to queue.
+			 *
+			 *  \return Boolean \c true if the transfer was queued, \c false if the address is not a valid data endpoint
+			 *          or the transfer is already pending.
+			 */
+			bool Endpoint_Transfer_Submit(USB_Endpoint_Transfer_t* const Transfer) ATTR_NON_NULL_PTR_ARG(1);
+
+			/** Drops every queued transfer, marking each as \ref ENDPOINT_TRANSFER_Aborted and running its callback.
+			 *  This is done by the library on a bus reset and before the configuration changes, and may also be
+			 *  called by the application, for example on a disconnection.
+			 */
+			void Endpoint_Transfer_AbortAll(void);
+			#endif
+
+	/* Private Interface - For use in library only: */
+	#if !defined(__DOXYGEN__)
+		/* Function Prototypes: */
+			#if defined(__INCLUDE_FROM_USB_DRIVER) && defined(INTERRUPT_DATA_ENDPOINTS)
+				void Endpoint_Transfer_ProcessInterrupts(void);
+			#endif
+	#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
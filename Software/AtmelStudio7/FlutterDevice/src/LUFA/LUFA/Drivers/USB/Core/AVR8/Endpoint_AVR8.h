@@ -230,6 +230,18 @@
 				#endif
 			}
 
+			/** Indicates the size of each bank of the currently selected endpoint, as set when it was configured.
+			 *
+			 *  \ingroup Group_EndpointRW_AVR8
+			 *
+			 *  \return Size in bytes of the currently selected Endpoint's banks.
+			 */
+			static inline uint16_t Endpoint_GetEndpointSize(void) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline uint16_t Endpoint_GetEndpointSize(void)
+			{
+				return (8 << ((UECFG1X >> EPSIZE0) & 0x07));
+			}
+
 			/** Determines the currently selected endpoint's direction.
 			 *
 			 *  \return The currently selected endpoint's direction, as a \c ENDPOINT_DIR_* mask.
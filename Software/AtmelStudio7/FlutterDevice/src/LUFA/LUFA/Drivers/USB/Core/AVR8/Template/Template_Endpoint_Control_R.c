@@ -51,12 +51,13 @@ uint8_t TEMPLATE_FUNC_NAME (void* const Buffer,
 
 		if (Endpoint_IsOUTReceived())
 		{
-			while (Length && Endpoint_BytesInEndpoint())
-			{
-				TEMPLATE_TRANSFER_BYTE(DataStream);
-				TEMPLATE_BUFFER_MOVE(DataStream, 1);
-				Length--;
-			}
+			uint16_t BytesInBurst = Endpoint_BytesInEndpoint();
+
+			if (BytesInBurst > Length)
+			  BytesInBurst = Length;
+
+			ENDPOINT_STREAM_BURST(DataStream, BytesInBurst);
+			Length -= BytesInBurst;
 
 			Endpoint_ClearOUT();
 		}
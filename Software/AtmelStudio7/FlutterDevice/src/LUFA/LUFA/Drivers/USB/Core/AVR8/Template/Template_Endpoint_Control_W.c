@@ -57,14 +57,14 @@ uint8_t TEMPLATE_FUNC_NAME (const void* const Buffer,
 		if (Endpoint_IsINReady())
 		{
 			uint16_t BytesInEndpoint = Endpoint_BytesInEndpoint();
+			uint16_t BytesInBurst    = (USB_Device_ControlEndpointSize - BytesInEndpoint);
 
-			while (Length && (BytesInEndpoint < USB_Device_ControlEndpointSize))
-			{
-				TEMPLATE_TRANSFER_BYTE(DataStream);
-				TEMPLATE_BUFFER_MOVE(DataStream, 1);
-				Length--;
-				BytesInEndpoint++;
-			}
+			if (BytesInBurst > Length)
+			  BytesInBurst = Length;
+
+			ENDPOINT_STREAM_BURST(DataStream, BytesInBurst);
+			Length          -= BytesInBurst;
+			BytesInEndpoint += BytesInBurst;
 
 			LastPacketFull = (BytesInEndpoint == USB_Device_ControlEndpointSize);
 			Endpoint_ClearIN();
@@ -68,10 +68,14 @@ uint8_t TEMPLATE_FUNC_NAME (TEMPLATE_BUFFER_TYPE const Buffer,
 		}
 		else
 		{
-			TEMPLATE_TRANSFER_BYTE(DataStream);
-			TEMPLATE_BUFFER_MOVE(DataStream, 1);
-			Length--;
-			BytesInTransfer++;
+			uint16_t BytesInBurst = TEMPLATE_BURST_LENGTH();
+
+			if (BytesInBurst > Length)
+			  BytesInBurst = Length;
+
+			ENDPOINT_STREAM_BURST(DataStream, BytesInBurst);
+			Length          -= BytesInBurst;
+			BytesInTransfer += BytesInBurst;
 		}
 	}
 
@@ -84,6 +88,7 @@ uint8_t TEMPLATE_FUNC_NAME (TEMPLATE_BUFFER_TYPE const Buffer,
 #undef TEMPLATE_CLEAR_ENDPOINT
 #undef TEMPLATE_BUFFER_OFFSET
 #undef TEMPLATE_BUFFER_MOVE
+#undef TEMPLATE_BURST_LENGTH
 
 #endif
 
@@ -96,6 +96,11 @@ void USB_Init(
 	}
 	#endif
 
+	/* The signature row is read once here, rather than with interrupts disabled on every request */
+	#if defined(USB_CAN_BE_DEVICE) && !defined(NO_INTERNAL_SERIAL) && (USE_INTERNAL_SERIAL != NO_DESCRIPTOR)
+	USB_Device_InitInternalSerialDescriptor();
+	#endif
+
 	USB_IsInitialized = true;
 
 	USB_ResetInterface();
@@ -34,6 +34,16 @@
 #define  __INCLUDE_FROM_USB_DRIVER
 #include "../USBInterrupt.h"
 
+#if defined(NESTED_GENERAL_INTERRUPT)
+/** Device interrupts latched by the top half of the general interrupt and not yet handled, as a mask of
+ *  \c USB_INT_* bits.
+ */
+static volatile uint8_t USB_GeneralInterruptsLatched;
+
+/** Whether the bottom half of the general interrupt is running, in which case nested top halves only latch. */
+static volatile bool    USB_GeneralBottomHalfActive;
+#endif
+
 void USB_INT_DisableAllInterrupts(void)
 {
 	#if defined(USB_SERIES_6_AVR) || defined(USB_SERIES_7_AVR)
@@ -71,18 +81,30 @@ void USB_INT_ClearAllInterrupts(void)
 
 	#if defined(USB_CAN_BE_DEVICE)
 	UDINT  = 0;
+
+	#if defined(NESTED_GENERAL_INTERRUPT)
+	USB_GeneralInterruptsLatched = 0;
+	#endif
 	#endif
 }
 
-ISR(USB_GEN_vect, ISR_BLOCK)
+#if defined(USB_CAN_BE_DEVICE)
+/** Top half of the device interrupts of the general interrupt. Each enabled and pending source is latched and
+ *  then cleared, or masked where its flag can only be cleared once the controller clock runs again, so that the
+ *  interrupt no longer fires for it.
+ *
+ *  \return Mask of \c USB_INT_* bits of the interrupts latched.
+ */
+static inline uint8_t USB_Device_LatchGeneralInterrupts(void) ATTR_ALWAYS_INLINE;
+static inline uint8_t USB_Device_LatchGeneralInterrupts(void)
 {
-	#if defined(USB_CAN_BE_DEVICE)
+	uint8_t Latched = 0;
+
 	#if !defined(NO_SOF_EVENTS)
 	if (USB_INT_HasOccurred(USB_INT_SOFI) && USB_INT_IsEnabled(USB_INT_SOFI))
 	{
 		USB_INT_Clear(USB_INT_SOFI);
-
-		EVENT_USB_Device_StartOfFrame();
+		Latched |= (1 << USB_INT_SOFI);
 	}
 	#endif
 
@@ -90,7 +112,46 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 	if (USB_INT_HasOccurred(USB_INT_VBUSTI) && USB_INT_IsEnabled(USB_INT_VBUSTI))
 	{
 		USB_INT_Clear(USB_INT_VBUSTI);
+		Latched |= (1 << USB_INT_VBUSTI);
+	}
+	#endif
+
+	if (USB_INT_HasOccurred(USB_INT_SUSPI) && USB_INT_IsEnabled(USB_INT_SUSPI))
+	{
+		USB_INT_Disable(USB_INT_SUSPI);
+		Latched |= (1 << USB_INT_SUSPI);
+	}
+
+	if (USB_INT_HasOccurred(USB_INT_WAKEUPI) && USB_INT_IsEnabled(USB_INT_WAKEUPI))
+	{
+		USB_INT_Disable(USB_INT_WAKEUPI);
+		Latched |= (1 << USB_INT_WAKEUPI);
+	}
 
+	if (USB_INT_HasOccurred(USB_INT_EORSTI) && USB_INT_IsEnabled(USB_INT_EORSTI))
+	{
+		USB_INT_Clear(USB_INT_EORSTI);
+		Latched |= (1 << USB_INT_EORSTI);
+	}
+
+	return Latched;
+}
+
+/** Bottom half of the device interrupts of the general interrupt, handling those latched by the top half.
+ *
+ *  \param[in] Latched  Mask of \c USB_INT_* bits of the interrupts to handle.
+ */
+static inline void USB_Device_ProcessGeneralInterrupts(const uint8_t Latched) ATTR_ALWAYS_INLINE;
+static inline void USB_Device_ProcessGeneralInterrupts(const uint8_t Latched)
+{
+	#if !defined(NO_SOF_EVENTS)
+	if (Latched & (1 << USB_INT_SOFI))
+	  EVENT_USB_Device_StartOfFrame();
+	#endif
+
+	#if defined(USB_SERIES_4_AVR) || defined(USB_SERIES_6_AVR) || defined(USB_SERIES_7_AVR)
+	if (Latched & (1 << USB_INT_VBUSTI))
+	{
 		if (USB_VBUS_GetStatus())
 		{
 			if (!(USB_Options & USB_OPT_MANUAL_PLL))
@@ -113,9 +174,8 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 	}
 	#endif
 
-	if (USB_INT_HasOccurred(USB_INT_SUSPI) && USB_INT_IsEnabled(USB_INT_SUSPI))
+	if (Latched & (1 << USB_INT_SUSPI))
 	{
-		USB_INT_Disable(USB_INT_SUSPI);
 		USB_INT_Enable(USB_INT_WAKEUPI);
 
 		USB_CLK_Freeze();
@@ -132,7 +192,7 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		#endif
 	}
 
-	if (USB_INT_HasOccurred(USB_INT_WAKEUPI) && USB_INT_IsEnabled(USB_INT_WAKEUPI))
+	if (Latched & (1 << USB_INT_WAKEUPI))
 	{
 		if (!(USB_Options & USB_OPT_MANUAL_PLL))
 		{
@@ -144,7 +204,6 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 
 		USB_INT_Clear(USB_INT_WAKEUPI);
 
-		USB_INT_Disable(USB_INT_WAKEUPI);
 		USB_INT_Enable(USB_INT_SUSPI);
 
 		if (USB_Device_ConfigurationNumber)
@@ -159,10 +218,8 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		#endif
 	}
 
-	if (USB_INT_HasOccurred(USB_INT_EORSTI) && USB_INT_IsEnabled(USB_INT_EORSTI))
+	if (Latched & (1 << USB_INT_EORSTI))
 	{
-		USB_INT_Clear(USB_INT_EORSTI);
-
 		USB_DeviceState                = DEVICE_STATE_Default;
 		USB_Device_ConfigurationNumber = 0;
 
@@ -175,10 +232,55 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 
 		#if defined(INTERRUPT_CONTROL_ENDPOINT)
 		USB_INT_Enable(USB_INT_RXSTPI);
+		#elif defined(DEFERRED_CONTROL_REQUESTS)
+		USB_Device_ControlRequestDeferred = false;
+		USB_INT_Enable(USB_INT_RXSTPI);
+		#endif
+
+		#if defined(INTERRUPT_DATA_ENDPOINTS)
+		Endpoint_Transfer_AbortAll();
 		#endif
 
 		EVENT_USB_Device_Reset();
 	}
+}
+#endif
+
+ISR(USB_GEN_vect, ISR_BLOCK)
+{
+	#if defined(NESTED_GENERAL_INTERRUPT)
+	USB_GeneralInterruptsLatched |= USB_Device_LatchGeneralInterrupts();
+
+	/* An interrupt taken while the bottom half runs has been latched for it, and must not start another */
+	if (USB_GeneralBottomHalfActive)
+	  return;
+
+	USB_GeneralBottomHalfActive = true;
+	#endif
+
+	#if defined(USB_INTERRUPT_HOOKS)
+	EVENT_USB_InterruptEntry();
+	#endif
+
+	#if defined(USB_CAN_BE_DEVICE)
+	#if defined(NESTED_GENERAL_INTERRUPT)
+	/* The bottom half runs with interrupts enabled, so that the PLL lock waits and the event handlers do not hold
+	 * off the interrupts of the application; anything latched in the meantime is handled before it finishes */
+	uint8_t Latched;
+
+	while ((Latched = USB_GeneralInterruptsLatched) != 0)
+	{
+		USB_GeneralInterruptsLatched = 0;
+
+		GlobalInterruptEnable();
+		USB_Device_ProcessGeneralInterrupts(Latched);
+		GlobalInterruptDisable();
+	}
+
+	USB_GeneralBottomHalfActive = false;
+	#else
+	USB_Device_ProcessGeneralInterrupts(USB_Device_LatchGeneralInterrupts());
+	#endif
 	#endif
 
 	#if defined(USB_CAN_BE_HOST)
@@ -255,23 +357,57 @@ ISR(USB_GEN_vect, ISR_BLOCK)
 		EVENT_USB_UIDChange();
 	}
 	#endif
+
+	#if defined(USB_INTERRUPT_HOOKS)
+	EVENT_USB_InterruptExit();
+	#endif
 }
 
-#if defined(INTERRUPT_CONTROL_ENDPOINT) && defined(USB_CAN_BE_DEVICE)
+#if (defined(INTERRUPT_CONTROL_ENDPOINT) || defined(DEFERRED_CONTROL_REQUESTS) || defined(INTERRUPT_DATA_ENDPOINTS)) && \
+    defined(USB_CAN_BE_DEVICE)
 ISR(USB_COM_vect, ISR_BLOCK)
 {
+	#if defined(USB_INTERRUPT_HOOKS)
+	EVENT_USB_InterruptEntry();
+	#endif
+
 	uint8_t PrevSelectedEndpoint = Endpoint_GetCurrentEndpoint();
 
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	Endpoint_Transfer_ProcessInterrupts();
+	#endif
+
+	#if defined(INTERRUPT_CONTROL_ENDPOINT) || defined(DEFERRED_CONTROL_REQUESTS)
 	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
-	USB_INT_Disable(USB_INT_RXSTPI);
 
-	GlobalInterruptEnable();
+	/* The data endpoints share this vector, so only take a SETUP which has arrived while no other is in progress */
+	if (USB_INT_HasOccurred(USB_INT_RXSTPI) && USB_INT_IsEnabled(USB_INT_RXSTPI))
+	{
+		USB_INT_Disable(USB_INT_RXSTPI);
 
-	USB_Device_ProcessControlRequest();
+		GlobalInterruptEnable();
+
+		USB_Device_ProcessControlRequest();
+
+		/* The SETUP interrupt is enabled again with interrupts disabled, so that the next SETUP is taken once this
+		 * handler has returned rather than nested within it */
+		GlobalInterruptDisable();
+
+		Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+
+		//A deferred request keeps the SETUP interrupt disabled until USB_USBTask() has dealt with it
+		#if defined(DEFERRED_CONTROL_REQUESTS)
+		if (!(USB_Device_ControlRequestDeferred))
+		#endif
+		  USB_INT_Enable(USB_INT_RXSTPI);
+	}
+	#endif
 
-	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
-	USB_INT_Enable(USB_INT_RXSTPI);
 	Endpoint_SelectEndpoint(PrevSelectedEndpoint);
+
+	#if defined(USB_INTERRUPT_HOOKS)
+	EVENT_USB_InterruptExit();
+	#endif
 }
 #endif
 
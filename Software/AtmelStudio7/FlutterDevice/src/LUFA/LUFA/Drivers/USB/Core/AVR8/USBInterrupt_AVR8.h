@@ -54,6 +54,10 @@
 			#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
 		#endif
 
+		#if defined(NESTED_GENERAL_INTERRUPT) && defined(USB_CAN_BE_HOST)
+			#error NESTED_GENERAL_INTERRUPT is only supported in USB_DEVICE_ONLY mode.
+		#endif
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Enums: */
@@ -360,6 +364,7 @@
 			#include "../USBMode.h"
 			#include "../Events.h"
 			#include "../USBController.h"
+			#include "../EndpointTransfer.h"
 
 		/* Function Prototypes: */
 			void USB_INT_ClearAllInterrupts(void);
@@ -35,6 +35,7 @@
 
 #define  __INCLUDE_FROM_DEVICESTDREQ_C
 #include "DeviceStandardReq.h"
+#include "EndpointTransfer.h"
 
 uint8_t USB_Device_ConfigurationNumber;
 
@@ -46,6 +47,10 @@ bool    USB_Device_CurrentlySelfPowered;
 bool    USB_Device_RemoteWakeupEnabled;
 #endif
 
+#if defined(DEFERRED_CONTROL_REQUESTS)
+volatile bool USB_Device_ControlRequestDeferred;
+#endif
+
 void USB_Device_ProcessControlRequest(void)
 {
 	#if defined(ARCH_BIG_ENDIAN)
@@ -61,8 +66,36 @@ void USB_Device_ProcessControlRequest(void)
 	  *(RequestHeader++) = Endpoint_Read_8();
 	#endif
 
+	#if defined(DEFERRED_CONTROL_REQUESTS)
+	/* Only standard requests are handled in the interrupt; the others are left with the SETUP unacknowledged, so
+	 * that the controller NAKs the host until the main program has run the application's request handler. So are
+	 * SET_CONFIGURATION and SET_INTERFACE, which reconfigure the endpoints and class drivers that the main program
+	 * may be in the middle of using */
+	if (((USB_ControlRequest.bmRequestType & CONTROL_REQTYPE_TYPE) != REQTYPE_STANDARD) ||
+	    (USB_ControlRequest.bRequest == REQ_SetConfiguration) || (USB_ControlRequest.bRequest == REQ_SetInterface))
+	{
+		USB_Device_ControlRequestDeferred = true;
+		EVENT_USB_Device_ControlRequestDeferred();
+		return;
+	}
+	#else
+	EVENT_USB_Device_ControlRequest();
+	#endif
+
+	USB_Device_ProcessStandardRequest();
+}
+
+#if defined(DEFERRED_CONTROL_REQUESTS)
+void USB_Device_ProcessDeferredControlRequest(void)
+{
 	EVENT_USB_Device_ControlRequest();
 
+	USB_Device_ProcessStandardRequest();
+}
+#endif
+
+static void USB_Device_ProcessStandardRequest(void)
+{
 	if (Endpoint_IsSETUPReceived())
 	{
 		uint8_t bmRequestType = USB_ControlRequest.bmRequestType;
@@ -193,6 +226,10 @@ static void USB_Device_SetConfiguration(void)
 
 	Endpoint_ClearSETUP();
 
+	#if defined(INTERRUPT_DATA_ENDPOINTS)
+	Endpoint_Transfer_AbortAll();
+	#endif
+
 	USB_Device_ConfigurationNumber = (uint8_t)USB_ControlRequest.wValue;
 
 	Endpoint_ClearStatusStage();
@@ -216,19 +253,22 @@ static void USB_Device_GetConfiguration(void)
 }
 
 #if !defined(NO_INTERNAL_SERIAL) && (USE_INTERNAL_SERIAL != NO_DESCRIPTOR)
-static void USB_Device_GetInternalSerialDescriptor(void)
+static struct
 {
-	struct
-	{
-		USB_Descriptor_Header_t Header;
-		uint16_t                UnicodeString[INTERNAL_SERIAL_LENGTH_BITS / 4];
-	} SignatureDescriptor;
+	USB_Descriptor_Header_t Header;
+	uint16_t                UnicodeString[INTERNAL_SERIAL_LENGTH_BITS / 4];
+} SignatureDescriptor;
 
+void USB_Device_InitInternalSerialDescriptor(void)
+{
 	SignatureDescriptor.Header.Type = DTYPE_String;
 	SignatureDescriptor.Header.Size = USB_STRING_LEN(INTERNAL_SERIAL_LENGTH_BITS / 4);
 
 	USB_Device_GetSerialString(SignatureDescriptor.UnicodeString);
+}
 
+static void USB_Device_GetInternalSerialDescriptor(void)
+{
 	Endpoint_ClearSETUP();
 
 	Endpoint_Write_Control_Stream_LE(&SignatureDescriptor, sizeof(SignatureDescriptor));
@@ -132,10 +132,24 @@
 			#error Only one of the USE_*_DESCRIPTORS modes should be selected.
 		#endif
 
+		#if defined(DEFERRED_CONTROL_REQUESTS) && defined(INTERRUPT_CONTROL_ENDPOINT)
+			#error DEFERRED_CONTROL_REQUESTS and INTERRUPT_CONTROL_ENDPOINT are mutually exclusive.
+		#endif
+
+		/* External Variables: */
+			#if defined(DEFERRED_CONTROL_REQUESTS)
+				extern volatile bool USB_Device_ControlRequestDeferred;
+			#endif
+
 		/* Function Prototypes: */
 			void USB_Device_ProcessControlRequest(void);
 
+			#if defined(DEFERRED_CONTROL_REQUESTS)
+				void USB_Device_ProcessDeferredControlRequest(void);
+			#endif
+
 			#if defined(__INCLUDE_FROM_DEVICESTDREQ_C)
+				static void USB_Device_ProcessStandardRequest(void);
 				static void USB_Device_SetAddress(void);
 				static void USB_Device_SetConfiguration(void);
 				static void USB_Device_GetConfiguration(void);
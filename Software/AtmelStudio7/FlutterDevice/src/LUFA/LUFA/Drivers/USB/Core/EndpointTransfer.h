@@ -0,0 +1,137 @@
+/*
+  Copyright 2020  Tristan Luther | Swallowtail Electronics
+
+  Permission to use, copy, modify, distribute, and sell this
+  software and its documentation for any purpose is hereby granted
+  without fee, provided that the above copyright notice appear in
+  all copies and that both that the copyright notice and this
+  permission notice and warranty disclaimer appear in supporting
+  documentation, and that the name of the author not be used in
+  advertising or publicity pertaining to distribution of the
+  software without specific, written prior permission.
+
+  The author disclaims all warranties with regard to this
+  software, including all implied warranties of merchantability
+  and fitness.  In no event shall the author be liable for any
+  special, indirect or consequential damages or any damages
+  whatsoever resulting from loss of use, data or profits, whether
+  in an action of contract, negligence or other tortious action,
+  arising out of or in connection with the use or performance of
+  this software.
+*/
+
+
+/** \file
+ *  \brief Interrupt driven endpoint transfers.
+ *  \copydetails Group_EndpointTransfer
+ *
+ *  \note This file should not be included directly. It is automatically included as needed by the USB driver
+ *        dispatch header located in LUFA/Drivers/USB/USB.h.
+ */
+
+/** \ingroup Group_EndpointManagement
+ *  \defgroup Group_EndpointTransfer Interrupt Driven Endpoint Transfers
+ *  \brief Interrupt driven endpoint transfers.
+ *
+ *  Transfer descriptors which queue a buffer on a data endpoint, to be moved to or from the host one bank at a time
+ *  from the endpoint interrupt rather than by the blocking \c Endpoint_*_Stream_* functions. A transfer completes
+ *  once all of its data has been handed to the controller (IN) or a short or final packet has been read (OUT), at
+ *  which point its optional callback is run from the interrupt. Transfers on different endpoints progress
+ *  independently of one another and of the main program.
+ *
+ *  Interrupt driven transfers are only available when the \c INTERRUPT_DATA_ENDPOINTS token is defined.
+ *
+ *  @{
+ */
+
+#ifndef __ENDPOINT_TRANSFER_H__
+#define __ENDPOINT_TRANSFER_H__
+
+	/* Includes: */
+		#include "../../../Common/Common.h"
+		#include "USBMode.h"
+
+	/* Enable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			extern "C" {
+		#endif
+
+	/* Preprocessor Checks: */
+		#if !defined(__INCLUDE_FROM_USB_DRIVER)
+			#error Do not include this file directly. Include LUFA/Drivers/USB/USB.h instead.
+		#endif
+
+	/* Public Interface - May be used in end-application: */
+		/* Enums: */
+			/** Enum for the possible states of a \ref USB_Endpoint_Transfer_t. */
+			enum Endpoint_Transfer_Status_t
+			{
+				ENDPOINT_TRANSFER_Idle     = 0, /**< The transfer has not been submitted. */
+				ENDPOINT_TRANSFER_Pending  = 1, /**< The transfer is queued on its endpoint and has not yet completed. */
+				ENDPOINT_TRANSFER_Complete = 2, /**< The transfer has completed, \c BytesTransferred holds its length. */
+				ENDPOINT_TRANSFER_Aborted  = 3, /**< The transfer was dropped by a bus reset or configuration change
+				                                 *   before it completed.
+				                                 */
+			};
+
+		/* Type Defines: */
+			struct USB_Endpoint_Transfer;
+
+			/** Type define for a transfer completion callback, run from the endpoint interrupt (or from
+			 *  \ref Endpoint_Transfer_AbortAll()) with global interrupts disabled once a transfer has completed or has
+			 *  been aborted. The callback may submit further transfers, including the one just completed.
+			 */
+			typedef void (*Endpoint_TransferCallback_t)(struct USB_Endpoint_Transfer* const Transfer);
+
+			/** \brief Endpoint Transfer Descriptor.
+			 *
+			 *  Describes a buffer to be sent or received on a data endpoint by the endpoint interrupt. The descriptor
+			 *  and its buffer belong to the driver from the time the transfer is submitted until its status leaves
+			 *  \ref ENDPOINT_TRANSFER_Pending.
+			 */
+			typedef struct USB_Endpoint_Transfer
+			{
+				uint8_t  Address; /**< Address of the endpoint to transfer on, including the \c ENDPOINT_DIR_* direction. */
+				void*    Buffer; /**< Data to send to the host, or storage for the data received from the host. */
+				uint16_t Length; /**< Length in bytes of the data to send, or of the storage for received data. Any
+				                  *   received bytes beyond this length are discarded.
+				                  */
+				uint16_t HostLength; /**< Length the host reads an IN transfer with, or zero if the same as \c Length.
+				                      *   An IN transfer shorter than this whose last packet is full is followed by a
+				                      *   zero length packet, so that the host sees where it ends.
+				                      */
+				uint16_t BytesTransferred; /**< Number of bytes sent or received so far. */
+				volatile uint8_t Status; /**< Current state of the transfer, a value from \ref Endpoint_Transfer_Status_t. */
+				Endpoint_TransferCallback_t Callback; /**< Function to run once the transfer completes or is aborted,
+				                                       *   or \c NULL if the status is polled instead.
+				                                       */
+				struct USB_Endpoint_Transfer* Next; /**< Next transfer queued on the same endpoint, for internal use. */
+			} USB_Endpoint_Transfer_t;
+
+		/* Inline Functions: */
+			/** Determines if the given transfer is still queued on its endpoint.
+			 *
+			 *  \param[in] Transfer  Transfer descriptor to check.
+			 *
+			 *  \return Boolean \c true if the transfer has been submitted and has not yet completed or been aborted.
+			 */
+			static inline bool Endpoint_Transfer_IsPending(const USB_Endpoint_Transfer_t* const Transfer) ATTR_WARN_UNUSED_RESULT ATTR_ALWAYS_INLINE;
+			static inline bool Endpoint_Transfer_IsPending(const USB_Endpoint_Transfer_t* const Transfer)
+			{
+				return (Transfer->Status == ENDPOINT_TRANSFER_Pending);
+			}
+
+	/* Architecture Includes: */
+		#if (ARCH == ARCH_AVR8)
+			#include "AVR8/EndpointTransfer_AVR8.h"
+		#endif
+
+	/* Disable C linkage for C++ Compilers: */
+		#if defined(__cplusplus)
+			}
+		#endif
+
+#endif
+
+/** @} */
+
@@ -327,6 +327,48 @@
 			void EVENT_USB_Device_StartOfFrame(void);
 		#endif
 
+		#if defined(DEFERRED_CONTROL_REQUESTS) || defined(__DOXYGEN__)
+			/** Event for a control request having been deferred to the main program. With the
+			 *  \c DEFERRED_CONTROL_REQUESTS token, SETUP packets are taken and standard requests answered from the
+			 *  endpoint interrupt, while other requests are held, NAKing the host, until the next call to
+			 *  \ref USB_USBTask() runs \ref EVENT_USB_Device_ControlRequest() for them. So are the standard
+			 *  \c SET_CONFIGURATION and \c SET_INTERFACE requests, which reconfigure the endpoints and class drivers
+			 *  that the main program uses, and which are answered after the application's handler has seen them
+			 *  as in the polled mode. This event should arrange for
+			 *  that call to happen soon, for example by waking a sleeping main loop, as the time until it does is the
+			 *  latency of the request.
+			 *
+			 *  This event is time-critical; it runs in interrupt context.
+			 *
+			 *  \note This event only exists if the \c DEFERRED_CONTROL_REQUESTS token is supplied to the compiler.
+			 */
+			void EVENT_USB_Device_ControlRequestDeferred(void);
+		#endif
+
+		#if defined(USB_INTERRUPT_HOOKS) || defined(__DOXYGEN__)
+			/** Event for entry to the USB controller interrupt, fired before any of the other events raised from
+			 *  the interrupt. Together with \ref EVENT_USB_InterruptExit() this can be used to instrument the time
+			 *  spent servicing the USB controller.
+			 *
+			 *  This event is time-critical; it runs in interrupt context, with interrupts disabled, on every entry
+			 *  to the general and the endpoint interrupts of the USB controller. Those may nest when the control
+			 *  endpoint or the general interrupt is serviced with interrupts enabled, in which case the events of
+			 *  the nested interrupt are fired between those of the interrupt it preempted.
+			 *
+			 *  \note This event only exists if the \c USB_INTERRUPT_HOOKS token is supplied to the compiler.
+			 */
+			void EVENT_USB_InterruptEntry(void);
+
+			/** Event for exit from the USB controller interrupt, fired after all of the other events raised from
+			 *  the interrupt, with interrupts disabled.
+			 *
+			 *  \note This event only exists if the \c USB_INTERRUPT_HOOKS token is supplied to the compiler.
+			 *
+			 *  \see \ref EVENT_USB_InterruptEntry() event for accompanying entry event.
+			 */
+			void EVENT_USB_InterruptExit(void);
+		#endif
+
 	/* Private Interface - For use in library only: */
 	#if !defined(__DOXYGEN__)
 		/* Function Prototypes: */
@@ -358,6 +400,15 @@
 					void EVENT_USB_Device_Reset(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 					void EVENT_USB_Device_StartOfFrame(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
 				#endif
+
+				#if defined(DEFERRED_CONTROL_REQUESTS)
+					void EVENT_USB_Device_ControlRequestDeferred(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
+				#endif
+
+				#if defined(USB_INTERRUPT_HOOKS)
+					void EVENT_USB_InterruptEntry(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
+					void EVENT_USB_InterruptExit(void) ATTR_WEAK ATTR_ALIAS(USB_Event_Stub);
+				#endif
 			#endif
 	#endif
 
@@ -67,8 +67,20 @@ static void USB_DeviceTask(void)
 
 	Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
 
+	#if defined(DEFERRED_CONTROL_REQUESTS)
+	if (USB_Device_ControlRequestDeferred)
+	{
+		USB_Device_ControlRequestDeferred = false;
+
+		USB_Device_ProcessDeferredControlRequest();
+
+		Endpoint_SelectEndpoint(ENDPOINT_CONTROLEP);
+		USB_INT_Enable(USB_INT_RXSTPI);
+	}
+	#else
 	if (Endpoint_IsSETUPReceived())
 	  USB_Device_ProcessControlRequest();
+	#endif
 
 	Endpoint_SelectEndpoint(PrevEndpoint);
 }
@@ -43,6 +43,18 @@
 #ifndef _APP_CONFIG_H_
 #define _APP_CONFIG_H_
 
-	#define GENERIC_REPORT_SIZE       8
+//	#define GENERIC_FULL_SPEED_REPORTS
+
+	#if defined(GENERIC_FULL_SPEED_REPORTS)
+		#define GENERIC_REPORT_SIZE       64
+	#else
+		#define GENERIC_REPORT_SIZE       8
+	#endif
+
+//	#define SCHED_CYCLE_ACCOUNTING
+//	#define SCHED_NO_SLEEP
+//	#define POLLED_CONTROL_REQUESTS
+//	#define PROFILE_ENABLED
+//	#define WATCHDOG_ENABLED
 
 #endif
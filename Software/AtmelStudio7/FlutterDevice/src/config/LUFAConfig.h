@@ -42,6 +42,8 @@
 #ifndef _LUFA_CONFIG_H_
 #define _LUFA_CONFIG_H_
 
+	#include "AppConfig.h"
+
 	#if (ARCH == ARCH_AVR8)
 
 		/* Non-USB Related Configuration Tokens: */
@@ -64,6 +66,8 @@
 //		#define USB_STREAM_TIMEOUT_MS            {Insert Value Here}
 //		#define NO_LIMITED_CONTROLLER_CONNECT
 //		#define NO_SOF_EVENTS
+//		#define USB_INTERRUPT_HOOKS
+		#define NESTED_GENERAL_INTERRUPT
 
 		/* USB Device Mode Driver Related Tokens: */
 //		#define USE_RAM_DESCRIPTORS
@@ -75,9 +79,15 @@
 		#define FIXED_NUM_CONFIGURATIONS         1
 //		#define CONTROL_ONLY_DEVICE
 //		#define INTERRUPT_CONTROL_ENDPOINT
+		#define INTERRUPT_DATA_ENDPOINTS
 //		#define NO_DEVICE_REMOTE_WAKEUP
 //		#define NO_DEVICE_SELF_POWER
 
+		/* Control Request Handling: */
+		#if !defined(POLLED_CONTROL_REQUESTS) && !defined(INTERRUPT_CONTROL_ENDPOINT)
+			#define DEFERRED_CONTROL_REQUESTS
+		#endif
+
 		/* USB Host Mode Driver Related Tokens: */
 //		#define HOST_STATE_AS_GPIOR              {Insert Value Here}
 //		#define USB_HOST_TIMEOUT_MS              {Insert Value Here}
@@ -85,6 +95,12 @@
 //		#define NO_AUTO_VBUS_MANAGEMENT
 //		#define INVERTED_VBUS_ENABLE_LINE
 
+		/* Application Profiling Hooks: */
+		#if defined(PROFILE_ENABLED)
+			#define USB_INTERRUPT_HOOKS
+			#define SS_4201AS_INTERRUPT_HOOKS
+		#endif
+
 	#elif (ARCH == ARCH_XMEGA)
 
 		/* Non-USB Related Configuration Tokens: */
@@ -16,8 +16,14 @@ namespace segmentVolumeDevice
         // Create an instance of the USB device
         private segmentVolumeDevice theSegmentVolDevice;
 
+        // Every attached unit, each driven with the same volume
+        private List<segmentVolumeDevice> units = new List<segmentVolumeDevice>();
+
         // Create an instance of the default audio device
         private MMDevice defaultDevice;
+
+        // Set while the device is showing the mute blink, so it is only started once
+        private bool muteShown;
         public Form1()
         {
             InitializeComponent();
@@ -36,6 +42,7 @@ namespace segmentVolumeDevice
 
             // Perform an initial search for the target device
             theSegmentVolDevice.findTargetDevice();
+            findUnits();
 
             // Initialize the core audio API
             MMDeviceEnumerator devEnum = new MMDeviceEnumerator();
@@ -52,11 +59,30 @@ namespace segmentVolumeDevice
             base.WndProc(ref m);
         }
 
+        // Method to search for every attached unit again, after a device has been attached or detached
+        private void findUnits()
+        {
+            foreach (segmentVolumeDevice unit in units)
+                unit.closeUnit();
+
+            units = segmentVolumeDevice.findUnits(0x2341, 0x8036);
+
+            // Units found again are resent the mute blink
+            muteShown = false;
+        }
+
         // Listener for USB events
         private void usbEvent_receiver(object o, EventArgs e)
         {
+            findUnits();
+
             // Check the status of the USB device and update the form accordingly
-            if (theSegmentVolDevice.isDeviceAttached)
+            if (units.Count > 1)
+            {
+                // Several units are attached, all are driven
+                this.usbToolStripStatusLabel.Text = units.Count.ToString() + " Volume Level Devices Attached";
+            }
+            else if (units.Count == 1 || theSegmentVolDevice.isDeviceAttached)
             {
                 // Device is attached, do tasks here
                 this.usbToolStripStatusLabel.Text = "Volume Level Device Attached";
@@ -110,30 +136,54 @@ namespace segmentVolumeDevice
             this.volLvl.Text = Math.Round(dBToDecWin(defaultDevice.AudioEndpointVolume.MasterVolumeLevel)).ToString() + "%";
 
             byte volume = Convert.ToByte(Math.Round(dBToDecWin(defaultDevice.AudioEndpointVolume.MasterVolumeLevel)));
-
-            // Update the volume value for the device
-            theSegmentVolDevice.setNumber(volume);
-
-            // Update the level value for the device
-            theSegmentVolDevice.setLevel((byte)GetVol());
+            byte level = (byte)GetVol();
 
             //Check if the device is attached
-            if (theSegmentVolDevice.isDeviceAttached)
+            if (units.Count > 0 || theSegmentVolDevice.isDeviceAttached)
+            {
+                bool muted = defaultDevice.AudioEndpointVolume.Mute;
+
+                //Drive every unit found, or else the first device found by the HID library
+                foreach (segmentVolumeDevice device in (units.Count > 0) ? units : new List<segmentVolumeDevice> { theSegmentVolDevice })
+                {
+                    // Update the volume and level values for the device
+                    device.setNumber(volume);
+                    device.setLevel(level);
+
+                    if (muted)
+                    {
+                        //The device blinks on its own while muted, start it once
+                        if (!muteShown)
+                            device.writeMuteBlink();
+                    }
+                    else
+                    {
+                        //Send the USB command to the device, this also stops the mute blink
+                        device.writeVolume();
+                    }
+                }
+
+                muteShown = muted;
+            }
+            else
             {
-                //Send the USB command to the device
-                theSegmentVolDevice.writeVolume();
+                muteShown = false;
             }
         }
 
         // The main form is closing, clear the segement display
         private void Form1_FormClosing(object sender, FormClosingEventArgs e)
         {
-            // Update the volume/level value for the device
-            theSegmentVolDevice.setNumber(0);
-            theSegmentVolDevice.setLevel(0);
+            foreach (segmentVolumeDevice device in (units.Count > 0) ? units : new List<segmentVolumeDevice> { theSegmentVolDevice })
+            {
+                // Update the volume/level value for the device
+                device.setNumber(0);
+                device.setLevel(0);
 
-            // Send the USB command to the device
-            theSegmentVolDevice.writeVolume();
+                // Send the USB command to the device
+                device.writeVolume();
+                device.closeUnit();
+            }
         }
 
         private void Form1_Load(object sender, EventArgs e)
@@ -0,0 +1,216 @@
+﻿using System;
+using System.Collections.Generic;
+using System.IO;
+using System.Linq;
+using System.Runtime.InteropServices;
+using System.Text;
+using System.Threading.Tasks;
+using Microsoft.Win32.SafeHandles;
+
+namespace segmentVolumeDevice
+{
+    // One Flutter unit, found by its VID and PID and told apart from the others by its USB serial number. The generic
+    // HID library only ever opens the first matching device, so several units are opened and written through here
+    class flutterUnit : IDisposable
+    {
+        [StructLayout(LayoutKind.Sequential)]
+        private struct SP_DEVICE_INTERFACE_DATA
+        {
+            public int cbSize;
+            public Guid InterfaceClassGuid;
+            public int Flags;
+            public IntPtr Reserved;
+        }
+
+        [StructLayout(LayoutKind.Sequential)]
+        private struct HIDD_ATTRIBUTES
+        {
+            public int Size;
+            public ushort VendorID;
+            public ushort ProductID;
+            public ushort VersionNumber;
+        }
+
+        [DllImport("hid.dll")]
+        private static extern void HidD_GetHidGuid(out Guid hidGuid);
+
+        [DllImport("hid.dll", SetLastError = true)]
+        private static extern bool HidD_GetAttributes(SafeFileHandle device, ref HIDD_ATTRIBUTES attributes);
+
+        [DllImport("hid.dll", SetLastError = true)]
+        private static extern bool HidD_GetSerialNumberString(SafeFileHandle device, byte[] buffer, int bufferLength);
+
+        [DllImport("setupapi.dll", SetLastError = true)]
+        private static extern IntPtr SetupDiGetClassDevs(ref Guid classGuid, IntPtr enumerator, IntPtr hwndParent, int flags);
+
+        [DllImport("setupapi.dll", SetLastError = true)]
+        private static extern bool SetupDiEnumDeviceInterfaces(IntPtr deviceInfoSet, IntPtr deviceInfoData, ref Guid interfaceClassGuid,
+                                                               int memberIndex, ref SP_DEVICE_INTERFACE_DATA deviceInterfaceData);
+
+        [DllImport("setupapi.dll", SetLastError = true, CharSet = CharSet.Auto)]
+        private static extern bool SetupDiGetDeviceInterfaceDetail(IntPtr deviceInfoSet, ref SP_DEVICE_INTERFACE_DATA deviceInterfaceData,
+                                                                   IntPtr deviceInterfaceDetailData, int deviceInterfaceDetailDataSize,
+                                                                   out int requiredSize, IntPtr deviceInfoData);
+
+        [DllImport("setupapi.dll", SetLastError = true)]
+        private static extern bool SetupDiDestroyDeviceInfoList(IntPtr deviceInfoSet);
+
+        [DllImport("kernel32.dll", SetLastError = true, CharSet = CharSet.Auto)]
+        private static extern SafeFileHandle CreateFile(string fileName, uint desiredAccess, uint shareMode, IntPtr securityAttributes,
+                                                        uint creationDisposition, uint flagsAndAttributes, IntPtr templateFile);
+
+        private const int DIGCF_PRESENT = 0x02;
+        private const int DIGCF_DEVICEINTERFACE = 0x10;
+        private const uint GENERIC_READ = 0x80000000;
+        private const uint GENERIC_WRITE = 0x40000000;
+        private const uint FILE_SHARE_READ = 0x01;
+        private const uint FILE_SHARE_WRITE = 0x02;
+        private const uint OPEN_EXISTING = 3;
+
+        // Longest serial number string HidD_GetSerialNumberString returns, in bytes
+        private const int serialBufferLength = 254;
+
+        // Windows device path of the unit's HID interface
+        private string devicePath;
+
+        // Stream output reports are written to, or null while the unit is not open
+        private FileStream reportStream;
+
+        // The unit's USB serial number, unique to each unit
+        public string serialNumber { get; private set; }
+
+        // True while the unit is open for writing
+        public bool isOpen
+        {
+            get { return reportStream != null; }
+        }
+
+        private flutterUnit(string devicePath, string serialNumber)
+        {
+            this.devicePath = devicePath;
+            this.serialNumber = serialNumber;
+        }
+
+        // Method to find every attached unit with the given VID and PID, in serial number order
+        public static List<flutterUnit> findUnits(int vid, int pid)
+        {
+            List<flutterUnit> units = new List<flutterUnit>();
+
+            Guid hidGuid;
+            HidD_GetHidGuid(out hidGuid);
+
+            IntPtr deviceInfoSet = SetupDiGetClassDevs(ref hidGuid, IntPtr.Zero, IntPtr.Zero, DIGCF_PRESENT | DIGCF_DEVICEINTERFACE);
+            if (deviceInfoSet == new IntPtr(-1))
+                return units;
+
+            try
+            {
+                SP_DEVICE_INTERFACE_DATA interfaceData = new SP_DEVICE_INTERFACE_DATA();
+                interfaceData.cbSize = Marshal.SizeOf(interfaceData);
+
+                for (int memberIndex = 0; SetupDiEnumDeviceInterfaces(deviceInfoSet, IntPtr.Zero, ref hidGuid, memberIndex, ref interfaceData); memberIndex++)
+                {
+                    string path = getDevicePath(deviceInfoSet, ref interfaceData);
+                    if (path == null)
+                        continue;
+
+                    // Open without any access, which is enough to query a device that is already open elsewhere
+                    using (SafeFileHandle handle = CreateFile(path, 0, FILE_SHARE_READ | FILE_SHARE_WRITE, IntPtr.Zero, OPEN_EXISTING, 0, IntPtr.Zero))
+                    {
+                        if (handle.IsInvalid)
+                            continue;
+
+                        HIDD_ATTRIBUTES attributes = new HIDD_ATTRIBUTES();
+                        attributes.Size = Marshal.SizeOf(attributes);
+                        if (!HidD_GetAttributes(handle, ref attributes) || attributes.VendorID != vid || attributes.ProductID != pid)
+                            continue;
+
+                        byte[] serialBuffer = new byte[serialBufferLength];
+                        string serial = "";
+                        if (HidD_GetSerialNumberString(handle, serialBuffer, serialBuffer.Length))
+                            serial = Encoding.Unicode.GetString(serialBuffer).TrimEnd('\0');
+
+                        units.Add(new flutterUnit(path, serial));
+                    }
+                }
+            }
+            finally
+            {
+                SetupDiDestroyDeviceInfoList(deviceInfoSet);
+            }
+
+            return units.OrderBy(unit => unit.serialNumber).ToList();
+        }
+
+        // Method to read the device path out of a device interface detail structure
+        private static string getDevicePath(IntPtr deviceInfoSet, ref SP_DEVICE_INTERFACE_DATA interfaceData)
+        {
+            int requiredSize;
+            SetupDiGetDeviceInterfaceDetail(deviceInfoSet, ref interfaceData, IntPtr.Zero, 0, out requiredSize, IntPtr.Zero);
+            if (requiredSize == 0)
+                return null;
+
+            IntPtr detailData = Marshal.AllocHGlobal(requiredSize);
+            try
+            {
+                // cbSize is that of the fixed part of the structure, which differs between 32 and 64 bit processes
+                Marshal.WriteInt32(detailData, (IntPtr.Size == 8) ? 8 : 4 + Marshal.SystemDefaultCharSize);
+
+                if (!SetupDiGetDeviceInterfaceDetail(deviceInfoSet, ref interfaceData, detailData, requiredSize, out requiredSize, IntPtr.Zero))
+                    return null;
+
+                return Marshal.PtrToStringAuto(IntPtr.Add(detailData, 4));
+            }
+            finally
+            {
+                Marshal.FreeHGlobal(detailData);
+            }
+        }
+
+        // Method to open the unit for writing, returns false if it has gone
+        public bool open()
+        {
+            if (isOpen)
+                return true;
+
+            SafeFileHandle handle = CreateFile(devicePath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                               IntPtr.Zero, OPEN_EXISTING, 0, IntPtr.Zero);
+            if (handle.IsInvalid)
+                return false;
+
+            reportStream = new FileStream(handle, FileAccess.ReadWrite, 1, false);
+            return true;
+        }
+
+        // Method to write an output report, byte 0 being the report ID, returns false if the unit has gone
+        public bool writeReport(byte[] report)
+        {
+            if (!open())
+                return false;
+
+            try
+            {
+                reportStream.Write(report, 0, report.Length);
+                return true;
+            }
+            catch (IOException)
+            {
+                close();
+                return false;
+            }
+        }
+
+        // Method to close the unit, it is opened again by the next write
+        public void close()
+        {
+            if (reportStream != null)
+                reportStream.Dispose();
+            reportStream = null;
+        }
+
+        public void Dispose()
+        {
+            close();
+        }
+    }
+}
@@ -20,6 +20,34 @@ namespace segmentVolumeDevice
             
         }
 
+        // Class constructor for one of several attached units, written to through its own handle
+        public segmentVolumeDevice(int vid, int pid, flutterUnit unit) : this(vid, pid)
+        {
+            this.unit = unit;
+        }
+
+        // Unit the commands are written to, or null to write to the first device found by the HID library
+        private flutterUnit unit;
+
+        // The unit's USB serial number, or null for the first device found by the HID library
+        public string serialNumber
+        {
+            get { return (unit != null) ? unit.serialNumber : null; }
+        }
+
+        // Method to find every attached unit, each as its own device object so that they can be driven independently
+        public static List<segmentVolumeDevice> findUnits(int vid, int pid)
+        {
+            return flutterUnit.findUnits(vid, pid).Select(unit => new segmentVolumeDevice(vid, pid, unit)).ToList();
+        }
+
+        // Method to close the unit's handle once it is no longer used
+        public void closeUnit()
+        {
+            if (unit != null)
+                unit.close();
+        }
+
         //byte for the number to be displayed
         private byte numberDisplayed;
 
@@ -40,43 +68,126 @@ namespace segmentVolumeDevice
             levelNumber = num;
         }
 
-        // Method to write the LED brightness values to the device
-        public void writeVolume()
+        // Command types understood by the device, each sent as [type][length][value]
+        private const byte commandEnd = 0x00;
+        private const byte commandSetNumber = 0x01;
+        private const byte commandSetLeds = 0x02;
+        private const byte commandSetLevel = 0x03;
+        private const byte commandSetThresholds = 0x04;
+        private const byte commandSetBrightness = 0x05;
+        private const byte commandSetRefresh = 0x06;
+        private const byte commandSetMeter = 0x08;
+        private const byte commandAnimKeyframe = 0x09;
+        private const byte commandAnimStart = 0x0A;
+
+        // Animation slot holding the mute blink, and the keyframe flag holding values until the keyframe is reached
+        private const byte muteAnimationSlot = 0;
+        private const byte animationKeyStep = 0x01;
+
+        // Output buffer the commands are packed into, and the next free byte in it
+        private Byte[] commandBuffer = new Byte[9];
+        private int commandLength;
+
+        // Method to start a new batch of commands
+        private void beginCommands()
         {
-            // Declare our output buffer
-            Byte[] outputBuffer = new Byte[9];
-
-            // Byte 0 must be set to 0
-            outputBuffer[0] = 0;
-
-            // Byte 1 must be set to our command
-            outputBuffer[1] = 0x80;
+            // Byte 0 must be set to 0, and the zero padding marks the end of the commands
+            Array.Clear(commandBuffer, 0, commandBuffer.Length);
+            commandLength = 1;
+        }
 
-            // Fill the rest of the buffer with the display number data
-            outputBuffer[2] = numberDisplayed;
-            outputBuffer[3] = levelNumber;
+        // Method to add a command to the batch, returns false if it does not fit
+        private bool addCommand(byte type, params byte[] value)
+        {
+            if (commandLength + 2 + value.Length > commandBuffer.Length)
+                return false;
+
+            commandBuffer[commandLength++] = type;
+            commandBuffer[commandLength++] = (byte)value.Length;
+            Array.Copy(value, 0, commandBuffer, commandLength, value.Length);
+            commandLength += value.Length;
+            return true;
+        }
 
+        // Method to send the batch of commands in a single report
+        private void writeCommands()
+        {
             // Perform the write command
-            writeRawReportToDevice(outputBuffer);
+            if (unit != null)
+                unit.writeReport(commandBuffer);
+            else
+                writeRawReportToDevice(commandBuffer);
+        }
 
+        // Method to write the number and the level to the device
+        public void writeVolume()
+        {
+            beginCommands();
+            addCommand(commandSetNumber, numberDisplayed);
+            addCommand(commandSetLevel, levelNumber);
+            writeCommands();
         }
+
         //Method to write to the LED Bargraph
         public void writeLevel()
         {
-            // Declare our output buffer
-            Byte[] outputBuffer = new Byte[9];
+            beginCommands();
+            addCommand(commandSetLevel, levelNumber);
+            writeCommands();
+        }
 
-            // Byte 0 must be set to 0
-            outputBuffer[0] = 0;
+        //Method to set the levels at which each LED of the bargraph lights up
+        public void writeThresholds(byte led1, byte led2, byte led3, byte led4)
+        {
+            beginCommands();
+            addCommand(commandSetThresholds, led1, led2, led3, led4);
+            writeCommands();
+        }
 
-            // Byte 1 must be set to our command
-            outputBuffer[1] = 0x81;
+        //Method to set the display brightness from 0 to 15, without resending the number
+        public void writeBrightness(byte brightness)
+        {
+            beginCommands();
+            addCommand(commandSetBrightness, brightness);
+            writeCommands();
+        }
 
-            // Fill the rest of the buffer with the display number data
-            outputBuffer[2] = levelNumber;
+        //Method to set how the bargraph follows the level, attack and release are out of 256 per refresh (255 is instant)
+        public void writeMeterSettings(byte attack, byte release, byte peakHold, byte peakDecay)
+        {
+            beginCommands();
+            addCommand(commandSetMeter, attack, release, peakHold, peakDecay, 1);
+            writeCommands();
+        }
 
-            // Perform the write command
-            writeRawReportToDevice(outputBuffer);
+        //Method to store one keyframe of an animation, frames is the time in display refreshes taken to reach it
+        private void writeKeyframe(byte slot, byte index, byte frames, byte number, byte level, byte brightness, byte flags)
+        {
+            beginCommands();
+            addCommand(commandAnimKeyframe, (byte)((slot << 4) | index), frames, number, level, (byte)((brightness << 4) | flags));
+            writeCommands();
+        }
+
+        //Method to blink the number on the device until the next volume is written, without any further writes
+        public void writeMuteBlink()
+        {
+            // Full brightness, then dim after half a second, then full again after another half a second
+            writeKeyframe(muteAnimationSlot, 0, 0, numberDisplayed, 0, 15, 0);
+            writeKeyframe(muteAnimationSlot, 1, 50, numberDisplayed, 0, 0, animationKeyStep);
+            writeKeyframe(muteAnimationSlot, 2, 50, numberDisplayed, 0, 15, animationKeyStep);
+
+            // Loop the three keyframes until stopped
+            beginCommands();
+            addCommand(commandAnimStart, muteAnimationSlot, 3, 0);
+            writeCommands();
+        }
+
+        //Method to set how many times a second the display is refreshed
+        public void writeRefreshRate(byte refreshHz)
+        {
+            beginCommands();
+            addCommand(commandSetRefresh, refreshHz);
+            writeCommands();
         }
     }
 }
\ No newline at end of file